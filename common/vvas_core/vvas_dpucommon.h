@@ -48,6 +48,7 @@
  * @VVAS_XCLASS_ROADLINE: ROADLINE
  * @VVAS_XCLASS_ULTRAFAST: ULTRAFAST
  * @VVAS_XCLASS_RAWTENSOR: RAWTENSOR
+ * @VVAS_XCLASS_CPUREF: CPU reference model, predictions carry the emulated class
  * @VVAS_XCLASS_NOTFOUND: UNKNOWN
  */
 typedef enum {
@@ -71,6 +72,7 @@ typedef enum {
   VVAS_XCLASS_ROADLINE,
   VVAS_XCLASS_ULTRAFAST,
   VVAS_XCLASS_RAWTENSOR,
+  VVAS_XCLASS_CPUREF,
 
   VVAS_XCLASS_NOTFOUND
 }VvasClass;
@@ -61,6 +61,27 @@ typedef struct {
   VvasColorInfo box_color;
 }VvasBoundingBox;
 
+/**
+ * struct VvasBBoxTransform - Describes mapping of bounding boxes between two frames
+ * @hfactor: Horizontal scale factor applied to x and width
+ * @vfactor: Vertical scale factor applied to y and height
+ * @xoffset: Horizontal offset added to x after scaling
+ * @yoffset: Vertical offset added to y after scaling
+ * @clip_width: Boxes are clipped to [0, clip_width), 0 disables horizontal clipping
+ * @clip_height: Boxes are clipped to [0, clip_height), 0 disables vertical clipping
+ * @round_position: Round x and y to nearest integer when true, truncate when false.
+ *                  Width and height are always rounded to nearest integer.
+ */
+typedef struct {
+  double hfactor;
+  double vfactor;
+  double xoffset;
+  double yoffset;
+  uint32_t clip_width;
+  uint32_t clip_height;
+  bool round_position;
+}VvasBBoxTransform;
+
 /**
  * struct Pointf - coordinate of point
  * @x: horizontal coordinate of the upper position in pixels
@@ -197,10 +218,13 @@ enum seg_type
  * @type: enum to hold type of segmentation
  * @width: Width of output image
  * @height: Height of output image
- * @fmt: Segmentation output format
- * @data: Segmentation output data
+ * @fmt: Segmentation output format, "BGR", "GRAY8" or "RLE"
+ * @data: Segmentation output data. For "RLE" it is an array of uint32_t runs,
+ *        class index in the 8 most significant bits and length in the others,
+ *        runs do not span rows and cover width * height pixels.
  * @free: function pointer to free data
- * @copy: function pointer to copy data
+ * @copy: function pointer to copy data, copies may share @data which must
+ *        be treated as read only
  */
 typedef struct {
   enum seg_type type;
@@ -253,6 +277,8 @@ typedef struct {
  * @reid: Getting feature from an image
  * @segmentation: Segmentation data
  * @tb: Rawtensor data
+ * @ref_count: Reference count, trees handed out shared are read only and are
+ *             freed by the last vvas_inferprediction_free()
  */
 typedef struct {
   uint64_t prediction_id;
@@ -270,6 +296,7 @@ typedef struct {
   Reid reid;
   Segmentation segmentation;
   TensorBuf *tb;
+  atomic_int ref_count;
 }VvasInferPrediction;
 
 /**
@@ -315,11 +342,25 @@ VvasInferPrediction* vvas_inferprediction_copy(VvasInferPrediction *smeta);
  void* vvas_inferprediction_node_copy(const void *infer, void *data);
 
 
+/**
+ *  vvas_inferprediction_ref () - Takes a reference on a prediction tree
+ *
+ *  @self: Address of the root of a prediction tree
+ *
+ *  Context: A referenced tree is shared and must be treated as read only,
+ *           each reference is dropped by vvas_inferprediction_free().
+ *
+ *  Return: @self
+ */
+VvasInferPrediction* vvas_inferprediction_ref(VvasInferPrediction *self);
+
 /**
  *  vvas_inferprediction_free () - This function deallocates memory for @VvasInferPrediction
  *
  *  @self: Address of the object handle to be freed
  *
+ *  Context: When other references to @self are held, only drops one of them.
+ *
  *  Return: none 
  */ 
 void vvas_inferprediction_free(VvasInferPrediction *self);
@@ -342,6 +383,69 @@ char *vvas_inferprediction_to_string (VvasInferPrediction * self);
  */
 uint64_t vvas_inferprediction_get_prediction_id(void);
 
+/**
+ *  vvas_bbox_transform_set_scale () - Initializes transform to scale boxes between two resolutions
+ *
+ *  @xform: Address of @VvasBBoxTransform to be initialized
+ *  @src_width: Width of the frame boxes are currently relative to
+ *  @src_height: Height of the frame boxes are currently relative to
+ *  @dst_width: Width of the frame boxes are to be mapped to
+ *  @dst_height: Height of the frame boxes are to be mapped to
+ *
+ *  Positions are truncated and no clipping is done, caller may update
+ *  @xform fields after this call.
+ *
+ *  Return: none
+ */
+void vvas_bbox_transform_set_scale (VvasBBoxTransform * xform,
+    uint32_t src_width, uint32_t src_height, uint32_t dst_width,
+    uint32_t dst_height);
+
+/**
+ *  vvas_bbox_transform_set_letterbox_inverse () - Initializes transform to map boxes
+ *  from a letterboxed model input back to the source frame
+ *
+ *  @xform: Address of @VvasBBoxTransform to be initialized
+ *  @model_width: Width of the model input holding the letterboxed image
+ *  @model_height: Height of the model input holding the letterboxed image
+ *  @src_width: Width of the source frame
+ *  @src_height: Height of the source frame
+ *
+ *  Source frame is assumed to be scaled preserving aspect ratio and centered in
+ *  the model input. Resulting boxes are clipped to the source frame.
+ *
+ *  Return: none
+ */
+void vvas_bbox_transform_set_letterbox_inverse (VvasBBoxTransform * xform,
+    uint32_t model_width, uint32_t model_height, uint32_t src_width,
+    uint32_t src_height);
+
+/**
+ *  vvas_bbox_transform_apply () - Transforms an array of bounding boxes in place
+ *
+ *  @bbox: Array of bounding boxes
+ *  @num_bbox: Number of entries in @bbox
+ *  @xform: Transform to be applied
+ *
+ *  Positions saturate to the int32 range and sizes to 0..INT32_MAX, a NaN
+ *  result gives the lower bound.
+ *
+ *  Return: none
+ */
+void vvas_bbox_transform_apply (VvasBoundingBox * bbox, uint32_t num_bbox,
+    const VvasBBoxTransform * xform);
+
+/**
+ *  vvas_inferprediction_transform () - Transforms bounding boxes of all nodes of a prediction tree in place
+ *
+ *  @self: Address of root @VvasInferPrediction of the tree
+ *  @xform: Transform to be applied
+ *
+ *  Return: none
+ */
+void vvas_inferprediction_transform (VvasInferPrediction * self,
+    const VvasBBoxTransform * xform);
+
 
 #ifdef __cplusplus
 }
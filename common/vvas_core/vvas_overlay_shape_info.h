@@ -24,6 +24,7 @@
 #define __VVAS_OVERLAY_SHAPE_INFO_H__
 
 #include <vvas_utils/vvas_utils.h>
+#include <vvas_core/vvas_common.h>
 
 /**
  * enum VvasOverlayArrowDirection - Structure representing Arrow Direction information
@@ -55,7 +56,8 @@ typedef struct {
  * @red: red value
  * @green: green value
  * @blue: blue value
- * @alpha: alpha value
+ * @alpha: Opacity of rectangles, text backgrounds and polygons, from 1 (almost
+ *         transparent) to 255 (opaque). 0 is treated as opaque
  */
 typedef struct {
   uint8_t red;
@@ -174,6 +176,71 @@ typedef struct {
   VvasOverlayColorData poly_color; 
 } VvasOverlayPolygonParams;
 
+/**
+ * enum VvasOverlayMaskType - Enum representing type of mask
+ * @MASK_TYPE_CLASS_MAP: Each mask pixel is a class index, drawn with the
+ *                       palette color at that index
+ * @MASK_TYPE_BINARY: Non zero mask pixels are drawn with the first palette
+ *                    color, zero pixels are left untouched
+ */
+typedef enum {
+    /** Mask of class indices */
+  MASK_TYPE_CLASS_MAP,
+    /** Mask of object and background pixels */
+  MASK_TYPE_BINARY
+} VvasOverlayMaskType;
+
+/**
+ * enum VvasOverlayMaskScaling - Enum representing scaling of mask to the frame
+ * @MASK_SCALING_NEAREST: Nearest mask pixel is used
+ * @MASK_SCALING_BILINEAR: Colors of neighbouring mask pixels are
+ *                         interpolated, giving smooth edges
+ */
+typedef enum {
+    /** Nearest neighbour scaling */
+  MASK_SCALING_NEAREST,
+    /** Bilinear scaling */
+  MASK_SCALING_BILINEAR
+} VvasOverlayMaskScaling;
+
+/**
+ * struct VvasOverlayMaskParams - Structure representing information to blend
+ * a segmentation or object mask on frame.
+ * @points: top left corner of the frame region covered by the mask
+ * @width: width of the region, mask is scaled to it
+ * @height: height of the region, mask is scaled to it
+ * @mask_type: type of mask
+ * @scaling: scaling of mask to the region
+ * @mask_width: width of the mask
+ * @mask_height: height of the mask
+ * @mask_stride: number of bytes between rows of the mask
+ * @mask_data: one byte per mask pixel. It is not copied nor freed with the
+ *             shape and must remain valid until the shape is drawn
+ * @num_colors: number of colors in @palette, classes beyond it are not drawn
+ * @palette: color of each class, alpha of each color scales @alpha. It is not
+ *           copied nor freed with the shape and must remain valid until the
+ *           shape is drawn
+ * @ignore_class: class of a class map which is not drawn, usually the
+ *                background class, -1 to draw all classes
+ * @alpha: opacity of the mask, from 1 (almost transparent) to 255 (opaque).
+ *         0 is treated as opaque
+ */
+typedef struct {
+  VvasOverlayCoordinates points;
+  uint32_t width;
+  uint32_t height;
+  VvasOverlayMaskType mask_type;
+  VvasOverlayMaskScaling scaling;
+  uint32_t mask_width;
+  uint32_t mask_height;
+  uint32_t mask_stride;
+  const uint8_t *mask_data;
+  uint32_t num_colors;
+  const VvasOverlayColorData *palette;
+  int32_t ignore_class;
+  uint8_t alpha;
+} VvasOverlayMaskParams;
+
 /**
  * struct VvasOverlayShapeInfo - Structure representing Overlay Shape information
  * @num_rects: number of rectangles to be displayed
@@ -188,6 +255,10 @@ typedef struct {
  * @arrow_params: arrow meta information
  * @circle_params: circle meta information
  * @polygn_params: polygon meta information
+ * @num_masks: number of masks to be blended, at most this many entries of
+ *             @mask_params are read
+ * @mask_params: mask meta information, masks are drawn below other shapes.
+ *               No mask is drawn when it is NULL, whatever @num_masks is
  */ 
 typedef struct {
   uint32_t num_rects;
@@ -202,8 +273,75 @@ typedef struct {
   VvasList *arrow_params;
   VvasList *circle_params;
   VvasList *polygn_params;
+  uint32_t num_masks;
+  VvasList *mask_params;
 } VvasOverlayShapeInfo;
 
+/**
+ * struct VvasOverlayShapeBatch - Structure representing Overlay Shape information
+ * stored in contiguous arrays. Storage grows on demand and is retained when
+ * the batch is reset, so that a batch reused across frames does not allocate
+ * once it has reached the working set size.
+ * @num_rects: number of rectangles in @rects
+ * @num_text: number of texts in @texts
+ * @num_lines: number of lines in @lines
+ * @num_arrows: number of arrows in @arrows
+ * @num_circles: number of circles in @circles
+ * @num_polys: number of polygons in @polygons
+ * @num_masks: number of masks in @masks
+ * @num_points: number of polygon points in @points
+ * @text_len: number of bytes used in @text_pool
+ * @rects_size: allocated number of elements in @rects
+ * @text_size: allocated number of elements in @texts
+ * @lines_size: allocated number of elements in @lines
+ * @arrows_size: allocated number of elements in @arrows
+ * @circles_size: allocated number of elements in @circles
+ * @polys_size: allocated number of elements in @polygons and @poly_pt_offsets
+ * @masks_size: allocated number of elements in @masks
+ * @points_size: allocated number of elements in @points
+ * @text_pool_size: allocated size of @text_pool in bytes
+ * @rects: rectangle information
+ * @texts: text information, disp_text of each entry points into @text_pool
+ * @lines: line information
+ * @arrows: arrow information
+ * @circles: circle information
+ * @polygons: polygon information, poly_pts of each entry is unused (NULL)
+ * @poly_pt_offsets: index of the first point of each polygon in @points
+ * @points: points of all polygons
+ * @masks: mask information
+ * @text_pool: storage of all text strings
+ */
+typedef struct {
+  uint32_t num_rects;
+  uint32_t num_text;
+  uint32_t num_lines;
+  uint32_t num_arrows;
+  uint32_t num_circles;
+  uint32_t num_polys;
+  uint32_t num_masks;
+  uint32_t num_points;
+  uint32_t text_len;
+  uint32_t rects_size;
+  uint32_t text_size;
+  uint32_t lines_size;
+  uint32_t arrows_size;
+  uint32_t circles_size;
+  uint32_t polys_size;
+  uint32_t masks_size;
+  uint32_t points_size;
+  uint32_t text_pool_size;
+  VvasOverlayRectParams *rects;
+  VvasOverlayTextParams *texts;
+  VvasOverlayLineParams *lines;
+  VvasOverlayArrowParams *arrows;
+  VvasOverlayCircleParams *circles;
+  VvasOverlayPolygonParams *polygons;
+  uint32_t *poly_pt_offsets;
+  VvasOverlayCoordinates *points;
+  VvasOverlayMaskParams *masks;
+  char *text_pool;
+} VvasOverlayShapeBatch;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -234,6 +372,151 @@ void vvas_overlay_shape_info_copy (VvasOverlayShapeInfo *dest_shape_info, VvasOv
 
 void vvas_overlay_shape_info_free (VvasOverlayShapeInfo *shape_info);
 
+/**
+ * vvas_overlay_shape_batch_init() - Initializes an empty shape batch
+ * @batch: Pointer to shape batch structure
+ *
+ * Return: none
+ */
+void vvas_overlay_shape_batch_init (VvasOverlayShapeBatch *batch);
+
+/**
+ * vvas_overlay_shape_batch_reset() - Removes all shapes from the batch while
+ * keeping its storage for reuse
+ * @batch: Pointer to shape batch structure
+ *
+ * Return: none
+ */
+void vvas_overlay_shape_batch_reset (VvasOverlayShapeBatch *batch);
+
+/**
+ * vvas_overlay_shape_batch_free() - Frees storage of the shape batch
+ * @batch: Pointer to shape batch structure
+ *
+ * Return: none
+ */
+void vvas_overlay_shape_batch_free (VvasOverlayShapeBatch *batch);
+
+/**
+ * vvas_overlay_shape_batch_add_rect() - Appends a rectangle to the batch
+ * @batch: Pointer to shape batch structure
+ * @rect: Rectangle to be copied into the batch
+ *
+ * Return:
+ * * On Success returns address of the rectangle stored in the batch, which
+ *   remains valid until the next addition of a rectangle.
+ * * On Failure returns NULL.
+ */
+VvasOverlayRectParams *vvas_overlay_shape_batch_add_rect (VvasOverlayShapeBatch *batch,
+    const VvasOverlayRectParams *rect);
+
+/**
+ * vvas_overlay_shape_batch_add_text() - Appends a text to the batch
+ * @batch: Pointer to shape batch structure
+ * @text: Text to be copied into the batch, disp_text is copied into the
+ *        text pool of the batch
+ *
+ * Return:
+ * * On Success returns address of the text stored in the batch, which
+ *   remains valid until the next addition of a text.
+ * * On Failure returns NULL.
+ */
+VvasOverlayTextParams *vvas_overlay_shape_batch_add_text (VvasOverlayShapeBatch *batch,
+    const VvasOverlayTextParams *text);
+
+/**
+ * vvas_overlay_shape_batch_add_line() - Appends a line to the batch
+ * @batch: Pointer to shape batch structure
+ * @line: Line to be copied into the batch
+ *
+ * Return:
+ * * On Success returns address of the line stored in the batch, which
+ *   remains valid until the next addition of a line.
+ * * On Failure returns NULL.
+ */
+VvasOverlayLineParams *vvas_overlay_shape_batch_add_line (VvasOverlayShapeBatch *batch,
+    const VvasOverlayLineParams *line);
+
+/**
+ * vvas_overlay_shape_batch_add_arrow() - Appends an arrow to the batch
+ * @batch: Pointer to shape batch structure
+ * @arrow: Arrow to be copied into the batch
+ *
+ * Return:
+ * * On Success returns address of the arrow stored in the batch, which
+ *   remains valid until the next addition of an arrow.
+ * * On Failure returns NULL.
+ */
+VvasOverlayArrowParams *vvas_overlay_shape_batch_add_arrow (VvasOverlayShapeBatch *batch,
+    const VvasOverlayArrowParams *arrow);
+
+/**
+ * vvas_overlay_shape_batch_add_circle() - Appends a circle to the batch
+ * @batch: Pointer to shape batch structure
+ * @circle: Circle to be copied into the batch
+ *
+ * Return:
+ * * On Success returns address of the circle stored in the batch, which
+ *   remains valid until the next addition of a circle.
+ * * On Failure returns NULL.
+ */
+VvasOverlayCircleParams *vvas_overlay_shape_batch_add_circle (VvasOverlayShapeBatch *batch,
+    const VvasOverlayCircleParams *circle);
+
+/**
+ * vvas_overlay_shape_batch_add_polygon() - Appends a polygon to the batch
+ * @batch: Pointer to shape batch structure
+ * @polygon: Polygon to be copied into the batch, poly_pts and num_pts are ignored
+ * @pts: Points of the polygon. When NULL, @num_pts points are reserved in
+ *       points of the batch and are expected to be filled by the caller
+ * @num_pts: Number of points of the polygon
+ *
+ * Return:
+ * * On Success returns address of the polygon stored in the batch, which
+ *   remains valid until the next addition of a polygon.
+ * * On Failure returns NULL.
+ */
+VvasOverlayPolygonParams *vvas_overlay_shape_batch_add_polygon (VvasOverlayShapeBatch *batch,
+    const VvasOverlayPolygonParams *polygon, const VvasOverlayCoordinates *pts,
+    uint32_t num_pts);
+
+/**
+ * vvas_overlay_shape_batch_add_mask() - Appends a mask to the batch
+ * @batch: Pointer to shape batch structure
+ * @mask: Mask to be copied into the batch, mask_data and palette are not
+ *        copied and must remain valid until the batch is drawn
+ *
+ * Return:
+ * * On Success returns address of the mask stored in the batch, which
+ *   remains valid until the next addition of a mask.
+ * * On Failure returns NULL.
+ */
+VvasOverlayMaskParams *vvas_overlay_shape_batch_add_mask (VvasOverlayShapeBatch *batch,
+    const VvasOverlayMaskParams *mask);
+
+/**
+ * vvas_overlay_shape_batch_from_info() - Replaces content of the batch with
+ * shapes from list based shape information
+ * @batch: Pointer to shape batch structure
+ * @shape_info: Shape information to be converted
+ *
+ * Return: &enum VvasReturnType
+ */
+VvasReturnType vvas_overlay_shape_batch_from_info (VvasOverlayShapeBatch *batch,
+    const VvasOverlayShapeInfo *shape_info);
+
+/**
+ * vvas_overlay_shape_batch_to_info() - Appends shapes of the batch to list
+ * based shape information
+ * @batch: Pointer to shape batch structure
+ * @shape_info: Shape information to which shapes are appended, it must be
+ *              released using vvas_overlay_shape_info_free()
+ *
+ * Return: &enum VvasReturnType
+ */
+VvasReturnType vvas_overlay_shape_batch_to_info (const VvasOverlayShapeBatch *batch,
+    VvasOverlayShapeInfo *shape_info);
+
 #ifdef __cplusplus
 }
 #endif
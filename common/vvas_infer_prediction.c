@@ -16,11 +16,17 @@
  * limitations under the License.
  */
 
+#include "config.h"
 #include <vvas_core/vvas_infer_prediction.h>
 #include <vvas_core/vvas_log.h>
 #include <stdlib.h>
 #include <string.h>
 #include <vvas_utils/vvas_utils.h>
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #define LOG_LEVEL     (LOG_LEVEL_WARNING)
 
@@ -30,6 +36,22 @@
 #define LOG_D(...)    (LOG_MESSAGE(LOG_LEVEL_DEBUG, LOG_LEVEL,  __VA_ARGS__))
 #define MAX_LEN       2048
 
+/* Number of bounding boxes gathered into packed arrays before transforming */
+#define VVAS_BBOX_BATCH_SIZE  (64u)
+/* transformed boxes are clamped to what fits in VvasBoundingBox */
+#define VVAS_BBOX_MIN_POS     ((double) INT32_MIN)
+#define VVAS_BBOX_MAX_POS     ((double) INT32_MAX)
+
+/** @struct VvasBBoxBatch
+ *  @brief  Bounding boxes collected from a prediction tree for transformation.
+ */
+typedef struct
+{
+  const VvasBBoxTransform *xform;
+  uint32_t num;
+  VvasBoundingBox *bbox[VVAS_BBOX_BATCH_SIZE];
+} VvasBBoxBatch;
+
 static char *prediction_to_string (VvasInferPrediction * self, int level);
 static char *prediction_classes_to_string (VvasInferPrediction * self,
     int level);
@@ -243,6 +265,7 @@ vvas_inferprediction_new (void)
     infer->segmentation.data = NULL;
     infer->feature.type = UNKNOWN_FEATURE;
     infer->tb = NULL;
+    atomic_init (&infer->ref_count, 1);
 
     infer->node = vvas_treenode_new (infer);
   } else {
@@ -323,6 +346,22 @@ vvas_inferprediction_copy (VvasInferPrediction * smeta)
   return Node->data;
 }
 
+/**
+ *  @fn  VvasInferPrediction * vvas_inferprediction_ref (VvasInferPrediction * self)
+ *  @param [in] self - Root of a prediction tree
+ *  @return @self
+ *  @brief This function takes a reference on a prediction tree, which is then
+ *         shared read only until every reference is freed.
+ */
+VvasInferPrediction *
+vvas_inferprediction_ref (VvasInferPrediction * self)
+{
+  if (NULL != self) {
+    atomic_fetch_add (&self->ref_count, 1);
+  }
+  return self;
+}
+
 /**
  *  @fn  void vvas_inferprediction_free(VvasInferPrediction *self);
  *  @param [in] self - Address of VvasInferPrediction
@@ -337,6 +376,11 @@ vvas_inferprediction_free (VvasInferPrediction * self)
     return;
   }
 
+  /* other holders of a shared tree keep it alive */
+  if (atomic_fetch_sub (&self->ref_count, 1) > 1) {
+    return;
+  }
+
   VvasList *pred_nodes = vvas_inferprediction_get_nodes (self);
 
   if (NULL == pred_nodes) {
@@ -552,3 +596,301 @@ uint64_t vvas_inferprediction_get_prediction_id(void)
 
   return ret;
 }
+
+/**
+ *  @fn void vvas_bbox_transform_set_scale (VvasBBoxTransform * xform,
+ *                                          uint32_t src_width,
+ *                                          uint32_t src_height,
+ *                                          uint32_t dst_width,
+ *                                          uint32_t dst_height)
+ *  @param [out] xform - Transform to be initialized.
+ *  @param [in] src_width - Width of the frame boxes are relative to.
+ *  @param [in] src_height - Height of the frame boxes are relative to.
+ *  @param [in] dst_width - Width of the frame boxes are mapped to.
+ *  @param [in] dst_height - Height of the frame boxes are mapped to.
+ *  @return none
+ *  @brief This function initializes transform for scaling boxes between resolutions.
+ */
+void
+vvas_bbox_transform_set_scale (VvasBBoxTransform * xform, uint32_t src_width,
+    uint32_t src_height, uint32_t dst_width, uint32_t dst_height)
+{
+  if (NULL == xform) {
+    LOG_D ("NULL received");
+    return;
+  }
+
+  memset (xform, 0x0, sizeof (VvasBBoxTransform));
+  xform->hfactor = src_width ? ((dst_width * 1.0) / src_width) : 1.0;
+  xform->vfactor = src_height ? ((dst_height * 1.0) / src_height) : 1.0;
+}
+
+/**
+ *  @fn void vvas_bbox_transform_set_letterbox_inverse (VvasBBoxTransform * xform,
+ *                                                      uint32_t model_width,
+ *                                                      uint32_t model_height,
+ *                                                      uint32_t src_width,
+ *                                                      uint32_t src_height)
+ *  @param [out] xform - Transform to be initialized.
+ *  @param [in] model_width - Width of the letterboxed model input.
+ *  @param [in] model_height - Height of the letterboxed model input.
+ *  @param [in] src_width - Width of the source frame.
+ *  @param [in] src_height - Height of the source frame.
+ *  @return none
+ *  @brief This function initializes transform for mapping boxes from a
+ *         letterboxed model input back to the source frame.
+ */
+void
+vvas_bbox_transform_set_letterbox_inverse (VvasBBoxTransform * xform,
+    uint32_t model_width, uint32_t model_height, uint32_t src_width,
+    uint32_t src_height)
+{
+  double hratio, vratio, ratio;
+
+  if (NULL == xform) {
+    LOG_D ("NULL received");
+    return;
+  }
+
+  memset (xform, 0x0, sizeof (VvasBBoxTransform));
+  if (!model_width || !model_height || !src_width || !src_height) {
+    LOG_E ("Invalid resolution model %ux%u, source %ux%u", model_width,
+        model_height, src_width, src_height);
+    xform->hfactor = xform->vfactor = 1.0;
+    return;
+  }
+
+  /* source is scaled by the smaller ratio and centered in the model input */
+  hratio = (model_width * 1.0) / src_width;
+  vratio = (model_height * 1.0) / src_height;
+  ratio = (hratio < vratio) ? hratio : vratio;
+
+  xform->hfactor = 1.0 / ratio;
+  xform->vfactor = 1.0 / ratio;
+  xform->xoffset = -((model_width - src_width * ratio) / 2.0) / ratio;
+  xform->yoffset = -((model_height - src_height * ratio) / 2.0) / ratio;
+  xform->clip_width = src_width;
+  xform->clip_height = src_height;
+}
+
+/**
+ *  @fn static void vvas_bbox_transform_packed (double *pos, double *size,
+ *                                              uint32_t num, double factor,
+ *                                              double offset, uint32_t clip,
+ *                                              bool round_position)
+ *  @param [inout] pos - Packed x (or y) coordinates.
+ *  @param [inout] size - Packed widths (or heights).
+ *  @param [in] num - Number of entries in @pos and @size.
+ *  @param [in] factor - Scale factor.
+ *  @param [in] offset - Offset added to position after scaling.
+ *  @param [in] clip - Clip limit, 0 to disable clipping.
+ *  @param [in] round_position - Round position when true, truncate otherwise.
+ *  @return none
+ *  @brief This function transforms one axis of packed boxes, using SIMD where
+ *         available. All paths produce identical results. Positions are
+ *         clamped to int32 range and sizes to 0..INT32_MAX before rounding,
+ *         NaN becomes the lower bound.
+ */
+static void
+vvas_bbox_transform_packed (double *pos, double *size, uint32_t num,
+    double factor, double offset, uint32_t clip, bool round_position)
+{
+  uint32_t i = 0;
+  double limit = clip;
+
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+  float64x2_t _factor = vdupq_n_f64 (factor);
+  float64x2_t _offset = vdupq_n_f64 (offset);
+  float64x2_t _limit = vdupq_n_f64 (limit);
+  float64x2_t _zero = vdupq_n_f64 (0.0);
+  float64x2_t _min = vdupq_n_f64 (VVAS_BBOX_MIN_POS);
+  float64x2_t _max = vdupq_n_f64 (VVAS_BBOX_MAX_POS);
+
+  /* maxnm/minnm return the number when other operand is NaN */
+  for (; i + 2 <= num; i += 2) {
+    float64x2_t _pos = vaddq_f64 (vmulq_f64 (vld1q_f64 (pos + i), _factor),
+        _offset);
+    float64x2_t _size = vmulq_f64 (vld1q_f64 (size + i), _factor);
+
+    _pos = vminnmq_f64 (vmaxnmq_f64 (_pos, _min), _max);
+    _size = vrndnq_f64 (vminnmq_f64 (vmaxnmq_f64 (_size, _zero), _max));
+    _pos = round_position ? vrndnq_f64 (_pos) : vrndq_f64 (_pos);
+    if (clip) {
+      float64x2_t _end = vminq_f64 (vaddq_f64 (_pos, _size), _limit);
+      _pos = vminq_f64 (vmaxq_f64 (_pos, _zero), _limit);
+      _size = vmaxq_f64 (vsubq_f64 (_end, _pos), _zero);
+    }
+    vst1q_f64 (pos + i, _pos);
+    vst1q_f64 (size + i, _size);
+  }
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+  __m128d _factor = _mm_set1_pd (factor);
+  __m128d _offset = _mm_set1_pd (offset);
+  __m128d _limit = _mm_set1_pd (limit);
+  __m128d _zero = _mm_setzero_pd ();
+  __m128d _min = _mm_set1_pd (VVAS_BBOX_MIN_POS);
+  __m128d _max = _mm_set1_pd (VVAS_BBOX_MAX_POS);
+
+  /* conversions below use default MXCSR rounding i.e. nearest even, values
+   * are clamped first as out of range values convert to INT32_MIN. max_pd
+   * returns its second operand when first is NaN */
+  for (; i + 2 <= num; i += 2) {
+    __m128d _pos = _mm_add_pd (_mm_mul_pd (_mm_loadu_pd (pos + i), _factor),
+        _offset);
+    __m128d _size = _mm_mul_pd (_mm_loadu_pd (size + i), _factor);
+
+    _pos = _mm_min_pd (_mm_max_pd (_pos, _min), _max);
+    _size = _mm_cvtepi32_pd (_mm_cvtpd_epi32 (_mm_min_pd (_mm_max_pd (_size,
+                    _zero), _max)));
+    _pos = round_position ? _mm_cvtepi32_pd (_mm_cvtpd_epi32 (_pos)) :
+        _mm_cvtepi32_pd (_mm_cvttpd_epi32 (_pos));
+    if (clip) {
+      __m128d _end = _mm_min_pd (_mm_add_pd (_pos, _size), _limit);
+      _pos = _mm_min_pd (_mm_max_pd (_pos, _zero), _limit);
+      _size = _mm_max_pd (_mm_sub_pd (_end, _pos), _zero);
+    }
+    _mm_storeu_pd (pos + i, _pos);
+    _mm_storeu_pd (size + i, _size);
+  }
+#endif
+
+  for (; i < num; i++) {
+    double p = pos[i] * factor + offset;
+    double sz = size[i] * factor;
+
+    p = (p > VVAS_BBOX_MIN_POS) ? p : VVAS_BBOX_MIN_POS;
+    p = (p < VVAS_BBOX_MAX_POS) ? p : VVAS_BBOX_MAX_POS;
+    sz = (sz > 0.0) ? sz : 0.0;
+    sz = nearbyint ((sz < VVAS_BBOX_MAX_POS) ? sz : VVAS_BBOX_MAX_POS);
+    p = round_position ? nearbyint (p) : trunc (p);
+    if (clip) {
+      double end = ((p + sz) < limit) ? (p + sz) : limit;
+      p = (p > 0.0) ? p : 0.0;
+      p = (p < limit) ? p : limit;
+      sz = ((end - p) > 0.0) ? (end - p) : 0.0;
+    }
+    pos[i] = p;
+    size[i] = sz;
+  }
+}
+
+/**
+ *  @fn static void vvas_bbox_batch_flush (VvasBBoxBatch * batch)
+ *  @param [inout] batch - Collected bounding boxes.
+ *  @return none
+ *  @brief This function gathers collected boxes into packed arrays, transforms
+ *         them and scatters the result back.
+ */
+static void
+vvas_bbox_batch_flush (VvasBBoxBatch * batch)
+{
+  double x[VVAS_BBOX_BATCH_SIZE], y[VVAS_BBOX_BATCH_SIZE];
+  double w[VVAS_BBOX_BATCH_SIZE], h[VVAS_BBOX_BATCH_SIZE];
+  const VvasBBoxTransform *xform = batch->xform;
+  uint32_t i;
+
+  for (i = 0; i < batch->num; i++) {
+    x[i] = batch->bbox[i]->x;
+    y[i] = batch->bbox[i]->y;
+    w[i] = batch->bbox[i]->width;
+    h[i] = batch->bbox[i]->height;
+  }
+
+  vvas_bbox_transform_packed (x, w, batch->num, xform->hfactor,
+      xform->xoffset, xform->clip_width, xform->round_position);
+  vvas_bbox_transform_packed (y, h, batch->num, xform->vfactor,
+      xform->yoffset, xform->clip_height, xform->round_position);
+
+  for (i = 0; i < batch->num; i++) {
+    batch->bbox[i]->x = (int32_t) x[i];
+    batch->bbox[i]->y = (int32_t) y[i];
+    batch->bbox[i]->width = (uint32_t) w[i];
+    batch->bbox[i]->height = (uint32_t) h[i];
+  }
+  batch->num = 0;
+}
+
+/**
+ *  @fn void vvas_bbox_transform_apply (VvasBoundingBox * bbox,
+ *                                      uint32_t num_bbox,
+ *                                      const VvasBBoxTransform * xform)
+ *  @param [inout] bbox - Array of bounding boxes.
+ *  @param [in] num_bbox - Number of entries in @bbox.
+ *  @param [in] xform - Transform to be applied.
+ *  @return none
+ *  @brief This function transforms an array of bounding boxes in place.
+ */
+void
+vvas_bbox_transform_apply (VvasBoundingBox * bbox, uint32_t num_bbox,
+    const VvasBBoxTransform * xform)
+{
+  VvasBBoxBatch batch;
+  uint32_t i;
+
+  if ((NULL == bbox) || (NULL == xform)) {
+    LOG_D ("NULL received");
+    return;
+  }
+
+  batch.xform = xform;
+  batch.num = 0;
+  for (i = 0; i < num_bbox; i++) {
+    batch.bbox[batch.num++] = &bbox[i];
+    if (VVAS_BBOX_BATCH_SIZE == batch.num) {
+      vvas_bbox_batch_flush (&batch);
+    }
+  }
+  if (batch.num) {
+    vvas_bbox_batch_flush (&batch);
+  }
+}
+
+/**
+ *  @fn static bool vvas_inferprediction_collect_bbox (const VvasTreeNode * node, void *data)
+ *  @param [in] node - Address of the node.
+ *  @param [inout] data - VvasBBoxBatch collecting boxes.
+ *  @return FALSE to continue traversing.
+ *  @brief This function collects bounding box of each node, transforming the
+ *         batch whenever it is full.
+ */
+static bool
+vvas_inferprediction_collect_bbox (const VvasTreeNode * node, void *data)
+{
+  VvasBBoxBatch *batch = (VvasBBoxBatch *) data;
+  VvasInferPrediction *pred = (VvasInferPrediction *) node->data;
+
+  batch->bbox[batch->num++] = &pred->bbox;
+  if (VVAS_BBOX_BATCH_SIZE == batch->num) {
+    vvas_bbox_batch_flush (batch);
+  }
+
+  return false;
+}
+
+/**
+ *  @fn void vvas_inferprediction_transform (VvasInferPrediction * self,
+ *                                           const VvasBBoxTransform * xform)
+ *  @param [inout] self - Root of the prediction tree.
+ *  @param [in] xform - Transform to be applied.
+ *  @return none
+ *  @brief This function transforms bounding boxes of all nodes in the tree.
+ */
+void
+vvas_inferprediction_transform (VvasInferPrediction * self,
+    const VvasBBoxTransform * xform)
+{
+  VvasBBoxBatch batch;
+
+  if ((NULL == self) || (NULL == xform)) {
+    LOG_D ("NULL received");
+    return;
+  }
+
+  batch.xform = xform;
+  batch.num = 0;
+  vvas_treenode_traverse (self->node, IN_ORDER, TRAVERSE_ALL, -1,
+      vvas_inferprediction_collect_bbox, &batch);
+  if (batch.num) {
+    vvas_bbox_batch_flush (&batch);
+  }
+}
@@ -100,6 +100,18 @@ polygons_copy (VvasOverlayPolygonParams * src, void * data)
   return dest;
 }
 
+static VvasOverlayMaskParams *
+masks_copy (VvasOverlayMaskParams * src, void * data)
+{
+  VvasOverlayMaskParams *dest = (VvasOverlayMaskParams *) calloc (1, sizeof (VvasOverlayMaskParams));
+  if (!dest)
+    return NULL;
+
+  /* mask_data and palette are owned by the producer of the mask */
+  memcpy (dest, src, sizeof (VvasOverlayMaskParams));
+  return dest;
+}
+
 static void
 text_free (void *data)
 {
@@ -137,6 +149,7 @@ vvas_overlay_shape_info_init (VvasOverlayShapeInfo *shape_info)
   shape_info->num_arrows = 0;
   shape_info->num_circles = 0;
   shape_info->num_polys = 0;
+  shape_info->num_masks = 0;
 
   shape_info->rect_params = NULL;
   shape_info->text_params = NULL;
@@ -144,6 +157,7 @@ vvas_overlay_shape_info_init (VvasOverlayShapeInfo *shape_info)
   shape_info->arrow_params = NULL;
   shape_info->circle_params = NULL;
   shape_info->polygn_params = NULL;
+  shape_info->mask_params = NULL;
 }
 
 void
@@ -155,6 +169,9 @@ vvas_overlay_shape_info_copy (VvasOverlayShapeInfo *dest_shape_info, VvasOverlay
   dest_shape_info->num_arrows = src_shape_info->num_arrows;
   dest_shape_info->num_circles = src_shape_info->num_circles;
   dest_shape_info->num_polys = src_shape_info->num_polys;
+  /* mask list is the reference, a count without list means no masks */
+  dest_shape_info->num_masks =
+      src_shape_info->mask_params ? src_shape_info->num_masks : 0;
 
   dest_shape_info->rect_params =
       vvas_list_copy_deep (src_shape_info->rect_params, (void *) rects_copy, NULL);
@@ -168,6 +185,8 @@ vvas_overlay_shape_info_copy (VvasOverlayShapeInfo *dest_shape_info, VvasOverlay
       vvas_list_copy_deep (src_shape_info->circle_params, (void *) circles_copy, NULL);
   dest_shape_info->polygn_params =
       vvas_list_copy_deep (src_shape_info->polygn_params, (void *) polygons_copy, NULL);
+  dest_shape_info->mask_params =
+      vvas_list_copy_deep (src_shape_info->mask_params, (void *) masks_copy, NULL);
 }
 
 void
@@ -202,4 +221,423 @@ vvas_overlay_shape_info_free (VvasOverlayShapeInfo *shape_info)
     vvas_list_free_full (shape_info->polygn_params, polygons_free);
     shape_info->polygn_params = NULL;
   }
+
+  if (shape_info->mask_params) {
+    vvas_list_free_full (shape_info->mask_params, free);
+    shape_info->mask_params = NULL;
+  }
+}
+
+/**
+ *  @fn static bool shape_batch_reserve (void **array, uint32_t *size,
+ *                                       uint32_t count, size_t elem_size)
+ *  @param [inout] array - Address of the array to be grown
+ *  @param [inout] size - Allocated number of elements in @array
+ *  @param [in] count - Number of elements required in @array
+ *  @param [in] elem_size - Size of one element
+ *  @return TRUE on success
+ *          FALSE on allocation failure
+ *  @brief Grows @array geometrically so that it can hold at least @count
+ *         elements. Existing elements are preserved.
+ */
+static bool
+shape_batch_reserve (void **array, uint32_t * size, uint32_t count,
+    size_t elem_size)
+{
+  uint32_t new_size;
+  void *new_array;
+
+  if (count <= *size)
+    return true;
+
+  new_size = *size ? *size : 16;
+  while (new_size < count)
+    new_size *= 2;
+
+  new_array = realloc (*array, (size_t) new_size * elem_size);
+  if (!new_array)
+    return false;
+
+  *array = new_array;
+  *size = new_size;
+  return true;
+}
+
+/**
+ *  @fn static char *shape_batch_store_text (VvasOverlayShapeBatch * batch,
+ *                                           const char *text)
+ *  @param [inout] batch - Shape batch
+ *  @param [in] text - String to be stored
+ *  @return Address of the stored string on success
+ *          NULL on allocation failure
+ *  @brief Copies @text into the text pool of @batch. When the pool moves,
+ *         disp_text of texts already in the batch are rebased on the new pool.
+ */
+static char *
+shape_batch_store_text (VvasOverlayShapeBatch * batch, const char *text)
+{
+  uint32_t len = text ? strlen (text) + 1 : 1;
+  char *old_pool = batch->text_pool;
+  char *str;
+  uint32_t idx;
+
+  if (!shape_batch_reserve ((void **) &batch->text_pool,
+          &batch->text_pool_size, batch->text_len + len, sizeof (char)))
+    return NULL;
+
+  if (old_pool && old_pool != batch->text_pool) {
+    for (idx = 0; idx < batch->num_text; idx++)
+      batch->texts[idx].disp_text =
+          batch->text_pool + (batch->texts[idx].disp_text - old_pool);
+  }
+
+  str = batch->text_pool + batch->text_len;
+  if (text)
+    memcpy (str, text, len);
+  else
+    str[0] = '\0';
+  batch->text_len += len;
+
+  return str;
+}
+
+/**
+ *  @fn static bool shape_list_append (VvasList **head, VvasList **tail, void *data)
+ *  @param [inout] head - Head of the list
+ *  @param [inout] tail - Last node of the list
+ *  @param [in] data - Data to be appended
+ *  @return TRUE on success
+ *          FALSE on allocation failure
+ *  @brief Appends @data at @tail without walking the list from @head
+ */
+static bool
+shape_list_append (VvasList ** head, VvasList ** tail, void *data)
+{
+  if (!*tail) {
+    *head = vvas_list_append (*head, data);
+    *tail = *head;
+    while (*tail && (*tail)->next)
+      *tail = (*tail)->next;
+    return *head != NULL;
+  }
+
+  vvas_list_append (*tail, data);
+  if (!(*tail)->next)
+    return false;
+  *tail = (*tail)->next;
+  return true;
+}
+
+void
+vvas_overlay_shape_batch_init (VvasOverlayShapeBatch * batch)
+{
+  memset (batch, 0, sizeof (VvasOverlayShapeBatch));
+}
+
+void
+vvas_overlay_shape_batch_reset (VvasOverlayShapeBatch * batch)
+{
+  batch->num_rects = 0;
+  batch->num_text = 0;
+  batch->num_lines = 0;
+  batch->num_arrows = 0;
+  batch->num_circles = 0;
+  batch->num_polys = 0;
+  batch->num_masks = 0;
+  batch->num_points = 0;
+  batch->text_len = 0;
+}
+
+void
+vvas_overlay_shape_batch_free (VvasOverlayShapeBatch * batch)
+{
+  free (batch->rects);
+  free (batch->texts);
+  free (batch->lines);
+  free (batch->arrows);
+  free (batch->circles);
+  free (batch->polygons);
+  free (batch->poly_pt_offsets);
+  free (batch->points);
+  free (batch->masks);
+  free (batch->text_pool);
+  vvas_overlay_shape_batch_init (batch);
+}
+
+VvasOverlayRectParams *
+vvas_overlay_shape_batch_add_rect (VvasOverlayShapeBatch * batch,
+    const VvasOverlayRectParams * rect)
+{
+  if (!shape_batch_reserve ((void **) &batch->rects, &batch->rects_size,
+          batch->num_rects + 1, sizeof (VvasOverlayRectParams)))
+    return NULL;
+
+  batch->rects[batch->num_rects] = *rect;
+  return &batch->rects[batch->num_rects++];
+}
+
+VvasOverlayTextParams *
+vvas_overlay_shape_batch_add_text (VvasOverlayShapeBatch * batch,
+    const VvasOverlayTextParams * text)
+{
+  char *disp_text;
+
+  if (!shape_batch_reserve ((void **) &batch->texts, &batch->text_size,
+          batch->num_text + 1, sizeof (VvasOverlayTextParams)))
+    return NULL;
+
+  disp_text = shape_batch_store_text (batch, text->disp_text);
+  if (!disp_text)
+    return NULL;
+
+  batch->texts[batch->num_text] = *text;
+  batch->texts[batch->num_text].disp_text = disp_text;
+  return &batch->texts[batch->num_text++];
+}
+
+VvasOverlayLineParams *
+vvas_overlay_shape_batch_add_line (VvasOverlayShapeBatch * batch,
+    const VvasOverlayLineParams * line)
+{
+  if (!shape_batch_reserve ((void **) &batch->lines, &batch->lines_size,
+          batch->num_lines + 1, sizeof (VvasOverlayLineParams)))
+    return NULL;
+
+  batch->lines[batch->num_lines] = *line;
+  return &batch->lines[batch->num_lines++];
+}
+
+VvasOverlayArrowParams *
+vvas_overlay_shape_batch_add_arrow (VvasOverlayShapeBatch * batch,
+    const VvasOverlayArrowParams * arrow)
+{
+  if (!shape_batch_reserve ((void **) &batch->arrows, &batch->arrows_size,
+          batch->num_arrows + 1, sizeof (VvasOverlayArrowParams)))
+    return NULL;
+
+  batch->arrows[batch->num_arrows] = *arrow;
+  return &batch->arrows[batch->num_arrows++];
+}
+
+VvasOverlayCircleParams *
+vvas_overlay_shape_batch_add_circle (VvasOverlayShapeBatch * batch,
+    const VvasOverlayCircleParams * circle)
+{
+  if (!shape_batch_reserve ((void **) &batch->circles, &batch->circles_size,
+          batch->num_circles + 1, sizeof (VvasOverlayCircleParams)))
+    return NULL;
+
+  batch->circles[batch->num_circles] = *circle;
+  return &batch->circles[batch->num_circles++];
+}
+
+VvasOverlayPolygonParams *
+vvas_overlay_shape_batch_add_polygon (VvasOverlayShapeBatch * batch,
+    const VvasOverlayPolygonParams * polygon, const VvasOverlayCoordinates * pts,
+    uint32_t num_pts)
+{
+  uint32_t offsets_size = batch->polys_size;
+  VvasOverlayPolygonParams *dest;
+
+  /* polygons and poly_pt_offsets grow in lock step and share polys_size */
+  if (!shape_batch_reserve ((void **) &batch->poly_pt_offsets, &offsets_size,
+          batch->num_polys + 1, sizeof (uint32_t))
+      || !shape_batch_reserve ((void **) &batch->polygons, &batch->polys_size,
+          batch->num_polys + 1, sizeof (VvasOverlayPolygonParams)))
+    return NULL;
+
+  if (!shape_batch_reserve ((void **) &batch->points, &batch->points_size,
+          batch->num_points + num_pts, sizeof (VvasOverlayCoordinates)))
+    return NULL;
+
+  if (pts && num_pts)
+    memcpy (&batch->points[batch->num_points], pts,
+        num_pts * sizeof (VvasOverlayCoordinates));
+
+  dest = &batch->polygons[batch->num_polys];
+  *dest = *polygon;
+  dest->poly_pts = NULL;
+  dest->num_pts = num_pts;
+  batch->poly_pt_offsets[batch->num_polys++] = batch->num_points;
+  batch->num_points += num_pts;
+
+  return dest;
+}
+
+VvasOverlayMaskParams *
+vvas_overlay_shape_batch_add_mask (VvasOverlayShapeBatch * batch,
+    const VvasOverlayMaskParams * mask)
+{
+  if (!shape_batch_reserve ((void **) &batch->masks, &batch->masks_size,
+          batch->num_masks + 1, sizeof (VvasOverlayMaskParams)))
+    return NULL;
+
+  batch->masks[batch->num_masks] = *mask;
+  return &batch->masks[batch->num_masks++];
+}
+
+VvasReturnType
+vvas_overlay_shape_batch_from_info (VvasOverlayShapeBatch * batch,
+    const VvasOverlayShapeInfo * shape_info)
+{
+  VvasList *head;
+  uint32_t idx;
+
+  vvas_overlay_shape_batch_reset (batch);
+
+  for (head = shape_info->rect_params; head; head = head->next) {
+    if (!vvas_overlay_shape_batch_add_rect (batch,
+            (VvasOverlayRectParams *) head->data))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  for (head = shape_info->text_params; head; head = head->next) {
+    if (!vvas_overlay_shape_batch_add_text (batch,
+            (VvasOverlayTextParams *) head->data))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  for (head = shape_info->line_params; head; head = head->next) {
+    if (!vvas_overlay_shape_batch_add_line (batch,
+            (VvasOverlayLineParams *) head->data))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  for (head = shape_info->arrow_params; head; head = head->next) {
+    if (!vvas_overlay_shape_batch_add_arrow (batch,
+            (VvasOverlayArrowParams *) head->data))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  for (head = shape_info->circle_params; head; head = head->next) {
+    if (!vvas_overlay_shape_batch_add_circle (batch,
+            (VvasOverlayCircleParams *) head->data))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  for (head = shape_info->polygn_params; head; head = head->next) {
+    VvasOverlayPolygonParams *polygon = (VvasOverlayPolygonParams *) head->data;
+    VvasOverlayCoordinates *pts;
+    VvasList *pt_head;
+
+    /* points are reserved in the batch and copied in place */
+    if (!vvas_overlay_shape_batch_add_polygon (batch, polygon, NULL,
+            vvas_list_length (polygon->poly_pts)))
+      return VVAS_RET_ALLOC_ERROR;
+
+    pts = &batch->points[batch->poly_pt_offsets[batch->num_polys - 1]];
+    for (pt_head = polygon->poly_pts; pt_head; pt_head = pt_head->next)
+      *pts++ = *(VvasOverlayCoordinates *) pt_head->data;
+  }
+
+  /* at most num_masks entries are read, masks are ignored when any of
+   * num_masks or mask_params is not set */
+  for (head = shape_info->mask_params, idx = 0;
+      head && idx < shape_info->num_masks; head = head->next, idx++) {
+    if (!vvas_overlay_shape_batch_add_mask (batch,
+            (VvasOverlayMaskParams *) head->data))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  return VVAS_RET_SUCCESS;
+}
+
+VvasReturnType
+vvas_overlay_shape_batch_to_info (const VvasOverlayShapeBatch * batch,
+    VvasOverlayShapeInfo * shape_info)
+{
+  VvasList *tail;
+  uint32_t idx, pt;
+
+  tail = NULL;
+  for (idx = 0; idx < batch->num_rects; idx++) {
+    VvasOverlayRectParams *rect = rects_copy (&batch->rects[idx], NULL);
+    if (!rect || !shape_list_append (&shape_info->rect_params, &tail, rect)) {
+      free (rect);
+      return VVAS_RET_ALLOC_ERROR;
+    }
+    shape_info->num_rects++;
+  }
+
+  tail = NULL;
+  for (idx = 0; idx < batch->num_text; idx++) {
+    VvasOverlayTextParams *text = text_copy (&batch->texts[idx], NULL);
+    if (!text || !shape_list_append (&shape_info->text_params, &tail, text)) {
+      if (text)
+        text_free (text);
+      return VVAS_RET_ALLOC_ERROR;
+    }
+    shape_info->num_text++;
+  }
+
+  tail = NULL;
+  for (idx = 0; idx < batch->num_lines; idx++) {
+    VvasOverlayLineParams *line = lines_copy (&batch->lines[idx], NULL);
+    if (!line || !shape_list_append (&shape_info->line_params, &tail, line)) {
+      free (line);
+      return VVAS_RET_ALLOC_ERROR;
+    }
+    shape_info->num_lines++;
+  }
+
+  tail = NULL;
+  for (idx = 0; idx < batch->num_arrows; idx++) {
+    VvasOverlayArrowParams *arrow = arrows_copy (&batch->arrows[idx], NULL);
+    if (!arrow || !shape_list_append (&shape_info->arrow_params, &tail, arrow)) {
+      free (arrow);
+      return VVAS_RET_ALLOC_ERROR;
+    }
+    shape_info->num_arrows++;
+  }
+
+  tail = NULL;
+  for (idx = 0; idx < batch->num_circles; idx++) {
+    VvasOverlayCircleParams *circle = circles_copy (&batch->circles[idx], NULL);
+    if (!circle
+        || !shape_list_append (&shape_info->circle_params, &tail, circle)) {
+      free (circle);
+      return VVAS_RET_ALLOC_ERROR;
+    }
+    shape_info->num_circles++;
+  }
+
+  tail = NULL;
+  for (idx = 0; idx < batch->num_polys; idx++) {
+    const VvasOverlayCoordinates *pts =
+        &batch->points[batch->poly_pt_offsets[idx]];
+    VvasOverlayPolygonParams *polygon = polygons_copy (&batch->polygons[idx],
+        NULL);
+    VvasList *pt_tail = NULL;
+
+    if (!polygon)
+      return VVAS_RET_ALLOC_ERROR;
+
+    for (pt = 0; pt < batch->polygons[idx].num_pts; pt++) {
+      VvasOverlayCoordinates *point =
+          points_copy ((VvasOverlayCoordinates *) & pts[pt], NULL);
+      if (!point || !shape_list_append (&polygon->poly_pts, &pt_tail, point)) {
+        free (point);
+        polygons_free (polygon);
+        return VVAS_RET_ALLOC_ERROR;
+      }
+    }
+
+    if (!shape_list_append (&shape_info->polygn_params, &tail, polygon)) {
+      polygons_free (polygon);
+      return VVAS_RET_ALLOC_ERROR;
+    }
+    shape_info->num_polys++;
+  }
+
+  tail = NULL;
+  for (idx = 0; idx < batch->num_masks; idx++) {
+    VvasOverlayMaskParams *mask = masks_copy (&batch->masks[idx], NULL);
+    if (!mask || !shape_list_append (&shape_info->mask_params, &tail, mask)) {
+      free (mask);
+      return VVAS_RET_ALLOC_ERROR;
+    }
+    shape_info->num_masks++;
+  }
+
+  return VVAS_RET_SUCCESS;
 }
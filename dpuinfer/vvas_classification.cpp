@@ -32,6 +32,7 @@ vvas_classification::run (void * handle, std::vector < cv::Mat > & images, VvasI
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
 
   auto results = model->run (images);
+  vvas_dpuinfer_mark_run (kpriv);
   char *pstr;                   /* prediction string */
 
   for (auto i = 0u; i < results.size (); i++) {
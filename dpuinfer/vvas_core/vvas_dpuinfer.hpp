@@ -20,7 +20,10 @@
  * DOC: VVAS DPU Infer APIs
  * This file contains structures and methods related to VVAS Inference.
  */
- 
+
+#ifndef __VVAS_DPUINFER_HPP__
+#define __VVAS_DPUINFER_HPP__
+
 #include <vvas_core/vvas_infer_prediction.h>
 #include <vvas_core/vvas_video.h>
 
@@ -38,13 +41,42 @@ extern "C" {
  * @modelclass: Model class
  * @batch_size: Batch size
  * @need_preprocess: If this is set to true, then software pre-processing will be performed using Vitis-AI library
- * @performance_test: Performance test
+ * @performance_test: Logs frames run and frame rate at info level once per
+ *                    second and on destroy, @vvas_dpuinfer_get_stats gives
+ *                    detailed statistics without logging
  * @objs_detection_max: Sort the detected objects based on area of the bounding box, from highest to lowest area.
  * @filter_labels: Array of labels to process
  * @num_filter_labels: Number of labels to process
  * @float_feature: Float feature
  * @segoutfmt: Segmentation output format
  * @segoutfactor: Multiplication factor for Y8 output to look bright
+ * @segoutrle: Segmentation output holds run-length encoded class indices
+ *             instead of GRAY8 pixels, its fmt is "RLE". Requires GRAY8
+ *             @segoutfmt, @segoutfactor is not applied.
+ * @batch_timeout_us: Frames given to @vvas_dpuinfer_process_frames or
+ *                    @vvas_dpuinfer_submit by any number of threads are queued
+ *                    and run together in batches of the model batch size. A batch
+ *                    is run when it is full or when its oldest frames waited this
+ *                    many microseconds, 0 to run queued frames right away.
+ * @num_inflight_batches: Number of batches handled at the same time by worker
+ *                        threads, 0 is same as 1 and values above 16 are
+ *                        clamped to 16. Model runs are serialized,
+ *                        completion of a batch overlaps run of the next one.
+ * @mosaic_max_tiles: Detection models only, CPU reference models must have
+ *                    "detection" model-type. When more than 1, input frames may
+ *                    be smaller than the model input and up to this many of
+ *                    them are tiled into one model input, which is run once.
+ *                    Detections are returned in coordinates of the frame they
+ *                    came from, batches then take batch_size * mosaic_max_tiles
+ *                    frames, as reported by @vvas_dpuinfer_get_config.
+ * @mosaic_guard: Pixels left blank between tiles of a mosaic, less than the
+ *                model input width and height
+ * @share_model: Instances created with this set and the same model path,
+ *               name, class, batch size, format and pre-processing load the
+ *               model once. Their model runs are serialized and their frames
+ *               are batched per instance, not together. When not set, each
+ *               instance has its own model, which may run at the same time as
+ *               others on DPUs with several cores.
 */
 typedef struct {
   char * model_path;
@@ -60,13 +92,19 @@ typedef struct {
   bool float_feature;
   VvasVideoFormat segoutfmt;
   int segoutfactor;
+  bool segoutrle;
+  unsigned int batch_timeout_us;
+  unsigned int num_inflight_batches;
+  unsigned int mosaic_max_tiles;
+  unsigned int mosaic_guard;
+  bool share_model;
 } VvasDpuInferConf;
 
 /**
  * struct VvasModelConf - Contains information related to model requirements
  * @model_width: Model required width
  * @model_height: Model required height
- * @batch_size: Model supported batch size
+ * @batch_size: Model supported batch size, frames of a batch in mosaic mode
  * @mean_r: Mean value of R channel
  * @mean_g: Mean value of G channel
  * @mean_b: Mean value of B channel
@@ -86,11 +124,84 @@ typedef struct {
   float scale_b;
 } VvasModelConf;
 
+/**
+ * struct VvasDpuInferLatency - Latency of one stage of batch processing
+ * @count: Number of batches measured
+ * @min_us: Shortest latency in microseconds
+ * @max_us: Longest latency in microseconds
+ * @mean_us: Mean latency in microseconds
+ * @p50_us: Median latency in microseconds
+ * @p90_us: 90th percentile of latency in microseconds
+ * @p99_us: 99th percentile of latency in microseconds
+ *
+ * Percentiles come from a histogram and are within 12.5% of the exact value.
+*/
+typedef struct {
+  uint64_t count;
+  uint64_t min_us;
+  uint64_t max_us;
+  double mean_us;
+  uint64_t p50_us;
+  uint64_t p90_us;
+  uint64_t p99_us;
+} VvasDpuInferLatency;
+
+/**
+ * struct VvasDpuInferStats - Statistics of the batches run by an instance
+ * @prepare: Mapping of input frames and wrapping them for the model, on host
+ * @run: Model execution by Vitis AI, pre-processing and DPU run included
+ * @predictions: Building prediction trees from model results, on host
+ * @batch: Whole batch, sum of the three stages above
+ * @batches: Number of batches run
+ * @frames: Number of frames run
+ * @objects: Number of predictions attached to frames
+ * @batch_fill_ratio: Frames run over the frames batches could hold, 1.0 when
+ *                    all batches were full
+ * @elapsed_sec: Seconds since the first batch
+ * @frames_per_sec: Frames run per second over @elapsed_sec
+ * @objects_per_sec: Objects predicted per second over @elapsed_sec
+ *
+ * Models not reporting the end of their run account prediction building in
+ * @run, @predictions is zero for them.
+*/
+typedef struct {
+  VvasDpuInferLatency prepare;
+  VvasDpuInferLatency run;
+  VvasDpuInferLatency predictions;
+  VvasDpuInferLatency batch;
+  uint64_t batches;
+  uint64_t frames;
+  uint64_t objects;
+  double batch_fill_ratio;
+  double elapsed_sec;
+  double frames_per_sec;
+  double objects_per_sec;
+} VvasDpuInferStats;
+
 /**
  *  typedef VvasDpuInfer - Holds the reference to dpu instance.
  */
 typedef void VvasDpuInfer;
 
+/**
+ *  typedef VvasDpuInferRequest - Holds the reference to frames submitted with
+ *  @vvas_dpuinfer_submit.
+ */
+typedef void VvasDpuInferRequest;
+
+/**
+ *  typedef VvasDpuInferDoneCallback - Called from a worker thread when frames
+ *  submitted with @vvas_dpuinfer_submit are done. It must not submit to or wait
+ *  for the same instance.
+ *
+ *  @predictions: Array given to @vvas_dpuinfer_submit, holding the predictions
+ *  @batch_size: Number of frames
+ *  @ret: VvasReturnType of the batch
+ *  @user_data: User data given to @vvas_dpuinfer_submit
+ */
+typedef void (*VvasDpuInferDoneCallback) (VvasInferPrediction ** predictions,
+    int batch_size, VvasReturnType ret, void *user_data);
+
 /**
  *  vvas_dpuinfer_create () - Initializes DPU with config parameters and allocates DpuInfer instance
  *
@@ -120,11 +231,55 @@ VvasDpuInfer * vvas_dpuinfer_create (VvasDpuInferConf * dpu_conf, VvasLogLevel l
  */
 VvasReturnType vvas_dpuinfer_process_frames (VvasDpuInfer * dpu_handle, VvasVideoFrame *inputs[MAX_NUM_OBJECT], VvasInferPrediction *predictions[MAX_NUM_OBJECT], int batch_size);
 
+/**
+ *  vvas_dpuinfer_submit () - Queues frames for processing and returns without
+ *  waiting for them, unless @num_inflight_batches batches are already queued.
+ *
+ *  @dpu_handle: VvasDpuInfer handle created using @vvas_dpuinfer_create.
+ *  @inputs: Array of @VvasVideoFrame, frames must stay valid until done.
+ *  @predictions: Array of @VvasInferPrediction, it must stay valid until done,
+ *                predictions are stored in it when frames are done.
+ *  @batch_size: Number of frames.
+ *  @callback: Called when frames are done, may be NULL.
+ *  @user_data: User data passed to @callback.
+ *  @request: Address to store the request, which must be given to
+ *            @vvas_dpuinfer_wait. May be NULL when completion is only
+ *            reported through @callback.
+ *
+ *  Frames of a thread are done in the order they were submitted.
+ *
+ *  Return: VvasReturnType
+ */
+VvasReturnType vvas_dpuinfer_submit (VvasDpuInfer * dpu_handle, VvasVideoFrame *inputs[MAX_NUM_OBJECT], VvasInferPrediction *predictions[MAX_NUM_OBJECT], int batch_size, VvasDpuInferDoneCallback callback, void *user_data, VvasDpuInferRequest ** request);
+
+/**
+ *  vvas_dpuinfer_poll () - Checks whether submitted frames are done
+ *
+ *  @dpu_handle: VvasDpuInfer handle created using @vvas_dpuinfer_create.
+ *  @request: Request returned by @vvas_dpuinfer_submit.
+ *
+ *  Return: true when done, @vvas_dpuinfer_wait then returns right away.
+ */
+bool vvas_dpuinfer_poll (VvasDpuInfer * dpu_handle, VvasDpuInferRequest * request);
+
+/**
+ *  vvas_dpuinfer_wait () - Waits until submitted frames are done and frees the request
+ *
+ *  @dpu_handle: VvasDpuInfer handle created using @vvas_dpuinfer_create.
+ *  @request: Request returned by @vvas_dpuinfer_submit.
+ *
+ *  Return: VvasReturnType of the batch the frames were run in
+ */
+VvasReturnType vvas_dpuinfer_wait (VvasDpuInfer * dpu_handle, VvasDpuInferRequest * request);
+
 /**
  *  vvas_dpuinfer_destroy () - De-initialises the model and free all other resources allocated
  *
  *  @dpu_handle: VvasDpuInfer handle created using @vvas_dpuinfer_create.
  *
+ *  Frames still queued are run first. Requests returned by @vvas_dpuinfer_submit
+ *  must be given to @vvas_dpuinfer_wait before.
+ *
  *  Return: VvasReturnType
  */
 VvasReturnType vvas_dpuinfer_destroy (VvasDpuInfer * dpu_handle);
@@ -139,7 +294,21 @@ VvasReturnType vvas_dpuinfer_destroy (VvasDpuInfer * dpu_handle);
  */
 VvasReturnType vvas_dpuinfer_get_config (VvasDpuInfer * dpu_handle, VvasModelConf *model_conf);
 
+/**
+ *  vvas_dpuinfer_get_stats () - Returns latency and throughput statistics of the instance
+ *
+ *  @dpu_handle: VvasDpuInfer handle created using @vvas_dpuinfer_create.
+ *  @stats: VvasDpuInferStats structure
+ *  @reset: If true, statistics start again from zero after being read
+ *
+ *  May be called from any thread while frames are processed.
+ *
+ *  Return: VvasReturnType
+ */
+VvasReturnType vvas_dpuinfer_get_stats (VvasDpuInfer * dpu_handle, VvasDpuInferStats *stats, bool reset);
+
 #ifdef __cplusplus
 }
 #endif
 
+#endif
@@ -0,0 +1,667 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vvas_cpuref.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <jansson.h>
+
+#include "vart/runner_helper.hpp"
+#include "xir/tensor/tensor.hpp"
+
+/* Output tensors of one frame, owned by the TensorBuf attached to it */
+typedef struct
+{
+  std::vector < std::unique_ptr < xir::Tensor >> tensors;
+  std::vector < std::unique_ptr < vart::TensorBuffer >> buffers;
+} vvas_cpuref_tb;
+
+typedef struct
+{
+  int label;
+  float x;
+  float y;
+  float width;
+  float height;
+  float score;
+} vvas_cpuref_box;
+
+/* splitmix64, cheap and good enough for synthetic results */
+static inline uint64_t
+cpuref_next (uint64_t * state)
+{
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  return z ^ (z >> 31);
+}
+
+/* uniform in [0, 1) */
+static inline float
+cpuref_uniform (uint64_t * state)
+{
+  return (cpuref_next (state) >> 40) * (1.0f / 16777216.0f);
+}
+
+/* Seeds the results of a frame from a grid of its pixels */
+static uint64_t
+cpuref_frame_state (const cv::Mat & image, uint64_t seed)
+{
+  uint64_t state = seed;
+  size_t esize = image.elemSize ();
+
+  for (int gy = 0; gy < 8; gy++) {
+    const uint8_t *row = image.ptr < uint8_t > ((image.rows - 1) * gy / 7);
+    for (int gx = 0; gx < 8; gx++) {
+      const uint8_t *px = row + (image.cols - 1) * gx / 7 * esize;
+      uint64_t v = 0;
+      for (size_t c = 0; c < esize && c < 8; c++)
+        v |= (uint64_t) px[c] << (8 * c);
+      state ^= v;
+      cpuref_next (&state);
+    }
+  }
+  return state;
+}
+
+static void
+cpuref_tb_copy (void **frm, void **to)
+{
+  TensorBuf **frm_tb = (TensorBuf **) frm;
+  TensorBuf **to_tb = (TensorBuf **) to;
+
+  if (!(*frm_tb)) {
+    *to_tb = NULL;
+    return;
+  }
+
+  /** increase ref count*/
+  atomic_fetch_add (&(*frm_tb)->ref_count, 1);
+  *to_tb = *frm_tb;
+}
+
+static void
+cpuref_tb_free (void **ptr)
+{
+  TensorBuf **tb = (TensorBuf **) ptr;
+  if (*tb) {
+    vvas_cpuref_tb *cpuref_tb = (vvas_cpuref_tb *) (*tb)->priv;
+    if (cpuref_tb) {
+      /** decrease ref count*/
+      if (atomic_fetch_sub (&(*tb)->ref_count, 1) == 1) {
+        delete cpuref_tb;
+        free (*tb);
+        *tb = NULL;
+      }
+    }
+  }
+}
+
+static int
+cpuref_json_int (json_t * root, const char *key, int def)
+{
+  json_t *value = json_object_get (root, key);
+  return json_is_integer (value) ? (int) json_integer_value (value) : def;
+}
+
+static double
+cpuref_json_real (json_t * root, const char *key, double def)
+{
+  json_t *value = json_object_get (root, key);
+  return json_is_number (value) ? json_number_value (value) : def;
+}
+
+static bool
+cpuref_json_bgr (json_t * root, const char *key, float bgr[3])
+{
+  json_t *value = json_object_get (root, key);
+
+  if (!value)
+    return true;
+  if (!json_is_array (value) || json_array_size (value) != 3)
+    return false;
+  for (int i = 0; i < 3; i++) {
+    if (!json_is_number (json_array_get (value, i)))
+      return false;
+    bgr[i] = json_number_value (json_array_get (value, i));
+  }
+  return true;
+}
+
+bool
+vvas_cpuref::parse (VvasDpuInferPrivate * kpriv, const std::string & json_file)
+{
+  json_t *root, *value;
+  json_error_t error;
+  float mean_bgr[3] = { 0, 0, 0 };
+  float scale_bgr[3] = { 1, 1, 1 };
+  std::string weights_file;
+
+  root = json_load_file (json_file.c_str (), JSON_DECODE_ANY, &error);
+  if (!root) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+        "failed to load json file(%s) reason %s", json_file.c_str (),
+        error.text);
+    return false;
+  }
+
+  value = json_object_get (root, "model-type");
+  if (json_is_string (value)) {
+    const char *name = json_string_value (value);
+    if (!strcmp (name, "detection"))
+      type = VVAS_CPUREF_DETECTION;
+    else if (!strcmp (name, "classification"))
+      type = VVAS_CPUREF_CLASSIFICATION;
+    else if (!strcmp (name, "rawtensor"))
+      type = VVAS_CPUREF_RAWTENSOR;
+    else if (!strcmp (name, "network"))
+      type = VVAS_CPUREF_NETWORK;
+    else {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+          "model-type %s not supported", name);
+      goto error;
+    }
+  }
+
+  /* predictions carry the class of the model being emulated */
+  value = json_object_get (root, "model-class");
+  if (json_is_string (value)) {
+    model_class =
+        (VvasClass) vvas_xclass_to_num ((char *) json_string_value (value));
+  } else if (kpriv->modelclass != VVAS_XCLASS_CPUREF) {
+    model_class = (VvasClass) kpriv->modelclass;
+  } else if (type == VVAS_CPUREF_DETECTION) {
+    model_class = VVAS_XCLASS_YOLOV3;
+  } else if (type == VVAS_CPUREF_RAWTENSOR) {
+    model_class = VVAS_XCLASS_RAWTENSOR;
+  } else {
+    model_class = VVAS_XCLASS_CLASSIFICATION;
+  }
+  if (model_class == VVAS_XCLASS_NOTFOUND || model_class == VVAS_XCLASS_CPUREF) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+        "model-class not supported in %s", json_file.c_str ());
+    goto error;
+  }
+
+  width = cpuref_json_int (root, "width", width);
+  height = cpuref_json_int (root, "height", height);
+  batch = cpuref_json_int (root, "batch-size",
+      kpriv->batch_size > 0 ? kpriv->batch_size : batch);
+  latency_us = cpuref_json_int (root, "latency-us", 0);
+  frame_latency_us = cpuref_json_int (root, "frame-latency-us", 0);
+  seed = (uint64_t) cpuref_json_int (root, "seed", 0);
+  min_objects = std::max (0, cpuref_json_int (root, "min-objects", 0));
+  max_objects = std::max ((int) min_objects,
+      cpuref_json_int (root, "max-objects", max_objects));
+  min_box = cpuref_json_real (root, "min-box-size", min_box);
+  max_box = cpuref_json_real (root, "max-box-size", max_box);
+  num_classes = kpriv->labelptr ? kpriv->max_labels :
+      cpuref_json_int (root, "num-classes", type == VVAS_CPUREF_DETECTION ?
+      num_classes : 1000);
+  top_k = cpuref_json_int (root, "top-k", top_k);
+  grid = cpuref_json_int (root, "grid-size", grid);
+  hidden = cpuref_json_int (root, "hidden-size", hidden);
+  value = json_object_get (root, "weights-file");
+  if (json_is_string (value))
+    weights_file = kpriv->modelpath + "/" + kpriv->modelname + "/" +
+        json_string_value (value);
+
+  if (width <= 0 || height <= 0 || batch <= 0 || num_classes <= 0 ||
+      top_k <= 0 || grid <= 0 || hidden < 0 || latency_us < 0 ||
+      frame_latency_us < 0 || min_box <= 0.0f || max_box > 1.0f ||
+      min_box > max_box) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+        "invalid model parameters in %s", json_file.c_str ());
+    goto error;
+  }
+  top_k = std::min (top_k, num_classes);
+
+  if (!cpuref_json_bgr (root, "mean", mean_bgr) ||
+      !cpuref_json_bgr (root, "scale", scale_bgr)) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+        "mean and scale need 3 values in %s", json_file.c_str ());
+    goto error;
+  }
+  kpriv->pp_config.mean_r = mean_bgr[2];
+  kpriv->pp_config.mean_g = mean_bgr[1];
+  kpriv->pp_config.mean_b = mean_bgr[0];
+  kpriv->pp_config.scale_r = scale_bgr[2];
+  kpriv->pp_config.scale_g = scale_bgr[1];
+  kpriv->pp_config.scale_b = scale_bgr[0];
+  if (kpriv->modelfmt == VVAS_VIDEO_FORMAT_RGB) {
+    mean = cv::Scalar (mean_bgr[2], mean_bgr[1], mean_bgr[0]);
+    scale = cv::Scalar (scale_bgr[2], scale_bgr[1], scale_bgr[0]);
+  } else {
+    mean = cv::Scalar (mean_bgr[0], mean_bgr[1], mean_bgr[2]);
+    scale = cv::Scalar (scale_bgr[0], scale_bgr[1], scale_bgr[2]);
+  }
+
+  value = json_object_get (root, "output-tensors");
+  if (value && !json_is_array (value)) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+        "output-tensors key is not of array type");
+    goto error;
+  }
+  for (unsigned int i = 0; value && i < json_array_size (value); i++) {
+    json_t *obj = json_array_get (value, i);
+    json_t *name = json_object_get (obj, "name");
+    vvas_cpuref_tensor t;
+
+    t.name = json_is_string (name) ? json_string_value (name) :
+        "output_" + std::to_string (i);
+    t.height = cpuref_json_int (obj, "height", 1);
+    t.width = cpuref_json_int (obj, "width", 1);
+    t.channels = cpuref_json_int (obj, "channels", 1);
+    t.fix_point = cpuref_json_int (obj, "fix-point", 0);
+    if (t.height <= 0 || t.width <= 0 || t.channels <= 0) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+          "invalid shape of output tensor %s", t.name.c_str ());
+      goto error;
+    }
+    tensors.push_back (t);
+  }
+  if (tensors.size () > sizeof (((TensorBuf *) 0)->ptr) / sizeof (void *)) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+        "too many output tensors (%lu)", tensors.size ());
+    goto error;
+  }
+  if (tensors.empty ())
+    tensors.push_back ({"output", 1, 1, num_classes, 0});
+
+  /* name the classes when the model directory has no label.json */
+  if (!kpriv->labelptr) {
+    kpriv->labelptr = new labels[num_classes];
+    for (int i = 0; i < num_classes; i++) {
+      kpriv->labelptr[i].label = i;
+      kpriv->labelptr[i].name = "class-" + std::to_string (i);
+      kpriv->labelptr[i].display_name = kpriv->labelptr[i].name;
+    }
+    kpriv->max_labels = num_classes;
+    kpriv->num_labels = num_classes;
+  }
+
+  json_decref (root);
+
+  if (type == VVAS_CPUREF_NETWORK)
+    return init_network (kpriv, weights_file);
+  return true;
+
+error:
+  json_decref (root);
+  return false;
+}
+
+/* Loads the layers of the network, or derives them from seed */
+bool
+vvas_cpuref::init_network (VvasDpuInferPrivate * kpriv,
+    const std::string & file)
+{
+  std::vector < int >sizes = { grid * grid * 3 };
+  std::ifstream in;
+  uint64_t state = seed;
+
+  if (hidden)
+    sizes.push_back (hidden);
+  sizes.push_back (num_classes);
+
+  if (!file.empty ()) {
+    in.open (file, std::ifstream::in | std::ifstream::binary);
+    if (!in.good ()) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+          "failed to read weights file %s", file.c_str ());
+      return false;
+    }
+  }
+
+  for (auto l = 1u; l < sizes.size (); l++) {
+    cv::Mat w (sizes[l], sizes[l - 1], CV_32F);
+    cv::Mat b (1, sizes[l], CV_32F);
+
+    if (in.is_open ()) {
+      in.read ((char *) w.data, w.total () * sizeof (float));
+      in.read ((char *) b.data, b.total () * sizeof (float));
+    } else {
+      float range = 1.0f / sqrtf ((float) sizes[l - 1]);
+      for (auto i = 0u; i < w.total (); i++)
+        ((float *) w.data)[i] = (2.0f * cpuref_uniform (&state) - 1.0f) * range;
+      b = cv::Scalar (0);
+    }
+    weights.push_back (w);
+    biases.push_back (b);
+  }
+
+  if (in.is_open () && (!in.good () || in.peek () != EOF)) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+        "size of weights file %s does not match the network", file.c_str ());
+    return false;
+  }
+  return true;
+}
+
+vvas_cpuref::vvas_cpuref (void *handle, const std::string & json_file)
+{
+  VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *) handle;
+  log_level = kpriv->log_level;
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "model : %s",
+      json_file.c_str ());
+
+  valid = parse (kpriv, json_file);
+}
+
+void
+vvas_cpuref::detect (VvasDpuInferPrivate * kpriv, cv::Mat & image,
+    uint64_t state, VvasInferPrediction ** parent)
+{
+  std::vector < vvas_cpuref_box > boxes;
+  unsigned int num = min_objects +
+      cpuref_next (&state) % (max_objects - min_objects + 1);
+  unsigned int cur_objs = 0;
+  int cols = image.cols;
+  int rows = image.rows;
+
+  for (auto n = 0u; n < num; n++) {
+    vvas_cpuref_box box;
+    box.label = cpuref_next (&state) % num_classes;
+    box.width = min_box + cpuref_uniform (&state) * (max_box - min_box);
+    box.height = min_box + cpuref_uniform (&state) * (max_box - min_box);
+    box.x = cpuref_uniform (&state) * (1.0f - box.width);
+    box.y = cpuref_uniform (&state) * (1.0f - box.height);
+    box.score = 0.3f + 0.7f * cpuref_uniform (&state);
+    boxes.push_back (box);
+  }
+
+  /* sort objects based on dimension to pick objects with bigger bbox */
+  std::sort (boxes.begin (), boxes.end (),
+      [](const vvas_cpuref_box & box1, const vvas_cpuref_box & box2) {
+        return box1.width * box1.height > box2.width * box2.height;
+      });
+
+  LOG_MESSAGE (LOG_LEVEL_INFO, kpriv->log_level, "objects detected %lu",
+      boxes.size ());
+
+  for (auto & box:boxes) {
+    if (vvas_label_filtered (kpriv, box.label))
+      continue;
+    const char *display_name = kpriv->labelptr[box.label].display_name.c_str ();
+
+    if (!*parent) {
+      VvasBoundingBox parent_bbox = { 0 };
+      parent_bbox.width = cols;
+      parent_bbox.height = rows;
+      *parent = vvas_inferprediction_new ();
+      (*parent)->bbox = parent_bbox;
+    }
+
+    VvasBoundingBox bbox = { 0 };
+    VvasInferPrediction *predict;
+    VvasInferClassification *c = NULL;
+
+    bbox.x = box.x * cols;
+    bbox.y = box.y * rows;
+    bbox.width = box.width * cols;
+    bbox.height = box.height * rows;
+
+    predict = vvas_inferprediction_new ();
+    predict->bbox = bbox;
+
+    c = vvas_inferclassification_new ();
+    c->class_id = box.label;
+    c->class_prob = box.score;
+    c->class_label = strdup (display_name);
+    c->num_classes = 0;
+    predict->classifications = vvas_list_append (predict->classifications, c);
+
+    /* add class and name in prediction node */
+    predict->model_class = model_class;
+    predict->model_name = strdup (kpriv->modelname.c_str ());
+    vvas_inferprediction_append (*parent, predict);
+
+    LOG_MESSAGE (LOG_LEVEL_INFO, kpriv->log_level,
+        "RESULT: %s(%d) %d %d %u %u (%f)", display_name, box.label,
+        bbox.x, bbox.y, bbox.width, bbox.height, box.score);
+
+    cur_objs++;
+    if (cur_objs == kpriv->objs_detection_max) {
+      LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level,
+          "reached max limit of objects to add to metadata");
+      break;
+    }
+  }
+}
+
+void
+vvas_cpuref::classify (VvasDpuInferPrivate * kpriv, cv::Mat & image,
+    uint64_t state, VvasInferPrediction ** parent)
+{
+  std::vector < float >scores (num_classes);
+  std::vector < int >index (num_classes);
+
+  if (type == VVAS_CPUREF_NETWORK) {
+    cv::Mat small, x, y;
+
+    /* average pool to the input grid, then fully connected layers */
+    cv::resize (image, small, cv::Size (grid, grid), 0, 0, cv::INTER_AREA);
+    small.convertTo (x, CV_32FC3);
+    if (kpriv->need_preprocess) {
+      cv::subtract (x, mean, x);
+      cv::multiply (x, scale, x);
+    }
+    x = x.reshape (1, 1);
+    for (auto l = 0u; l < weights.size (); l++) {
+      cv::gemm (x, weights[l], 1.0, biases[l], 1.0, y, cv::GEMM_2_T);
+      if (l + 1 < weights.size ())
+        x = cv::max (y, 0.0f);
+      else
+        x = y.clone ();
+    }
+
+    /* softmax */
+    double max_logit;
+    cv::minMaxLoc (x, NULL, &max_logit);
+    cv::exp (x - max_logit, x);
+    x /= cv::sum (x)[0];
+    std::copy (x.ptr < float >(), x.ptr < float >() + num_classes,
+        scores.begin ());
+  } else {
+    /* a dominant class and a decreasing tail of random classes */
+    float total = 0.0f;
+    for (auto & s:scores) {
+      s = cpuref_uniform (&state) * 0.1f;
+      total += s;
+    }
+    scores[cpuref_next (&state) % num_classes] += total * 4.0f;
+    total *= 5.0f;
+    for (auto & s:scores)
+      s /= total;
+  }
+
+  for (auto i = 0; i < num_classes; i++)
+    index[i] = i;
+  std::partial_sort (index.begin (), index.begin () + top_k, index.end (),
+      [&scores] (int a, int b) {
+        return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+      });
+
+  if (!*parent) {
+    VvasBoundingBox parent_bbox = { 0 };
+    parent_bbox.width = image.cols;
+    parent_bbox.height = image.rows;
+    *parent = vvas_inferprediction_new ();
+    (*parent)->bbox = parent_bbox;
+  }
+
+  VvasBoundingBox child_bbox = { 0 };
+  VvasInferPrediction *child_predict = vvas_inferprediction_new ();
+  child_predict->bbox = child_bbox;
+
+  for (auto k = 0; k < top_k; k++) {
+    VvasInferClassification *c = vvas_inferclassification_new ();
+    c->class_id = index[k];
+    c->class_prob = scores[index[k]];
+    c->class_label = strdup (kpriv->labelptr[index[k]].display_name.c_str ());
+    c->num_classes = 0;
+    child_predict->classifications =
+        vvas_list_append (child_predict->classifications, c);
+
+    LOG_MESSAGE (LOG_LEVEL_INFO, kpriv->log_level,
+        " r.index %d %s, r.score, %f", c->class_id, c->class_label,
+        c->class_prob);
+  }
+
+  /* add class and name in prediction node */
+  child_predict->model_class = model_class;
+  child_predict->model_name = strdup (kpriv->modelname.c_str ());
+  vvas_inferprediction_append (*parent, child_predict);
+}
+
+void
+vvas_cpuref::rawtensor (VvasDpuInferPrivate * kpriv, cv::Mat & image,
+    uint64_t state, VvasInferPrediction ** parent)
+{
+  vvas_cpuref_tb *cpuref_tb = new vvas_cpuref_tb;
+
+  for (auto & t:tensors) {
+    auto tensor = xir::Tensor::create (t.name,
+        { 1, t.height, t.width, t.channels },
+        xir::DataType { xir::DataType::XINT, 8 });
+    tensor->set_attr < int >("fix_point", t.fix_point);
+
+    auto buffer = vart::alloc_cpu_flat_tensor_buffer (tensor.get ());
+    uint64_t data = 0u;
+    size_t size = 0u;
+    std::tie (data, size) = buffer->data ({ 0, 0, 0, 0 });
+    for (size_t i = 0; i < size; i += 8) {
+      uint64_t v = cpuref_next (&state);
+      memcpy ((uint8_t *) data + i, &v, std::min ((size_t) 8, size - i));
+    }
+
+    cpuref_tb->tensors.push_back (std::move (tensor));
+    cpuref_tb->buffers.push_back (std::move (buffer));
+  }
+
+  if (!*parent) {
+    VvasBoundingBox parent_bbox = { 0 };
+    parent_bbox.width = image.cols;
+    parent_bbox.height = image.rows;
+    *parent = vvas_inferprediction_new ();
+    (*parent)->bbox = parent_bbox;
+  }
+
+  VvasInferPrediction *predict = vvas_inferprediction_new ();
+  TensorBuf *tb = (TensorBuf *) malloc (sizeof (TensorBuf));
+
+  /* fill tensor data */
+  tb->priv = (void *) cpuref_tb;
+  tb->copy = cpuref_tb_copy;
+  tb->free = cpuref_tb_free;
+  tb->size = cpuref_tb->buffers.size ();
+  tb->width = image.cols;
+  tb->height = image.rows;
+  tb->fmt = (unsigned long int) vart::Runner::TensorFormat::NHWC;
+  tb->ref_count = 1;
+  for (auto i = 0u; i < cpuref_tb->buffers.size (); ++i)
+    tb->ptr[i] = (void *) cpuref_tb->buffers[i].get ();
+  predict->tb = tb;
+
+  /* add class and name in prediction node */
+  predict->model_class = model_class;
+  predict->model_name = strdup (kpriv->modelname.c_str ());
+  vvas_inferprediction_append (*parent, predict);
+}
+
+int
+vvas_cpuref::run (void *handle, std::vector < cv::Mat > &images,
+    VvasInferPrediction ** predictions)
+{
+  VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *) handle;
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter batch");
+  char *pstr;                   /* prediction string */
+
+  /* emulated accelerator run, results are built afterwards like models do */
+  auto deadline = std::chrono::steady_clock::now () +
+      std::chrono::microseconds (latency_us +
+      frame_latency_us * (long) images.size ());
+
+  std::this_thread::sleep_until (deadline);
+  vvas_dpuinfer_mark_run (kpriv);
+
+  if (type == VVAS_CPUREF_DETECTION && kpriv->objs_detection_max == 0) {
+    LOG_MESSAGE (LOG_LEVEL_WARNING, kpriv->log_level,
+        "max-objects count is zero. So, not doing any metadata processing");
+    return true;
+  }
+
+  for (auto i = 0u; i < images.size (); i++) {
+    VvasInferPrediction *parent_predict = predictions[i];
+    uint64_t state = cpuref_frame_state (images[i], seed);
+
+    if (type == VVAS_CPUREF_DETECTION)
+      detect (kpriv, images[i], state, &parent_predict);
+    else if (type == VVAS_CPUREF_RAWTENSOR)
+      rawtensor (kpriv, images[i], state, &parent_predict);
+    else
+      classify (kpriv, images[i], state, &parent_predict);
+
+    if (parent_predict && kpriv->log_level >= LOG_LEVEL_DEBUG) {
+      pstr = vvas_inferprediction_to_string (parent_predict);
+      LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level,
+          "prediction tree : \n%s", pstr);
+      free (pstr);
+    }
+    predictions[i] = parent_predict;
+  }
+
+  LOG_MESSAGE (LOG_LEVEL_INFO, kpriv->log_level, " ");
+  return true;
+}
+
+int
+vvas_cpuref::requiredwidth (void)
+{
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, log_level, "enter");
+  return width;
+}
+
+int
+vvas_cpuref::requiredheight (void)
+{
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, log_level, "enter");
+  return height;
+}
+
+int
+vvas_cpuref::supportedbatchsz (void)
+{
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, log_level, "enter");
+  return batch;
+}
+
+int
+vvas_cpuref::close (void)
+{
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, log_level, "enter");
+  return true;
+}
+
+vvas_cpuref::~vvas_cpuref ()
+{
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, log_level, "enter");
+}
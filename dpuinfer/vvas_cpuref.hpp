@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+#include "vvas_dpupriv.hpp"
+
+using namespace std;
+using namespace cv;
+
+/*
+ * CPU reference model, runs without a DPU so that everything downstream of
+ * vvas_dpuinfer_process_frames () can be benchmarked and regression tested on
+ * ordinary hosts. The model is described by <model-name>.json in the model
+ * directory, in place of the xmodel:
+ *
+ *  model-type:       "detection", "classification", "rawtensor" or "network"
+ *  model-class:      Model class set in the predictions, like "YOLOV3"
+ *  width, height:    Input resolution
+ *  batch-size:       Supported batch size
+ *  latency-us:       Duration of the emulated accelerator run of a batch
+ *  frame-latency-us: Duration added to the run for each frame of a batch
+ *  seed:             Seed of the synthetic results
+ *  min-objects, max-objects: Range of detected objects per frame
+ *  min-box-size, max-box-size: Range of box sides relative to the frame
+ *  num-classes:      Classes when label.json is not present
+ *  top-k:            Classifications reported per frame
+ *  mean, scale:      Pre-processing, in BGR order like the prototxt
+ *  output-tensors:   Array of { name, height, width, channels, fix-point }
+ *  grid-size, hidden-size, weights-file: Shape and float32 weights of the
+ *                    tiny network, weights are derived from seed if no file
+ *
+ * Synthetic results only depend on the seed and on the pixels of the frame,
+ * so a frame gives the same predictions whatever batch or order it runs in.
+ */
+
+enum
+{
+  VVAS_CPUREF_DETECTION,
+  VVAS_CPUREF_CLASSIFICATION,
+  VVAS_CPUREF_RAWTENSOR,
+  VVAS_CPUREF_NETWORK
+};
+
+typedef struct
+{
+  std::string name;
+  int height;
+  int width;
+  int channels;
+  int fix_point;
+} vvas_cpuref_tensor;
+
+class vvas_cpuref:public vvas_dpumodel
+{
+  int log_level = 0;
+  bool valid = false;
+
+  int type = VVAS_CPUREF_DETECTION;
+  VvasClass model_class = VVAS_XCLASS_NOTFOUND;
+  int width = 224;
+  int height = 224;
+  int batch = 1;
+  long latency_us = 0;
+  long frame_latency_us = 0;
+  uint64_t seed = 0;
+  unsigned int min_objects = 0;
+  unsigned int max_objects = 8;
+  float min_box = 0.05f;
+  float max_box = 0.3f;
+  int num_classes = 80;
+  int top_k = 1;
+  cv::Scalar mean;
+  cv::Scalar scale;
+  std::vector < vvas_cpuref_tensor > tensors;
+
+  /* tiny network, one optional hidden layer with ReLU */
+  int grid = 8;
+  int hidden = 0;
+  std::vector < cv::Mat > weights;
+  std::vector < cv::Mat > biases;
+
+  bool parse (VvasDpuInferPrivate * kpriv, const std::string & json_file);
+  bool init_network (VvasDpuInferPrivate * kpriv, const std::string & file);
+  void detect (VvasDpuInferPrivate * kpriv, cv::Mat & image, uint64_t state,
+      VvasInferPrediction ** parent);
+  void classify (VvasDpuInferPrivate * kpriv, cv::Mat & image,
+      uint64_t state, VvasInferPrediction ** parent);
+  void rawtensor (VvasDpuInferPrivate * kpriv, cv::Mat & image,
+      uint64_t state, VvasInferPrediction ** parent);
+
+public:
+  vvas_cpuref (void * handle, const std::string & json_file);
+  bool is_valid (void) { return valid; }
+  bool is_detection (void) { return type == VVAS_CPUREF_DETECTION; }
+  virtual int run (void * handle, std::vector < cv::Mat > &images,
+      VvasInferPrediction ** predictions);
+
+  virtual int requiredwidth (void);
+  virtual int requiredheight (void);
+  virtual int supportedbatchsz (void);
+  virtual int close (void);
+  virtual ~ vvas_cpuref ();
+};
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vvas_dpubatch.hpp"
+
+/**
+ *  @fn vvas_dpubatch::vvas_dpubatch (int batch_size, unsigned int timeout_us,
+ *                                    unsigned int num_workers,
+ *                                    const vvas_dpubatch_run & run)
+ *  @param [in] batch_size - Maximum number of frames in a batch
+ *  @param [in] timeout_us - Time a request may wait for other requests to
+ *                           fill its batch, in microseconds
+ *  @param [in] num_workers - Number of batches in flight, at least 1
+ *  @param [in] run - Runs one batch, called by one worker at a time
+ *  @brief Starts the worker threads, throws std::system_error on failure.
+ */
+vvas_dpubatch::vvas_dpubatch (int batch_size, unsigned int timeout_us,
+    unsigned int num_workers, const vvas_dpubatch_run & run)
+:  run (run), timeout (timeout_us), batch_size (batch_size)
+{
+  num_workers = std::max (num_workers, 1u);
+  /* one more batch per worker may wait in the queue */
+  max_queued = batch_size * num_workers;
+
+  try {
+    for (auto i = 0u; i < num_workers; i++)
+      workers.emplace_back (&vvas_dpubatch::worker_main, this);
+  } catch (const std::system_error &) {
+    stop ();
+    throw;
+  }
+}
+
+vvas_dpubatch::~vvas_dpubatch ()
+{
+  stop ();
+}
+
+/**
+ *  @fn void vvas_dpubatch::stop (void)
+ *  @return none
+ *  @brief Runs queued requests and joins the worker threads.
+ */
+void
+vvas_dpubatch::stop (void)
+{
+  {
+    std::lock_guard < std::mutex > guard (lock);
+    quit = true;
+  }
+  wake.notify_all ();
+  for (auto & worker:workers)
+    worker.join ();
+  workers.clear ();
+}
+
+/**
+ *  @fn void vvas_dpubatch::complete (vvas_dpubatch_request * req,
+ *                                    VvasReturnType ret)
+ *  @param [in] req - Request whose frames were run
+ *  @param [in] ret - Result of the batch
+ *  @return none
+ *  @brief Hands predictions to the caller and wakes it up, requests nobody
+ *         waits for are freed.
+ */
+void
+vvas_dpubatch::complete (vvas_dpubatch_request * req, VvasReturnType ret)
+{
+  std::copy (req->predictions.begin (), req->predictions.end (), req->out);
+  if (req->callback)
+    req->callback (ret);
+
+  std::lock_guard < std::mutex > guard (lock);
+  if (req->release) {
+    delete req;
+    return;
+  }
+  req->ret = ret;
+  req->done = true;
+  done.notify_all ();
+}
+
+/**
+ *  @fn void vvas_dpubatch::worker_main (void)
+ *  @return none
+ *  @brief Loop of a worker thread. Requests are taken in arrival order and
+ *         are never split, remaining requests wait for next batch. Batches
+ *         run and complete in the order they were formed. Queued requests
+ *         are still run when quitting, without waiting.
+ */
+void
+vvas_dpubatch::worker_main (void)
+{
+  std::unique_lock < std::mutex > guard (lock);
+  std::vector < vvas_dpubatch_request * >batch;
+  std::vector < VvasVideoFrame * >inputs;
+  std::vector < VvasInferPrediction * >predictions;
+
+  for (;;) {
+    wake.wait (guard, [&] { return quit || !queue.empty (); });
+    if (queue.empty ())
+      return;
+
+    /* oldest request has the earliest deadline */
+    while (!quit && !queue.empty () && queued < batch_size &&
+        wake.wait_until (guard, queue.front ()->deadline) !=
+        std::cv_status::timeout);
+    if (queue.empty ())
+      continue;
+
+    batch.clear ();
+    inputs.clear ();
+    predictions.clear ();
+    while (!queue.empty () &&
+        (int) inputs.size () + (int) queue.front ()->inputs.size () <=
+        batch_size) {
+      vvas_dpubatch_request *req = queue.front ();
+      queue.pop_front ();
+      queued -= req->inputs.size ();
+      batch.push_back (req);
+      inputs.insert (inputs.end (), req->inputs.begin (), req->inputs.end ());
+      predictions.insert (predictions.end (), req->predictions.begin (),
+          req->predictions.end ());
+    }
+    space.notify_all ();
+    uint64_t ticket = formed++;
+
+    /* take turn to run, batches formed earlier run first */
+    done.wait (guard, [&] { return run_turn == ticket; });
+    guard.unlock ();
+    VvasReturnType ret = run (inputs.data (), predictions.data (),
+        (int) inputs.size ());
+    guard.lock ();
+    run_turn++;
+    done.notify_all ();
+
+    /* route predictions back in order, callbacks overlap the next run */
+    done.wait (guard, [&] { return done_turn == ticket; });
+    guard.unlock ();
+    size_t offset = 0;
+    for (auto req:batch) {
+      std::copy (predictions.begin () + offset,
+          predictions.begin () + offset + req->inputs.size (),
+          req->predictions.begin ());
+      offset += req->inputs.size ();
+      complete (req, ret);
+    }
+    guard.lock ();
+    done_turn++;
+    done.notify_all ();
+  }
+}
+
+/**
+ *  @fn vvas_dpubatch_request * vvas_dpubatch::submit (VvasVideoFrame ** inputs,
+ *                                                     VvasInferPrediction ** predictions,
+ *                                                     int num,
+ *                                                     const vvas_dpubatch_done & callback,
+ *                                                     bool release)
+ *  @param [in] inputs - Frames to run
+ *  @param [in,out] predictions - Predictions of each frame, written when the
+ *                                request is done
+ *  @param [in] num - Number of frames, not more than batch size
+ *  @param [in] callback - Called from a worker when the request is done, may
+ *                         be empty. It must not submit to this batcher.
+ *  @param [in] release - If set, request is freed once done and must not be
+ *                        used anymore, otherwise it must be freed by @wait
+ *  @return Request
+ *  @brief Queues frames, waits only while the queue is full.
+ */
+vvas_dpubatch_request *
+vvas_dpubatch::submit (VvasVideoFrame ** inputs,
+    VvasInferPrediction ** predictions, int num,
+    const vvas_dpubatch_done & callback, bool release)
+{
+  vvas_dpubatch_request *req = new vvas_dpubatch_request;
+
+  req->inputs.assign (inputs, inputs + num);
+  req->predictions.assign (predictions, predictions + num);
+  req->out = predictions;
+  req->callback = callback;
+  req->ret = VVAS_RET_ERROR;
+  req->done = false;
+  req->release = release;
+
+  std::unique_lock < std::mutex > guard (lock);
+  space.wait (guard, [&] { return queued == 0 || queued + num <= max_queued; });
+  req->deadline = std::chrono::steady_clock::now () + timeout;
+  queue.push_back (req);
+  queued += num;
+  /* only a full batch or a new head of queue changes what workers wait for */
+  if (queued >= batch_size || queue.size () == 1)
+    wake.notify_all ();
+
+  return req;
+}
+
+/**
+ *  @fn bool vvas_dpubatch::poll (vvas_dpubatch_request * req)
+ *  @param [in] req - Request returned by @submit without release
+ *  @return true when the request is done
+ *  @brief Checks for completion without waiting.
+ */
+bool
+vvas_dpubatch::poll (vvas_dpubatch_request * req)
+{
+  std::lock_guard < std::mutex > guard (lock);
+  return req->done;
+}
+
+/**
+ *  @fn VvasReturnType vvas_dpubatch::wait (vvas_dpubatch_request * req)
+ *  @param [in] req - Request returned by @submit without release
+ *  @return VvasReturnType of the batch the frames were run in
+ *  @brief Waits until the request is done and frees it.
+ */
+VvasReturnType
+vvas_dpubatch::wait (vvas_dpubatch_request * req)
+{
+  VvasReturnType ret;
+  {
+    std::unique_lock < std::mutex > guard (lock);
+    done.wait (guard, [&] { return req->done; });
+    ret = req->ret;
+  }
+  delete req;
+  return ret;
+}
+
+/**
+ *  @fn VvasReturnType vvas_dpubatch::process (VvasVideoFrame ** inputs,
+ *                                             VvasInferPrediction ** predictions,
+ *                                             int num)
+ *  @param [in] inputs - Frames to run
+ *  @param [in,out] predictions - Predictions of each frame
+ *  @param [in] num - Number of frames, not more than batch size
+ *  @return VvasReturnType of the batch the frames were run in
+ *  @brief Queues frames and waits until their batch is run.
+ */
+VvasReturnType
+vvas_dpubatch::process (VvasVideoFrame ** inputs,
+    VvasInferPrediction ** predictions, int num)
+{
+  return wait (submit (inputs, predictions, num, nullptr, false));
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <vvas_core/vvas_dpuinfer.hpp>
+
+/* Runs one batch of frames through the model */
+typedef std::function < VvasReturnType (VvasVideoFrame ** inputs,
+    VvasInferPrediction ** predictions, int batch_size) > vvas_dpubatch_run;
+
+/* Called from a worker once the frames of a request are done */
+typedef std::function < void (VvasReturnType ret) > vvas_dpubatch_done;
+
+/* Frames of one caller, kept together in a single batch */
+typedef struct
+{
+  std::vector < VvasVideoFrame * >inputs;
+  std::vector < VvasInferPrediction * >predictions;
+  VvasInferPrediction **out;
+  std::chrono::steady_clock::time_point deadline;
+  vvas_dpubatch_done callback;
+  VvasReturnType ret;
+  bool done;
+  bool release;
+} vvas_dpubatch_request;
+
+/*
+ * Queues frames of any number of callers and runs them in batches from
+ * worker threads. A batch is dispatched when it is full, or when the oldest
+ * queued request waited for the batch timeout. Each worker holds one batch,
+ * model runs are serialized while routing of predictions and completion
+ * callbacks of the previous batch go on in parallel.
+ */
+class vvas_dpubatch
+{
+  std::mutex lock;
+  std::condition_variable wake;
+  std::condition_variable done;
+  std::condition_variable space;
+  std::deque < vvas_dpubatch_request * > queue;
+  std::vector < std::thread > workers;
+  vvas_dpubatch_run run;
+  std::chrono::microseconds timeout;
+  int batch_size;
+  int max_queued;
+  int queued = 0;
+  uint64_t formed = 0;
+  uint64_t run_turn = 0;
+  uint64_t done_turn = 0;
+  bool quit = false;
+
+  void stop (void);
+  void worker_main (void);
+  void complete (vvas_dpubatch_request * req, VvasReturnType ret);
+
+public:
+  vvas_dpubatch (int batch_size, unsigned int timeout_us,
+      unsigned int num_workers, const vvas_dpubatch_run & run);
+  ~vvas_dpubatch ();
+
+  vvas_dpubatch_request *submit (VvasVideoFrame ** inputs,
+      VvasInferPrediction ** predictions, int num,
+      const vvas_dpubatch_done & callback, bool release);
+  bool poll (vvas_dpubatch_request * req);
+  VvasReturnType wait (vvas_dpubatch_request * req);
+  VvasReturnType process (VvasVideoFrame ** inputs,
+      VvasInferPrediction ** predictions, int num);
+};
@@ -20,11 +20,11 @@
 #include <opencv2/highgui.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/opencv.hpp>
-#include <sys/time.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <string>
 #include <fstream>
+#include <map>
 
 #include <vitis/ai/bounded_queue.hpp>
 #include <vitis/ai/env_config.hpp>
@@ -36,6 +36,7 @@
 #include <vvas_core/vvas_dpuinfer.hpp>
 #include "vvas_dpumodels.hpp"
 #include "vvas_dpupriv.hpp"
+#include "vvas_dpumosaic.hpp"
 
 #ifdef ENABLE_CLASSIFICATION
 #include "vvas_classification.hpp"
@@ -97,16 +98,27 @@
 #ifdef ENABLE_RAWTENSOR
 #include "vvas_rawtensor.hpp"
 #endif
+#ifdef ENABLE_CPUREF
+#include "vvas_cpuref.hpp"
+#endif
 
 using namespace cv;
 using namespace std;
 
+/* Each batch in flight has its own worker thread */
+#define DPUINFER_MAX_INFLIGHT_BATCHES 16
+
 static VvasMutex model_create_lock;
+
+/* models shared by instances, see vvas_dpushared_get () */
+static std::mutex registry_lock;
+static std::condition_variable registry_cond;
+static std::map < std::string, vvas_dpushared * >registry;
 int
 vvas_xclass_to_num (char *name)
 {
   int nameslen = 0;
-  while (vvas_xmodelclass[nameslen] != NULL) {
+  while (nameslen < VVAS_XCLASS_NOTFOUND) {
     if (!strcmp (vvas_xmodelclass[nameslen], name))
       return nameslen;
     nameslen++;
@@ -114,6 +126,26 @@ vvas_xclass_to_num (char *name)
   return VVAS_XCLASS_NOTFOUND;
 }
 
+/* Models giving bounding boxes of objects found in the frame */
+static bool
+vvas_xclass_is_detection (int modelclass)
+{
+  switch (modelclass) {
+    case VVAS_XCLASS_YOLOV3:
+    case VVAS_XCLASS_YOLOV2:
+    case VVAS_XCLASS_SSD:
+    case VVAS_XCLASS_TFSSD:
+    case VVAS_XCLASS_REFINEDET:
+    case VVAS_XCLASS_FACEDETECT:
+    case VVAS_XCLASS_PLATEDETECT:
+    case VVAS_XCLASS_EFFICIENTDETD2:
+    case VVAS_XCLASS_CPUREF:
+      return true;
+    default:
+      return false;
+  }
+}
+
 vvas_dpumodel::~vvas_dpumodel ()
 {
 }
@@ -237,6 +269,26 @@ modelexists (VvasDpuInferPrivate * kpriv)
   auto prototxt_name =
       kpriv->modelpath + "/" + kpriv->modelname + "/" + kpriv->modelname +
       ".prototxt";
+#ifdef ENABLE_CPUREF
+  auto cpuref_name =
+      kpriv->modelpath + "/" + kpriv->modelname + "/" + kpriv->modelname +
+      ".json";
+
+  /* CPU reference models are described by a json file instead of an xmodel */
+  if (kpriv->modelclass == VVAS_XCLASS_CPUREF || (!fileexists (xmodel_name)
+          && !fileexists (elf_name) && fileexists (cpuref_name))) {
+    if (!fileexists (cpuref_name)) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level, "%s not found",
+          cpuref_name.c_str ());
+      cpuref_name = "";
+    } else {
+      LOG_MESSAGE (LOG_LEVEL_INFO, kpriv->log_level,
+          "using CPU reference model %s", cpuref_name.c_str ());
+      kpriv->cpuref = true;
+    }
+    return cpuref_name;
+  }
+#endif
 
   if (kpriv->modelclass != VVAS_XCLASS_RAWTENSOR && !fileexists (prototxt_name)) {
     LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level, "%s not found",
@@ -369,15 +421,6 @@ error:
   return NULL;
 }
 
-long long
-get_time ()
-{
-  struct timeval tv;
-  gettimeofday (&tv, NULL);
-  return ((long long) tv.tv_sec * 1000000 + tv.tv_usec) +
-      42 * 60 * 60 * INT64_C (1000000);
-}
-
 vvas_dpumodel *
 vvas_xinitmodel (VvasDpuInferPrivate * kpriv, int modelclass)
 {
@@ -404,7 +447,7 @@ vvas_xinitmodel (VvasDpuInferPrivate * kpriv, int modelclass)
    * & destroy should be handled by application.
    */
   vvas_mutex_lock (&model_create_lock);
-  switch (modelclass) {
+  switch (kpriv->cpuref ? VVAS_XCLASS_CPUREF : modelclass) {
 #ifdef ENABLE_CLASSIFICATION
     case VVAS_XCLASS_CLASSIFICATION:
     {
@@ -560,6 +603,19 @@ vvas_xinitmodel (VvasDpuInferPrivate * kpriv, int modelclass)
       break;
     }
 #endif
+#ifdef ENABLE_CPUREF
+    case VVAS_XCLASS_CPUREF:
+    {
+      vvas_cpuref *cpuref = new vvas_cpuref (kpriv, kpriv->elfname);
+      if (!cpuref->is_valid ()) {
+        delete cpuref;
+        vvas_mutex_unlock (&model_create_lock);
+        return NULL;
+      }
+      model = cpuref;
+      break;
+    }
+#endif
 
     default:
     {
@@ -576,7 +632,8 @@ vvas_xinitmodel (VvasDpuInferPrivate * kpriv, int modelclass)
     delete model;
     kpriv->modelclass = VVAS_XCLASS_NOTFOUND;
     if (kpriv->labelptr != NULL)
-      delete kpriv->labelptr;
+      delete[]kpriv->labelptr;
+    kpriv->labelptr = NULL;
     return NULL;
   }
 
@@ -590,6 +647,144 @@ vvas_xinitmodel (VvasDpuInferPrivate * kpriv, int modelclass)
   return model;
 }
 
+/**
+ *  @fn static vvas_dpushared * vvas_dpushared_get (VvasDpuInferPrivate * kpriv)
+ *
+ *  @param [in,out] kpriv  Private structure of the instance, model fields
+ *                         are filled from the shared model
+ *  @return Shared model with a reference taken for the instance, NULL on failure
+ *  @brief  Looks up the model loaded with the same path, name, class, batch
+ *          size, input format and pre-processing, or loads it. Only one
+ *          instance loads a given model, others wait for it. Instances
+ *          without share_model always load their own model.
+ */
+static vvas_dpushared *
+vvas_dpushared_get (VvasDpuInferPrivate * kpriv)
+{
+  vvas_dpushared *shared;
+  std::string key = kpriv->modelpath + "/" + kpriv->modelname + ":" +
+      std::to_string (kpriv->modelclass) + ":" +
+      std::to_string (kpriv->batch_size) + ":" +
+      std::to_string (kpriv->modelfmt) + ":" +
+      std::to_string (kpriv->need_preprocess);
+
+  /* nobody else looks up a key holding the instance address */
+  if (!kpriv->share_model)
+    key += ":" + std::to_string ((uintptr_t) kpriv);
+
+  std::unique_lock < std::mutex > guard (registry_lock);
+  for (;;) {
+    auto it = registry.find (key);
+    if (it == registry.end ())
+      break;
+    if (it->second->ready) {
+      shared = it->second;
+      shared->ref_count++;
+      guard.unlock ();
+      LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level,
+          "sharing model %s, %u instances", key.c_str (), shared->ref_count);
+      goto found;
+    }
+    registry_cond.wait (guard);
+  }
+
+  /* placeholder makes instances of same model wait for this one to load it */
+  shared = new vvas_dpushared;
+  shared->key = key;
+  shared->ref_count = 1;
+  shared->ready = false;
+  registry[key] = shared;
+  guard.unlock ();
+
+  kpriv->elfname = modelexists (kpriv);
+  if (kpriv->elfname.empty ()) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+        "elfname %s does not exist", kpriv->elfname.c_str ());
+    goto error;
+  }
+
+  kpriv->model = vvas_xinitmodel (kpriv, kpriv->modelclass);
+  if (!kpriv->model) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+        "failed to init model %s", kpriv->modelname.c_str ());
+    goto error;
+  }
+
+  shared->model = kpriv->model;
+  shared->elfname = kpriv->elfname;
+  shared->cpuref = kpriv->cpuref;
+  shared->labelptr = kpriv->labelptr;
+  shared->max_labels = kpriv->max_labels;
+  shared->num_labels = kpriv->num_labels;
+  shared->labelflags = kpriv->labelflags;
+  shared->batch_size = kpriv->batch_size;
+  shared->model_width = kpriv->model->requiredwidth ();
+  shared->model_height = kpriv->model->requiredheight ();
+  shared->pp_config = kpriv->pp_config;
+
+  guard.lock ();
+  shared->ready = true;
+  registry_cond.notify_all ();
+  guard.unlock ();
+
+found:
+  kpriv->model = shared->model;
+  kpriv->elfname = shared->elfname;
+  kpriv->cpuref = shared->cpuref;
+  kpriv->labelptr = shared->labelptr;
+  kpriv->max_labels = shared->max_labels;
+  kpriv->num_labels = shared->num_labels;
+  kpriv->labelflags = shared->labelflags;
+  kpriv->batch_size = shared->batch_size;
+  kpriv->model_width = shared->model_width;
+  kpriv->model_height = shared->model_height;
+  kpriv->pp_config = shared->pp_config;
+  return shared;
+
+error:
+  if (kpriv->labelptr)
+    delete[]kpriv->labelptr;
+  kpriv->labelptr = NULL;
+  kpriv->model = NULL;
+
+  guard.lock ();
+  registry.erase (key);
+  registry_cond.notify_all ();
+  guard.unlock ();
+  delete shared;
+  return NULL;
+}
+
+/**
+ *  @fn static void vvas_dpushared_put (vvas_dpushared * shared)
+ *
+ *  @param [in] shared  Shared model returned by @ref vvas_dpushared_get
+ *  @return none
+ *  @brief  Drops the reference of an instance, last one destroys the model.
+ */
+static void
+vvas_dpushared_put (vvas_dpushared * shared)
+{
+  {
+    std::lock_guard < std::mutex > guard (registry_lock);
+    if (--shared->ref_count)
+      return;
+    registry.erase (shared->key);
+  }
+
+  /*
+   * Vitis AI model destroy is not concurrent, serializing destructor call.
+   */
+  vvas_mutex_lock (&model_create_lock);
+  shared->model->close ();
+  delete shared->model;
+  vvas_mutex_unlock (&model_create_lock);
+
+  if (shared->labelptr)
+    delete[]shared->labelptr;
+  delete shared;
+}
+
 int
 prepare_filter_labels (VvasDpuInferPrivate * kpriv, char **filter_labels,
     int num)
@@ -600,9 +795,250 @@ prepare_filter_labels (VvasDpuInferPrivate * kpriv, char **filter_labels,
     }
     kpriv->filter_labels.push_back (std::string (filter_labels[i]));
   }
+
+  /* a label passes when a filter label is a prefix of its display name */
+  kpriv->filter_bitmap.assign ((kpriv->max_labels + 63) / 64, 0);
+  for (int label = 0; kpriv->labelptr && label < kpriv->max_labels; label++) {
+    const std::string & display_name = kpriv->labelptr[label].display_name;
+    for (auto & filter_label:kpriv->filter_labels) {
+      if (!display_name.compare (0, filter_label.size (), filter_label)) {
+        LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level,
+            "label %s(%d) is in filter_label list", display_name.c_str (),
+            label);
+        kpriv->filter_bitmap[label >> 6] |= UINT64_C (1) << (label & 63);
+        break;
+      }
+    }
+  }
   return 0;
 }
 
+/**
+ *  @fn static void vvas_dpuinfer_log_performance (VvasDpuInferPrivate * kpriv, bool force)
+ *
+ *  @param [in] kpriv          Private structure of the instance
+ *  @param [in] force          Log even if last log is less than a second old
+ *  @return  None
+ *  @brief   Logs frames run and frame rate from the statistics of the instance
+ *           at most once per second, for performance_test.
+ */
+static void
+vvas_dpuinfer_log_performance (VvasDpuInferPrivate * kpriv, bool force)
+{
+  VvasDpuInferStats stats;
+  int64_t now = std::chrono::duration_cast < std::chrono::microseconds >
+      (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+  int64_t last = kpriv->perf_logged_us.load ();
+
+  /* batches of an instance may finish on several workers, one logs */
+  if (!force && (now - last < 1000000 ||
+          !kpriv->perf_logged_us.compare_exchange_strong (last, now)))
+    return;
+
+  kpriv->stats.get (&stats, false);
+  LOG_MESSAGE (LOG_LEVEL_INFO, kpriv->log_level,
+      "%s: frames=%lu fps=%.2f", kpriv->modelname.c_str (),
+      (unsigned long) stats.frames, stats.frames_per_sec);
+}
+
+/**
+ *  @fn static VvasReturnType vvas_dpuinfer_run_mosaic (VvasDpuInferPrivate * kpriv, VvasVideoFrame ** inputs, VvasInferPrediction ** predictions, int batch_size)
+ *
+ *  @param [in] kpriv          Private structure of the instance
+ *  @param [in] inputs         Array of @ref VvasVideoFrame, ROIs of any size
+ *  @param [in,out] predictions         Array of @ref VvasInferPrediction
+ *  @param [in] batch_size     Number of frames, not more than max_frames
+ *  @return VvasReturnType
+ *  @brief   Tiles frames into mosaics of model input size, runs the mosaics
+ *           and hands detections back to the frames they came from.
+ */
+static VvasReturnType
+vvas_dpuinfer_run_mosaic (VvasDpuInferPrivate * kpriv,
+    VvasVideoFrame ** inputs, VvasInferPrediction ** predictions,
+    int batch_size)
+{
+  vvas_dpumodel *model = (vvas_dpumodel *) kpriv->model;
+  cv::Size input (kpriv->model_width, kpriv->model_height);
+  std::vector < cv::Size > rois (batch_size);
+  std::vector < vvas_mosaic_tile > tiles;
+  std::vector < VvasInferPrediction * >results;
+  std::vector < cv::Mat > images;
+  VvasVideoFrameMapInfo vframe_info;
+  VvasVideoInfo vinfo;
+  vvas_dpustats::time_point begin, prepared;
+  uint64_t objects = 0;
+  VvasReturnType vret;
+  int num;
+
+  begin = std::chrono::steady_clock::now ();
+  for (auto i = 0; i < batch_size; i++) {
+    if (!inputs[i]) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+          "Input Frame %d is NULL", i + 1);
+      return VVAS_RET_ERROR;
+    }
+    vvas_video_frame_get_videoinfo (inputs[i], &vinfo);
+    if (vinfo.fmt != kpriv->modelfmt) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+          "Video frame format %d not supported", vinfo.fmt);
+      return VVAS_RET_ERROR;
+    }
+    rois[i] = cv::Size (vinfo.width, vinfo.height);
+  }
+
+  num = vvas_mosaic_pack (rois, input, kpriv->mosaic_guard,
+      kpriv->mosaic_tiles, tiles);
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level,
+      "packed %d frames into %d mosaics", batch_size, num);
+
+  /* canvases are kept across batches, guard pixels are cleared each time */
+  if ((int) kpriv->mosaics.size () < num)
+    kpriv->mosaics.resize (num);
+  for (auto m = 0; m < num; m++) {
+    kpriv->mosaics[m].create (input, CV_8UC3);
+    kpriv->mosaics[m].setTo (cv::Scalar::all (0));
+    images.push_back (kpriv->mosaics[m]);
+  }
+
+  for (auto i = 0; i < batch_size; i++) {
+    vret = vvas_video_frame_map (inputs[i], VVAS_DATA_MAP_READ, &vframe_info);
+    if (vret != VVAS_RET_SUCCESS) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+          "Failed to map video frame");
+      return vret;
+    }
+
+    cv::Mat roi (vframe_info.height, vframe_info.width, CV_8UC3,
+        (void *) vframe_info.planes[0].data, vframe_info.planes[0].stride);
+    cv::Mat tile = kpriv->mosaics[tiles[i].mosaic] (tiles[i].rect);
+    if (tiles[i].scale == 1.0)
+      roi.copyTo (tile);
+    else
+      cv::resize (roi, tile, tile.size (), 0, 0, cv::INTER_AREA);
+
+    vvas_video_frame_unmap (inputs[i], &vframe_info);
+  }
+
+  prepared = std::chrono::steady_clock::now ();
+  results.assign (num, NULL);
+  for (auto m = 0; m < num; m += kpriv->batch_size) {
+    std::vector < cv::Mat > chunk (images.begin () + m,
+        images.begin () + std::min (num, m + kpriv->batch_size));
+    std::lock_guard < std::mutex > guard (kpriv->shared->run_lock);
+
+    if (model->run (kpriv, chunk, results.data () + m) != true) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level, "Model run failed %s",
+          kpriv->modelname.c_str ());
+      for (auto result:results) {
+        if (result)
+          vvas_inferprediction_free (result);
+      }
+      return VVAS_RET_ERROR;
+    }
+  }
+
+  for (auto m = 0; m < num; m++)
+    objects += vvas_mosaic_unpack (results[m], m, rois, tiles, predictions);
+
+  kpriv->stats.record (begin, prepared, std::chrono::steady_clock::now (),
+      batch_size, kpriv->max_frames, objects);
+  return VVAS_RET_SUCCESS;
+}
+
+/**
+ *  @fn static VvasReturnType vvas_dpuinfer_run_batch (VvasDpuInferPrivate * kpriv, VvasVideoFrame ** inputs, VvasInferPrediction ** predictions, int batch_size)
+ *
+ *  @param [in] kpriv          Private structure of the instance
+ *  @param [in] inputs         Array of @ref VvasVideoFrame
+ *  @param [in,out] predictions         Array of @ref VvasInferPrediction
+ *  @param [in] batch_size     Number of frames, not more than batch size of the model
+ *  @return VvasReturnType
+ *  @brief   Runs one batch of frames through the model.
+ */
+static VvasReturnType
+vvas_dpuinfer_run_batch (VvasDpuInferPrivate * kpriv, VvasVideoFrame ** inputs,
+    VvasInferPrediction ** predictions, int batch_size)
+{
+  std::vector < cv::Mat > images;
+  VvasReturnType vret;
+
+  vvas_dpumodel *model = (vvas_dpumodel *) kpriv->model;
+  VvasVideoFrame *cur_frame = NULL;
+  VvasVideoFrameMapInfo vframe_info;
+  vvas_dpustats::time_point begin, prepared;
+  uint64_t objects = 0;
+
+  if (kpriv->mosaic_tiles > 1)
+    return vvas_dpuinfer_run_mosaic (kpriv, inputs, predictions, batch_size);
+
+  begin = std::chrono::steady_clock::now ();
+  for (auto i = 0; i < batch_size; i++) {
+    cur_frame = inputs[i];
+    if (!cur_frame) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+          "Input Frame %d is NULL", i + 1);
+      return VVAS_RET_ERROR;
+    }
+
+    vret = vvas_video_frame_map (cur_frame, VVAS_DATA_MAP_READ, &vframe_info);
+    if (vret != VVAS_RET_SUCCESS) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+          "Failed to map video frame");
+      return vret;
+    }
+
+    if (vframe_info.fmt != kpriv->modelfmt) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+          "Video frame format %d not supported", vframe_info.fmt);
+      return VVAS_RET_ERROR;
+    }
+
+    if (kpriv->model_width != vframe_info.width
+        || kpriv->model_height != vframe_info.height) {
+      LOG_MESSAGE (LOG_LEVEL_WARNING, kpriv->log_level,
+          "Input height/width not match with model" "requirement");
+      LOG_MESSAGE (LOG_LEVEL_WARNING, kpriv->log_level,
+          "model required wxh is %dx%d", kpriv->model_width,
+          kpriv->model_height);
+      LOG_MESSAGE (LOG_LEVEL_WARNING, kpriv->log_level,
+          "input image wxh is %dx%d", vframe_info.width, vframe_info.height);
+    }
+
+
+    uchar *data_ptr = (uchar *) vframe_info.planes[0].data;
+    cv::Mat image (vframe_info.height, vframe_info.width, CV_8UC3,
+        (void *) (data_ptr), vframe_info.planes[0].stride);
+
+    vvas_video_frame_unmap (cur_frame, &vframe_info);
+    images.push_back (image);
+    LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "pushed Mat image %d",
+        i + 1);
+  }
+
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "Processing frame");
+  prepared = std::chrono::steady_clock::now ();
+  {
+    /* instances sharing the model take turns, waiting counts as run time,
+     * runs of an instance with its own model are already serialized */
+    std::lock_guard < std::mutex > guard (kpriv->shared->run_lock);
+    if (model->run (kpriv, images, predictions) != true) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level, "Model run failed %s",
+          kpriv->modelname.c_str ());
+      return VVAS_RET_ERROR;
+    }
+  }
+
+  for (auto i = 0; i < batch_size; i++) {
+    if (predictions[i])
+      objects += vvas_treenode_get_n_childnodes (predictions[i]->node);
+  }
+  kpriv->stats.record (begin, prepared, std::chrono::steady_clock::now (),
+      batch_size, kpriv->batch_size, objects);
+
+  return VVAS_RET_SUCCESS;
+
+}
+
 /**
  *  @fn VvasDpuInfer * vvas_dpuinfer_create (VvasDpuInferConf * dpu_conf, VvasLogLevel log_level)
  *
@@ -617,6 +1053,7 @@ VvasDpuInfer *
 vvas_dpuinfer_create (VvasDpuInferConf * dpu_conf, VvasLogLevel log_level)
 {
   VvasDpuInferPrivate *kpriv = NULL;
+  unsigned int num_inflight;
 
   kpriv = new VvasDpuInferPrivate;
   if (!kpriv) {
@@ -626,6 +1063,15 @@ vvas_dpuinfer_create (VvasDpuInferConf * dpu_conf, VvasLogLevel log_level)
 
   kpriv->model = NULL;
   kpriv->labelptr = NULL;
+  kpriv->cpuref = false;
+  kpriv->segoutrle = false;
+  kpriv->batcher = NULL;
+  kpriv->shared = NULL;
+  kpriv->share_model = dpu_conf->share_model;
+  kpriv->mosaic_tiles = 0;
+  kpriv->mosaic_guard = 0;
+  kpriv->max_frames = 0;
+  kpriv->perf_logged_us = 0;
   kpriv->log_level = log_level;
   kpriv->need_preprocess = dpu_conf->need_preprocess;
   kpriv->batch_size = dpu_conf->batch_size;
@@ -645,6 +1091,7 @@ vvas_dpuinfer_create (VvasDpuInferConf * dpu_conf, VvasLogLevel log_level)
   if (kpriv->modelclass == VVAS_XCLASS_SEGMENTATION) {
     kpriv->segoutfactor = dpu_conf->segoutfactor;
     kpriv->segoutfmt = dpu_conf->segoutfmt;
+    kpriv->segoutrle = dpu_conf->segoutrle;
     if (kpriv->segoutfmt == VVAS_VIDEO_FORMAT_UNKNOWN ||
         !(kpriv->segoutfmt == VVAS_VIDEO_FORMAT_BGR ||
             kpriv->segoutfmt == VVAS_VIDEO_FORMAT_GRAY8)) {
@@ -653,6 +1100,11 @@ vvas_dpuinfer_create (VvasDpuInferConf * dpu_conf, VvasLogLevel log_level)
           dpu_conf->segoutfmt);
       goto error;
     }
+    if (kpriv->segoutrle && kpriv->segoutfmt != VVAS_VIDEO_FORMAT_GRAY8) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+          "run-length segmentation output needs GRAY8 segoutfmt");
+      goto error;
+    }
   } else if (kpriv->modelclass == VVAS_XCLASS_RAWTENSOR
       && kpriv->need_preprocess) {
     LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
@@ -664,25 +1116,44 @@ vvas_dpuinfer_create (VvasDpuInferConf * dpu_conf, VvasLogLevel log_level)
     goto error;
   }
 
-  kpriv->modelname = dpu_conf->model_name;
-  kpriv->elfname = modelexists (kpriv);
-  if (kpriv->elfname.empty ()) {
+  kpriv->mosaic_tiles = dpu_conf->mosaic_max_tiles;
+  if (kpriv->mosaic_tiles > 1 && !vvas_xclass_is_detection (kpriv->modelclass)) {
     LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
-        "elfname %s does not exist", kpriv->elfname.c_str ());
+        "mosaic packing needs a detection model, not %s",
+        dpu_conf->modelclass);
     goto error;
   }
+
+  kpriv->modelname = dpu_conf->model_name;
   kpriv->objs_detection_max = dpu_conf->objs_detection_max;
   kpriv->performance_test = dpu_conf->performance_test;
   kpriv->float_feature = dpu_conf->float_feature;
 
-  kpriv->model = vvas_xinitmodel (kpriv, kpriv->modelclass);
-  if (!kpriv->model) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
-        "failed to init model %s", kpriv->modelname.c_str ());
+  /* loads the model, unless another instance did already */
+  kpriv->shared = vvas_dpushared_get (kpriv);
+  if (!kpriv->shared)
     goto error;
+
+  if (kpriv->mosaic_tiles > 1) {
+#ifdef ENABLE_CPUREF
+    /* CPU reference model runs as any class, its json tells what it gives */
+    if (kpriv->cpuref && !((vvas_cpuref *) kpriv->model)->is_detection ()) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+          "mosaic packing needs a detection model, %s is not",
+          kpriv->modelname.c_str ());
+      goto error;
+    }
+#endif
+    /* tiles and guard pixels must fit in the model input */
+    if (dpu_conf->mosaic_guard >= (unsigned int) std::min (kpriv->model_width,
+            kpriv->model_height)) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+          "mosaic_guard %u must be less than model input %dx%d",
+          dpu_conf->mosaic_guard, kpriv->model_width, kpriv->model_height);
+      goto error;
+    }
+    kpriv->mosaic_guard = dpu_conf->mosaic_guard;
   }
-  kpriv->model_width = kpriv->model->requiredwidth ();
-  kpriv->model_height = kpriv->model->requiredheight ();
 
   if (kpriv->need_preprocess) {
     /** No need of PP from VVAS */
@@ -694,6 +1165,12 @@ vvas_dpuinfer_create (VvasDpuInferConf * dpu_conf, VvasLogLevel log_level)
     kpriv->pp_config.scale_b = 1;
   }
 
+  /* frames of a batch share mosaics, so more of them fit in a batch */
+  kpriv->max_frames = kpriv->batch_size;
+  if (kpriv->mosaic_tiles > 1)
+    kpriv->max_frames = std::min (kpriv->batch_size * kpriv->mosaic_tiles,
+        (unsigned int) MAX_NUM_OBJECT);
+
   if (dpu_conf->num_filter_labels) {
     if (prepare_filter_labels (kpriv, dpu_conf->filter_labels,
             dpu_conf->num_filter_labels) < 0) {
@@ -701,13 +1178,40 @@ vvas_dpuinfer_create (VvasDpuInferConf * dpu_conf, VvasLogLevel log_level)
     }
   }
 
+  /* num_inflight_batches was appended to the structure, a value left unset
+   * by the application must not start an unbounded number of threads */
+  num_inflight = dpu_conf->num_inflight_batches;
+  if (num_inflight > DPUINFER_MAX_INFLIGHT_BATCHES) {
+    LOG_MESSAGE (LOG_LEVEL_WARNING, kpriv->log_level,
+        "num_inflight_batches %u is more than %u, using %u",
+        num_inflight, DPUINFER_MAX_INFLIGHT_BATCHES,
+        DPUINFER_MAX_INFLIGHT_BATCHES);
+    num_inflight = DPUINFER_MAX_INFLIGHT_BATCHES;
+  }
+
+  try {
+    kpriv->batcher = new vvas_dpubatch (kpriv->max_frames,
+        dpu_conf->batch_timeout_us, num_inflight,
+        [kpriv] (VvasVideoFrame ** inputs,
+            VvasInferPrediction ** predictions, int batch_size) {
+          VvasReturnType vret = vvas_dpuinfer_run_batch (kpriv, inputs,
+              predictions, batch_size);
+
+          if (kpriv->performance_test && !VVAS_IS_ERROR (vret))
+            vvas_dpuinfer_log_performance (kpriv, false);
+          return vret;
+        });
+  } catch (const std::system_error &) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+        "failed to create worker threads");
+    goto error;
+  }
+
   return (VvasDpuInfer *) kpriv;
 
 error:
-  if (kpriv->model)
-    kpriv->model->close ();
-  if (kpriv->labelptr)
-    delete[]kpriv->labelptr;
+  if (kpriv->shared)
+    vvas_dpushared_put (kpriv->shared);
   delete kpriv;
   return NULL;
 }
@@ -731,95 +1235,100 @@ vvas_dpuinfer_process_frames (VvasDpuInfer * dpu_handle,
 {
   VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *) dpu_handle;
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
-  std::vector < cv::Mat > images;
-  vvas_perf *pf = &kpriv->pf;
-  VvasReturnType vret;
 
-  vvas_dpumodel *model = (vvas_dpumodel *) kpriv->model;
-  VvasVideoFrame *cur_frame = NULL;
-  VvasVideoFrameMapInfo vframe_info;
-
-  if (batch_size > kpriv->batch_size) {
+  if (batch_size > kpriv->max_frames) {
     LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
         "received more frames than batch size (%d) of the DPU",
-        kpriv->batch_size);
+        kpriv->max_frames);
     return VVAS_RET_ERROR;
   }
 
-  for (auto i = 0; i < batch_size; i++) {
-    cur_frame = inputs[i];
-    if (!cur_frame) {
-      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
-          "Input Frame %d is NULL", i + 1);
-      return VVAS_RET_ERROR;
-    }
-
-    vret = vvas_video_frame_map (cur_frame, VVAS_DATA_MAP_READ, &vframe_info);
-    if (vret != VVAS_RET_SUCCESS) {
-      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
-          "Failed to map video frame");
-      return vret;
-    }
-
-    if (vframe_info.fmt != kpriv->modelfmt) {
-      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
-          "Video frame format %d not supported", vframe_info.fmt);
-      return VVAS_RET_ERROR;
-    }
-
-    if (kpriv->model_width != vframe_info.width
-        || kpriv->model_height != vframe_info.height) {
-      LOG_MESSAGE (LOG_LEVEL_WARNING, kpriv->log_level,
-          "Input height/width not match with model" "requirement");
-      LOG_MESSAGE (LOG_LEVEL_WARNING, kpriv->log_level,
-          "model required wxh is %dx%d", kpriv->model_width,
-          kpriv->model_height);
-      LOG_MESSAGE (LOG_LEVEL_WARNING, kpriv->log_level,
-          "input image wxh is %dx%d", vframe_info.width, vframe_info.height);
-    }
-
+  return kpriv->batcher->process (inputs, predictions, batch_size);
+}
 
-    uchar *data_ptr = (uchar *) vframe_info.planes[0].data;
-    cv::Mat image (vframe_info.height, vframe_info.width, CV_8UC3,
-        (void *) (data_ptr), vframe_info.planes[0].stride);
+/**
+ *  @fn VvasReturnType vvas_dpuinfer_submit (VvasDpuInfer * dpu_handle, VvasVideoFrame *inputs[MAX_NUM_OBJECT], VvasInferPrediction *predictions[MAX_NUM_OBJECT], int batch_size, VvasDpuInferDoneCallback callback, void *user_data, VvasDpuInferRequest ** request)
+ *
+ *  @param [in] dpu_handle     VvasDpuInfer handle created using @vvas_dpuinfer_create
+ *  @param [in] inputs         Array of @ref VvasVideoFrame
+ *  @param [in,out] predictions         Array of @ref VvasInferPrediction, filled when done
+ *  @param [in] batch_size     Batch size.
+ *  @param [in] callback       Called from a worker thread when done, may be NULL
+ *  @param [in] user_data      User data passed to @callback
+ *  @param [out] request       Request to give to @ref vvas_dpuinfer_wait, may be NULL
+ *  @return VvasReturnType
+ *  @brief   Queues frames for processing without waiting for them.
+ *  @note    Frames and @predictions array must stay valid until done.
+ */
+VvasReturnType
+vvas_dpuinfer_submit (VvasDpuInfer * dpu_handle,
+    VvasVideoFrame * inputs[MAX_NUM_OBJECT],
+    VvasInferPrediction * predictions[MAX_NUM_OBJECT], int batch_size,
+    VvasDpuInferDoneCallback callback, void *user_data,
+    VvasDpuInferRequest ** request)
+{
+  VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *) dpu_handle;
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
+  vvas_dpubatch_done done;
+  vvas_dpubatch_request *req;
 
-    vvas_video_frame_unmap (cur_frame, &vframe_info);
-    images.push_back (image);
-    LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "pushed Mat image %d",
-        i + 1);
+  if (batch_size > kpriv->max_frames) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+        "received more frames than batch size (%d) of the DPU",
+        kpriv->max_frames);
+    return VVAS_RET_ERROR;
   }
 
-  if (kpriv->performance_test && !kpriv->pf.test_started) {
-    pf->timer_start = get_time ();
-    pf->last_displayed_time = pf->timer_start;
-    pf->test_started = 1;
+  if (!request && !callback) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
+        "completion of frames would not be reported");
+    return VVAS_RET_INVALID_ARGS;
   }
 
-  LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "Processing frame");
-  if (model->run (kpriv, images, predictions) != true) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level, "Model run failed %s",
-        kpriv->modelname.c_str ());
-    return VVAS_RET_ERROR;
-  }
+  if (callback)
+    done = [callback, predictions, batch_size, user_data] (VvasReturnType ret) {
+      callback (predictions, batch_size, ret, user_data);
+    };
 
-  if (kpriv->performance_test && kpriv->pf.test_started) {
-    pf->frames += batch_size;
-    if (get_time () - pf->last_displayed_time >= 1000000.0) {
-      long long current_time = get_time ();
-      double time = (current_time - pf->last_displayed_time) / 1000000.0;
-      pf->last_displayed_time = current_time;
-      double fps =
-          (time >
-          0.0) ? ((pf->frames - pf->last_displayed_frame) / time) : 999.99;
-      pf->last_displayed_frame = pf->frames;
-      printf ("\rframe=%5lu fps=%6.*f        \r", pf->frames,
-          (fps < 9.995) ? 3 : 2, fps);
-      fflush (stdout);
-    }
-  }
+  req = kpriv->batcher->submit (inputs, predictions, batch_size, done,
+      request == NULL);
+  if (request)
+    *request = (VvasDpuInferRequest *) req;
 
   return VVAS_RET_SUCCESS;
+}
 
+/**
+ *  @fn bool vvas_dpuinfer_poll (VvasDpuInfer * dpu_handle, VvasDpuInferRequest * request)
+ *
+ *  @param [in] dpu_handle     VvasDpuInfer handle created using @vvas_dpuinfer_create
+ *  @param [in] request        Request returned by @ref vvas_dpuinfer_submit
+ *  @return true when frames of @request are done
+ *  @brief   Checks whether submitted frames are done, without waiting.
+ */
+bool
+vvas_dpuinfer_poll (VvasDpuInfer * dpu_handle, VvasDpuInferRequest * request)
+{
+  VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *) dpu_handle;
+
+  return kpriv->batcher->poll ((vvas_dpubatch_request *) request);
+}
+
+/**
+ *  @fn VvasReturnType vvas_dpuinfer_wait (VvasDpuInfer * dpu_handle, VvasDpuInferRequest * request)
+ *
+ *  @param [in] dpu_handle     VvasDpuInfer handle created using @vvas_dpuinfer_create
+ *  @param [in] request        Request returned by @ref vvas_dpuinfer_submit
+ *  @return VvasReturnType of the batch the frames were run in
+ *  @brief   Waits until submitted frames are done and frees @request.
+ */
+VvasReturnType
+vvas_dpuinfer_wait (VvasDpuInfer * dpu_handle, VvasDpuInferRequest * request)
+{
+  VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *) dpu_handle;
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
+
+  return kpriv->batcher->wait ((vvas_dpubatch_request *) request);
 }
 
 /**
@@ -838,7 +1347,8 @@ vvas_dpuinfer_get_config (VvasDpuInfer * dpu_handle, VvasModelConf * model_conf)
   VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *) dpu_handle;
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
   if (model_conf) {
-    if (!kpriv->need_preprocess) {
+    /* CPU reference models take their scale as is */
+    if (!kpriv->need_preprocess && !kpriv->cpuref) {
       float inner_scale_factor = get_innerscale_value (kpriv->elfname);
       LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "inner scale %f",
           inner_scale_factor);
@@ -849,7 +1359,7 @@ vvas_dpuinfer_get_config (VvasDpuInfer * dpu_handle, VvasModelConf * model_conf)
 
     model_conf->model_width = kpriv->model_width;
     model_conf->model_height = kpriv->model_height;
-    model_conf->batch_size = kpriv->batch_size;
+    model_conf->batch_size = kpriv->max_frames;
     model_conf->mean_r = kpriv->pp_config.mean_r;
     model_conf->mean_g = kpriv->pp_config.mean_g;
     model_conf->mean_b = kpriv->pp_config.mean_b;
@@ -863,6 +1373,30 @@ vvas_dpuinfer_get_config (VvasDpuInfer * dpu_handle, VvasModelConf * model_conf)
   return VVAS_RET_SUCCESS;
 }
 
+/**
+ *  @fn VvasReturnType vvas_dpuinfer_get_stats (VvasDpuInfer * dpu_handle, VvasDpuInferStats * stats, bool reset)
+ *
+ *  @param [in] dpu_handle VvasDpuInfer handle created using @ref vvas_dpuinfer_create.
+ *  @param [out] stats @ref VvasDpuInferStats structure
+ *  @param [in] reset Start statistics again from zero after reading them
+ *  @return VvasReturnType
+ *  @brief  Returns latency of each stage of batch processing and throughput.
+ *  @note It is user's responsibility to allocate memory to this structure
+ */
+VvasReturnType
+vvas_dpuinfer_get_stats (VvasDpuInfer * dpu_handle, VvasDpuInferStats * stats,
+    bool reset)
+{
+  VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *) dpu_handle;
+
+  if (!kpriv || !stats)
+    return VVAS_RET_INVALID_ARGS;
+
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
+  kpriv->stats.get (stats, reset);
+  return VVAS_RET_SUCCESS;
+}
+
 /**
  *  @fn VvasReturnType vvas_dpuinfer_destroy (VvasDpuInfer * dpu_handle)
  *
@@ -875,35 +1409,23 @@ vvas_dpuinfer_destroy (VvasDpuInfer * dpu_handle)
 {
   VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *) dpu_handle;
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
-  vvas_perf *pf = &kpriv->pf;
 
-  if (kpriv->performance_test && kpriv->pf.test_started) {
-    double time = (get_time () - pf->timer_start) / 1000000.0;
-    double fps = (time > 0.0) ? (pf->frames / time) : 999.99;
-    printf ("\rframe=%5lu fps=%6.*f        \n", pf->frames,
-        (fps < 9.995) ? 3 : 2, fps);
+  /* runs frames still queued by other threads or submitted */
+  if (kpriv->batcher) {
+    delete kpriv->batcher;
+    kpriv->batcher = NULL;
   }
-  pf->test_started = 0;
-  pf->frames = 0;
-  pf->last_displayed_frame = 0;
-  pf->timer_start = 0;
-  pf->last_displayed_time = 0;
 
-  kpriv->modelclass = VVAS_XCLASS_NOTFOUND;
+  if (kpriv->performance_test)
+    vvas_dpuinfer_log_performance (kpriv, true);
 
-  /*
-   * Vitis AI model destroy is not concurrent, serializing destructor call.
-   */
-  vvas_mutex_lock (&model_create_lock);
-  if (kpriv->model != NULL) {
-    kpriv->model->close ();
-    delete kpriv->model;
-    kpriv->model = NULL;
-  }
-  vvas_mutex_unlock (&model_create_lock);
+  kpriv->modelclass = VVAS_XCLASS_NOTFOUND;
 
-  if (kpriv->labelptr)
-    delete[]kpriv->labelptr;
+  /* model and labels go away with the last instance using them */
+  if (kpriv->shared)
+    vvas_dpushared_put (kpriv->shared);
+  kpriv->model = NULL;
+  kpriv->labelptr = NULL;
 
   delete kpriv;
   return VVAS_RET_SUCCESS;
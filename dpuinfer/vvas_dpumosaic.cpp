@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vvas_dpumosaic.hpp"
+
+#include <algorithm>
+
+/* Row of tiles of same or lower height */
+typedef struct
+{
+  int mosaic;
+  int y;
+  int height;
+  int used;
+} vvas_mosaic_shelf;
+
+typedef struct
+{
+  int used;
+  unsigned int tiles;
+} vvas_mosaic_canvas;
+
+/**
+ *  @fn int vvas_mosaic_pack (const std::vector < cv::Size > &rois,
+ *                            cv::Size input, int guard,
+ *                            unsigned int max_tiles,
+ *                            std::vector < vvas_mosaic_tile > &tiles)
+ *  @param [in] rois - Size of each ROI
+ *  @param [in] input - Size of a model input
+ *  @param [in] guard - Pixels left between tiles
+ *  @param [in] max_tiles - Most tiles in one mosaic
+ *  @param [out] tiles - Tile of each ROI
+ *  @return Number of mosaics needed
+ *  @brief Shelf packing of ROIs by decreasing height. Each ROI goes to the
+ *         lowest shelf it fits in, or opens a shelf in the first mosaic with
+ *         room left, or a new mosaic. ROIs larger than the input are scaled
+ *         down to fit, keeping their aspect ratio.
+ */
+int
+vvas_mosaic_pack (const std::vector < cv::Size > &rois, cv::Size input,
+    int guard, unsigned int max_tiles, std::vector < vvas_mosaic_tile > &tiles)
+{
+  std::vector < vvas_mosaic_shelf > shelves;
+  std::vector < vvas_mosaic_canvas > canvases;
+  std::vector < size_t > order (rois.size ());
+
+  tiles.resize (rois.size ());
+  for (auto i = 0u; i < rois.size (); i++) {
+    vvas_mosaic_tile & tile = tiles[i];
+    cv::Size size = rois[i];
+
+    tile.scale = 1.0;
+    if (size.width > input.width || size.height > input.height) {
+      tile.scale = std::min ((double) input.width / size.width,
+          (double) input.height / size.height);
+      size.width = std::max (1, (int) (size.width * tile.scale));
+      size.height = std::max (1, (int) (size.height * tile.scale));
+    }
+    tile.rect = cv::Rect (0, 0, size.width, size.height);
+    order[i] = i;
+  }
+
+  std::stable_sort (order.begin (), order.end (),[&tiles] (size_t a, size_t b) {
+        return tiles[a].rect.height > tiles[b].rect.height;
+      });
+
+  for (auto i:order) {
+    vvas_mosaic_tile & tile = tiles[i];
+    vvas_mosaic_shelf *best = NULL;
+
+    for (auto & shelf:shelves) {
+      if (canvases[shelf.mosaic].tiles < max_tiles &&
+          tile.rect.height <= shelf.height &&
+          shelf.used + tile.rect.width <= input.width &&
+          (!best || shelf.height < best->height))
+        best = &shelf;
+    }
+
+    if (!best) {
+      vvas_mosaic_shelf shelf;
+      auto m = 0u;
+
+      for (; m < canvases.size (); m++) {
+        if (canvases[m].tiles < max_tiles &&
+            canvases[m].used + tile.rect.height <= input.height)
+          break;
+      }
+      if (m == canvases.size ())
+        canvases.push_back ({0, 0});
+
+      shelf.mosaic = m;
+      shelf.y = canvases[m].used;
+      shelf.height = tile.rect.height;
+      shelf.used = 0;
+      canvases[m].used += tile.rect.height + guard;
+      shelves.push_back (shelf);
+      best = &shelves.back ();
+    }
+
+    tile.mosaic = best->mosaic;
+    tile.rect.x = best->used;
+    tile.rect.y = best->y;
+    best->used += tile.rect.width + guard;
+    canvases[best->mosaic].tiles++;
+  }
+
+  return canvases.size ();
+}
+
+/**
+ *  @fn unsigned int vvas_mosaic_unpack (VvasInferPrediction * mosaic,
+ *                                       int index,
+ *                                       const std::vector < cv::Size > &rois,
+ *                                       const std::vector < vvas_mosaic_tile > &tiles,
+ *                                       VvasInferPrediction ** predictions)
+ *  @param [in] mosaic - Predictions of the mosaic, freed on return
+ *  @param [in] index - Index of the mosaic
+ *  @param [in] rois - Size of each ROI
+ *  @param [in] tiles - Tile of each ROI
+ *  @param [in,out] predictions - Predictions of each ROI
+ *  @return Number of detections handed to ROIs
+ *  @brief Detections go to the tile holding their center. Those centered on
+ *         guard pixels, or with less than half of their area in the tile,
+ *         straddle tiles and are dropped.
+ */
+unsigned int
+vvas_mosaic_unpack (VvasInferPrediction * mosaic, int index,
+    const std::vector < cv::Size > &rois,
+    const std::vector < vvas_mosaic_tile > &tiles,
+    VvasInferPrediction ** predictions)
+{
+  unsigned int count = 0;
+
+  if (!mosaic)
+    return 0;
+
+  for (VvasTreeNode * node = mosaic->node->children; node; node = node->next) {
+    VvasInferPrediction *det = (VvasInferPrediction *) node->data;
+    cv::Rect box (det->bbox.x, det->bbox.y, det->bbox.width,
+        det->bbox.height);
+    cv::Point center (box.x + box.width / 2, box.y + box.height / 2);
+    size_t i = 0;
+
+    for (; i < tiles.size (); i++) {
+      if (tiles[i].mosaic == index && tiles[i].rect.contains (center))
+        break;
+    }
+    if (i == tiles.size ())
+      continue;
+    if ((box & tiles[i].rect).area () * 2 < box.area ())
+      continue;
+
+    VvasBBoxTransform xform = { 0 };
+    xform.hfactor = 1.0 / tiles[i].scale;
+    xform.vfactor = 1.0 / tiles[i].scale;
+    xform.xoffset = -tiles[i].rect.x / tiles[i].scale;
+    xform.yoffset = -tiles[i].rect.y / tiles[i].scale;
+    xform.clip_width = rois[i].width;
+    xform.clip_height = rois[i].height;
+
+    VvasInferPrediction *copy = vvas_inferprediction_copy (det);
+    if (!copy)
+      continue;
+    vvas_inferprediction_transform (copy, &xform);
+
+    if (!predictions[i]) {
+      VvasBoundingBox parent_bbox = { 0 };
+      parent_bbox.width = rois[i].width;
+      parent_bbox.height = rois[i].height;
+      predictions[i] = vvas_inferprediction_new ();
+      predictions[i]->bbox = parent_bbox;
+    }
+    vvas_inferprediction_append (predictions[i], copy);
+    count++;
+  }
+
+  vvas_inferprediction_free (mosaic);
+  return count;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include <vvas_core/vvas_infer_prediction.h>
+
+/*
+ * Mosaic packing of small regions of interest. Several ROIs are tiled into
+ * one model sized input, separated by guard pixels, so that a detection model
+ * runs once for all of them. Detections are then handed back to the ROI whose
+ * tile holds their center, in ROI coordinates.
+ */
+
+/* Place of one ROI in a mosaic */
+typedef struct
+{
+  int mosaic;
+  cv::Rect rect;
+  /* placed size over ROI size, below 1 when ROI is larger than the input */
+  double scale;
+} vvas_mosaic_tile;
+
+int vvas_mosaic_pack (const std::vector < cv::Size > &rois, cv::Size input,
+    int guard, unsigned int max_tiles, std::vector < vvas_mosaic_tile > &tiles);
+
+unsigned int vvas_mosaic_unpack (VvasInferPrediction * mosaic, int index,
+    const std::vector < cv::Size > &rois,
+    const std::vector < vvas_mosaic_tile > &tiles,
+    VvasInferPrediction ** predictions);
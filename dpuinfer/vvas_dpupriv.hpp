@@ -21,6 +21,7 @@
 #ifndef DPU2_H
 #define DPU2_H
 
+#include <atomic>
 #include <vector>
 #include <stdio.h>
 #include <string>
@@ -30,6 +31,9 @@
 #include <vvas_core/vvas_video.h>
 #include <vvas_core/vvas_infer_prediction.h>
 
+#include "vvas_dpubatch.hpp"
+#include "vvas_dpustats.hpp"
+
 using namespace cv;
 using namespace std;
 
@@ -68,13 +72,25 @@ enum
   VVAS_XLABEL_FOUND = 4
 };
 
+/* Model loaded once and shared by instances of the same configuration
+ * created with share_model */
 typedef struct {
-  int test_started = 0;
-  unsigned long frames = 0;
-  unsigned long last_displayed_frame = 0;
-  long long timer_start;
-  long long last_displayed_time;
-}vvas_perf;
+  std::string key;
+  unsigned int ref_count;
+  bool ready;
+  vvas_dpumodel *model;
+  std::mutex run_lock;
+  std::string elfname;
+  bool cpuref;
+  labels *labelptr;
+  int max_labels;
+  unsigned int num_labels;
+  int labelflags;
+  int batch_size;
+  int model_width;
+  int model_height;
+  dpu_pp_config pp_config;
+} vvas_dpushared;
 
 typedef struct {
   vvas_dpumodel *model;
@@ -96,11 +112,43 @@ typedef struct {
   labels *labelptr;
   int labelflags;
   std::vector <std::string> filter_labels;
+  std::vector <uint64_t> filter_bitmap;
   int performance_test;
   bool float_feature;
-  vvas_perf pf;
+  /* steady clock time of the last performance log, in microseconds */
+  std::atomic < int64_t > perf_logged_us;
   VvasVideoFormat segoutfmt;
   int segoutfactor;
+  bool segoutrle;
+  bool cpuref;
+  vvas_dpubatch *batcher;
+  vvas_dpustats stats;
+  bool share_model;
+  vvas_dpushared *shared;
+  unsigned int mosaic_tiles;
+  int mosaic_guard;
+  std::vector <cv::Mat> mosaics;
+  int max_frames;
 } VvasDpuInferPrivate;
 
+int vvas_xclass_to_num (char *name);
+
+/* Called by models once results are back from the accelerator, time spent
+ * after this is accounted as prediction building */
+static inline void
+vvas_dpuinfer_mark_run (VvasDpuInferPrivate * kpriv)
+{
+  kpriv->stats.run_end = std::chrono::steady_clock::now ();
+}
+
+/* Returns true when objects of @label are dropped by filter_labels */
+static inline bool
+vvas_label_filtered (VvasDpuInferPrivate * kpriv, int label)
+{
+  if (kpriv->filter_labels.empty ())
+    return false;
+  return label < 0 || (size_t) label >= kpriv->filter_bitmap.size () * 64 ||
+      !((kpriv->filter_bitmap[label >> 6] >> (label & 63)) & 1);
+}
+
 #endif
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vvas_dpustats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+/**
+ *  @fn unsigned int vvas_dpustats_histogram::bucket (uint64_t us)
+ *  @param [in] us - Latency in microseconds
+ *  @return Index of the bucket holding @us
+ *  @brief Values up to 15 map to themselves, above that the 3 bits after the
+ *         most significant one select one of 8 buckets of its power of two.
+ */
+unsigned int
+vvas_dpustats_histogram::bucket (uint64_t us)
+{
+  if (us < 16)
+    return us;
+
+  unsigned int msb = 63 - __builtin_clzll (us);
+  return 16 + (msb - 4) * 8 + ((us >> (msb - 3)) & 7);
+}
+
+/**
+ *  @fn uint64_t vvas_dpustats_histogram::upper (unsigned int index)
+ *  @param [in] index - Index of a bucket
+ *  @return Largest value held by the bucket
+ */
+uint64_t
+vvas_dpustats_histogram::upper (unsigned int index)
+{
+  if (index < 16)
+    return index;
+
+  unsigned int msb = (index - 16) / 8 + 4;
+  uint64_t lower = (uint64_t) (8 + (index - 16) % 8) << (msb - 3);
+  return lower + (UINT64_C (1) << (msb - 3)) - 1;
+}
+
+void
+vvas_dpustats_histogram::reset (void)
+{
+  memset (buckets, 0, sizeof (buckets));
+  count = 0;
+  sum = 0;
+  min = 0;
+  max = 0;
+}
+
+void
+vvas_dpustats_histogram::record (uint64_t us)
+{
+  buckets[bucket (us)]++;
+  min = count ? std::min (min, us) : us;
+  max = std::max (max, us);
+  sum += us;
+  count++;
+}
+
+/**
+ *  @fn uint64_t vvas_dpustats_histogram::percentile (double p) const
+ *  @param [in] p - Percentile, between 0 and 1
+ *  @return Upper bound of the bucket holding the percentile, not more than
+ *          the largest recorded value
+ */
+uint64_t
+vvas_dpustats_histogram::percentile (double p) const
+{
+  uint64_t rank = std::max ((uint64_t) ceil (p * count), (uint64_t) 1);
+  uint64_t seen = 0;
+
+  for (auto i = 0u; i < num_buckets; i++) {
+    seen += buckets[i];
+    if (seen >= rank)
+      return std::min (upper (i), max);
+  }
+  return max;
+}
+
+void
+vvas_dpustats_histogram::get (VvasDpuInferLatency * latency) const
+{
+  latency->count = count;
+  latency->min_us = min;
+  latency->max_us = max;
+  latency->mean_us = count ? (double) sum / count : 0.0;
+  latency->p50_us = count ? percentile (0.50) : 0;
+  latency->p90_us = count ? percentile (0.90) : 0;
+  latency->p99_us = count ? percentile (0.99) : 0;
+}
+
+/**
+ *  @fn void vvas_dpustats::record (const time_point & begin,
+ *                                  const time_point & prepared,
+ *                                  const time_point & end, int num_frames,
+ *                                  int batch_size, uint64_t num_objects)
+ *  @param [in] begin - Time the batch was taken
+ *  @param [in] prepared - Time input frames were mapped and wrapped
+ *  @param [in] end - Time the model returned predictions
+ *  @param [in] num_frames - Frames in the batch
+ *  @param [in] batch_size - Batch size of the model
+ *  @param [in] num_objects - Predictions attached to the frames
+ *  @return none
+ *  @brief Accounts one batch. Time between @prepared and @end is split at
+ *         @run_end when the model set it, otherwise it is all run time.
+ */
+void
+vvas_dpustats::record (const time_point & begin, const time_point & prepared,
+    const time_point & end, int num_frames, int batch_size,
+    uint64_t num_objects)
+{
+  auto us =[](const time_point & from, const time_point & to) {
+    return (uint64_t) std::chrono::duration_cast < std::chrono::microseconds >
+        (to - from).count ();
+  };
+  time_point split = end;
+
+  if (run_end >= prepared && run_end <= end)
+    split = run_end;
+
+  std::lock_guard < std::mutex > guard (lock);
+  if (!batches)
+    start = begin;
+  stages[VVAS_DPUSTATS_PREPARE].record (us (begin, prepared));
+  stages[VVAS_DPUSTATS_RUN].record (us (prepared, split));
+  stages[VVAS_DPUSTATS_PREDICTIONS].record (us (split, end));
+  stages[VVAS_DPUSTATS_BATCH].record (us (begin, end));
+  batches++;
+  frames += num_frames;
+  objects += num_objects;
+  capacity += std::max (batch_size, num_frames);
+}
+
+/**
+ *  @fn void vvas_dpustats::get (VvasDpuInferStats * stats, bool reset)
+ *  @param [out] stats - Statistics since creation or last reset
+ *  @param [in] reset - Start counting again after reading
+ *  @return none
+ *  @brief Rates are computed over the time since the first batch.
+ */
+void
+vvas_dpustats::get (VvasDpuInferStats * stats, bool reset)
+{
+  std::lock_guard < std::mutex > guard (lock);
+  double elapsed = 0.0;
+
+  if (batches)
+    elapsed = std::chrono::duration < double >
+        (std::chrono::steady_clock::now () - start).count ();
+
+  stages[VVAS_DPUSTATS_PREPARE].get (&stats->prepare);
+  stages[VVAS_DPUSTATS_RUN].get (&stats->run);
+  stages[VVAS_DPUSTATS_PREDICTIONS].get (&stats->predictions);
+  stages[VVAS_DPUSTATS_BATCH].get (&stats->batch);
+  stats->batches = batches;
+  stats->frames = frames;
+  stats->objects = objects;
+  stats->batch_fill_ratio = capacity ? (double) frames / capacity : 0.0;
+  stats->elapsed_sec = elapsed;
+  stats->frames_per_sec = elapsed > 0.0 ? frames / elapsed : 0.0;
+  stats->objects_per_sec = elapsed > 0.0 ? objects / elapsed : 0.0;
+
+  if (reset) {
+    for (auto & stage:stages)
+      stage.reset ();
+    batches = 0;
+    frames = 0;
+    objects = 0;
+    capacity = 0;
+  }
+}
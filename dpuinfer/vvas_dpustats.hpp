@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+#include <vvas_core/vvas_dpuinfer.hpp>
+
+/*
+ * Latency histogram in microseconds. Values below 16 have a bucket each,
+ * larger values have 8 buckets per power of two, so percentiles are within
+ * 12.5% of the exact value while recording stays a few instructions.
+ */
+class vvas_dpustats_histogram
+{
+  static const unsigned int num_buckets = 16 + 60 * 8;
+  uint64_t buckets[num_buckets];
+  uint64_t count;
+  uint64_t sum;
+  uint64_t min;
+  uint64_t max;
+
+  static unsigned int bucket (uint64_t us);
+  static uint64_t upper (unsigned int index);
+  uint64_t percentile (double p) const;
+
+public:
+  vvas_dpustats_histogram () { reset (); }
+  void reset (void);
+  void record (uint64_t us);
+  void get (VvasDpuInferLatency * latency) const;
+};
+
+enum
+{
+  VVAS_DPUSTATS_PREPARE,
+  VVAS_DPUSTATS_RUN,
+  VVAS_DPUSTATS_PREDICTIONS,
+  VVAS_DPUSTATS_BATCH,
+  VVAS_DPUSTATS_NUM_STAGES
+};
+
+/* Statistics of the batches run by one instance */
+class vvas_dpustats
+{
+  std::mutex lock;
+  vvas_dpustats_histogram stages[VVAS_DPUSTATS_NUM_STAGES];
+  std::chrono::steady_clock::time_point start;
+  uint64_t batches = 0;
+  uint64_t frames = 0;
+  uint64_t objects = 0;
+  uint64_t capacity = 0;
+
+public:
+  typedef std::chrono::steady_clock::time_point time_point;
+
+  /* set by the model once the accelerator returned its results */
+  time_point run_end;
+
+  void record (const time_point & begin, const time_point & prepared,
+      const time_point & end, int num_frames, int batch_size,
+      uint64_t num_objects);
+  void get (VvasDpuInferStats * stats, bool reset);
+};
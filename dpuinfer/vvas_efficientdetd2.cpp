@@ -45,6 +45,7 @@ vvas_efficientdetd2::run (void * handle, std::vector < cv::Mat > &images,
   VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *)handle;
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter batch");
   auto results = model->run (images);
+  vvas_dpuinfer_mark_run (kpriv);
 
   char *pstr;                   /* prediction string */
 
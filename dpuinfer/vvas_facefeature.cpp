@@ -40,9 +40,11 @@ vvas_facefeature::run (void * handle, std::vector < cv::Mat > &images,
 
   if (kpriv->float_feature) {
     results_float = model->run (images);
+    vvas_dpuinfer_mark_run (kpriv);
     size = results_float.size ();
   } else {
     results_fixed = model->run_fixed (images);
+    vvas_dpuinfer_mark_run (kpriv);
     size = results_fixed.size ();
   }
 
@@ -35,6 +35,7 @@ vvas_platedetect::run (void * handle, std::vector < cv::Mat > &images,
   VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *)handle;
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter batch");
   auto results = model->run (images);
+  vvas_dpuinfer_mark_run (kpriv);
 
   char *pstr;                   /* prediction string */
 
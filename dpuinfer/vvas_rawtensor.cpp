@@ -251,6 +251,7 @@ vvas_rawtensor::run (void *handle, std::vector < cv::Mat > &images,
         output->get_tensor ()->get_data_size () /
         output->get_tensor ()->get_shape ()[0]);
   }
+  vvas_dpuinfer_mark_run (kpriv);
   auto output_tensor = output_tensor_buffers[0]->get_tensor ();
   auto obatch = output_tensor->get_shape ().at (0);
   auto size = output_tensor_buffers.size ();
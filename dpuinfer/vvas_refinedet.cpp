@@ -43,6 +43,7 @@ vvas_refinedet::run (void * handle, std::vector < cv::Mat > &images,
   VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *)handle;
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
   auto results = model->run (images);
+  vvas_dpuinfer_mark_run (kpriv);
   char *pstr;                   /* prediction string */
 
   if (kpriv->objs_detection_max > 0) {
@@ -89,6 +89,7 @@ vvas_reid::run (void * handle, std::vector < cv::Mat > &images,
 
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
   results = model->run (images);
+  vvas_dpuinfer_mark_run (kpriv);
 
   for (auto i = 0u; i < results.size (); i++) {
     VvasBoundingBox parent_bbox = { 0 };
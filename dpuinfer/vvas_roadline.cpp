@@ -36,6 +36,7 @@ vvas_roadline::run (void * handle, std::vector < cv::Mat > &images,
   VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *)handle;
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter batch");
   auto results = model->run (images);
+  vvas_dpuinfer_mark_run (kpriv);
 
   for (auto i = 0u; i < results.size (); i++) {
     VvasBoundingBox parent_bbox = { 0 };
@@ -17,6 +17,155 @@
 
 #include "vvas_segmentation.hpp"
 
+#include <atomic>
+
+/* Data of a mask starts this many bytes after its header, cache aligned */
+#define VVAS_SEGPOOL_HEADER 64
+/* Idle masks kept for reuse */
+#define VVAS_SEGPOOL_MAX_IDLE 16
+
+class vvas_segpool;
+
+/* Header in front of the data of every mask */
+typedef struct
+{
+  vvas_segpool *pool;
+  std::atomic < int > ref_count;
+  size_t capacity;
+} vvas_segpool_buf;
+
+/*
+ * Reuses mask buffers of frames already consumed downstream. Masks are
+ * reference counted, copies of a prediction share the data of the mask.
+ * The pool is freed once its model is closed and every mask came back.
+ */
+class vvas_segpool
+{
+  std::mutex lock;
+  std::vector < vvas_segpool_buf * > idle;
+  unsigned int refs = 1;
+  bool closed = false;
+
+  void unref_locked (std::unique_lock < std::mutex > & guard);
+
+public:
+  void *alloc (size_t size);
+  void close (void);
+  static void ref (void *data);
+  static void unref (void *data);
+};
+
+static inline vvas_segpool_buf *
+vvas_segpool_header (void *data)
+{
+  return (vvas_segpool_buf *) ((uint8_t *) data - VVAS_SEGPOOL_HEADER);
+}
+
+/**
+ *  @fn void *vvas_segpool::alloc (size_t size)
+ *  @param [in] size - Bytes needed
+ *  @return Data of a mask with one reference, NULL on failure
+ *  @brief Takes an idle mask large enough or allocates a new one.
+ */
+void *
+vvas_segpool::alloc (size_t size)
+{
+  vvas_segpool_buf *buf = NULL;
+  void *mem;
+
+  {
+    std::lock_guard < std::mutex > guard (lock);
+    for (auto it = idle.begin (); it != idle.end (); it++) {
+      if ((*it)->capacity >= size) {
+        buf = *it;
+        idle.erase (it);
+        break;
+      }
+    }
+    refs++;
+  }
+
+  if (!buf) {
+    if (posix_memalign (&mem, VVAS_SEGPOOL_HEADER, VVAS_SEGPOOL_HEADER + size)) {
+      std::unique_lock < std::mutex > guard (lock);
+      unref_locked (guard);
+      return NULL;
+    }
+    buf = new (mem) vvas_segpool_buf;
+    buf->pool = this;
+    buf->capacity = size;
+  }
+  buf->ref_count = 1;
+  return (uint8_t *) buf + VVAS_SEGPOOL_HEADER;
+}
+
+/**
+ *  @fn void vvas_segpool::unref_locked (std::unique_lock < std::mutex > & guard)
+ *  @param [in] guard - Holds the pool lock, released on return
+ *  @return none
+ *  @brief Drops one reference to the pool, last one frees it.
+ */
+void
+vvas_segpool::unref_locked (std::unique_lock < std::mutex > & guard)
+{
+  bool last = (--refs == 0);
+
+  guard.unlock ();
+  if (last)
+    delete this;
+}
+
+/**
+ *  @fn void vvas_segpool::close (void)
+ *  @return none
+ *  @brief Called by the model, frees idle masks and the reference of the
+ *         model. Masks still in use are freed when they come back.
+ */
+void
+vvas_segpool::close (void)
+{
+  std::unique_lock < std::mutex > guard (lock);
+
+  closed = true;
+  for (auto buf:idle) {
+    buf->~vvas_segpool_buf ();
+    free (buf);
+  }
+  idle.clear ();
+  unref_locked (guard);
+}
+
+void
+vvas_segpool::ref (void *data)
+{
+  vvas_segpool_header (data)->ref_count++;
+}
+
+/**
+ *  @fn void vvas_segpool::unref (void *data)
+ *  @param [in] data - Data of a mask returned by @alloc
+ *  @return none
+ *  @brief Drops one reference to the mask, last one gives it back to its pool.
+ */
+void
+vvas_segpool::unref (void *data)
+{
+  vvas_segpool_buf *buf = vvas_segpool_header (data);
+  vvas_segpool *pool = buf->pool;
+
+  if (--buf->ref_count)
+    return;
+
+  std::unique_lock < std::mutex > guard (pool->lock);
+  if (!pool->closed && pool->idle.size () < VVAS_SEGPOOL_MAX_IDLE) {
+    pool->idle.push_back (buf);
+  } else {
+    buf->~vvas_segpool_buf ();
+    free (buf);
+  }
+  pool->unref_locked (guard);
+}
+
 bool
 seg_free (void *ptr)
 {
@@ -25,7 +174,7 @@ seg_free (void *ptr)
     return false;
 
   if (seg->data)
-    free (seg->data);
+    vvas_segpool::unref (seg->data);
   seg->data = NULL;
 
   return true;
@@ -34,7 +183,7 @@ seg_free (void *ptr)
 bool
 seg_copy (const void *frm, void *to)
 {
-  int i, size;
+  int i;
   Segmentation *frm_seg = (Segmentation *) frm;
   Segmentation *to_seg = (Segmentation *) to;
   int sizeoffmt = sizeof (frm_seg->fmt) / sizeof (frm_seg->fmt[0]);
@@ -50,24 +199,10 @@ seg_copy (const void *frm, void *to)
   for (i = 0; i < sizeoffmt; i++)
     to_seg->fmt[i] = frm_seg->fmt[i];
 
-  if (!strcmp (to_seg->fmt, "BGR"))
-    size = (to_seg->width * to_seg->height * 3);
-  else
-    size = (to_seg->width * to_seg->height);
-
-  to_seg->data = NULL;
-
-  if((NULL != frm_seg->data) &&
-     (0 != size)) {
-    
-     void *mem = NULL;
-     mem = malloc(size);
-
-     if(mem) {
-       memcpy(mem, frm_seg->data, size);
-       to_seg->data = mem;
-     }
-  }
+  /* masks are read only, copies share the data */
+  to_seg->data = frm_seg->data;
+  if (to_seg->data)
+    vvas_segpool::ref (to_seg->data);
   return true;
 }
 
@@ -79,6 +214,70 @@ vvas_segmentation::vvas_segmentation (void * handle,
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
 
   model = vitis::ai::Segmentation::create (model_name, need_preprocess);
+  pool = new vvas_segpool;
+}
+
+/**
+ *  @fn void *vvas_segmentation::map_gray8 (VvasDpuInferPrivate * kpriv,
+ *                                          const cv::Mat & mask)
+ *  @param [in] kpriv - Private structure of the instance
+ *  @param [in] mask - Class index of each pixel
+ *  @return Data of a GRAY8 mask from the pool, NULL on failure
+ *  @brief Scales class indices by segoutfactor through a lookup table,
+ *         written once into the pooled mask.
+ */
+void *
+vvas_segmentation::map_gray8 (VvasDpuInferPrivate * kpriv,
+    const cv::Mat & mask)
+{
+  void *data = pool->alloc (mask.total ());
+  if (!data)
+    return NULL;
+
+  cv::Mat out (mask.rows, mask.cols, CV_8UC1, data);
+  if (kpriv->segoutfactor == 0 || kpriv->segoutfactor == 1) {
+    mask.copyTo (out);
+    return data;
+  }
+
+  if (lut_factor != kpriv->segoutfactor) {
+    for (int c = 0; c < 256; c++)
+      lut[c] = (uchar) (c * kpriv->segoutfactor);
+    lut_factor = kpriv->segoutfactor;
+  }
+  cv::LUT (mask, cv::Mat (1, 256, CV_8UC1, lut), out);
+  return data;
+}
+
+/**
+ *  @fn void *vvas_segmentation::encode_rle (const cv::Mat & mask)
+ *  @param [in] mask - Class index of each pixel
+ *  @return Data of a RLE mask from the pool, NULL on failure
+ *  @brief Each run is a uint32_t with the class index in the 8 most
+ *         significant bits and the length in the others. Runs do not span
+ *         rows, they cover width * height pixels in raster order.
+ */
+void *
+vvas_segmentation::encode_rle (const cv::Mat & mask)
+{
+  runs.clear ();
+  for (int y = 0; y < mask.rows; y++) {
+    const uchar *row = mask.ptr < uchar > (y);
+    int x = 0;
+
+    while (x < mask.cols) {
+      uchar value = row[x];
+      int start = x;
+      while (++x < mask.cols && row[x] == value);
+      runs.push_back (((uint32_t) value << 24) | (uint32_t) (x - start));
+    }
+  }
+
+  size_t size = runs.size () * sizeof (uint32_t);
+  void *data = pool->alloc (size);
+  if (data)
+    memcpy (data, runs.data (), size);
+  return data;
 }
 
 int
@@ -89,19 +288,12 @@ vvas_segmentation::run (void * handle, std::vector < cv::Mat > &images,
   std::vector < vitis::ai::SegmentationResult > results;
 
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
-  if (kpriv->segoutfmt == VVAS_VIDEO_FORMAT_BGR)
+  if (kpriv->segoutfmt == VVAS_VIDEO_FORMAT_BGR) {
     results = model->run_8UC3 (images);
-  else if (kpriv->segoutfmt == VVAS_VIDEO_FORMAT_GRAY8) {
+    vvas_dpuinfer_mark_run (kpriv);
+  } else if (kpriv->segoutfmt == VVAS_VIDEO_FORMAT_GRAY8) {
     results = model->run_8UC1 (images);
-    for (auto i = 0u; i < results.size (); i++) {
-      if (!(kpriv->segoutfactor == 0 || kpriv->segoutfactor == 1)) {
-        for (auto y = 0; y < results[i].segmentation.rows; y++) {
-          for (auto x = 0; x < results[i].segmentation.cols; x++) {
-            results[i].segmentation.at < uchar > (y, x) *= kpriv->segoutfactor;
-          }
-        }
-      }
-    }
+    vvas_dpuinfer_mark_run (kpriv);
   } else {
     LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level, "unsupported fmt");
     return false;
@@ -109,8 +301,9 @@ vvas_segmentation::run (void * handle, std::vector < cv::Mat > &images,
   for (auto i = 0u; i < results.size (); i++) {
     VvasBoundingBox parent_bbox = { 0 };
     VvasInferPrediction *parent_predict = NULL;
-    int cols = results[i].segmentation.cols;
-    int rows = results[i].segmentation.rows;
+    const cv::Mat & mask = results[i].segmentation;
+    int cols = mask.cols;
+    int rows = mask.rows;
 
     parent_predict = predictions[i];
 
@@ -123,7 +316,6 @@ vvas_segmentation::run (void * handle, std::vector < cv::Mat > &images,
     }
 
     {
-      int size;
       Segmentation *seg;
       VvasInferPrediction *predict;
       predict = vvas_inferprediction_new ();
@@ -132,30 +324,33 @@ vvas_segmentation::run (void * handle, std::vector < cv::Mat > &images,
       seg = &predict->segmentation;
       seg->width = cols;
       seg->height = rows;
-      kpriv->segoutfmt == VVAS_VIDEO_FORMAT_BGR ? strcpy (seg->fmt,
-          "BGR") : strcpy (seg->fmt, "GRAY8");
-      if (!strcmp (seg->fmt, "BGR"))
-        size = (seg->width * seg->height * 3);
-      else
-        size = (seg->width * seg->height);
       seg->copy = seg_copy;
       seg->free = seg_free;
       seg->data = NULL;
 
-     if((NULL != results[i].segmentation.data) &&
-        (0 != size)) {
-      
-        void *mem = NULL;
-        mem = malloc(size);
+      if (kpriv->segoutrle)
+        strcpy (seg->fmt, "RLE");
+      else if (kpriv->segoutfmt == VVAS_VIDEO_FORMAT_BGR)
+        strcpy (seg->fmt, "BGR");
+      else
+        strcpy (seg->fmt, "GRAY8");
 
-        if(mem) {
-          memcpy(mem, results[i].segmentation.data,size);
-          seg->data = mem;
+      /* single write of the mask into a pooled buffer */
+      if (mask.data && mask.total ()) {
+        if (kpriv->segoutrle) {
+          seg->data = encode_rle (mask);
+        } else if (kpriv->segoutfmt == VVAS_VIDEO_FORMAT_BGR) {
+          seg->data = pool->alloc (mask.total () * 3);
+          if (seg->data) {
+            cv::Mat out (rows, cols, CV_8UC3, seg->data);
+            mask.copyTo (out);
+          }
+        } else {
+          seg->data = map_gray8 (kpriv, mask);
         }
       }
-      else {
+      if (!seg->data)
         LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "Failed to copy");
-      }
 
       /* add class and name in prediction node */
       predict->model_class = (VvasClass) kpriv->modelclass;
@@ -209,4 +404,7 @@ vvas_segmentation::close (void)
 vvas_segmentation::~vvas_segmentation ()
 {
   LOG_MESSAGE (LOG_LEVEL_DEBUG, log_level, "enter");
+  /* masks still referenced by predictions keep the pool alive */
+  if (pool)
+    pool->close ();
 }
@@ -24,11 +24,22 @@
 using namespace std;
 using namespace cv;
 
+class vvas_segpool;
+
 class vvas_segmentation:public vvas_dpumodel
 {
 
   int log_level = 0;
   std::unique_ptr < vitis::ai::Segmentation > model;
+  /* masks handed out in predictions, outlives the model while referenced */
+  vvas_segpool *pool = NULL;
+  /* GRAY8 output of each class index */
+  uchar lut[256];
+  int lut_factor = -1;
+  std::vector < uint32_t > runs;
+
+  void *map_gray8 (VvasDpuInferPrivate * kpriv, const cv::Mat & mask);
+  void *encode_rle (const cv::Mat & mask);
 
 public:
 
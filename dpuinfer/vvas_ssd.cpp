@@ -50,6 +50,7 @@ vvas_ssd::run (void * handle, std::vector < cv::Mat > &images,
   VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *)handle;
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter");
   auto results = model->run (images);
+  vvas_dpuinfer_mark_run (kpriv);
 
   labels *lptr;
   char *pstr;                   /* prediction string */
@@ -52,6 +52,7 @@ vvas_yolov3::run (void *handle, std::vector < cv::Mat > &images,
   VvasDpuInferPrivate *kpriv = (VvasDpuInferPrivate *)handle;
   LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level, "enter batch");
   auto results = model->run (images);
+  vvas_dpuinfer_mark_run (kpriv);
 
   labels *lptr;
   char *pstr;                   /* prediction string */
@@ -92,23 +93,9 @@ vvas_yolov3::run (void *handle, std::vector < cv::Mat > &images,
 
     for (auto & box:results[i].bboxes) {
 
+        if (vvas_label_filtered (kpriv, box.label))
+          continue;
         lptr = kpriv->labelptr + box.label;
-        if (kpriv->filter_labels.size ()) {
-          bool found_label = false;
-
-          for (unsigned int n = 0; n < kpriv->filter_labels.size (); n++) {
-            const char *filter_label = kpriv->filter_labels[n].c_str ();
-            const char *current_label = lptr->display_name.c_str ();
-            if (!strncmp (current_label, filter_label, strlen (filter_label))) {
-              LOG_MESSAGE (LOG_LEVEL_DEBUG, kpriv->log_level,
-                  "current label %s is in filter_label list", current_label);
-              found_label = true;
-            }
-          }
-
-          if (!found_label)
-            continue;
-        }
 
         if (!parent_predict) {
           parent_bbox.x = parent_bbox.y = 0;
@@ -20,6 +20,9 @@
  * inference metadata as per the different resolution than the original resolution.
  * The infer meta data to be scaled and attached is decided based on matching the
  * PTS of the source and the destination frames.
+ * A single handle can serve multiple streams, each identified by a stream ID.
+ * Submission and lookup may run on different threads, lookups do not take any
+ * lock.
  */
 
 #ifndef __VVAS_METAAFFIXER_H__
@@ -30,6 +33,12 @@
 
 typedef void  VvasMetaAffixer;
 
+/**
+ * typedef VvasMetaAffixerSharedMeta - Holds reference to scaled metadata
+ *                                     shared between lookups.
+ */
+typedef struct _VvasMetaAffixerSharedMeta VvasMetaAffixerSharedMeta;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -47,6 +56,26 @@ typedef enum  {
   VVAS_METAAFFIXER_NULL_VALUE = 0x03
 }VvasMetaAffixerRespCode;
 
+/**
+ * enum VvasMetaAffixerInterpolation - This enum represents how metadata is
+ *                                     derived for frames between infer frames.
+ * @VVAS_METAAFFIXER_INTERPOLATION_NONE: Metadata of the infer frame with
+ *                                       maximum overlap is used.
+ * @VVAS_METAAFFIXER_INTERPOLATION_LINEAR: Boxes of objects found in both infer
+ *                                         frames around the frame PTS, matched
+ *                                         by tracker ID or IoU, are linearly
+ *                                         interpolated. If no infer frame is
+ *                                         available after the frame yet, boxes
+ *                                         are extrapolated from the last two
+ *                                         infer frames. Falls back to
+ *                                         @VVAS_METAAFFIXER_INTERPOLATION_NONE
+ *                                         when no such pair exists.
+ */
+typedef enum {
+  VVAS_METAAFFIXER_INTERPOLATION_NONE = 0,
+  VVAS_METAAFFIXER_INTERPOLATION_LINEAR
+}VvasMetaAffixerInterpolation;
+
 
 /**
  *  vvas_metaaffixer_create () - Creates metaaffixer handle 
@@ -63,6 +92,24 @@ typedef enum  {
                                           uint32_t infer_queue_size, 
                                           VvasLogLevel loglevel);
 
+/**
+ *  vvas_metaaffixer_create_multistream () - Creates metaaffixer handle for multiple streams
+ *  @inferframe_dur: Duration of the infer frame.
+ *  @infer_queue_size: Represents Max queue size of the infer frame per stream
+ *  @max_streams: Maximum number of streams, valid stream IDs are 0 to @max_streams - 1
+ *  @loglevel: Indicates log level
+ *  Context: This function will allocate internal resources and
+ *          return the handle. Infer frames of each stream are queued and
+ *          evicted independently.
+ *  Return:
+ *  * On Sucess returns handle of Metaaffixer handle
+ *  * On Failure returns NULL
+ */
+VvasMetaAffixer* vvas_metaaffixer_create_multistream(uint64_t inferframe_dur,
+                                                     uint32_t infer_queue_size,
+                                                     uint32_t max_streams,
+                                                     VvasLogLevel loglevel);
+
 /**
  *  vvas_metaaffixer_destroy() - Destroys metaaffixer handle
  *  @handle: MetaAffixer handle to be destroyed 
@@ -72,7 +119,25 @@ typedef enum  {
 void vvas_metaaffixer_destroy(VvasMetaAffixer *handle);
 
 /**
- *  vvas_metaaffixer_get_frame_meta() - Provides scaled metadata. 
+ *  vvas_metaaffixer_set_interpolation() - Configures box interpolation between infer frames.
+ *  @handle: Address of context handle @ref VvasMetaAffixer
+ *  @mode: Interpolation mode, applies to lookups with sync_pts set.
+ *  @iou_threshold: Minimum IoU, in range 0 to 1, for matching objects which
+ *                  do not have a tracker ID.
+ *
+ *  Context: This function is to be called before submitting infer metadata.
+ *           Interpolated metadata is specific to each frame and is not shared
+ *           by vvas_metaaffixer_get_shared_frame_meta().
+ *  Return:
+ *  * On Success returns VVAS_RET_SUCCESS
+ *  * On Failure returns VVAS_RET_INVALID_ARGS
+ */
+VvasReturnType vvas_metaaffixer_set_interpolation(VvasMetaAffixer *handle,
+                                                  VvasMetaAffixerInterpolation mode,
+                                                  float iou_threshold);
+
+/**
+ *  vvas_metaaffixer_get_frame_meta() - Provides scaled metadata of stream 0.
  *  @handle: Address of context handle @ref VvasMetaAffixer
  *  @sync_pts: if FALSE then last received infer meta data
  *                               is used for scaling. Else reference infer metadata is
@@ -82,7 +147,10 @@ void vvas_metaaffixer_destroy(VvasMetaAffixer *handle);
  *  @respcode: Metaaffixer response code.
  *  @ScaledMetaData: Scaled meta data is updated here.
  *
- *  Context: This function returns scaled metadata based on input frame info
+ *  Context: This function returns scaled metadata based on input frame info.
+ *           Input frames of same resolution matching the same infer frame
+ *           get the same tree, which is read only. Release it with
+ *           vvas_inferprediction_free(), or copy it before modifying it.
  *  Return: 
  *  * On Success returns VVAS_SUCCESS
  *  * On Failure returns VVAS_RET_ERROR 
@@ -93,9 +161,84 @@ void vvas_metaaffixer_destroy(VvasMetaAffixer *handle);
                                                 VvasMetadata *metadata,
                                                 VvasMetaAffixerRespCode *respcode,
                                                 VvasInferPrediction **ScaledMetaData);
+
+/**
+ *  vvas_metaaffixer_get_stream_frame_meta() - Provides scaled metadata of a stream.
+ *  @handle: Address of context handle @ref VvasMetaAffixer
+ *  @stream_id: ID of the stream input frame belongs to
+ *  @sync_pts: if FALSE then last received infer meta data
+ *                               is used for scaling. Else reference infer metadata is
+ *                               chosen based on PTS of input frame.
+ *  @vinfo: Input Frame Information
+ *  @metadata: Metadata of input frame
+ *  @respcode: Metaaffixer response code.
+ *  @ScaledMetaData: Scaled meta data is updated here.
+ *
+ *  Context: This function returns scaled metadata based on input frame info.
+ *           This function does not take any lock and can be called
+ *           concurrently with vvas_metaaffixer_submit_stream_infer_meta().
+ *           Returned tree is shared as for vvas_metaaffixer_get_frame_meta().
+ *  Return:
+ *  * On Success returns VVAS_SUCCESS
+ *  * On Failure returns VVAS_RET_ERROR
+ */
+VvasReturnType vvas_metaaffixer_get_stream_frame_meta(VvasMetaAffixer *handle,
+                                                      uint32_t stream_id,
+                                                      bool sync_pts,
+                                                      VvasVideoInfo *vinfo,
+                                                      VvasMetadata *metadata,
+                                                      VvasMetaAffixerRespCode *respcode,
+                                                      VvasInferPrediction **ScaledMetaData);
  
 /**
- *  vvas_metaaffixer_submit_infer_meta() - Submit infer metadata.  
+ *  vvas_metaaffixer_get_shared_frame_meta() - Provides shared scaled metadata of a stream.
+ *  @handle: Address of context handle @ref VvasMetaAffixer
+ *  @stream_id: ID of the stream input frame belongs to
+ *  @sync_pts: if FALSE then last received infer meta data
+ *                               is used for scaling. Else reference infer metadata is
+ *                               chosen based on PTS of input frame.
+ *  @vinfo: Input Frame Information
+ *  @metadata: Metadata of input frame
+ *  @respcode: Metaaffixer response code.
+ *  @SharedMetaData: Reference to scaled meta data is updated here.
+ *
+ *  Context: Unlike vvas_metaaffixer_get_stream_frame_meta(), scaled metadata is
+ *           cached per infer frame and destination resolution. All input frames
+ *           matching the same infer frame at same resolution get a reference
+ *           to the same read only tree, so no copy is made after the first one.
+ *           Use vvas_metaaffixer_shared_meta_get() to access the metadata and
+ *           release it with vvas_metaaffixer_shared_meta_unref().
+ *  Return:
+ *  * On Success returns VVAS_SUCCESS
+ *  * On Failure returns VVAS_RET_ERROR
+ */
+VvasReturnType vvas_metaaffixer_get_shared_frame_meta(VvasMetaAffixer *handle,
+                                                      uint32_t stream_id,
+                                                      bool sync_pts,
+                                                      VvasVideoInfo *vinfo,
+                                                      VvasMetadata *metadata,
+                                                      VvasMetaAffixerRespCode *respcode,
+                                                      VvasMetaAffixerSharedMeta **SharedMetaData);
+
+/**
+ *  vvas_metaaffixer_shared_meta_get() - Gets scaled metadata from a shared reference.
+ *  @shared: Reference returned by vvas_metaaffixer_get_shared_frame_meta()
+ *
+ *  Context: Returned metadata is read only and valid until @shared is released.
+ *  Return: Scaled metadata.
+ */
+const VvasInferPrediction* vvas_metaaffixer_shared_meta_get(VvasMetaAffixerSharedMeta *shared);
+
+/**
+ *  vvas_metaaffixer_shared_meta_unref() - Releases a shared scaled metadata reference.
+ *  @shared: Reference returned by vvas_metaaffixer_get_shared_frame_meta()
+ *
+ *  Return: None
+ */
+void vvas_metaaffixer_shared_meta_unref(VvasMetaAffixerSharedMeta *shared);
+
+/**
+ *  vvas_metaaffixer_submit_infer_meta() - Submit infer metadata of stream 0.
  *  @handle: Context handle @ref VvasMetaAffixer
  *  @vinfo: Address of frame info
  *  @metadata: Metadata of frame
@@ -111,6 +254,27 @@ VvasReturnType vvas_metaaffixer_submit_infer_meta(VvasMetaAffixer *handle,
                                                   VvasMetadata *metadata,      
                                                   VvasInferPrediction *infer);
 
+/**
+ *  vvas_metaaffixer_submit_stream_infer_meta() - Submit infer metadata of a stream.
+ *  @handle: Context handle @ref VvasMetaAffixer
+ *  @stream_id: ID of the stream infer metadata belongs to
+ *  @vinfo: Address of frame info
+ *  @metadata: Metadata of frame
+ *  @infer: Infer metadata associated with infer frame
+ *
+ *  Context: This function will submit meta data information. Submissions to
+ *           the same stream are serialised, different streams do not block
+ *           each other.
+ *  Return:
+ *  * On Success returns VVAS_RET_SUCCESS
+ *  * On Failure returns VVAS_RET_ERROR
+ */
+VvasReturnType vvas_metaaffixer_submit_stream_infer_meta(VvasMetaAffixer *handle,
+                                                         uint32_t stream_id,
+                                                         VvasVideoInfo *vinfo,
+                                                         VvasMetadata *metadata,
+                                                         VvasInferPrediction *infer);
+
 #ifdef __cplusplus
 }
 #endif
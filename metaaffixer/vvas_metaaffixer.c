@@ -30,16 +30,43 @@
 #define LOG(...)    (LOG_MESSAGE(LOG_LEVEL_INFO, LOG_LEVEL_INFO,  __VA_ARGS__))
 #define INFER_META_BATCH_SIZE       (8u)
 
+#define VVAS_METAAFFIXER_NUM_EPOCHS (3u)
+#define VVAS_METAAFFIXER_MAX_SCALED_CACHE (4u)
+
+typedef struct _VvasMetaAffixerMapData VvasMetaAffixerMapData;
+
+/** @struct VvasMetaAffixerStream
+ *  @brief Per stream infer frame data.
+ *
+ *  Writers of a stream are serialised with @wlock. Readers never take a lock,
+ *  they read the ring under the @seq seqlock and pin an epoch while they
+ *  dereference infer frame data, so evicted entries are only freed once no
+ *  reader can hold a reference to them.
+ */
+typedef struct
+{
+  _Atomic (VvasMetaAffixerMapData *) * ring;    /* infer frame data sorted on PTS */
+  atomic_uint head;
+  atomic_uint count;
+  _Atomic (VvasMetaAffixerMapData *) cur;
+  atomic_uint seq;
+  atomic_uint epoch;
+  atomic_int active[VVAS_METAAFFIXER_NUM_EPOCHS];
+  VvasMetaAffixerMapData *retired[VVAS_METAAFFIXER_NUM_EPOCHS];
+  VvasMutex wlock;
+} VvasMetaAffixerStream;
+
 /** @struct VvasMetaAffixerInfo
  *  @brief Meta Affixer internal structure.           
  */
 typedef struct
 {
-  VvasHashTable *map;           /* for storing infer frame data */
-  uint64_t *cur_pts;
-  uint64_t *near_pts;
+  _Atomic (VvasMetaAffixerStream *) * streams;  /* indexed on stream ID */
+  uint32_t max_streams;
   uint64_t inferframe_dur;
   uint32_t max_infer_size;
+  VvasMetaAffixerInterpolation interpolation;
+  float interp_iou_threshold;
   VvasLogLevel loglevel;
 } VvasMetaAffixerInfo;
 
@@ -56,10 +83,27 @@ typedef struct
   double vfactor;
 } VvasInferScaleFactor;
 
+/** @struct VvasMetaAffixerSearch
+ *  @brief  contains input and result of a search in infer frame ring.
+ */
+typedef struct
+{
+  VvasMetadata *metadata;
+  VvasMetaAffixerMapData *frames[2];
+} VvasMetaAffixerSearch;
+
+/**
+ *  @brief Function searching infer frame ring with given head and count,
+ *         returns FALSE if the ring was modified under it.
+ */
+typedef bool (*VvasMetaAffixerSearchFunc) (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerStream * stream, uint32_t head, uint32_t count,
+    VvasMetaAffixerSearch * search);
+
 /** @struct VvasMetaAffixerMapData
  *  @brief  contains information related to infer & frame info. 
  */
-typedef struct
+struct _VvasMetaAffixerMapData
 {
   int32_t width;
   int32_t height;
@@ -67,181 +111,593 @@ typedef struct
   uint64_t dur;
   VvasInferPrediction *meta;
   uint64_t seq_id;
-} VvasMetaAffixerMapData;
+  VvasMetaAffixerMapData *next; /* link in retired list */
+  _Atomic (VvasMetaAffixerSharedMeta *) scaled[VVAS_METAAFFIXER_MAX_SCALED_CACHE];
+};
+
+/** @struct VvasMetaAffixerSharedMeta
+ *  @brief  scaled metadata shared between lookups.
+ */
+struct _VvasMetaAffixerSharedMeta
+{
+  atomic_int ref_count;
+  int32_t width;
+  int32_t height;
+  VvasInferPrediction *meta;
+};
 
 static void
 get_sequence_id (VvasMetaAffixerMapData * map)
 {
-  static uint64_t _id = 0ul;
-  static VvasMutex _id_mutex;
+  static atomic_uint_fast64_t _id = 0ul;
 
-  vvas_mutex_lock (&_id_mutex);
-  map->seq_id = _id++;
-  vvas_mutex_unlock (&_id_mutex);
+  map->seq_id = atomic_fetch_add (&_id, 1);
 
   return;
 }
 
 /**
- *  @fn  bool vvas_metaaffixer_mapdata_remove_foreach (void * key, void * value, 
- *                                                             void * user_data)
- *  @param [in] key -  Key associated with the entry. 
- *  @param [in] value - Value associated with the key value
- *  @param [in] user_data - User data to be passed, can be NULL. 
- *  
- *  @return TRUE - entry will be removed and move to next entry.
- *          FALSE - will go to next element in table until end
- *          
- *  @brief This function is used to copy node data while performing deep-copy 
- *         of a tree node.
+ *  @fn  void vvas_metaaffixer_mapdata_free (VvasMetaAffixerMapData * mp)
+ *  @param [in] mp - Infer frame data to be freed.
+ *  @return None
+ *  @brief This function frees infer frame data, its metadata and drops
+ *         references to its cached scaled metadata.
  */
-static bool
-vvas_metaaffixer_mapdata_remove_foreach (void *key, void *value,
-    void *user_data)
+static void
+vvas_metaaffixer_mapdata_free (VvasMetaAffixerMapData * mp)
 {
-  VvasMetaAffixerMapData *mp = (VvasMetaAffixerMapData *) value;
+  uint32_t i;
+
   if (NULL != mp) {
+    for (i = 0; i < VVAS_METAAFFIXER_MAX_SCALED_CACHE; i++) {
+      vvas_metaaffixer_shared_meta_unref (atomic_load (&mp->scaled[i]));
+    }
     vvas_inferprediction_free (mp->meta);
     free (mp);
   }
-  return TRUE;
 }
 
 /**
- *  @fn  void* vvas_metaaffixer_node_scale(const void  *node, void *data)
- *  
- *  @param [in] node - Address of the node.
- *  @param [in] data - Additional data.
- *  
- *  @return On Success returns address of the new node.
- *          On Failure returns NULL 
- *          
- *  @brief This function will scale each node cored on scaling factor.
+ *  @fn  uint32_t vvas_metaaffixer_reader_enter (VvasMetaAffixerStream * stream)
+ *  @param [in] stream - Stream to be read.
+ *  @return Epoch pinned by the reader.
+ *  @brief This function pins current epoch of the stream, infer frame data
+ *         read after this is not freed until vvas_metaaffixer_reader_exit.
  */
-static void *
-vvas_metaaffixer_node_scale (const void *node, void *data)
+static uint32_t
+vvas_metaaffixer_reader_enter (VvasMetaAffixerStream * stream)
 {
-  VvasInferPrediction *dmeta = NULL;
-  VvasInferPrediction *smeta = (VvasInferPrediction *) node;
-  VvasInferScaleFactor *scl_factor = (VvasInferScaleFactor *) data;
+  uint32_t e;
 
-  if ((NULL != smeta) && (NULL != scl_factor)) {
-    dmeta = vvas_inferprediction_node_copy (smeta, NULL);
-    dmeta->bbox.x = smeta->bbox.x * scl_factor->hfactor;
-    dmeta->bbox.y = smeta->bbox.y * scl_factor->vfactor;
-    dmeta->bbox.width = nearbyintf (smeta->bbox.width * scl_factor->hfactor);
-    dmeta->bbox.height = nearbyintf (smeta->bbox.height * scl_factor->vfactor);
+  while (1) {
+    e = atomic_load (&stream->epoch);
+    atomic_fetch_add (&stream->active[e % VVAS_METAAFFIXER_NUM_EPOCHS], 1);
+    if (atomic_load (&stream->epoch) == e) {
+      break;
+    }
+    /* epoch advanced meanwhile, pin the new one */
+    atomic_fetch_sub (&stream->active[e % VVAS_METAAFFIXER_NUM_EPOCHS], 1);
   }
+  return e;
+}
 
-  return dmeta;
+/**
+ *  @fn  void vvas_metaaffixer_reader_exit (VvasMetaAffixerStream * stream,
+ *                                         uint32_t epoch)
+ *  @param [in] stream - Stream which was read.
+ *  @param [in] epoch - Epoch returned by vvas_metaaffixer_reader_enter.
+ *  @return None
+ *  @brief This function unpins epoch pinned by the reader.
+ */
+static void
+vvas_metaaffixer_reader_exit (VvasMetaAffixerStream * stream, uint32_t epoch)
+{
+  atomic_fetch_sub (&stream->active[epoch % VVAS_METAAFFIXER_NUM_EPOCHS], 1);
 }
 
 /**
- *  @fn void  vvas_metaaffixer_get_inferframe_pts (VvasMetaAffixerInfo *pHandle, 
- *                                                VvasVideoInfo *vinfo
- *                                                VvasMetadata *metadata)
- *  @param [in] handle - handle for metaaffixer instance
- *  @param [in] vinfo  - address of input frame info
- *  @param [in] metadata - address of input frame metadata
- *  @return none 
- *  @brief  this function will find nearest pts from infer frames.  
+ *  @fn  void vvas_metaaffixer_retire (VvasMetaAffixerStream * stream,
+ *                                    VvasMetaAffixerMapData * mp)
+ *  @param [in] stream - Stream owning the infer frame data.
+ *  @param [in] mp - Infer frame data already unlinked from the ring.
+ *  @return None
+ *  @brief This function defers freeing of @mp until readers which could have
+ *         seen it are gone. Data retired in epoch E is freed when epoch
+ *         advances to E + 2, epoch only advances when no reader is left in
+ *         the previous epoch. Must be called with writer lock held.
  */
 static void
-vvas_metaaffixer_get_inferframe_pts (VvasMetaAffixerInfo * pHandle,
-    VvasVideoInfo * vinfo, VvasMetadata * metadata)
+vvas_metaaffixer_retire (VvasMetaAffixerStream * stream,
+    VvasMetaAffixerMapData * mp)
 {
-  if ((NULL == pHandle) ||
-      (NULL == vinfo) || (NULL == metadata) || (NULL == pHandle->map)) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, DEFAULT_LOG_LEVEL,  "Invalid arguments");
-    return;
+  uint32_t e = atomic_load (&stream->epoch);
+  uint32_t old = (e + 1) % VVAS_METAAFFIXER_NUM_EPOCHS;
+
+  mp->next = stream->retired[e % VVAS_METAAFFIXER_NUM_EPOCHS];
+  stream->retired[e % VVAS_METAAFFIXER_NUM_EPOCHS] = mp;
+
+  /* (e + 1) % 3 is also (e - 2) % 3, its readers are gone when nobody is
+   * left in e - 1 */
+  if (0 == atomic_load (&stream->active[(e + 2) % VVAS_METAAFFIXER_NUM_EPOCHS])) {
+    while (stream->retired[old]) {
+      mp = stream->retired[old];
+      stream->retired[old] = mp->next;
+      vvas_metaaffixer_mapdata_free (mp);
+    }
+    atomic_store (&stream->epoch, e + 1);
+  }
+}
+
+/**
+ *  @fn  VvasMetaAffixerMapData * vvas_metaaffixer_ring_at (VvasMetaAffixerInfo * pHandle,
+ *                                                         VvasMetaAffixerStream * stream,
+ *                                                         uint32_t head, uint32_t idx)
+ *  @param [in] pHandle - MetaAffixer handle.
+ *  @param [in] stream - Stream to be read.
+ *  @param [in] head - Ring head read by the caller.
+ *  @param [in] idx - Index of the entry, 0 being the entry with oldest PTS.
+ *  @return Infer frame data at @idx, can be NULL if ring is being modified.
+ *  @brief This function returns infer frame data at PTS sorted position @idx.
+ */
+static inline VvasMetaAffixerMapData *
+vvas_metaaffixer_ring_at (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerStream * stream, uint32_t head, uint32_t idx)
+{
+  return atomic_load_explicit (&stream->ring[(head + idx) %
+          pHandle->max_infer_size], memory_order_acquire);
+}
+
+/**
+ *  @fn  bool vvas_metaaffixer_ring_bound (VvasMetaAffixerInfo * pHandle,
+ *                                        VvasMetaAffixerStream * stream,
+ *                                        uint32_t head, uint32_t count,
+ *                                        uint64_t pts, bool upper,
+ *                                        uint32_t * idx)
+ *  @param [in] pHandle - MetaAffixer handle.
+ *  @param [in] stream - Stream to be read.
+ *  @param [in] head - Ring head read by the caller.
+ *  @param [in] count - Ring entry count read by the caller.
+ *  @param [in] pts - PTS to be searched.
+ *  @param [in] upper - FALSE to find first entry whose PTS is not less than
+ *                      @pts, TRUE to find first entry whose PTS is greater
+ *                      than @pts.
+ *  @param [out] idx - Index of the entry found, @count if there is no such entry.
+ *  @return FALSE if ring was modified under the caller, TRUE otherwise.
+ *  @brief This function does binary search for @pts in sorted infer frames.
+ */
+static bool
+vvas_metaaffixer_ring_bound (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerStream * stream, uint32_t head, uint32_t count,
+    uint64_t pts, bool upper, uint32_t * idx)
+{
+  uint32_t lo = 0, hi = count;
+
+  while (lo < hi) {
+    uint32_t mid = lo + ((hi - lo) >> 1);
+    VvasMetaAffixerMapData *mp =
+        vvas_metaaffixer_ring_at (pHandle, stream, head, mid);
+    if (NULL == mp) {
+      return FALSE;
+    }
+    if ((mp->pts < pts) || (upper && (mp->pts == pts))) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
   }
+  *idx = lo;
+  return TRUE;
+}
 
-  VvasHashTableIter iter;
-  uint32_t size = vvas_hash_table_size (pHandle->map);
-  uint64_t min_seq_id = 0;
+/**
+ *  @fn  void vvas_metaaffixer_ring_insert (VvasMetaAffixerInfo * pHandle,
+ *                                         VvasMetaAffixerStream * stream,
+ *                                         VvasMetaAffixerMapData * mp)
+ *  @param [in] pHandle - MetaAffixer handle.
+ *  @param [in] stream - Stream to insert into.
+ *  @param [in] mp - Infer frame data to be inserted.
+ *  @return None
+ *  @brief This function inserts infer frame data keeping the ring sorted on
+ *         PTS. Monotonic PTS is appended at the tail in O(1), out of order
+ *         PTS is placed after all entries having same or lower PTS so that
+ *         entries with equal PTS remain in submission order.
+ *         Caller must hold writer lock, be inside seqlock write section and
+ *         ensure ring is not full.
+ */
+static void
+vvas_metaaffixer_ring_insert (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerStream * stream, VvasMetaAffixerMapData * mp)
+{
+  uint32_t max = pHandle->max_infer_size;
+  uint32_t head = atomic_load_explicit (&stream->head, memory_order_relaxed);
+  uint32_t count = atomic_load_explicit (&stream->count, memory_order_relaxed);
+  uint32_t pos = count;
+  uint32_t i;
+
+  if (count &&
+      (mp->pts < vvas_metaaffixer_ring_at (pHandle, stream, head,
+              count - 1)->pts)) {
+    vvas_metaaffixer_ring_bound (pHandle, stream, head, count, mp->pts, TRUE,
+        &pos);
+    LOG_D ("Out of order PTS %ld placed at %u", mp->pts, pos);
+  }
+
+  if (pos &&
+      (vvas_metaaffixer_ring_at (pHandle, stream, head,
+              pos - 1)->pts == mp->pts)) {
+    LOG_W ("Duplicate timestamp %ld found", mp->pts);
+  }
+
+  /* shift newer entries by one to make space at pos, release ordering
+   * publishes infer frame data to readers loading the slot */
+  for (i = count; i > pos; i--) {
+    atomic_store_explicit (&stream->ring[(head + i) % max],
+        vvas_metaaffixer_ring_at (pHandle, stream, head, i - 1),
+        memory_order_release);
+  }
+  atomic_store_explicit (&stream->ring[(head + pos) % max], mp,
+      memory_order_release);
+  atomic_store_explicit (&stream->count, count + 1, memory_order_relaxed);
+}
+
+/**
+ *  @fn uint64_t vvas_metaaffixer_remove_infer_meta (VvasMetaAffixerInfo *pHandle,
+ *                                                  VvasMetaAffixerStream * stream)
+ *  @param [in]  pHandle  MetaAffixer handle. 
+ *  @param [in]  stream  Stream to remove from.
+ *  @return  Removed infer frame data, NULL if there is nothing to remove.
+ *  @brief This function unlinks oldest infer & meta data from table.
+ *         Ring is sorted on PTS, hence oldest entry is always at head.
+ *         Caller must hold writer lock and be inside seqlock write section.
+ */
+static VvasMetaAffixerMapData *
+vvas_metaaffixer_remove_infer_meta (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerStream * stream)
+{
+  VvasMetaAffixerMapData *mp = NULL;
+  uint32_t head = atomic_load_explicit (&stream->head, memory_order_relaxed);
+  uint32_t count = atomic_load_explicit (&stream->count, memory_order_relaxed);
+
+  if (0 == count) {
+    return NULL;
+  }
+
+  mp = vvas_metaaffixer_ring_at (pHandle, stream, head, 0);
+  LOG_I ("Removing PTS %ld", mp->pts);
+
+  atomic_store_explicit (&stream->ring[head], NULL, memory_order_relaxed);
+  atomic_store_explicit (&stream->head, (head + 1) % pHandle->max_infer_size,
+      memory_order_relaxed);
+  atomic_store_explicit (&stream->count, count - 1, memory_order_relaxed);
+
+  if (atomic_load (&stream->cur) == mp) {
+    atomic_store (&stream->cur, NULL);
+  }
+  return mp;
+}
+
+/**
+ *  @fn  void vvas_metaaffixer_stream_free (VvasMetaAffixerInfo * pHandle,
+ *                                         VvasMetaAffixerStream * stream)
+ *  @param [in] pHandle - MetaAffixer handle.
+ *  @param [in] stream - Stream to be freed.
+ *  @return None
+ *  @brief This function frees a stream and all its infer frame data.
+ *         No reader or writer must be using the stream.
+ */
+static void
+vvas_metaaffixer_stream_free (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerStream * stream)
+{
   VvasMetaAffixerMapData *mp;
+  uint32_t i;
 
-  if (0 == size) {
-    LOG_D ("No data available in Infer table ");
+  if (NULL == stream) {
     return;
   }
 
-  /* initialize iterator */
-  vvas_hash_table_iter_init (pHandle->map, &iter);
+  while ((mp = vvas_metaaffixer_remove_infer_meta (pHandle, stream))) {
+    vvas_metaaffixer_mapdata_free (mp);
+  }
+  for (i = 0; i < VVAS_METAAFFIXER_NUM_EPOCHS; i++) {
+    while (stream->retired[i]) {
+      mp = stream->retired[i];
+      stream->retired[i] = mp->next;
+      vvas_metaaffixer_mapdata_free (mp);
+    }
+  }
+  vvas_mutex_clear (&stream->wlock);
+  free (stream->ring);
+  free (stream);
+}
+
+/**
+ *  @fn  VvasMetaAffixerStream * vvas_metaaffixer_get_stream (VvasMetaAffixerInfo * pHandle,
+ *                                                           uint32_t stream_id,
+ *                                                           bool create)
+ *  @param [in] pHandle - MetaAffixer handle.
+ *  @param [in] stream_id - Stream ID.
+ *  @param [in] create - Create the stream if it does not exist yet.
+ *  @return Stream instance, NULL if not present or failed to create.
+ *  @brief This function looks up stream by its ID without taking any lock.
+ *         Streams are created on first submission and live till handle is
+ *         destroyed.
+ */
+static VvasMetaAffixerStream *
+vvas_metaaffixer_get_stream (VvasMetaAffixerInfo * pHandle,
+    uint32_t stream_id, bool create)
+{
+  VvasMetaAffixerStream *stream = NULL;
+  VvasMetaAffixerStream *expected = NULL;
+
+  if (stream_id >= pHandle->max_streams) {
+    LOG_E ("Invalid stream ID %u, max streams %u", stream_id,
+        pHandle->max_streams);
+    return NULL;
+  }
+
+  stream = atomic_load_explicit (&pHandle->streams[stream_id],
+      memory_order_acquire);
+  if (stream || !create) {
+    return stream;
+  }
+
+  stream = (VvasMetaAffixerStream *) calloc (1, sizeof (VvasMetaAffixerStream));
+  if (NULL == stream) {
+    LOG_E ("failed to allocate stream %u", stream_id);
+    return NULL;
+  }
+  stream->ring = calloc (pHandle->max_infer_size, sizeof (*stream->ring));
+  if (NULL == stream->ring) {
+    LOG_E ("fatal error: failed to allocate infer frame ring");
+    free (stream);
+    return NULL;
+  }
+  vvas_mutex_init (&stream->wlock);
+
+  if (!atomic_compare_exchange_strong (&pHandle->streams[stream_id],
+          &expected, stream)) {
+    /* other writer created this stream meanwhile */
+    vvas_metaaffixer_stream_free (pHandle, stream);
+    stream = expected;
+  }
+  return stream;
+}
+
+/**
+ *  @fn uint32_t vvas_metaaffixer_get_overlap (VvasMetaAffixerInfo * pHandle,
+ *                                            VvasMetaAffixerMapData * mp,
+ *                                            uint64_t inframe_spts,
+ *                                            uint64_t inframe_epts)
+ *  @param [in] pHandle - MetaAffixer handle.
+ *  @param [in] mp - Infer frame data.
+ *  @param [in] inframe_spts - Start PTS of the input frame.
+ *  @param [in] inframe_epts - End PTS of the input frame.
+ *  @return Overlap percentage of the infer frame with input frame.
+ *  @brief This function computes overlap of infer frame w.r.t input frame.
+ */
+static uint32_t
+vvas_metaaffixer_get_overlap (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerMapData * mp, uint64_t inframe_spts, uint64_t inframe_epts)
+{
+  uint64_t infer_meta_dur = pHandle->inferframe_dur;
+  uint64_t infer_meta_spts = mp->pts;
+  uint64_t infer_meta_epts = mp->pts + infer_meta_dur;
+  uint32_t ovl_per = 0;
+
+  /* if infer frame is ahead  of input frame */
+  if ((infer_meta_spts >= inframe_spts) &&
+      (infer_meta_spts < inframe_epts) && (0 != infer_meta_dur)) {
+    /* overlap present calculate overlap w.r.t to Infer meta frame */
+    ovl_per =
+        (uint32_t) round (((float) (inframe_epts -
+                infer_meta_spts) / infer_meta_dur) * 100);
+    LOG_D
+        ("Infer<Input: frame ovlerlaps %d  Nearest PTS:%ld to inframepts:%ld ",
+        ovl_per, mp->pts, inframe_spts);
+
+  }
+  /* if infer frame  is behind of inframe */
+  else if ((inframe_spts >= infer_meta_spts) &&
+      (inframe_spts < infer_meta_epts) && (0 != infer_meta_dur)) {
+    /* overlap present calculate overlap w.r.t to Infer meta frame */
+    ovl_per =
+        (uint32_t) round (((float) (infer_meta_epts -
+                inframe_spts) / infer_meta_dur) * 100);
+    LOG_D
+        ("Infer>Input: frame ovlerlaps %d  Nearest PTS:%ld to inframepts:%ld ",
+        ovl_per, mp->pts, inframe_spts);
+  }
+
+  return ovl_per;
+}
+
+/**
+ *  @fn bool vvas_metaaffixer_find_inferframe (VvasMetaAffixerInfo *pHandle,
+ *                                            VvasMetaAffixerStream * stream,
+ *                                            uint32_t head, uint32_t count,
+ *                                            VvasMetaAffixerSearch * search)
+ *  @param [in] pHandle - handle for metaaffixer instance
+ *  @param [in] stream - stream to be searched
+ *  @param [in] head - ring head read by the caller
+ *  @param [in] count - ring entry count read by the caller
+ *  @param [in,out] search - metadata of input frame, frames[0] is updated
+ *                           with nearest infer frame, NULL if no frame overlaps
+ *  @return FALSE if ring was modified under the caller, TRUE otherwise.
+ *  @brief  this function will find nearest pts from infer frames.
+ *          As all infer frames have same duration, overlap decreases as
+ *          infer frames move away from the input frame PTS on either side.
+ *          Hence only the neighbours of input frame PTS in the sorted ring
+ *          are candidates for maximum overlap and are found by binary search.
+ */
+static bool
+vvas_metaaffixer_find_inferframe (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerStream * stream, uint32_t head, uint32_t count,
+    VvasMetaAffixerSearch * search)
+{
+  VvasMetadata *metadata = search->metadata;
+  VvasMetaAffixerMapData **near = &search->frames[0];
+  VvasMetaAffixerMapData *ahead = NULL, *behind = NULL;
+  uint32_t ahead_ovl = 0, behind_ovl = 0;
+  uint32_t idx, first;
+
+  *near = NULL;
+
+  if (0 == count) {
+    LOG_D ("No data available in Infer table ");
+    return TRUE;
+  }
 
   uint64_t inframe_spts = metadata->pts;
   uint64_t inframe_epts = metadata->pts + metadata->duration;
 
-  uint64_t *near_pts = NULL;
-  uint32_t overlap_percent = 0;
+  /* first infer frame at or after input frame */
+  if (!vvas_metaaffixer_ring_bound (pHandle, stream, head, count,
+          inframe_spts, FALSE, &idx)) {
+    return FALSE;
+  }
+  if (idx < count) {
+    ahead = vvas_metaaffixer_ring_at (pHandle, stream, head, idx);
+    if (NULL == ahead) {
+      return FALSE;
+    }
+    ahead_ovl = vvas_metaaffixer_get_overlap (pHandle, ahead, inframe_spts,
+        inframe_epts);
+  }
 
-  VvasMetaAffixerMapData *frame = NULL;
-  pHandle->near_pts = NULL;
+  /* last infer frame before input frame, oldest one among equal PTS */
+  if (idx > 0) {
+    behind = vvas_metaaffixer_ring_at (pHandle, stream, head, idx - 1);
+    if ((NULL == behind) ||
+        !vvas_metaaffixer_ring_bound (pHandle, stream, head, count,
+            behind->pts, FALSE, &first) ||
+        (NULL == (behind = vvas_metaaffixer_ring_at (pHandle, stream, head,
+                    first)))) {
+      return FALSE;
+    }
+    behind_ovl = vvas_metaaffixer_get_overlap (pHandle, behind, inframe_spts,
+        inframe_epts);
+  }
 
-  uint64_t infer_meta_dur = pHandle->inferframe_dur;
-  bool first_itr = TRUE;
-
-  while (vvas_hash_table_iter_next (&iter, (void **) &near_pts,
-          (void **) &frame)) {
-    uint64_t infer_meta_spts = *near_pts;
-    uint64_t infer_meta_epts = *near_pts + infer_meta_dur;
-    uint32_t ovl_per = 0;
-
-    /* if infer frame is ahead  of input frame */
-    if ((infer_meta_spts >= inframe_spts) &&
-        (infer_meta_spts < inframe_epts) && (0 != infer_meta_dur)) {
-      /* overlap present calculate overlap w.r.t to Infer meta frame */
-      ovl_per =
-          (uint32_t) round (((float) (inframe_epts -
-                  infer_meta_spts) / infer_meta_dur) * 100);
-      LOG_D
-          ("Infer<Input: frame ovlerlaps %d  Nearest PTS:%ld to inframepts:%ld ",
-          ovl_per, *near_pts, inframe_spts);
-
-    }
-    /* if infer frame  is behind of inframe */
-    else if ((inframe_spts >= infer_meta_spts) &&
-        (inframe_spts < infer_meta_epts) && (0 != infer_meta_dur)) {
-      /* overlap present calculate overlap w.r.t to Infer meta frame */
-      ovl_per =
-          (uint32_t) round (((float) (infer_meta_epts -
-                  inframe_spts) / infer_meta_dur) * 100);
-      LOG_D
-          ("Infer>Input: frame ovlerlaps %d  Nearest PTS:%ld to inframepts:%ld ",
-          ovl_per, *near_pts, inframe_spts);
-    }
-
-    if (ovl_per > overlap_percent) {
-
-      /* store near PTS */
-      pHandle->near_pts = near_pts;
-
-      /* update new overlap percent */
-      overlap_percent = ovl_per;
-      mp = (VvasMetaAffixerMapData *) vvas_hash_table_lookup (pHandle->map,
-          pHandle->near_pts);
-      if (mp) {
-        min_seq_id = mp->seq_id;
-        first_itr = FALSE;
-      }
-      LOG_I ("frame ovlerlaps %d  Nearest PTS:%ld to inframepts:%ld ", ovl_per,
-          *near_pts, inframe_spts);
-    } else if (ovl_per == overlap_percent) {
-      mp = (VvasMetaAffixerMapData *) vvas_hash_table_lookup (pHandle->map,
-          near_pts);
-      if (mp) {
-        if (first_itr) {
-          min_seq_id = mp->seq_id;
-          first_itr = FALSE;
-        } else if (mp->seq_id < min_seq_id) {
-          pHandle->near_pts = near_pts;
-          min_seq_id = mp->seq_id;
-        }
-      }
+  if (ahead_ovl > behind_ovl) {
+    *near = ahead;
+  } else if (behind_ovl > ahead_ovl) {
+    *near = behind;
+  } else if (ahead_ovl) {
+    /* same overlap, prefer infer frame received first */
+    *near = (ahead->seq_id < behind->seq_id) ? ahead : behind;
+  }
+
+  if (*near) {
+    LOG_I ("frame ovlerlaps %d  Nearest PTS:%ld to inframepts:%ld ",
+        (ahead_ovl > behind_ovl) ? ahead_ovl : behind_ovl, (*near)->pts,
+        inframe_spts);
+  }
+
+  return TRUE;
+}
+
+/**
+ *  @fn bool vvas_metaaffixer_find_interp_frames (VvasMetaAffixerInfo *pHandle,
+ *                                               VvasMetaAffixerStream * stream,
+ *                                               uint32_t head, uint32_t count,
+ *                                               VvasMetaAffixerSearch * search)
+ *  @param [in] pHandle - handle for metaaffixer instance
+ *  @param [in] stream - stream to be searched
+ *  @param [in] head - ring head read by the caller
+ *  @param [in] count - ring entry count read by the caller
+ *  @param [in,out] search - metadata of input frame, frames[] is updated
+ *                           with two infer frames of increasing PTS to
+ *                           interpolate or extrapolate from, NULL if none.
+ *  @return FALSE if ring was modified under the caller, TRUE otherwise.
+ *  @brief  this function finds infer frames just before and after input
+ *          frame PTS, or the two latest infer frames before input frame PTS
+ *          if no infer frame is available after it yet.
+ */
+static bool
+vvas_metaaffixer_find_interp_frames (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerStream * stream, uint32_t head, uint32_t count,
+    VvasMetaAffixerSearch * search)
+{
+  VvasMetaAffixerMapData *prev, *next = NULL;
+  uint32_t idx, first;
+
+  search->frames[0] = search->frames[1] = NULL;
+
+  /* first infer frame after input frame */
+  if (!vvas_metaaffixer_ring_bound (pHandle, stream, head, count,
+          search->metadata->pts, TRUE, &idx)) {
+    return FALSE;
+  }
+  if (0 == idx) {
+    return TRUE;
+  }
+
+  prev = vvas_metaaffixer_ring_at (pHandle, stream, head, idx - 1);
+  if (NULL == prev) {
+    return FALSE;
+  }
+
+  if (idx < count) {
+    next = vvas_metaaffixer_ring_at (pHandle, stream, head, idx);
+    if (NULL == next) {
+      return FALSE;
+    }
+  } else {
+    /* nothing after input frame yet, extrapolate from the two latest ones */
+    if (!vvas_metaaffixer_ring_bound (pHandle, stream, head, count,
+            prev->pts, FALSE, &first)) {
+      return FALSE;
+    }
+    if (0 == first) {
+      return TRUE;
+    }
+    next = prev;
+    prev = vvas_metaaffixer_ring_at (pHandle, stream, head, first - 1);
+    if (NULL == prev) {
+      return FALSE;
     }
   }
 
-  return;
+  search->frames[0] = prev;
+  search->frames[1] = next;
+  return TRUE;
+}
+
+/**
+ *  @fn bool vvas_metaaffixer_search (VvasMetaAffixerInfo *pHandle, 
+ *                                   VvasMetaAffixerStream * stream,
+ *                                   VvasMetaAffixerSearchFunc func,
+ *                                   VvasMetaAffixerSearch * search)
+ *  @param [in] handle - handle for metaaffixer instance
+ *  @param [in] stream - stream to be searched
+ *  @param [in] func - search to be run on the ring
+ *  @param [in,out] search - search input and result
+ *  @return None
+ *  @brief  this function runs @func on infer frames of the stream without
+ *          taking a lock. Search is retried if a writer modified the ring
+ *          meanwhile. Caller must have pinned an epoch of the stream.
+ */
+static void
+vvas_metaaffixer_search (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerStream * stream, VvasMetaAffixerSearchFunc func,
+    VvasMetaAffixerSearch * search)
+{
+  uint32_t seq, head, count;
+  bool valid = FALSE;
+
+  do {
+    seq = atomic_load_explicit (&stream->seq, memory_order_acquire);
+    if (seq & 1) {
+      /* writer is updating the ring */
+      continue;
+    }
+    head = atomic_load_explicit (&stream->head, memory_order_relaxed);
+    count = atomic_load_explicit (&stream->count, memory_order_relaxed);
+    valid = func (pHandle, stream, head, count, search);
+    atomic_thread_fence (memory_order_acquire);
+  } while ((seq & 1) || !valid ||
+      (seq != atomic_load_explicit (&stream->seq, memory_order_relaxed)));
 }
 
  /**
@@ -283,31 +739,6 @@ vvas_metaaffixer_print (const VvasTreeNode * node, void *data)
   return FALSE;
 }
 
-/**
- *  @fn bool vvas_metaaffixer_node_assign(const VvasTreeNode  *node, void *data)
- *  @param [in] node - Address of the node .
- *  @param [in] data - user data to be passed
- *  @return TRUE - To stop traversing
- *          FALSE - To continue traversing
- *  @brief This function is passed as parameter to traver all nodes in a tree.
- *
- */
-static bool
-vvas_metaaffixer_node_assign (const VvasTreeNode * node, void *data)
-{
-  VvasInferPrediction *dmeta = NULL;
-
-  if (NULL != node) {
-    dmeta = (VvasInferPrediction *) node->data;
-    if (dmeta->node) {
-      vvas_treenode_destroy (dmeta->node);
-    }
-    dmeta->node = (VvasTreeNode *) node;
-  }
-
-  return false;
-}
-
 /**
  *  @fn  VvasInferPrediction* vvas_metaaffixer_get_scaled_meta(VvasInferPrediction *dmeta, VvasInferPrediction *smeta)
  *  @param [in]  dmeta Address of context handle 
@@ -321,105 +752,463 @@ static VvasInferPrediction *
 vvas_metaaffixer_get_scaled_meta (VvasInferPrediction * smeta,
     VvasInferScaleFactor * scl_factor, VvasMetaAffixerInfo * pHandle)
 {
-  VvasTreeNode *node = NULL;
+  VvasInferPrediction *dmeta = NULL;
+  VvasBBoxTransform xform;
 
   if ((NULL != smeta) && (NULL != scl_factor) && (NULL != pHandle)) {
-    node =
-        vvas_treenode_copy_deep (smeta->node, vvas_metaaffixer_node_scale,
-        scl_factor);
+    dmeta = vvas_inferprediction_copy (smeta);
+    if (NULL == dmeta) {
+      return NULL;
+    }
+
+    /* scale all boxes of the copied tree in one batch */
+    memset (&xform, 0x0, sizeof (VvasBBoxTransform));
+    xform.hfactor = scl_factor->hfactor;
+    xform.vfactor = scl_factor->vfactor;
+    vvas_inferprediction_transform (dmeta, &xform);
 
-    vvas_treenode_traverse (node, IN_ORDER,
-        TRAVERSE_ALL, -1, vvas_metaaffixer_node_assign, NULL);
     if (pHandle->loglevel == LOG_LEVEL_INFO) {
-      vvas_treenode_traverse (node, IN_ORDER,
+      vvas_treenode_traverse (dmeta->node, IN_ORDER,
           TRAVERSE_ALL, -1, vvas_metaaffixer_print, pHandle);
     }
-    return node->data;
+    return dmeta;
   }
 
   return NULL;
 }
 
 /**
- *  @fn uint64_t vvas_metaaffixer_remove_infer_meta (VvasMetaAffixerInfo *pHandle)  
- *  @param [in]  pHandle  MetaAffixer handle. 
- *  @return  void 
- *  @brief This function removes old infer & meta data from table. 
+ *  @fn  VvasMetaAffixerMapData * vvas_metaaffixer_get_near_frame (VvasMetaAffixerInfo * pHandle,
+ *                                                               VvasMetaAffixerStream * stream,
+ *                                                               bool sync_pts,
+ *                                                               VvasMetadata * metadata,
+ *                                                               VvasMetaAffixerRespCode * respcode)
+ *  @param [in] pHandle - MetaAffixer handle.
+ *  @param [in] stream - Stream to be searched, can be NULL.
+ *  @param [in] sync_pts - if FALSE then last received infer meta data
+ *                         is chosen else infer metadata is chosen based on
+ *                         PTS of input frame.
+ *  @param [in] metadata - metadata of input frame
+ *  @param [out] respcode - metaaffixer response code.
+ *  @return Infer frame data to be scaled, NULL if none.
+ *  @brief This function picks the reference infer frame for an input frame.
+ *         Caller must have pinned an epoch of the stream.
  */
-static void
-vvas_metaaffixer_remove_infer_meta (VvasMetaAffixerInfo * pHandle)
+static VvasMetaAffixerMapData *
+vvas_metaaffixer_get_near_frame (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerStream * stream, bool sync_pts, VvasMetadata * metadata,
+    VvasMetaAffixerRespCode * respcode)
 {
-  uint32_t *pts = NULL;
-  VvasMetaAffixerMapData *vmeta = NULL;
   VvasMetaAffixerMapData *mp = NULL;
-  bool bbreak = FALSE;
 
-  if (NULL == pHandle) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, DEFAULT_LOG_LEVEL,  "Invalid arguments");
-    return;
+  *respcode = VVAS_METAAFFIXER_PASS;
+
+  if (!sync_pts) {
+
+    /* sync PTS with last infer frame meta data */
+    if (stream) {
+      mp = atomic_load (&stream->cur);
+    }
+    if (NULL == mp) {
+      LOG_E ("Near PTS is NULL ");
+      *respcode = VVAS_METAAFFIXER_NULL_VALUE;
+    }
+
+  } else {
+    if (stream) {
+      VvasMetaAffixerSearch search;
+
+      memset (&search, 0x0, sizeof (search));
+      search.metadata = metadata;
+      vvas_metaaffixer_search (pHandle, stream,
+          vvas_metaaffixer_find_inferframe, &search);
+      mp = search.frames[0];
+    }
+
+    if (NULL == mp) {
+
+      LOG_D ("No Frame Overlap");
+
+      /* No overlap found */
+      *respcode = VVAS_METAAFFIXER_NO_FRAME_OVERLAP;
+    }
+  }
+
+  if (NULL != mp) {
+    LOG_D ("PTS: %ld", mp->pts);
   }
 
-  VvasHashTableIter iter;
+  return mp;
+}
+
+/**
+ *  @fn  void vvas_metaaffixer_get_scale_factor (VvasMetaAffixerMapData * mp,
+ *                                              VvasVideoInfo * vinfo,
+ *                                              VvasInferScaleFactor * scl_factor)
+ *  @param [in] mp - Reference infer frame data.
+ *  @param [in] vinfo - Input Frame Information
+ *  @param [out] scl_factor - Scale factor from infer frame to input frame.
+ *  @return None
+ *  @brief This function computes scale factor from infer to input frame.
+ */
+static void
+vvas_metaaffixer_get_scale_factor (VvasMetaAffixerMapData * mp,
+    VvasVideoInfo * vinfo, VvasInferScaleFactor * scl_factor)
+{
+  memset (scl_factor, 0x0, sizeof (*scl_factor));
+
+  /* Source frame height & width */
+  scl_factor->sh = mp->height;
+  scl_factor->sw = mp->width;
+
+  /* destination frame height and width */
+  scl_factor->dh = vinfo->height;
+  scl_factor->dw = vinfo->width;
+
+  /* Compute scale factor */
+  vvas_metaaffixer_compute_scale_factor (scl_factor);
+}
 
-  /* initialize iterator */
-  vvas_hash_table_iter_init (pHandle->map, &iter);
+/**
+ *  @fn  VvasMetaAffixerSharedMeta * vvas_metaaffixer_shared_meta_new (VvasMetaAffixerInfo * pHandle,
+ *                                                                   VvasMetaAffixerMapData * mp,
+ *                                                                   VvasVideoInfo * vinfo)
+ *  @param [in] pHandle - MetaAffixer handle.
+ *  @param [in] mp - Reference infer frame data.
+ *  @param [in] vinfo - Input Frame Information
+ *  @return Scaled metadata with one reference, NULL on failure.
+ *  @brief This function scales metadata of @mp to the resolution of @vinfo.
+ */
+static VvasMetaAffixerSharedMeta *
+vvas_metaaffixer_shared_meta_new (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerMapData * mp, VvasVideoInfo * vinfo)
+{
+  VvasMetaAffixerSharedMeta *shared;
+  VvasInferScaleFactor scl_factor;
 
-  uint64_t tmp_pts = 0u;
-  bool first_itr = TRUE;
-  uint32_t *key = NULL;
-  uint32_t *tmp_key;
-  uint64_t min_seq_id;
+  shared = (VvasMetaAffixerSharedMeta *)
+      calloc (1, sizeof (VvasMetaAffixerSharedMeta));
+  if (NULL == shared) {
+    LOG_E ("failed to allocate scaled metadata");
+    return NULL;
+  }
 
-  while ((vvas_hash_table_iter_next (&iter, (void **) &pts, (void **) &vmeta) &&
-          (bbreak == FALSE))) {
+  shared->width = vinfo->width;
+  shared->height = vinfo->height;
+  vvas_metaaffixer_get_scale_factor (mp, vinfo, &scl_factor);
+  shared->meta =
+      vvas_metaaffixer_get_scaled_meta (mp->meta, &scl_factor, pHandle);
+  atomic_init (&shared->ref_count, 1);
 
-    if (first_itr) {
-      tmp_pts = *pts;
-      key = pts;
-      mp = (VvasMetaAffixerMapData *) vvas_hash_table_lookup (pHandle->map,
-          key);
-      if (mp) {
-        min_seq_id = mp->seq_id;
+  return shared;
+}
+
+/**
+ *  @fn  VvasMetaAffixerSharedMeta * vvas_metaaffixer_get_cached_meta (VvasMetaAffixerInfo * pHandle,
+ *                                                                   VvasMetaAffixerMapData * mp,
+ *                                                                   VvasVideoInfo * vinfo)
+ *  @param [in] pHandle - MetaAffixer handle.
+ *  @param [in] mp - Reference infer frame data.
+ *  @param [in] vinfo - Input Frame Information
+ *  @return Referenced scaled metadata, NULL on failure.
+ *  @brief This function returns scaled metadata of @mp for the resolution of
+ *         @vinfo. Scaled trees are cached in the infer frame data for up to
+ *         VVAS_METAAFFIXER_MAX_SCALED_CACHE resolutions, so consecutive input
+ *         frames referring the same infer frame share one scaled tree.
+ *         Cache slots are filled once without lock and never replaced, any
+ *         further resolution gets an uncached tree.
+ *         Caller must have pinned an epoch of the stream.
+ */
+static VvasMetaAffixerSharedMeta *
+vvas_metaaffixer_get_cached_meta (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerMapData * mp, VvasVideoInfo * vinfo)
+{
+  VvasMetaAffixerSharedMeta *shared = NULL;
+  VvasMetaAffixerSharedMeta *cached;
+  uint32_t i;
+
+  for (i = 0; i < VVAS_METAAFFIXER_MAX_SCALED_CACHE; i++) {
+    cached = atomic_load_explicit (&mp->scaled[i], memory_order_acquire);
+
+    if (NULL == cached) {
+      if (NULL == shared) {
+        shared = vvas_metaaffixer_shared_meta_new (pHandle, mp, vinfo);
+        if (NULL == shared) {
+          return NULL;
+        }
       }
-      first_itr = FALSE;
-    } else if (*pts < tmp_pts) {
-      tmp_pts = *pts;
-      key = pts;
-      mp = (VvasMetaAffixerMapData *) vvas_hash_table_lookup (pHandle->map,
-          key);
-      if (mp) {
-        min_seq_id = mp->seq_id;
+      /* one reference held by cache and one by caller */
+      atomic_store (&shared->ref_count, 2);
+      if (atomic_compare_exchange_strong (&mp->scaled[i], &cached, shared)) {
+        return shared;
       }
-    } else if (*pts == tmp_pts) {
-      LOG_W ("Duplicate timestamp %ld found", tmp_pts);
-      tmp_key = pts;
-      mp = (VvasMetaAffixerMapData *) vvas_hash_table_lookup (pHandle->map,
-          tmp_key);
-      if (mp) {
-        if (mp->seq_id < min_seq_id) {
-          min_seq_id = mp->seq_id;
-          key = pts;
-        }
+      /* other reader filled this slot meanwhile */
+      atomic_store (&shared->ref_count, 1);
+    }
+
+    if ((cached->width == vinfo->width) && (cached->height == vinfo->height)) {
+      atomic_fetch_add (&cached->ref_count, 1);
+      vvas_metaaffixer_shared_meta_unref (shared);
+      return cached;
+    }
+  }
+
+  if (NULL == shared) {
+    shared = vvas_metaaffixer_shared_meta_new (pHandle, mp, vinfo);
+  }
+  LOG_D ("scaled metadata cache full, %dx%d not cached", vinfo->width,
+      vinfo->height);
+
+  return shared;
+}
+
+/**
+ *  @fn  float vvas_metaaffixer_iou (VvasBoundingBox * a, VvasBoundingBox * b)
+ *  @param [in] a - First bounding box.
+ *  @param [in] b - Second bounding box.
+ *  @return Intersection over union of @a and @b.
+ *  @brief This function computes intersection over union of two boxes.
+ */
+static float
+vvas_metaaffixer_iou (VvasBoundingBox * a, VvasBoundingBox * b)
+{
+  int64_t x1 = (a->x > b->x) ? a->x : b->x;
+  int64_t y1 = (a->y > b->y) ? a->y : b->y;
+  int64_t x2 = ((a->x + (int64_t) a->width) < (b->x + (int64_t) b->width)) ?
+      (a->x + (int64_t) a->width) : (b->x + (int64_t) b->width);
+  int64_t y2 = ((a->y + (int64_t) a->height) < (b->y + (int64_t) b->height)) ?
+      (a->y + (int64_t) a->height) : (b->y + (int64_t) b->height);
+  double inter, uni;
+
+  if ((x2 <= x1) || (y2 <= y1)) {
+    return 0.0f;
+  }
+
+  inter = (double) (x2 - x1) * (y2 - y1);
+  uni = (double) a->width * a->height + (double) b->width * b->height - inter;
+
+  return (uni > 0) ? (float) (inter / uni) : 0.0f;
+}
+
+/**
+ *  @fn  VvasInferPrediction * vvas_metaaffixer_match_object (VvasMetaAffixerInfo * pHandle,
+ *                                                           VvasInferPrediction * obj,
+ *                                                           VvasInferPrediction * other,
+ *                                                           VvasTreeNode ** used,
+ *                                                           uint32_t num_used)
+ *  @param [in] pHandle - MetaAffixer handle.
+ *  @param [in] obj - Object to be matched.
+ *  @param [in] other - Root of the other infer frame metadata.
+ *  @param [in,out] used - Objects of @other already matched.
+ *  @param [in] num_used - Number of entries in @used.
+ *  @return Matching object of @other, NULL if none.
+ *  @brief This function finds the same object in other infer frame, first by
+ *         tracker ID and otherwise by best IoU above configured threshold.
+ */
+static VvasInferPrediction *
+vvas_metaaffixer_match_object (VvasMetaAffixerInfo * pHandle,
+    VvasInferPrediction * obj, VvasInferPrediction * other,
+    VvasTreeNode ** used, uint32_t num_used)
+{
+  VvasTreeNode *node, *best = NULL;
+  float best_iou = pHandle->interp_iou_threshold;
+  uint32_t i;
+
+  for (node = other->node->children; node; node = node->next) {
+    VvasInferPrediction *cand = (VvasInferPrediction *) node->data;
+    bool taken = FALSE;
+
+    for (i = 0; i < num_used; i++) {
+      if (used[i] == node) {
+        taken = TRUE;
+        break;
       }
     }
+    if (taken) {
+      continue;
+    }
+
+    if (obj->obj_track_label && cand->obj_track_label) {
+      if (!strcmp (obj->obj_track_label, cand->obj_track_label)) {
+        best = node;
+        break;
+      }
+      continue;
+    }
+
+    float iou = vvas_metaaffixer_iou (&obj->bbox, &cand->bbox);
+    if (iou >= best_iou) {
+      best_iou = iou;
+      best = node;
+    }
   }
 
-  if (NULL != key) {
-    LOG_I ("Removing PTS %ld", tmp_pts);
-    mp = (VvasMetaAffixerMapData *) vvas_hash_table_lookup (pHandle->map, key);
-    vvas_metaaffixer_mapdata_remove_foreach (NULL, mp, pHandle);
-    if (!vvas_hash_table_remove (pHandle->map, key)) {
-      LOG_E ("Failed to delete infer frame data");
+  if (best) {
+    used[num_used] = best;
+    return (VvasInferPrediction *) best->data;
+  }
+  return NULL;
+}
+
+/** @struct VvasMetaAffixerOffset
+ *  @brief  offset to move a subtree by.
+ */
+typedef struct
+{
+  const VvasTreeNode *root;
+  int32_t dx;
+  int32_t dy;
+} VvasMetaAffixerOffset;
+
+/**
+ *  @fn bool vvas_metaaffixer_node_translate(const VvasTreeNode  *node, void *data)
+ *  @param [in] node - Address of the node .
+ *  @param [in] data - Offset to move the node by.
+ *  @return FALSE - To continue traversing
+ *  @brief This function moves descendant nodes along with their moved parent.
+ */
+static bool
+vvas_metaaffixer_node_translate (const VvasTreeNode * node, void *data)
+{
+  VvasMetaAffixerOffset *offset = (VvasMetaAffixerOffset *) data;
+  VvasInferPrediction *pred = (VvasInferPrediction *) node->data;
+
+  if (node != offset->root) {
+    pred->bbox.x += offset->dx;
+    pred->bbox.y += offset->dy;
+  }
+  return FALSE;
+}
+
+/**
+ *  @fn  VvasInferPrediction * vvas_metaaffixer_get_interpolated_meta (VvasMetaAffixerInfo * pHandle,
+ *                                                                   VvasMetaAffixerStream * stream,
+ *                                                                   VvasVideoInfo * vinfo,
+ *                                                                   VvasMetadata * metadata)
+ *  @param [in] pHandle - MetaAffixer handle.
+ *  @param [in] stream - Stream to be searched.
+ *  @param [in] vinfo - Input Frame Information
+ *  @param [in] metadata - metadata of input frame
+ *  @return Scaled and interpolated metadata, NULL if caller has to fall back
+ *          to nearest infer frame.
+ *  @brief This function linearly interpolates boxes of objects between the
+ *         infer frames around input frame PTS, or extrapolates them from the
+ *         two latest infer frames by up to one infer interval. Metadata of
+ *         the infer frame nearer to input frame is used as base, its objects
+ *         which are also found in the other infer frame get the interpolated
+ *         box and their child objects move along. Unmatched objects are kept
+ *         as is. Caller must have pinned an epoch of the stream.
+ */
+static VvasInferPrediction *
+vvas_metaaffixer_get_interpolated_meta (VvasMetaAffixerInfo * pHandle,
+    VvasMetaAffixerStream * stream, VvasVideoInfo * vinfo,
+    VvasMetadata * metadata)
+{
+  VvasMetaAffixerMapData *f0, *f1, *base, *other;
+  VvasInferPrediction *scaled, *obj, *match;
+  VvasTreeNode *bnode, *snode, **used = NULL;
+  VvasInferScaleFactor scl_factor;
+  VvasMetaAffixerSearch search;
+  uint32_t num_used = 0, num_objs = 0;
+  double t;
+
+  memset (&search, 0x0, sizeof (search));
+  search.metadata = metadata;
+  vvas_metaaffixer_search (pHandle, stream,
+      vvas_metaaffixer_find_interp_frames, &search);
+
+  f0 = search.frames[0];
+  f1 = search.frames[1];
+  if ((NULL == f0) || (NULL == f1) ||
+      (f0->width != f1->width) || (f0->height != f1->height) ||
+      (metadata->pts == f0->pts) || (metadata->pts == f1->pts)) {
+    return NULL;
+  }
+
+  t = (double) ((int64_t) (metadata->pts - f0->pts)) / (f1->pts - f0->pts);
+  if (t > 2.0) {
+    LOG_D ("PTS %ld too far from infer frames to extrapolate", metadata->pts);
+    return NULL;
+  }
+
+  base = (t < 0.5) ? f0 : f1;
+  other = (base == f0) ? f1 : f0;
+
+  for (bnode = other->meta->node->children; bnode; bnode = bnode->next) {
+    num_objs++;
+  }
+  if (num_objs) {
+    used = (VvasTreeNode **) calloc (num_objs, sizeof (VvasTreeNode *));
+    if (NULL == used) {
+      return NULL;
     }
   }
+
+  vvas_metaaffixer_get_scale_factor (base, vinfo, &scl_factor);
+  scaled = vvas_metaaffixer_get_scaled_meta (base->meta, &scl_factor, pHandle);
+  if ((NULL == scaled) || (NULL == scaled->node)) {
+    LOG_E ("failed to scale metadata for interpolation");
+    vvas_inferprediction_free (scaled);
+    free (used);
+    return NULL;
+  }
+
+  /* deep copy keeps child order, walk source and scaled trees together */
+  for (bnode = base->meta->node->children, snode = scaled->node->children;
+      bnode && snode && (num_used < num_objs);
+      bnode = bnode->next, snode = snode->next) {
+    VvasInferPrediction *spred = (VvasInferPrediction *) snode->data;
+    VvasBoundingBox *b0, *b1;
+    VvasMetaAffixerOffset offset;
+    double x, y, w, h;
+
+    obj = (VvasInferPrediction *) bnode->data;
+    match = vvas_metaaffixer_match_object (pHandle, obj, other->meta, used,
+        num_used);
+    if (NULL == match) {
+      continue;
+    }
+    num_used++;
+
+    b0 = (base == f0) ? &obj->bbox : &match->bbox;
+    b1 = (base == f0) ? &match->bbox : &obj->bbox;
+
+    x = b0->x + (b1->x - b0->x) * t;
+    y = b0->y + (b1->y - b0->y) * t;
+    w = b0->width + ((double) b1->width - b0->width) * t;
+    h = b0->height + ((double) b1->height - b0->height) * t;
+
+    offset.root = snode;
+    offset.dx = (int32_t) (x * scl_factor.hfactor) - spred->bbox.x;
+    offset.dy = (int32_t) (y * scl_factor.vfactor) - spred->bbox.y;
+
+    spred->bbox.x += offset.dx;
+    spred->bbox.y += offset.dy;
+    spred->bbox.width = (w > 1.0) ? nearbyintf (w * scl_factor.hfactor) : 1;
+    spred->bbox.height = (h > 1.0) ? nearbyintf (h * scl_factor.vfactor) : 1;
+
+    if (snode->children && (offset.dx || offset.dy)) {
+      vvas_treenode_traverse (snode, PRE_ORDER, TRAVERSE_ALL, -1,
+          vvas_metaaffixer_node_translate, &offset);
+    }
+  }
+
+  LOG_D ("interpolated %u objects at %.2f between PTS %ld and %ld", num_used,
+      t, f0->pts, f1->pts);
+
+  free (used);
+  return scaled;
 }
 
  /**
- *  @fn   VvasMetaAffixer* vvas_metaaffixer_create (uint64_t inferframe_dur,
- *                                                 uint32_t infer_queue_size , 
- *                                                 VvasLogLevel loglevel)
+ *  @fn   VvasMetaAffixer* vvas_metaaffixer_create_multistream (uint64_t inferframe_dur,
+ *                                                             uint32_t infer_queue_size,
+ *                                                             uint32_t max_streams,
+ *                                                             VvasLogLevel loglevel)
  *  @param [in] inferframe_dur - Duration of the infer frame.                                                  
- *  @param [in] infer_queue_size  - Represents Max infer frame queue size.
+ *  @param [in] infer_queue_size  - Represents Max infer frame queue size per stream.
+ *  @param [in] max_streams - Maximum number of streams, stream IDs are
+ *                            0 to max_streams - 1.
  *  @param [in] loglevel - indicates log level
  *  @return On Sucess returns handle of Metaaffixer handle
  *          On Failure returns NULL
@@ -427,13 +1216,14 @@ vvas_metaaffixer_remove_infer_meta (VvasMetaAffixerInfo * pHandle)
  *          return the handle.
  */
 VvasMetaAffixer *
-vvas_metaaffixer_create (uint64_t inferframe_dur,
-    uint32_t infer_queue_size, VvasLogLevel loglevel)
+vvas_metaaffixer_create_multistream (uint64_t inferframe_dur,
+    uint32_t infer_queue_size, uint32_t max_streams, VvasLogLevel loglevel)
 {
   VvasMetaAffixerInfo *pHandle = NULL;
 
   if ((0 == inferframe_dur) ||
-      (0xFFFFFFFFFFFFFFFF == inferframe_dur) || (0 == infer_queue_size)) {
+      (0xFFFFFFFFFFFFFFFF == inferframe_dur) || (0 == infer_queue_size) ||
+      (0 == max_streams)) {
     LOG_MESSAGE (LOG_LEVEL_ERROR, DEFAULT_LOG_LEVEL,  "Invalid input param received");
     return NULL;
   }
@@ -449,10 +1239,14 @@ vvas_metaaffixer_create (uint64_t inferframe_dur,
 
     pHandle->inferframe_dur = inferframe_dur;
 
-    pHandle->map = vvas_hash_table_new (vvas_direct_hash, vvas_direct_equal);
+    pHandle->max_streams = max_streams;
 
-    if (NULL == pHandle->map) {
-      LOG_E ("fatal error: hashmap new returns NULL");
+    pHandle->interpolation = VVAS_METAAFFIXER_INTERPOLATION_NONE;
+
+    pHandle->streams = calloc (max_streams, sizeof (*pHandle->streams));
+
+    if (NULL == pHandle->streams) {
+      LOG_E ("fatal error: failed to allocate stream table");
 
       /* free allocated mem */
       free (pHandle);
@@ -464,6 +1258,26 @@ vvas_metaaffixer_create (uint64_t inferframe_dur,
   return (VvasMetaAffixer *) pHandle;
 }
 
+ /**
+ *  @fn   VvasMetaAffixer* vvas_metaaffixer_create (uint64_t inferframe_dur,
+ *                                                 uint32_t infer_queue_size , 
+ *                                                 VvasLogLevel loglevel)
+ *  @param [in] inferframe_dur - Duration of the infer frame.                                                  
+ *  @param [in] infer_queue_size  - Represents Max infer frame queue size.
+ *  @param [in] loglevel - indicates log level
+ *  @return On Sucess returns handle of Metaaffixer handle
+ *          On Failure returns NULL
+ *  @brief  this function will allocate internal resources and  
+ *          return the handle for a single stream.
+ */
+VvasMetaAffixer *
+vvas_metaaffixer_create (uint64_t inferframe_dur,
+    uint32_t infer_queue_size, VvasLogLevel loglevel)
+{
+  return vvas_metaaffixer_create_multistream (inferframe_dur,
+      infer_queue_size, 1, loglevel);
+}
+
 /**
  *  @fn void vvas_metaaffixer_destroy(VvasMetaAffixer* handle)
  *  @param [in] handle - MetaAffixer handle to be destroyed 
@@ -474,12 +1288,15 @@ void
 vvas_metaaffixer_destroy (VvasMetaAffixer * handle)
 {
   VvasMetaAffixerInfo *pHandle = (VvasMetaAffixerInfo *) handle;
+  uint32_t i;
 
   if (NULL != pHandle) {
 
-    vvas_hash_table_foreach_remove (pHandle->map,
-        vvas_metaaffixer_mapdata_remove_foreach, NULL);
-    vvas_hash_table_destroy (pHandle->map);
+    for (i = 0; i < pHandle->max_streams; i++) {
+      vvas_metaaffixer_stream_free (pHandle,
+          atomic_load (&pHandle->streams[i]));
+    }
+    free (pHandle->streams);
 
     free (pHandle);
   } else {
@@ -488,25 +1305,33 @@ vvas_metaaffixer_destroy (VvasMetaAffixer * handle)
 }
 
 /**
- *  @fn  VvasReturnType vvas_metaaffixer_submit_infer_meta(VvasMetaAffixer *handle,
- *                                                         VvasVideoInfo *vinfo,
- *                                                         VvasMetadata *metadata,      
- *                                                         VvasInferPrediction *infer)
+ *  @fn  VvasReturnType vvas_metaaffixer_submit_stream_infer_meta(VvasMetaAffixer *handle,
+ *                                                                uint32_t stream_id,
+ *                                                                VvasVideoInfo *vinfo,
+ *                                                                VvasMetadata *metadata,      
+ *                                                                VvasInferPrediction *infer)
  *  @param [in] handle - context handle
+ *  @param [in] stream_id - ID of the stream infer metadata belongs to
  *  @param [in] metadata - metadata of frame
  *  @param [in] vinfo  - address of frame info
  *  @param [in] infer - infer metadata associated with infer frame
  *  
  *  @return On Sucess returns VVAS_RET_SUCCESS\n
  *          On Failure returns VVAS_RET_ERROR
- *  @brief  this function will submit meta data information into Queue 
+ *  @brief  this function will submit meta data information into Queue of
+ *          the stream. Submissions to a stream are serialised, submissions
+ *          to different streams and lookups do not block each other.
  */
 VvasReturnType
-vvas_metaaffixer_submit_infer_meta (VvasMetaAffixer * handle,
-    VvasVideoInfo * vinfo, VvasMetadata * metadata, VvasInferPrediction * infer)
+vvas_metaaffixer_submit_stream_infer_meta (VvasMetaAffixer * handle,
+    uint32_t stream_id, VvasVideoInfo * vinfo, VvasMetadata * metadata,
+    VvasInferPrediction * infer)
 {
   VvasReturnType ret = VVAS_RET_SUCCESS;
   VvasMetaAffixerInfo *pHandle = (VvasMetaAffixerInfo *) handle;
+  VvasMetaAffixerStream *stream = NULL;
+  VvasMetaAffixerMapData *evicted = NULL;
+  uint32_t seq;
 
   if ((NULL == pHandle) ||
       (NULL == metadata) || (NULL == vinfo) || (NULL == infer)) {
@@ -514,13 +1339,12 @@ vvas_metaaffixer_submit_infer_meta (VvasMetaAffixer * handle,
     return VVAS_RET_ERROR;
   }
 
-  uint32_t size = vvas_hash_table_size (pHandle->map);
-
-  if (size >= pHandle->max_infer_size) {
-    vvas_metaaffixer_remove_infer_meta (pHandle);
+  stream = vvas_metaaffixer_get_stream (pHandle, stream_id, TRUE);
+  if (NULL == stream) {
+    return VVAS_RET_ERROR;
   }
 
-  size = sizeof (VvasMetaAffixerMapData);
+  uint32_t size = sizeof (VvasMetaAffixerMapData);
   VvasMetaAffixerMapData *map = (VvasMetaAffixerMapData *) calloc (1, size);
 
   if (NULL != map) {
@@ -530,18 +1354,59 @@ vvas_metaaffixer_submit_infer_meta (VvasMetaAffixer * handle,
     map->width = vinfo->width;
     map->meta = vvas_inferprediction_copy (infer);
     get_sequence_id (map);
-    vvas_hash_table_insert (pHandle->map, &map->pts, map);
 
-    pHandle->cur_pts = (uint64_t *) & map->pts;
+    vvas_mutex_lock (&stream->wlock);
+
+    /* enter seqlock write section */
+    seq = atomic_load_explicit (&stream->seq, memory_order_relaxed);
+    atomic_store_explicit (&stream->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence (memory_order_release);
+
+    if (atomic_load_explicit (&stream->count, memory_order_relaxed) >=
+        pHandle->max_infer_size) {
+      evicted = vvas_metaaffixer_remove_infer_meta (pHandle, stream);
+    }
+    vvas_metaaffixer_ring_insert (pHandle, stream, map);
+    atomic_store (&stream->cur, map);
+
+    atomic_store_explicit (&stream->seq, seq + 2, memory_order_release);
+
+    if (evicted) {
+      vvas_metaaffixer_retire (stream, evicted);
+    }
+
+    vvas_mutex_unlock (&stream->wlock);
     ret = VVAS_RET_SUCCESS;
   }
 
   return ret;
 }
 
+/**
+ *  @fn  VvasReturnType vvas_metaaffixer_submit_infer_meta(VvasMetaAffixer *handle,
+ *                                                         VvasVideoInfo *vinfo,
+ *                                                         VvasMetadata *metadata,      
+ *                                                         VvasInferPrediction *infer)
+ *  @param [in] handle - context handle
+ *  @param [in] metadata - metadata of frame
+ *  @param [in] vinfo  - address of frame info
+ *  @param [in] infer - infer metadata associated with infer frame
+ *  
+ *  @return On Sucess returns VVAS_RET_SUCCESS\n
+ *          On Failure returns VVAS_RET_ERROR
+ *  @brief  this function will submit meta data information into Queue of
+ *          stream 0.
+ */
+VvasReturnType
+vvas_metaaffixer_submit_infer_meta (VvasMetaAffixer * handle,
+    VvasVideoInfo * vinfo, VvasMetadata * metadata, VvasInferPrediction * infer)
+{
+  return vvas_metaaffixer_submit_stream_infer_meta (handle, 0, vinfo,
+      metadata, infer);
+}
 
 /**
- *  @fn  VvasReturnType vvas_metaaffixer_get_frame_meta(VvasMetaAffixer handle,
+ *  @fn  VvasReturnType vvas_metaaffixer_get_stream_frame_meta(VvasMetaAffixer handle,
  *                                                   uint32_t stream_id,
  *                                                   bool sync_pts,
  *                                                   VvasVideoInfo *vinfo,                                         
@@ -549,6 +1414,7 @@ vvas_metaaffixer_submit_infer_meta (VvasMetaAffixer * handle,
  *                                                   VvasMetaAffixerRespCode  *respcode,
  *                                                   VvasInferPrediction *ScaledMetadata)
  *  @param [in] handle -  Address of context handle 
+ *  @param [in] stream_id - ID of the stream input frame belongs to
  *  @param [in] sync_pts - if FALSE then last received infer meta data
  *                               is used for scaling else reference infer metadata is 
  *                               chosen cored on PTS of input frame.
@@ -559,10 +1425,14 @@ vvas_metaaffixer_submit_infer_meta (VvasMetaAffixer * handle,
  *  
  *  @return  On Success returns VVAS_RET_SUCCESS\n 
  *           On Failure returns VVAS_RET_ERROR_* 
- *  @brief This function returns scaled metadata cored on input frame info
+ *  @brief This function returns scaled metadata cored on input frame info.
+ *         It does not take any lock and can run concurrently with
+ *         submissions and other lookups. Unless interpolated, returned tree
+ *         is a reference to the cached scaled tree and is read only.
  */
 VvasReturnType
-vvas_metaaffixer_get_frame_meta (VvasMetaAffixer * handle,
+vvas_metaaffixer_get_stream_frame_meta (VvasMetaAffixer * handle,
+    uint32_t stream_id,
     bool sync_pts,
     VvasVideoInfo * vinfo,
     VvasMetadata * metadata,
@@ -570,70 +1440,237 @@ vvas_metaaffixer_get_frame_meta (VvasMetaAffixer * handle,
 {
   VvasReturnType ret = VVAS_RET_ERROR;
   VvasMetaAffixerInfo *pHandle = (VvasMetaAffixerInfo *) handle;
+  VvasMetaAffixerStream *stream = NULL;
+  VvasMetaAffixerMapData *mp = NULL;
+  uint32_t epoch = 0;
 
-  if ((NULL == pHandle) ||
+  if ((NULL == pHandle) || (NULL == respcode) ||
       (NULL == metadata) || (NULL == ScaledMetaData) || (NULL == vinfo)) {
     LOG_MESSAGE (LOG_LEVEL_ERROR, DEFAULT_LOG_LEVEL,  "Invalid arguments");
     return ret;
   }
 
-  *respcode = VVAS_METAAFFIXER_PASS;
+  stream = vvas_metaaffixer_get_stream (pHandle, stream_id, FALSE);
+  if (stream) {
+    epoch = vvas_metaaffixer_reader_enter (stream);
+  }
 
-  if (!sync_pts) {
+  if (sync_pts && stream &&
+      (VVAS_METAAFFIXER_INTERPOLATION_LINEAR == pHandle->interpolation)) {
+    *ScaledMetaData = vvas_metaaffixer_get_interpolated_meta (pHandle, stream,
+        vinfo, metadata);
+    if (NULL != *ScaledMetaData) {
+      *respcode = VVAS_METAAFFIXER_PASS;
+      vvas_metaaffixer_reader_exit (stream, epoch);
+      return VVAS_RET_SUCCESS;
+    }
+  }
 
-    /* sync PTS with last infer frame meta data */
-    pHandle->near_pts = pHandle->cur_pts;
+  mp = vvas_metaaffixer_get_near_frame (pHandle, stream, sync_pts, metadata,
+      respcode);
 
-  } else {
-    vvas_metaaffixer_get_inferframe_pts (pHandle, vinfo, metadata);
+  if (NULL != mp) {
+    VvasMetaAffixerSharedMeta *shared;
+
+    /* hand out the cached tree, caller reference is dropped by
+     * vvas_inferprediction_free () */
+    shared = vvas_metaaffixer_get_cached_meta (pHandle, mp, vinfo);
+    if ((NULL != shared) && (NULL != shared->meta)) {
+      *ScaledMetaData = vvas_inferprediction_ref (shared->meta);
+      ret = VVAS_RET_SUCCESS;
+    }
+    vvas_metaaffixer_shared_meta_unref (shared);
+  } else if (VVAS_METAAFFIXER_NO_FRAME_OVERLAP == *respcode) {
+    ret = VVAS_RET_SUCCESS;
+  }
 
-    if (NULL == pHandle->near_pts) {
+  if (stream) {
+    vvas_metaaffixer_reader_exit (stream, epoch);
+  }
 
-      LOG_D ("No Frame Overlap");
+  return ret;
+}
 
-      /* No overlap found */
-      *respcode = VVAS_METAAFFIXER_NO_FRAME_OVERLAP;
+/**
+ *  @fn  VvasReturnType vvas_metaaffixer_get_shared_frame_meta(VvasMetaAffixer handle,
+ *                                                   uint32_t stream_id,
+ *                                                   bool sync_pts,
+ *                                                   VvasVideoInfo *vinfo,
+ *                                                   VvasMetadata *metadata,
+ *                                                   VvasMetaAffixerRespCode  *respcode,
+ *                                                   VvasMetaAffixerSharedMeta **SharedMetaData)
+ *  @param [in] handle -  Address of context handle
+ *  @param [in] stream_id - ID of the stream input frame belongs to
+ *  @param [in] sync_pts - if FALSE then last received infer meta data
+ *                               is used for scaling else reference infer metadata is
+ *                               chosen cored on PTS of input frame.
+ *  @param [in] vinfo - Input Frame Information
+ *  @param [in] metadata - metadata of input frame
+ *  @param [out] respcode - metaaffixer response code.
+ *  @param [out] SharedMetaData - Reference to scaled meta data is udpated here.
+ *
+ *  @return  On Success returns VVAS_RET_SUCCESS\n
+ *           On Failure returns VVAS_RET_ERROR_*
+ *  @brief This function returns a reference to scaled metadata which is
+ *         shared by all input frames of same resolution that match the same
+ *         infer frame, metadata is only copied and scaled for first of them.
+ */
+VvasReturnType
+vvas_metaaffixer_get_shared_frame_meta (VvasMetaAffixer * handle,
+    uint32_t stream_id,
+    bool sync_pts,
+    VvasVideoInfo * vinfo,
+    VvasMetadata * metadata,
+    VvasMetaAffixerRespCode * respcode,
+    VvasMetaAffixerSharedMeta ** SharedMetaData)
+{
+  VvasReturnType ret = VVAS_RET_ERROR;
+  VvasMetaAffixerInfo *pHandle = (VvasMetaAffixerInfo *) handle;
+  VvasMetaAffixerStream *stream = NULL;
+  VvasMetaAffixerMapData *mp = NULL;
+  uint32_t epoch = 0;
 
-      return VVAS_RET_SUCCESS;
-    }
+  if ((NULL == pHandle) || (NULL == respcode) ||
+      (NULL == metadata) || (NULL == SharedMetaData) || (NULL == vinfo)) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, DEFAULT_LOG_LEVEL,  "Invalid arguments");
+    return ret;
   }
 
-  if (NULL != pHandle->near_pts) {
+  stream = vvas_metaaffixer_get_stream (pHandle, stream_id, FALSE);
+  if (stream) {
+    epoch = vvas_metaaffixer_reader_enter (stream);
+  }
 
-    LOG_D ("PTS: %ld", *pHandle->near_pts);
-    VvasMetaAffixerMapData *mp = (VvasMetaAffixerMapData *)
-        vvas_hash_table_lookup (pHandle->map, pHandle->near_pts);
-    if (NULL == mp) {
-      LOG_E ("Null received from table lookup");
+  if (sync_pts && stream &&
+      (VVAS_METAAFFIXER_INTERPOLATION_LINEAR == pHandle->interpolation)) {
+    VvasInferPrediction *interp = vvas_metaaffixer_get_interpolated_meta
+        (pHandle, stream, vinfo, metadata);
+
+    if (NULL != interp) {
+      /* interpolated metadata is specific to input frame, not cached */
+      VvasMetaAffixerSharedMeta *shared = (VvasMetaAffixerSharedMeta *)
+          calloc (1, sizeof (VvasMetaAffixerSharedMeta));
+      if (NULL != shared) {
+        shared->width = vinfo->width;
+        shared->height = vinfo->height;
+        shared->meta = interp;
+        atomic_init (&shared->ref_count, 1);
+        *SharedMetaData = shared;
+        *respcode = VVAS_METAAFFIXER_PASS;
+        ret = VVAS_RET_SUCCESS;
+      } else {
+        LOG_E ("failed to allocate scaled metadata");
+        vvas_inferprediction_free (interp);
+      }
+      vvas_metaaffixer_reader_exit (stream, epoch);
       return ret;
     }
+  }
 
-    VvasInferScaleFactor scl_factor;
-    memset (&scl_factor, 0x0, sizeof (scl_factor));
+  mp = vvas_metaaffixer_get_near_frame (pHandle, stream, sync_pts, metadata,
+      respcode);
 
-    /* Source frame height & width */
-    scl_factor.sh = mp->height;
-    scl_factor.sw = mp->width;
+  if (NULL != mp) {
+    *SharedMetaData = vvas_metaaffixer_get_cached_meta (pHandle, mp, vinfo);
+    if (NULL != *SharedMetaData) {
+      ret = VVAS_RET_SUCCESS;
+    }
+  } else if (VVAS_METAAFFIXER_NO_FRAME_OVERLAP == *respcode) {
+    ret = VVAS_RET_SUCCESS;
+  }
 
-    /* destination frame height and width */
-    scl_factor.dh = vinfo->height;
-    scl_factor.dw = vinfo->width;
+  if (stream) {
+    vvas_metaaffixer_reader_exit (stream, epoch);
+  }
 
-    /* Compute scale factor */
-    vvas_metaaffixer_compute_scale_factor (&scl_factor);
-    *ScaledMetaData =
-        vvas_metaaffixer_get_scaled_meta (mp->meta, &scl_factor, pHandle);
+  return ret;
+}
 
-    /* 
-       LOG_I("x=%d,y=%d, w=%d, h=%d", *ScaledMetaData->bbox.x, *ScaledMetaData->bbox.y,
-       *ScaledMetaData->bbox.width,  *ScaledMetaData->bbox.height);
-     */
+/**
+ *  @fn  const VvasInferPrediction * vvas_metaaffixer_shared_meta_get (VvasMetaAffixerSharedMeta * shared)
+ *  @param [in] shared - Reference to scaled metadata.
+ *  @return Scaled metadata, NULL if @shared is NULL.
+ *  @brief This function returns read only scaled metadata of the reference.
+ */
+const VvasInferPrediction *
+vvas_metaaffixer_shared_meta_get (VvasMetaAffixerSharedMeta * shared)
+{
+  return shared ? shared->meta : NULL;
+}
 
-    ret = VVAS_RET_SUCCESS;
-  } else {
-    LOG_E ("Near PTS is NULL ");
-    *respcode = VVAS_METAAFFIXER_NULL_VALUE;
+/**
+ *  @fn  void vvas_metaaffixer_shared_meta_unref (VvasMetaAffixerSharedMeta * shared)
+ *  @param [in] shared - Reference to scaled metadata, can be NULL.
+ *  @return None
+ *  @brief This function drops a reference to scaled metadata, it is freed
+ *         when the last reference is dropped.
+ */
+void
+vvas_metaaffixer_shared_meta_unref (VvasMetaAffixerSharedMeta * shared)
+{
+  if ((NULL != shared) && (1 == atomic_fetch_sub (&shared->ref_count, 1))) {
+    vvas_inferprediction_free (shared->meta);
+    free (shared);
   }
+}
 
-  return ret;
+/**
+ *  @fn  VvasReturnType vvas_metaaffixer_set_interpolation (VvasMetaAffixer * handle,
+ *                                                         VvasMetaAffixerInterpolation mode,
+ *                                                         float iou_threshold)
+ *  @param [in] handle - Address of context handle
+ *  @param [in] mode - Interpolation mode for PTS synchronised lookups.
+ *  @param [in] iou_threshold - Minimum IoU for matching objects which do not
+ *                              have tracker ID, in range 0 to 1.
+ *  @return  On Success returns VVAS_RET_SUCCESS\n
+ *           On Failure returns VVAS_RET_INVALID_ARGS
+ *  @brief This function configures interpolation of boxes between infer frames.
+ */
+VvasReturnType
+vvas_metaaffixer_set_interpolation (VvasMetaAffixer * handle,
+    VvasMetaAffixerInterpolation mode, float iou_threshold)
+{
+  VvasMetaAffixerInfo *pHandle = (VvasMetaAffixerInfo *) handle;
+
+  if ((NULL == pHandle) || (iou_threshold < 0.0f) || (iou_threshold > 1.0f)) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, DEFAULT_LOG_LEVEL,  "Invalid arguments");
+    return VVAS_RET_INVALID_ARGS;
+  }
+
+  pHandle->interpolation = mode;
+  pHandle->interp_iou_threshold = iou_threshold;
+
+  return VVAS_RET_SUCCESS;
+}
+
+/**
+ *  @fn  VvasReturnType vvas_metaaffixer_get_frame_meta(VvasMetaAffixer handle,
+ *                                                   bool sync_pts,
+ *                                                   VvasVideoInfo *vinfo,                                         
+ *                                                   VvasMetadata *metadata,
+ *                                                   VvasMetaAffixerRespCode  *respcode,
+ *                                                   VvasInferPrediction *ScaledMetadata)
+ *  @param [in] handle -  Address of context handle 
+ *  @param [in] sync_pts - if FALSE then last received infer meta data
+ *                               is used for scaling else reference infer metadata is 
+ *                               chosen cored on PTS of input frame.
+ *  @param [in] vinfo - Input Frame Information
+ *  @param [in] metadata - metadata of input frame
+ *  @param [out] respcode - metaaffixer response code.
+ *  @param [out] ScaledMetaData - Scaled meta data is udpated here.
+ *  
+ *  @return  On Success returns VVAS_RET_SUCCESS\n 
+ *           On Failure returns VVAS_RET_ERROR_* 
+ *  @brief This function returns scaled metadata of stream 0 cored on input
+ *         frame info
+ */
+VvasReturnType
+vvas_metaaffixer_get_frame_meta (VvasMetaAffixer * handle,
+    bool sync_pts,
+    VvasVideoInfo * vinfo,
+    VvasMetadata * metadata,
+    VvasMetaAffixerRespCode * respcode, VvasInferPrediction ** ScaledMetaData)
+{
+  return vvas_metaaffixer_get_stream_frame_meta (handle, 0, sync_pts, vinfo,
+      metadata, respcode, ScaledMetaData);
 }
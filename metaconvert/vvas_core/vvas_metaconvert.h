@@ -117,6 +117,37 @@ VvasMetaConvert *vvas_metaconvert_create (VvasContext *vvas_ctx, VvasMetaConvert
  */
 VvasReturnType vvas_metaconvert_prepare_overlay_metadata (VvasMetaConvert *meta_convert, VvasTreeNode *parent, VvasOverlayShapeInfo *shape_info);
 
+/**
+ * vvas_metaconvert_prepare_overlay_batch() - Converts Inference prediction tree to shapes stored in a shape batch
+ * @meta_convert: Handle to VVAS Meta convert
+ * @parent: Handle to parent node of Inference prediction tree
+ * @batch: Handle to shape batch to which shapes are appended. Caller is expected to reset the batch
+ *         with vvas_overlay_shape_batch_reset() for every frame and reuse it, so that steady state
+ *         conversion does not allocate memory
+ *
+ * Return: &enum VvasReturnType
+ */
+VvasReturnType vvas_metaconvert_prepare_overlay_batch (VvasMetaConvert *meta_convert, VvasTreeNode *parent, VvasOverlayShapeBatch *batch);
+
+/**
+ * vvas_metaconvert_prepare_overlay_batch_incremental() - Converts Inference prediction tree to shapes
+ *                                                        reusing shapes of unchanged nodes
+ * @meta_convert: Handle to VVAS Meta convert
+ * @parent: Handle to parent node of Inference prediction tree
+ * @batch: Handle to shape batch to which shapes are appended, same as in
+ *         vvas_metaconvert_prepare_overlay_batch()
+ * @changed: Set to false when shapes appended to @batch are same as in previous call, may be NULL
+ *
+ * Inputs of each node deciding its shapes (bounding box, classifications, tracker id, model class
+ * and model specific data) are hashed. Shapes of a node whose hash matches a node of previous call
+ * on @meta_convert are copied from previous call instead of being converted again, so only new or
+ * modified nodes are converted. Shapes are same as the ones prepared by
+ * vvas_metaconvert_prepare_overlay_batch().
+ *
+ * Return: &enum VvasReturnType
+ */
+VvasReturnType vvas_metaconvert_prepare_overlay_batch_incremental (VvasMetaConvert *meta_convert, VvasTreeNode *parent, VvasOverlayShapeBatch *batch, bool *changed);
+
 /**
  * vvas_metaconvert_destroy() - Destorys &struct VvasMetaConvert handle
  * @meta_convert: Handle to VVAS Meta convert
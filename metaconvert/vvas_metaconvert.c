@@ -18,9 +18,135 @@
 #include <vvas_core/vvas_metaconvert.h>
 #include <vvas_core/vvas_infer_prediction.h>
 #include <vvas_core/vvas_infer_classification.h>
+#include <stddef.h>
 
 #define NEED_TEXT_BG_COLOR 1    /* Text will have backgroup color */
 #define MAX_LABEL_LEN 1024
+#define LABEL_BUF_MIN_SIZE 256
+#define NODE_CACHE_MIN_SIZE 64
+
+/* FNV-1a parameters used for hashing node inputs in incremental mode */
+#define NODE_HASH_OFFSET 14695981039346656037ULL
+#define NODE_HASH_PRIME 1099511628211ULL
+
+/* Separators used while composing a label from more than one field */
+#define CLASS_LABEL_SEPARATOR " : "
+#define TRACKER_ID_SEPARATOR " : tid - "
+#define PROBABILITY_SEPARATOR " : prob - "
+
+/**
+ * enum VvasMetaConvertLabelOp - Operations of label format program compiled
+ *                               from allowed_labels configuration
+ * @VVAS_LABEL_OP_CLASS: Append first class name of the classification
+ * @VVAS_LABEL_OP_TRACKER_ID: Append tracker id of the prediction
+ * @VVAS_LABEL_OP_PROBABILITY: Append probability of the classification
+ */
+typedef enum
+{
+  VVAS_LABEL_OP_CLASS,
+  VVAS_LABEL_OP_TRACKER_ID,
+  VVAS_LABEL_OP_PROBABILITY,
+} VvasMetaConvertLabelOp;
+
+/**
+ * struct VvasMetaConvertLabelBuf - Reusable buffer in which label is composed
+ * @str: Label string
+ * @len: Length of the label string
+ * @size: Allocated size of @str
+ */
+typedef struct
+{
+  char *str;
+  uint32_t len;
+  uint32_t size;
+} VvasMetaConvertLabelBuf;
+
+/**
+ * struct VvasMetaConvertClassStyle - Style resolved for an allowed class
+ * @index: Index of the class in allowed_classes configuration
+ * @color: Color to be used for objects of this class
+ * @do_mask: If set, objects of this class are masked
+ */
+typedef struct
+{
+  int32_t index;
+  VvasRGBColor color;
+  uint8_t do_mask;
+} VvasMetaConvertClassStyle;
+
+/**
+ * struct VvasMetaConvertShapeMark - Number of shapes of each type in a shape batch
+ * @rects: Number of rectangles
+ * @text: Number of texts
+ * @lines: Number of lines
+ * @arrows: Number of arrows
+ * @circles: Number of circles
+ * @polys: Number of polygons
+ * @masks: Number of masks
+ */
+typedef struct
+{
+  uint32_t rects;
+  uint32_t text;
+  uint32_t lines;
+  uint32_t arrows;
+  uint32_t circles;
+  uint32_t polys;
+  uint32_t masks;
+} VvasMetaConvertShapeMark;
+
+/**
+ * struct VvasMetaConvertNodeCache - Shapes converted from a node in incremental mode
+ * @hash: Hash of the node inputs which decide its shapes
+ * @pre_start: Start of the shapes added before children of the node are converted
+ * @pre_end: End of the shapes added before children of the node are converted
+ * @post_start: Start of the shapes added after children of the node are converted
+ * @post_end: End of the shapes added after children of the node are converted
+ * @dirty: Whether shapes of the node are not yet at the same position in
+ *         cached shapes, set for converted nodes and moved reused nodes
+ * @reusable: Whether shapes of the node may be reused in next call. Masks
+ *            refer to buffers which are not copied, so nodes with masks are
+ *            always converted again
+ */
+typedef struct
+{
+  uint64_t hash;
+  VvasMetaConvertShapeMark pre_start;
+  VvasMetaConvertShapeMark pre_end;
+  VvasMetaConvertShapeMark post_start;
+  VvasMetaConvertShapeMark post_end;
+  bool dirty;
+  bool reusable;
+} VvasMetaConvertNodeCache;
+
+/**
+ * struct VvasMetaConvertCache - State of incremental conversion
+ * @shapes: Shapes prepared in previous call, node records index into this batch
+ * @prev: Node records of previous call
+ * @prev_count: Number of records in @prev
+ * @prev_size: Allocated number of records in @prev
+ * @cur: Node records of ongoing call
+ * @cur_count: Number of records in @cur
+ * @cur_size: Allocated number of records in @cur
+ * @index: Open addressing table of @prev indices plus one, keyed on node hash
+ * @index_size: Number of slots in @index, power of 2
+ * @converted: Number of nodes converted in ongoing call
+ * @in_order: Whether all reused nodes of ongoing call are at their previous position
+ */
+typedef struct
+{
+  VvasOverlayShapeBatch shapes;
+  VvasMetaConvertNodeCache *prev;
+  uint32_t prev_count;
+  uint32_t prev_size;
+  VvasMetaConvertNodeCache *cur;
+  uint32_t cur_count;
+  uint32_t cur_size;
+  uint32_t *index;
+  uint32_t index_size;
+  uint32_t converted;
+  bool in_order;
+} VvasMetaConvertCache;
 
 typedef struct
 {
@@ -34,10 +160,16 @@ typedef struct
   uint8_t mask_tree_level;
   uint32_t y_offset;
   bool draw_above_bbox_flag;
-  char **allowed_labels;
-  uint32_t allowed_labels_count;
+  VvasMetaConvertLabelOp *label_ops;
+  uint32_t label_ops_count;
+  VvasMetaConvertLabelBuf *label_bufs;
+  uint32_t label_bufs_count;
   VvasFilterObjectInfo **allowed_classes;
   uint32_t allowed_classes_count;
+  VvasMetaConvertClassStyle *class_styles;
+  VvasHashTable *class_table;
+  VvasOverlayShapeBatch shape_batch;
+  VvasMetaConvertCache cache;
 } VvasMetaConvertPriv;
 
 bool vvas_metaconvert_consider_child (VvasMetaConvert * meta_convert,
@@ -47,428 +179,347 @@ int vvas_metaconvert_set_color_for_allowed_classes (VvasMetaConvertPriv * priv,
     VvasInferClassification * classification, uint8_t * do_mask,
     VvasRGBColor * clr);
 
-static inline char *
-append_string (const char *str1, const char *str2)
+/**
+ *  @fn static bool label_buf_append (VvasMetaConvertLabelBuf * buf,
+ *                                    const char *str, uint32_t len)
+ *  @param [inout] buf - Label buffer
+ *  @param [in] str - String to be appended
+ *  @param [in] len - Length of @str
+ *  @return TRUE on success
+ *          FALSE on allocation failure
+ *  @brief Appends string to label buffer, growing the buffer when required.
+ *         Buffer keeps its size across frames, so steady scenes do not allocate.
+ */
+static bool
+label_buf_append (VvasMetaConvertLabelBuf * buf, const char *str, uint32_t len)
 {
-  uint32_t new_size = strlen (str1) + strlen (str2) + 1;
-  char *new_str = NULL;
+  if (buf->len + len + 1 > buf->size) {
+    uint32_t new_size = buf->size ? buf->size : LABEL_BUF_MIN_SIZE;
+    char *new_str;
 
-  new_str = (char *) malloc (new_size);
-  if (!new_str) {
-    return NULL;
+    while (buf->len + len + 1 > new_size)
+      new_size <<= 1;
+
+    new_str = (char *) realloc (buf->str, new_size);
+    if (!new_str)
+      return FALSE;
+
+    buf->str = new_str;
+    buf->size = new_size;
   }
 
-  strcpy (new_str, str1);
-  strcpy (new_str + strlen (str1), str2);
-  new_str[new_size - 1] = '\0';
-  return new_str;
+  memcpy (buf->str + buf->len, str, len);
+  buf->len += len;
+  buf->str[buf->len] = '\0';
+  return TRUE;
 }
 
-static char *
-prepare_label_string (VvasMetaConvertPriv * priv,
-    VvasInferPrediction * prediction, VvasInferClassification * classification)
+/**
+ *  @fn static void label_buf_truncate (VvasMetaConvertLabelBuf * buf, uint32_t len)
+ *  @param [inout] buf - Label buffer
+ *  @param [in] len - New length of the label
+ *  @return None
+ *  @brief Truncates label buffer to @len bytes.
+ */
+static void
+label_buf_truncate (VvasMetaConvertLabelBuf * buf, uint32_t len)
 {
-  int idx;
-  char *cur_label_string = NULL;
+  buf->len = len;
+  if (buf->str)
+    buf->str[len] = '\0';
+}
 
-  for (idx = 0; idx < priv->allowed_labels_count; idx++) {
-    if (classification->class_label &&
-        !strcmp (priv->allowed_labels[idx], "class")) {
-      char *first_label = NULL;
-      char *save_ptr = NULL;
+/**
+ *  @fn static VvasMetaConvertLabelBuf *get_label_buf (VvasMetaConvertPriv * priv,
+ *                                                     uint32_t depth)
+ *  @param [in] priv - Meta convert private handler
+ *  @param [in] depth - Depth of the node for which label is composed
+ *  @return Empty label buffer on success
+ *          NULL on allocation failure
+ *  @brief Returns label buffer for the given tree depth. Labels of parent nodes
+ *         are still being composed while children are converted, hence one
+ *         buffer is kept per depth.
+ */
+static VvasMetaConvertLabelBuf *
+get_label_buf (VvasMetaConvertPriv * priv, uint32_t depth)
+{
+  VvasMetaConvertLabelBuf *buf;
 
-      first_label = strtok_r (classification->class_label, ",", &save_ptr);
-      if (!first_label)
-        continue;
+  if (depth >= priv->label_bufs_count) {
+    VvasMetaConvertLabelBuf *bufs;
+
+    bufs = (VvasMetaConvertLabelBuf *) realloc (priv->label_bufs,
+        (depth + 1) * sizeof (VvasMetaConvertLabelBuf));
+    if (!bufs)
+      return NULL;
 
-      if (!cur_label_string)
-        cur_label_string = strdup (first_label);
-      else {
-        char *tmp_str;
+    memset (bufs + priv->label_bufs_count, 0x0,
+        (depth + 1 - priv->label_bufs_count) *
+        sizeof (VvasMetaConvertLabelBuf));
+    priv->label_bufs = bufs;
+    priv->label_bufs_count = depth + 1;
+  }
 
-        tmp_str = append_string (cur_label_string, " : ");
-        free (cur_label_string);
+  buf = &priv->label_bufs[depth];
+  label_buf_truncate (buf, 0);
+  return buf;
+}
 
-        cur_label_string = append_string (tmp_str, first_label);
-        free (tmp_str);
+/**
+ *  @fn static bool prepare_label_string (VvasMetaConvertPriv * priv,
+ *                                        VvasInferPrediction * prediction,
+ *                                        VvasInferClassification * classification,
+ *                                        VvasMetaConvertLabelBuf * buf)
+ *  @param [in] priv - Meta convert private handler
+ *  @param [in] prediction - Prediction to which classification belongs, may be NULL
+ *  @param [in] classification - Classification for which label is composed
+ *  @param [inout] buf - Label buffer to which composed label is appended
+ *  @return TRUE if any field of the label is composed
+ *          FALSE otherwise, @buf is left unchanged in this case
+ *  @brief Runs label format program compiled at create time on a classification.
+ *         Class label is not modified, only its first comma separated name is used.
+ */
+static bool
+prepare_label_string (VvasMetaConvertPriv * priv,
+    VvasInferPrediction * prediction, VvasInferClassification * classification,
+    VvasMetaConvertLabelBuf * buf)
+{
+  uint32_t start = buf->len;
+  bool composed = FALSE;
+  bool ok = TRUE;
+  uint32_t idx;
+
+  for (idx = 0; ok && idx < priv->label_ops_count; idx++) {
+    switch (priv->label_ops[idx]) {
+      case VVAS_LABEL_OP_CLASS:{
+        const char *first_label;
+        uint32_t len;
+
+        if (!classification->class_label)
+          break;
+
+        /* first non empty token, same as strtok_r with "," delimiter */
+        first_label = classification->class_label +
+            strspn (classification->class_label, ",");
+        len = strcspn (first_label, ",");
+        if (!len)
+          break;
+
+        if (composed)
+          ok = label_buf_append (buf, CLASS_LABEL_SEPARATOR,
+              strlen (CLASS_LABEL_SEPARATOR));
+        ok = ok && label_buf_append (buf, first_label, len);
+        composed = TRUE;
+        break;
       }
-    } else if (prediction && prediction->obj_track_label &&
-        !strcmp (priv->allowed_labels[idx], "tracker-id")) {
-      if (!cur_label_string)
-        cur_label_string = strdup (prediction->obj_track_label);
-      else {
-        char *tmp_str;
-
-        tmp_str = append_string (cur_label_string, " : tid - ");
-        free (cur_label_string);
-
-        cur_label_string = append_string (tmp_str, prediction->obj_track_label);
-        free (tmp_str);
+      case VVAS_LABEL_OP_TRACKER_ID:
+        if (!prediction || !prediction->obj_track_label)
+          break;
+
+        if (composed)
+          ok = label_buf_append (buf, TRACKER_ID_SEPARATOR,
+              strlen (TRACKER_ID_SEPARATOR));
+        ok = ok && label_buf_append (buf, prediction->obj_track_label,
+            strlen (prediction->obj_track_label));
+        composed = TRUE;
+        break;
+      case VVAS_LABEL_OP_PROBABILITY:{
+        char prob[128];
+        int len;
+
+        len = snprintf (prob, sizeof (prob), "%.2f",
+            classification->class_prob);
+        if (composed)
+          ok = label_buf_append (buf, PROBABILITY_SEPARATOR,
+              strlen (PROBABILITY_SEPARATOR));
+        ok = ok && label_buf_append (buf, prob, len);
+        composed = TRUE;
+        break;
       }
-    } else if (!strcmp (priv->allowed_labels[idx], "probability")) {
-      char prob[128] = { 0, };
+    }
+  }
 
-      snprintf (prob, 128, "%.2f", classification->class_prob);
+  if (!ok) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
+        "failed to allocate memory for label");
+    composed = FALSE;
+  }
 
-      if (!cur_label_string)
-        cur_label_string = strdup (prob);
-      else {
-        char *tmp_str;
+  if (!composed)
+    label_buf_truncate (buf, start);
 
-        tmp_str = append_string (cur_label_string, " : prob - ");
-        free (cur_label_string);
+  return composed;
+}
 
-        cur_label_string = append_string (tmp_str, prob);
-        free (tmp_str);
-      }
-    }
+/**
+ *  @fn static bool append_label_string (VvasMetaConvertPriv * priv,
+ *                                       VvasInferPrediction * prediction,
+ *                                       VvasInferClassification * classification,
+ *                                       VvasMetaConvertLabelBuf * buf,
+ *                                       bool has_label, const char *separator)
+ *  @param [in] priv - Meta convert private handler
+ *  @param [in] prediction - Prediction to which classification belongs, may be NULL
+ *  @param [in] classification - Classification for which label is composed
+ *  @param [inout] buf - Label buffer to which composed label is appended
+ *  @param [in] has_label - Whether @buf already holds a label
+ *  @param [in] separator - Separator to be added when @has_label is set
+ *  @return TRUE if label is composed
+ *          FALSE otherwise, @buf is left unchanged in this case
+ *  @brief Composes label of a classification in place after existing label.
+ */
+static bool
+append_label_string (VvasMetaConvertPriv * priv,
+    VvasInferPrediction * prediction, VvasInferClassification * classification,
+    VvasMetaConvertLabelBuf * buf, bool has_label, const char *separator)
+{
+  uint32_t start = buf->len;
+
+  if (has_label && !label_buf_append (buf, separator, strlen (separator))) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
+        "failed to allocate memory for label");
+    return FALSE;
   }
 
-  return cur_label_string;
+  if (!prepare_label_string (priv, prediction, classification, buf)) {
+    label_buf_truncate (buf, start);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Pairs of Pose14Pt points joined by a line, in drawing order */
+static const size_t pose_line_pts[][2] = {
+  {offsetof (Pose14Pt, right_shoulder), offsetof (Pose14Pt, right_elbow)},
+  {offsetof (Pose14Pt, right_elbow), offsetof (Pose14Pt, right_wrist)},
+  {offsetof (Pose14Pt, right_hip), offsetof (Pose14Pt, right_knee)},
+  {offsetof (Pose14Pt, right_knee), offsetof (Pose14Pt, right_ankle)},
+  {offsetof (Pose14Pt, left_shoulder), offsetof (Pose14Pt, left_elbow)},
+  {offsetof (Pose14Pt, left_elbow), offsetof (Pose14Pt, left_wrist)},
+  {offsetof (Pose14Pt, left_hip), offsetof (Pose14Pt, left_knee)},
+  {offsetof (Pose14Pt, left_knee), offsetof (Pose14Pt, left_ankle)},
+  {offsetof (Pose14Pt, head), offsetof (Pose14Pt, neck)},
+  {offsetof (Pose14Pt, right_shoulder), offsetof (Pose14Pt, neck)},
+  {offsetof (Pose14Pt, left_shoulder), offsetof (Pose14Pt, neck)},
+  {offsetof (Pose14Pt, right_shoulder), offsetof (Pose14Pt, right_hip)},
+  {offsetof (Pose14Pt, left_shoulder), offsetof (Pose14Pt, left_hip)},
+  {offsetof (Pose14Pt, right_hip), offsetof (Pose14Pt, left_hip)},
+};
+
+/**
+ *  @fn static void set_level_color (VvasOverlayColorData * color, int level)
+ *  @param [out] color - Color to be updated
+ *  @param [in] level - Inference level of the node
+ *  @return None
+ *  @brief Sets color used for landmark points and lines of given inference level
+ */
+static void
+set_level_color (VvasOverlayColorData * color, int level)
+{
+  if (level == 1) {
+    color->blue = 255;          /*blue */
+    color->green = 0;
+    color->red = 0;
+  } else if (level == 2) {
+    color->blue = 0;
+    color->green = 255;         /*green */
+    color->red = 0;
+  } else if (level == 3) {
+    color->blue = 0;
+    color->green = 0;
+    color->red = 255;           /*red */
+  } else {
+    color->blue = 225;
+    color->green = 225;
+    color->red = 0;             /*aqua */
+  }
 }
 
 static VvasReturnType
 convert_pose_detection_meta (VvasMetaConvertPriv * priv, VvasTreeNode * node,
-    VvasOverlayShapeInfo * shape_info)
+    VvasOverlayShapeBatch * batch)
 {
   VvasInferPrediction *prediction = (VvasInferPrediction *) node->data;
-  Pose14Pt *pose_ptr = &prediction->pose14pt;
+  const uint8_t *pose_ptr = (const uint8_t *) &prediction->pose14pt;
   Pointf *pt_ptr = (Pointf *) & prediction->pose14pt;
-  int num_circles = shape_info->num_circles;
-  int num_lines = shape_info->num_lines;
-  int num, idx;
+  int num;
   int level = vvas_treenode_get_depth (node) - 1;
-  VvasOverlayLineParams *line_params;
-  VvasList *head;
+  VvasOverlayCircleParams circle_params;
+  VvasOverlayLineParams line_params;
 
   LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level, "parsing pose detection meta");
 
   /* Add circles for each point */
+  memset (&circle_params, 0, sizeof (circle_params));
+  circle_params.radius = 3;
+  circle_params.thickness = 3;
+  set_level_color (&circle_params.circle_color, level);
+
   for (num = 0; num < sizeof (Pose14Pt) / sizeof (Pointf); num++) {
-    VvasOverlayCircleParams *circle_params =
-        (VvasOverlayCircleParams *) calloc (1,
-        sizeof (VvasOverlayCircleParams));
-    VvasOverlayColorData *circle_color = &(circle_params->circle_color);
-
-    circle_params->center_pt.x = pt_ptr->x;
-    circle_params->center_pt.y = pt_ptr->y;
-    circle_params->radius = 3;
-    circle_params->thickness = 3;
-    if (level == 1) {
-      circle_color->blue = 255; /*blue */
-      circle_color->green = 0;
-      circle_color->red = 0;
-    } else if (level == 2) {
-      circle_color->blue = 0;
-      circle_color->green = 255;        /*green */
-      circle_color->red = 0;
-    } else if (level == 3) {
-      circle_color->blue = 0;
-      circle_color->green = 0;
-      circle_color->red = 255;  /*red */
-    } else {
-      circle_color->blue = 225;
-      circle_color->green = 225;
-      circle_color->red = 0;    /*aqua */
-    }
+    circle_params.center_pt.x = pt_ptr->x;
+    circle_params.center_pt.y = pt_ptr->y;
 
-    /* append circle */
-    shape_info->circle_params =
-        vvas_list_append (shape_info->circle_params, circle_params);
-    num_circles++;
+    if (!vvas_overlay_shape_batch_add_circle (batch, &circle_params)) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
+          "failed to allocate memory");
+      return VVAS_RET_ALLOC_ERROR;
+    }
     pt_ptr++;
   }
-  shape_info->num_circles = num_circles;
 
   /* Add lines */
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->right_shoulder.x;
-  line_params->start_pt.y = pose_ptr->right_shoulder.y;
-  line_params->end_pt.x = pose_ptr->right_elbow.x;
-  line_params->end_pt.y = pose_ptr->right_elbow.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->right_elbow.x;
-  line_params->start_pt.y = pose_ptr->right_elbow.y;
-  line_params->end_pt.x = pose_ptr->right_wrist.x;
-  line_params->end_pt.y = pose_ptr->right_wrist.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->right_hip.x;
-  line_params->start_pt.y = pose_ptr->right_hip.y;
-  line_params->end_pt.x = pose_ptr->right_knee.x;
-  line_params->end_pt.y = pose_ptr->right_knee.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->right_knee.x;
-  line_params->start_pt.y = pose_ptr->right_knee.y;
-  line_params->end_pt.x = pose_ptr->right_ankle.x;
-  line_params->end_pt.y = pose_ptr->right_ankle.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->left_shoulder.x;
-  line_params->start_pt.y = pose_ptr->left_shoulder.y;
-  line_params->end_pt.x = pose_ptr->left_elbow.x;
-  line_params->end_pt.y = pose_ptr->left_elbow.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->left_elbow.x;
-  line_params->start_pt.y = pose_ptr->left_elbow.y;
-  line_params->end_pt.x = pose_ptr->left_wrist.x;
-  line_params->end_pt.y = pose_ptr->left_wrist.y;
-  line_params =
-      (VvasOverlayLineParams *) vvas_list_append (shape_info->line_params,
-      line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->left_hip.x;
-  line_params->start_pt.y = pose_ptr->left_hip.y;
-  line_params->end_pt.x = pose_ptr->left_knee.x;
-  line_params->end_pt.y = pose_ptr->left_knee.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->left_knee.x;
-  line_params->start_pt.y = pose_ptr->left_knee.y;
-  line_params->end_pt.x = pose_ptr->left_ankle.x;
-  line_params->end_pt.y = pose_ptr->left_ankle.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->head.x;
-  line_params->start_pt.y = pose_ptr->head.y;
-  line_params->end_pt.x = pose_ptr->neck.x;
-  line_params->end_pt.y = pose_ptr->neck.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->right_shoulder.x;
-  line_params->start_pt.y = pose_ptr->right_shoulder.y;
-  line_params->end_pt.x = pose_ptr->neck.x;
-  line_params->end_pt.y = pose_ptr->neck.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->left_shoulder.x;
-  line_params->start_pt.y = pose_ptr->left_shoulder.y;
-  line_params->end_pt.x = pose_ptr->neck.x;
-  line_params->end_pt.y = pose_ptr->neck.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->right_shoulder.x;
-  line_params->start_pt.y = pose_ptr->right_shoulder.y;
-  line_params->end_pt.x = pose_ptr->right_hip.x;
-  line_params->end_pt.y = pose_ptr->right_hip.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->left_shoulder.x;
-  line_params->start_pt.y = pose_ptr->left_shoulder.y;
-  line_params->end_pt.x = pose_ptr->left_hip.x;
-  line_params->end_pt.y = pose_ptr->left_hip.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  line_params =
-      (VvasOverlayLineParams *) calloc (1, sizeof (VvasOverlayLineParams));
-  if (!line_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-  line_params->start_pt.x = pose_ptr->right_hip.x;
-  line_params->start_pt.y = pose_ptr->right_hip.y;
-  line_params->end_pt.x = pose_ptr->left_hip.x;
-  line_params->end_pt.y = pose_ptr->left_hip.y;
-  shape_info->line_params =
-      vvas_list_append (shape_info->line_params, line_params);
-  num_lines++;
-
-  /* Add line colour in loop */
-  idx = 0;
-  head = shape_info->line_params;
-  /* Updating the head ptr to start of the newly predicted lines
-   * if already previous predicted lines are present */
-  while (shape_info->num_lines && idx != shape_info->num_lines && head) {
-    idx++;
-    head = head->next;
-  }
+  memset (&line_params, 0, sizeof (line_params));
+  line_params.thickness = 3;
+  set_level_color (&line_params.line_color, level);
 
-  for (num = shape_info->num_lines;
-      head
-      && num < ((sizeof (Pose14Pt) / sizeof (Pointf)) + shape_info->num_lines);
+  for (num = 0; num < sizeof (pose_line_pts) / sizeof (pose_line_pts[0]);
       num++) {
-    VvasOverlayColorData *line_color;
-    line_params = (VvasOverlayLineParams *) head->data;
-    line_color = &(line_params->line_color);
-
-    line_params->thickness = 3;
-    if (level == 1) {
-      line_color->blue = 255;   /*blue */
-      line_color->green = 0;
-      line_color->red = 0;
-    } else if (level == 2) {
-      line_color->blue = 0;
-      line_color->green = 255;  /*green */
-      line_color->red = 0;
-    } else if (level == 3) {
-      line_color->blue = 0;
-      line_color->green = 0;
-      line_color->red = 255;    /*red */
-    } else {
-      line_color->blue = 225;
-      line_color->green = 225;
-      line_color->red = 0;      /*aqua */
+    const Pointf *start = (const Pointf *) (pose_ptr + pose_line_pts[num][0]);
+    const Pointf *end = (const Pointf *) (pose_ptr + pose_line_pts[num][1]);
+
+    line_params.start_pt.x = start->x;
+    line_params.start_pt.y = start->y;
+    line_params.end_pt.x = end->x;
+    line_params.end_pt.y = end->y;
+
+    if (!vvas_overlay_shape_batch_add_line (batch, &line_params)) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
+          "failed to allocate memory");
+      return VVAS_RET_ALLOC_ERROR;
     }
-    head = head->next;
   }
 
-  shape_info->num_lines = num_lines;
   return VVAS_RET_SUCCESS;
 }
 
 static VvasReturnType
 convert_face_landmark_meta (VvasMetaConvertPriv * priv, VvasTreeNode * node,
-    VvasOverlayShapeInfo * shape_info)
+    VvasOverlayShapeBatch * batch)
 {
   VvasInferPrediction *prediction = (VvasInferPrediction *) node->data;
   int idx;
   int level = vvas_treenode_get_depth (node) - 1;
+  VvasOverlayCircleParams circle_params;
+
   LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level, "parsing pose detection meta");
 
+  memset (&circle_params, 0, sizeof (circle_params));
+  circle_params.radius = priv->radius;
+  circle_params.thickness = priv->line_thickness;
+  set_level_color (&circle_params.circle_color, level);
+
   /* Add circles for each point */
   for (idx = 0; idx < NUM_LANDMARK_POINT; idx++) {
     Pointf *pt_ptr = (Pointf *) & (prediction->feature.landmark[idx].x);
-    VvasOverlayCircleParams *circle_params =
-        (VvasOverlayCircleParams *) calloc (1,
-        sizeof (VvasOverlayCircleParams));
-    if (!circle_params) {
+
+    circle_params.center_pt.x = pt_ptr->x;
+    circle_params.center_pt.y = pt_ptr->y;
+
+    if (!vvas_overlay_shape_batch_add_circle (batch, &circle_params)) {
       LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
           "failed to allocate memory");
       return VVAS_RET_ALLOC_ERROR;
     }
-    VvasOverlayColorData *circle_color = &(circle_params->circle_color);
-
-    circle_params->center_pt.x = pt_ptr->x;
-    circle_params->center_pt.y = pt_ptr->y;
-    circle_params->radius = priv->radius;
-    circle_params->thickness = priv->line_thickness;
-
-    if (level == 1) {
-      circle_color->blue = 255; /*blue */
-      circle_color->green = 0;
-      circle_color->red = 0;
-    } else if (level == 2) {
-      circle_color->blue = 0;
-      circle_color->green = 255;        /*green */
-      circle_color->red = 0;
-    } else if (level == 3) {
-      circle_color->blue = 0;
-      circle_color->green = 0;
-      circle_color->red = 255;  /*red */
-    } else {
-      circle_color->blue = 225;
-      circle_color->green = 225;
-      circle_color->red = 0;    /*aqua */
-    }
-
-    shape_info->circle_params =
-        vvas_list_append (shape_info->circle_params, circle_params);
-    shape_info->num_circles++;
   }
 
   return VVAS_RET_SUCCESS;
@@ -476,45 +527,23 @@ convert_face_landmark_meta (VvasMetaConvertPriv * priv, VvasTreeNode * node,
 
 static VvasReturnType
 convert_road_line_meta (VvasMetaConvertPriv * priv, VvasTreeNode * node,
-    VvasOverlayShapeInfo * shape_info)
+    VvasOverlayShapeBatch * batch)
 {
   VvasInferPrediction *prediction = (VvasInferPrediction *) node->data;
   int idx;
   int type = prediction->feature.line_type;
   int line_size = prediction->feature.line_size;
-  VvasOverlayPolygonParams *polygn_params = NULL;
+  VvasOverlayPolygonParams polygn_params;
+  VvasOverlayPolygonParams *dest;
+  VvasOverlayCoordinates *poly_pts;
   VvasOverlayColorData *line_color = NULL;
 
   LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level, "parsing road line meta");
 
-  polygn_params =
-      (VvasOverlayPolygonParams *) calloc (1,
-      sizeof (VvasOverlayPolygonParams));
-  if (!polygn_params) {
-    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
-    return VVAS_RET_ALLOC_ERROR;
-  }
-
-  line_color = &(polygn_params->poly_color);
-
-  for (idx = 0; idx < line_size; idx++) {
-    Pointf *pt_ptr = (Pointf *) & (prediction->feature.road_line[idx].x);
-    VvasOverlayCoordinates *poly_pts =
-        (VvasOverlayCoordinates *) calloc (1, sizeof (VvasOverlayCoordinates));
-    if (!poly_pts) {
-      LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
-          "failed to allocate memory");
-      free (polygn_params);
-      return VVAS_RET_ALLOC_ERROR;
-    }
-    poly_pts->x = pt_ptr->x;
-    poly_pts->y = pt_ptr->y;
-    polygn_params->poly_pts =
-        vvas_list_append (polygn_params->poly_pts, poly_pts);
-  }
+  memset (&polygn_params, 0, sizeof (polygn_params));
+  line_color = &(polygn_params.poly_color);
 
-  polygn_params->thickness = 3;
-  polygn_params->num_pts = line_size;
+  polygn_params.thickness = 3;
   if (type == 0) {
     line_color->blue = 255;
     line_color->green = 255;
@@ -533,70 +562,522 @@ convert_road_line_meta (VvasMetaConvertPriv * priv, VvasTreeNode * node,
     line_color->red = 255;      /* red */
   }
 
-  shape_info->polygn_params =
-      vvas_list_append (shape_info->polygn_params, polygn_params);
-  shape_info->num_polys++;
+  if (line_size < 0)
+    line_size = 0;
+
+  /* reserve points of the polygon in the batch and fill them in place */
+  dest = vvas_overlay_shape_batch_add_polygon (batch, &polygn_params, NULL,
+      line_size);
+  if (!dest) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
+    return VVAS_RET_ALLOC_ERROR;
+  }
+
+  poly_pts = &batch->points[batch->poly_pt_offsets[batch->num_polys - 1]];
+  for (idx = 0; idx < line_size; idx++) {
+    Pointf *pt_ptr = (Pointf *) & (prediction->feature.road_line[idx].x);
+
+    poly_pts[idx].x = pt_ptr->x;
+    poly_pts[idx].y = pt_ptr->y;
+  }
+
   return VVAS_RET_SUCCESS;
 }
 
 static VvasReturnType
 convert_ultrafast_meta (VvasMetaConvertPriv * priv, VvasTreeNode * node,
-    VvasOverlayShapeInfo * shape_info)
+    VvasOverlayShapeBatch * batch)
 {
   VvasInferPrediction *prediction = (VvasInferPrediction *) node->data;
   int num;
   int level = prediction->feature.line_type;
   int line_size = prediction->feature.line_size;
+  VvasOverlayCircleParams circle_params;
+  VvasOverlayColorData *circle_color = &(circle_params.circle_color);
 
   LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level, "parsing ultrafast meta");
 
+  memset (&circle_params, 0, sizeof (circle_params));
+  circle_params.radius = priv->radius;
+  circle_params.thickness = priv->line_thickness;
+
+  if (level == 0) {
+    circle_color->blue = 255;
+    circle_color->green = 0;
+    circle_color->red = 0;      /* blue */
+  } else if (level == 1) {
+    circle_color->blue = 0;
+    circle_color->green = 255;  /* green */
+    circle_color->red = 0;
+  } else if (level == 2) {
+    circle_color->blue = 255;
+    circle_color->green = 255;
+    circle_color->red = 0;      /* aqua */
+  } else {
+    circle_color->blue = 0;
+    circle_color->green = 0;
+    circle_color->red = 255;    /* red */
+  }
+
   for (num = 0; num < line_size; num++) {
     Pointf *pt_ptr = (Pointf *) & (prediction->feature.road_line[num].x);
-    VvasOverlayCircleParams *circle_params = NULL;
-    VvasOverlayColorData *circle_color = NULL;
 
     if (pt_ptr->x < 0)
       continue;
 
-    circle_params =
-        (VvasOverlayCircleParams *) calloc (1,
-        sizeof (VvasOverlayCircleParams));
-    if (!circle_params) {
+    circle_params.center_pt.x = pt_ptr->x;
+    circle_params.center_pt.y = pt_ptr->y;
+
+    if (!vvas_overlay_shape_batch_add_circle (batch, &circle_params)) {
       LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
           "failed to allocate memory");
       return VVAS_RET_ALLOC_ERROR;
     }
+  }
+
+  return VVAS_RET_SUCCESS;
+}
+
+/**
+ *  @fn static uint64_t hash_bytes (uint64_t hash, const void *data, size_t len)
+ *  @param [in] hash - Hash of the data hashed so far
+ *  @param [in] data - Data to be hashed
+ *  @param [in] len - Length of @data in bytes
+ *  @return Updated hash
+ *  @brief Continues FNV-1a hash over @data.
+ */
+static uint64_t
+hash_bytes (uint64_t hash, const void *data, size_t len)
+{
+  const uint8_t *bytes = (const uint8_t *) data;
+  size_t idx;
+
+  for (idx = 0; idx < len; idx++) {
+    hash ^= bytes[idx];
+    hash *= NODE_HASH_PRIME;
+  }
+  return hash;
+}
+
+/**
+ *  @fn static uint64_t hash_string (uint64_t hash, const char *str)
+ *  @param [in] hash - Hash of the data hashed so far
+ *  @param [in] str - String to be hashed, may be NULL
+ *  @return Updated hash
+ *  @brief Continues hash over @str including its terminator, so that
+ *         consecutive strings can not alias each other.
+ */
+static uint64_t
+hash_string (uint64_t hash, const char *str)
+{
+  static const uint8_t null_marker = 0xff;
+
+  if (!str)
+    return hash_bytes (hash, &null_marker, sizeof (null_marker));
+
+  return hash_bytes (hash, str, strlen (str) + 1);
+}
+
+/**
+ *  @fn static uint64_t hash_classifications (uint64_t hash, VvasList * classes)
+ *  @param [in] hash - Hash of the data hashed so far
+ *  @param [in] classes - List of VvasInferClassification
+ *  @return Updated hash
+ *  @brief Continues hash over the fields of classifications used for labels and colors.
+ */
+static uint64_t
+hash_classifications (uint64_t hash, VvasList * classes)
+{
+  for (; classes; classes = classes->next) {
+    VvasInferClassification *classification =
+        (VvasInferClassification *) classes->data;
+
+    hash = hash_bytes (hash, &classification->class_id,
+        sizeof (classification->class_id));
+    hash = hash_bytes (hash, &classification->class_prob,
+        sizeof (classification->class_prob));
+    hash = hash_string (hash, classification->class_label);
+  }
+  return hash;
+}
+
+/**
+ *  @fn static uint64_t node_content_hash (VvasMetaConvertPriv * priv,
+ *                                         VvasTreeNode * node, int level)
+ *  @param [in] priv - Meta convert private handler
+ *  @param [in] node - Node of Inference prediction tree
+ *  @param [in] level - Depth of @node
+ *  @return Hash of the node inputs
+ *  @brief Hashes everything which decides shapes of @node itself: depth, bounding box,
+ *         classifications, tracker id, model class with its model specific data and
+ *         classifications of children which are folded into the label of @node.
+ *         Children converted as separate nodes are hashed on their own.
+ */
+static uint64_t
+node_content_hash (VvasMetaConvertPriv * priv, VvasTreeNode * node, int level)
+{
+  VvasInferPrediction *pred = (VvasInferPrediction *) node->data;
+  uint64_t hash = NODE_HASH_OFFSET;
+  VvasTreeNode *child;
+
+  hash = hash_bytes (hash, &level, sizeof (level));
+  hash = hash_bytes (hash, &pred->bbox.x, sizeof (pred->bbox.x));
+  hash = hash_bytes (hash, &pred->bbox.y, sizeof (pred->bbox.y));
+  hash = hash_bytes (hash, &pred->bbox.width, sizeof (pred->bbox.width));
+  hash = hash_bytes (hash, &pred->bbox.height, sizeof (pred->bbox.height));
+  hash = hash_bytes (hash, &pred->model_class, sizeof (pred->model_class));
+  hash = hash_string (hash, pred->obj_track_label);
+  hash = hash_classifications (hash, pred->classifications);
+
+  switch (pred->model_class) {
+    case VVAS_XCLASS_POSEDETECT:
+      hash = hash_bytes (hash, &pred->pose14pt, sizeof (pred->pose14pt));
+      break;
+    case VVAS_XCLASS_FACELANDMARK:
+      hash = hash_bytes (hash, pred->feature.landmark,
+          sizeof (pred->feature.landmark));
+      break;
+    case VVAS_XCLASS_BCC:
+      hash = hash_bytes (hash, &pred->count, sizeof (pred->count));
+      break;
+    case VVAS_XCLASS_ROADLINE:
+    case VVAS_XCLASS_ULTRAFAST:{
+      uint32_t line_size = pred->feature.line_size;
+
+      if (line_size > VVAS_MAX_FEATURES)
+        line_size = VVAS_MAX_FEATURES;
+
+      hash = hash_bytes (hash, &pred->feature.line_type,
+          sizeof (pred->feature.line_type));
+      hash = hash_bytes (hash, &pred->feature.line_size,
+          sizeof (pred->feature.line_size));
+      hash = hash_bytes (hash, pred->feature.road_line,
+          line_size * sizeof (Pointf));
+      break;
+    }
+    default:
+      break;
+  }
+
+  for (child = node->children; child; child = child->next) {
+    bool considered =
+        vvas_metaconvert_consider_child ((VvasMetaConvert *) priv, child);
+
+    hash = hash_bytes (hash, &considered, sizeof (considered));
+    if (!considered)
+      hash = hash_classifications (hash,
+          ((VvasInferPrediction *) child->data)->classifications);
+  }
+
+  return hash;
+}
+
+/**
+ *  @fn static void shape_mark (const VvasOverlayShapeBatch * batch,
+ *                              VvasMetaConvertShapeMark * mark)
+ *  @param [in] batch - Shape batch
+ *  @param [out] mark - Number of shapes of each type in @batch
+ *  @return None
+ *  @brief Records current end of each shape array of @batch.
+ */
+static void
+shape_mark (const VvasOverlayShapeBatch * batch, VvasMetaConvertShapeMark * mark)
+{
+  mark->rects = batch->num_rects;
+  mark->text = batch->num_text;
+  mark->lines = batch->num_lines;
+  mark->arrows = batch->num_arrows;
+  mark->circles = batch->num_circles;
+  mark->polys = batch->num_polys;
+  mark->masks = batch->num_masks;
+}
+
+/**
+ *  @fn static void shape_mark_lower (VvasMetaConvertShapeMark * mark,
+ *                                    const VvasMetaConvertShapeMark * start,
+ *                                    const VvasMetaConvertShapeMark * end)
+ *  @param [inout] mark - Mark to be lowered
+ *  @param [in] start - First shape of each type in range
+ *  @param [in] end - End of shapes of each type in range
+ *  @return None
+ *  @brief Lowers @mark to @start for each shape type having shapes in range
+ *         [@start, @end).
+ */
+static void
+shape_mark_lower (VvasMetaConvertShapeMark * mark,
+    const VvasMetaConvertShapeMark * start, const VvasMetaConvertShapeMark * end)
+{
+#define LOWER(field) \
+  if (start->field < end->field && start->field < mark->field) \
+    mark->field = start->field
+
+  LOWER (rects);
+  LOWER (text);
+  LOWER (lines);
+  LOWER (arrows);
+  LOWER (circles);
+  LOWER (polys);
+  LOWER (masks);
+#undef LOWER
+}
+
+/**
+ *  @fn static bool shape_range_has_masks (const VvasMetaConvertShapeMark * start,
+ *                                         const VvasMetaConvertShapeMark * end)
+ *  @param [in] start - First shape of each type in range
+ *  @param [in] end - End of shapes of each type in range
+ *  @return TRUE if range has masks, FALSE otherwise
+ *  @brief Checks whether range [@start, @end) has masks.
+ */
+static inline bool
+shape_range_has_masks (const VvasMetaConvertShapeMark * start,
+    const VvasMetaConvertShapeMark * end)
+{
+  return start->masks < end->masks;
+}
+
+/**
+ *  @fn static void shape_truncate (VvasOverlayShapeBatch * batch,
+ *                                  const VvasMetaConvertShapeMark * mark)
+ *  @param [inout] batch - Shape batch
+ *  @param [in] mark - Number of shapes of each type to be kept
+ *  @return None
+ *  @brief Drops shapes of @batch from @mark onwards, keeping storage.
+ */
+static void
+shape_truncate (VvasOverlayShapeBatch * batch,
+    const VvasMetaConvertShapeMark * mark)
+{
+  /* text and points of dropped shapes are at the end of their pools */
+  if (mark->text < batch->num_text)
+    batch->text_len =
+        (uint32_t) (batch->texts[mark->text].disp_text - batch->text_pool);
+  if (mark->polys < batch->num_polys)
+    batch->num_points = batch->poly_pt_offsets[mark->polys];
+
+  batch->num_rects = mark->rects;
+  batch->num_text = mark->text;
+  batch->num_lines = mark->lines;
+  batch->num_arrows = mark->arrows;
+  batch->num_circles = mark->circles;
+  batch->num_polys = mark->polys;
+  batch->num_masks = mark->masks;
+}
+
+/**
+ *  @fn static VvasReturnType shape_copy_range (VvasOverlayShapeBatch * dst,
+ *                                              const VvasOverlayShapeBatch * src,
+ *                                              const VvasMetaConvertShapeMark * start,
+ *                                              const VvasMetaConvertShapeMark * end)
+ *  @param [inout] dst - Shape batch to which shapes are appended
+ *  @param [in] src - Shape batch from which shapes are copied
+ *  @param [in] start - First shape of each type to be copied
+ *  @param [in] end - End of shapes of each type to be copied
+ *  @return VvasReturnType
+ *  @brief Appends shapes of @src in range [@start, @end) to @dst.
+ */
+static VvasReturnType
+shape_copy_range (VvasOverlayShapeBatch * dst,
+    const VvasOverlayShapeBatch * src, const VvasMetaConvertShapeMark * start,
+    const VvasMetaConvertShapeMark * end)
+{
+  uint32_t idx;
+
+  for (idx = start->rects; idx < end->rects; idx++) {
+    if (!vvas_overlay_shape_batch_add_rect (dst, &src->rects[idx]))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  for (idx = start->text; idx < end->text; idx++) {
+    if (!vvas_overlay_shape_batch_add_text (dst, &src->texts[idx]))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  for (idx = start->lines; idx < end->lines; idx++) {
+    if (!vvas_overlay_shape_batch_add_line (dst, &src->lines[idx]))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  for (idx = start->arrows; idx < end->arrows; idx++) {
+    if (!vvas_overlay_shape_batch_add_arrow (dst, &src->arrows[idx]))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  for (idx = start->circles; idx < end->circles; idx++) {
+    if (!vvas_overlay_shape_batch_add_circle (dst, &src->circles[idx]))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  for (idx = start->polys; idx < end->polys; idx++) {
+    uint32_t offset = src->poly_pt_offsets[idx];
+    uint32_t next = (idx + 1 < src->num_polys) ?
+        src->poly_pt_offsets[idx + 1] : src->num_points;
+
+    if (!vvas_overlay_shape_batch_add_polygon (dst, &src->polygons[idx],
+            &src->points[offset], next - offset))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  for (idx = start->masks; idx < end->masks; idx++) {
+    if (!vvas_overlay_shape_batch_add_mask (dst, &src->masks[idx]))
+      return VVAS_RET_ALLOC_ERROR;
+  }
+
+  return VVAS_RET_SUCCESS;
+}
+
+/**
+ *  @fn static const VvasMetaConvertNodeCache *node_cache_lookup (VvasMetaConvertCache * cache,
+ *                                                                uint64_t hash,
+ *                                                                uint32_t * position)
+ *  @param [in] cache - Incremental conversion state
+ *  @param [in] hash - Hash of the node inputs
+ *  @param [out] position - Index of the found record in previous call
+ *  @return Record of previous call with same inputs, NULL if there is none
+ *  @brief Looks up shapes converted in previous call from a node with same inputs.
+ */
+static const VvasMetaConvertNodeCache *
+node_cache_lookup (VvasMetaConvertCache * cache, uint64_t hash,
+    uint32_t * position)
+{
+  uint32_t mask = cache->index_size - 1;
+  uint32_t slot;
+
+  if (!cache->index_size)
+    return NULL;
+
+  for (slot = (uint32_t) (hash ^ (hash >> 32)) & mask; cache->index[slot];
+      slot = (slot + 1) & mask) {
+    uint32_t idx = cache->index[slot] - 1;
+
+    if (cache->prev[idx].hash == hash) {
+      *position = idx;
+      return &cache->prev[idx];
+    }
+  }
 
-    circle_color = &(circle_params->circle_color);
-
-    circle_params->center_pt.x = pt_ptr->x;
-    circle_params->center_pt.y = pt_ptr->y;
-    circle_params->radius = priv->radius;
-    circle_params->thickness = priv->line_thickness;
-
-    if (level == 0) {
-      circle_color->blue = 255;
-      circle_color->green = 0;
-      circle_color->red = 0;    /* blue */
-    } else if (level == 1) {
-      circle_color->blue = 0;
-      circle_color->green = 255;        /* green */
-      circle_color->red = 0;
-    } else if (level == 2) {
-      circle_color->blue = 255;
-      circle_color->green = 255;
-      circle_color->red = 0;    /* aqua */
-    } else {
-      circle_color->blue = 0;
-      circle_color->green = 0;
-      circle_color->red = 255;  /* red */
+  return NULL;
+}
+
+/**
+ *  @fn static VvasMetaConvertNodeCache *node_cache_push (VvasMetaConvertCache * cache)
+ *  @param [inout] cache - Incremental conversion state
+ *  @return New record of ongoing call on success
+ *          NULL on allocation failure
+ *  @brief Adds a record for a node converted in ongoing call.
+ */
+static VvasMetaConvertNodeCache *
+node_cache_push (VvasMetaConvertCache * cache)
+{
+  if (cache->cur_count == cache->cur_size) {
+    uint32_t new_size = cache->cur_size ? cache->cur_size << 1 :
+        NODE_CACHE_MIN_SIZE;
+    VvasMetaConvertNodeCache *cur;
+
+    cur = (VvasMetaConvertNodeCache *) realloc (cache->cur,
+        new_size * sizeof (VvasMetaConvertNodeCache));
+    if (!cur)
+      return NULL;
+
+    cache->cur = cur;
+    cache->cur_size = new_size;
+  }
+
+  return &cache->cur[cache->cur_count++];
+}
+
+/**
+ *  @fn static VvasReturnType node_cache_commit (VvasMetaConvertCache * cache,
+ *                                               const VvasOverlayShapeBatch * batch)
+ *  @param [inout] cache - Incremental conversion state
+ *  @param [in] batch - Shape batch prepared in ongoing call
+ *  @return VvasReturnType
+ *  @brief Makes records and shapes of ongoing call available to the next call.
+ *         Only shapes from the first dirty node onwards are copied, shapes of
+ *         nodes reused at their previous position are already cached. Storage
+ *         of both calls is swapped and kept, so that steady scenes do not
+ *         allocate memory.
+ */
+static VvasReturnType
+node_cache_commit (VvasMetaConvertCache * cache,
+    const VvasOverlayShapeBatch * batch)
+{
+  VvasMetaConvertShapeMark keep;
+  VvasMetaConvertShapeMark end;
+  VvasMetaConvertNodeCache *records;
+  uint32_t size, idx;
+
+  shape_mark (batch, &end);
+  shape_mark (&cache->shapes, &keep);
+  /* shapes beyond end of ongoing call are dropped */
+  shape_mark_lower (&keep, &end, &keep);
+  for (idx = 0; idx < cache->cur_count; idx++) {
+    const VvasMetaConvertNodeCache *record = &cache->cur[idx];
+
+    if (record->dirty) {
+      shape_mark_lower (&keep, &record->pre_start, &record->pre_end);
+      shape_mark_lower (&keep, &record->post_start, &record->post_end);
+    }
+  }
+
+  shape_truncate (&cache->shapes, &keep);
+  if (VVAS_IS_ERROR (shape_copy_range (&cache->shapes, batch, &keep, &end)))
+    goto error;
+
+  records = cache->prev;
+  size = cache->prev_size;
+  cache->prev = cache->cur;
+  cache->prev_size = cache->cur_size;
+  cache->prev_count = cache->cur_count;
+  cache->cur = records;
+  cache->cur_size = size;
+  cache->cur_count = 0;
+
+  /* keep index at most half full */
+  size = cache->index_size ? cache->index_size : NODE_CACHE_MIN_SIZE;
+  while (size < 2 * cache->prev_count)
+    size <<= 1;
+
+  if (size != cache->index_size) {
+    uint32_t *index = (uint32_t *) realloc (cache->index,
+        size * sizeof (uint32_t));
+
+    if (!index)
+      goto error;
+
+    cache->index = index;
+    cache->index_size = size;
+  }
+  memset (cache->index, 0x0, cache->index_size * sizeof (uint32_t));
+
+  for (idx = 0; idx < cache->prev_count; idx++) {
+    uint64_t hash = cache->prev[idx].hash;
+    uint32_t position;
+
+    if (!cache->prev[idx].reusable)
+      continue;
+
+    /* nodes with same inputs have same shapes, one record is enough */
+    if (!node_cache_lookup (cache, hash, &position)) {
+      uint32_t mask = cache->index_size - 1;
+      uint32_t slot = (uint32_t) (hash ^ (hash >> 32)) & mask;
+
+      while (cache->index[slot])
+        slot = (slot + 1) & mask;
+      cache->index[slot] = idx + 1;
     }
-    shape_info->num_circles++;
-    shape_info->circle_params =
-        vvas_list_append (shape_info->circle_params, circle_params);
   }
 
   return VVAS_RET_SUCCESS;
+
+error:
+  /* drop everything, next call converts all nodes */
+  vvas_overlay_shape_batch_reset (&cache->shapes);
+  cache->prev_count = 0;
+  cache->cur_count = 0;
+  if (cache->index)
+    memset (cache->index, 0x0, cache->index_size * sizeof (uint32_t));
+  return VVAS_RET_ALLOC_ERROR;
 }
 
 /**
@@ -666,20 +1147,28 @@ vvas_metaconvert_create (VvasContext * vvas_ctx, VvasMetaConvertConfig * cfg,
   priv->draw_above_bbox_flag = cfg->draw_above_bbox_flag;
 
   if (cfg->allowed_labels_count) {
-    /* copy filter labels if it exists */
-    priv->allowed_labels =
-        (char **) calloc (cfg->allowed_labels_count, sizeof (char *));
-    if (!priv->allowed_labels) {
+    /* compile filter labels into label format program */
+    priv->label_ops = (VvasMetaConvertLabelOp *)
+        calloc (cfg->allowed_labels_count, sizeof (VvasMetaConvertLabelOp));
+    if (!priv->label_ops) {
       LOG_MESSAGE (LOG_LEVEL_ERROR, log_level, "failed to allocate memory");
       if (ret)
         *ret = VVAS_RET_ALLOC_ERROR;
       goto error;
     }
 
-    for (i = 0; i < cfg->allowed_labels_count; i++)
-      priv->allowed_labels[i] = strdup (cfg->allowed_labels[i]);
-
-    priv->allowed_labels_count = cfg->allowed_labels_count;
+    for (i = 0; i < cfg->allowed_labels_count; i++) {
+      if (!strcmp (cfg->allowed_labels[i], "class")) {
+        priv->label_ops[priv->label_ops_count++] = VVAS_LABEL_OP_CLASS;
+      } else if (!strcmp (cfg->allowed_labels[i], "tracker-id")) {
+        priv->label_ops[priv->label_ops_count++] = VVAS_LABEL_OP_TRACKER_ID;
+      } else if (!strcmp (cfg->allowed_labels[i], "probability")) {
+        priv->label_ops[priv->label_ops_count++] = VVAS_LABEL_OP_PROBABILITY;
+      } else {
+        LOG_MESSAGE (LOG_LEVEL_WARNING, log_level,
+            "ignoring unsupported label %s", cfg->allowed_labels[i]);
+      }
+    }
   }
 
   if (cfg->allowed_classes_count) {
@@ -694,9 +1183,29 @@ vvas_metaconvert_create (VvasContext * vvas_ctx, VvasMetaConvertConfig * cfg,
       goto error;
     }
 
+    /* styles of allowed classes are resolved by class name in O(1) */
+    priv->class_styles = (VvasMetaConvertClassStyle *)
+        calloc (cfg->allowed_classes_count, sizeof (VvasMetaConvertClassStyle));
+    priv->class_table = vvas_hash_table_new (vvas_str_hash, vvas_str_equal);
+    if (!priv->class_styles || !priv->class_table) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, log_level, "failed to allocate memory");
+      if (ret)
+        *ret = VVAS_RET_ALLOC_ERROR;
+      goto error;
+    }
+
     for (i = 0; i < cfg->allowed_classes_count; i++) {
+      VvasMetaConvertClassStyle *style = &priv->class_styles[i];
+
       priv->allowed_classes[i] =
           (VvasFilterObjectInfo *) calloc (1, sizeof (VvasFilterObjectInfo));
+      if (!priv->allowed_classes[i]) {
+        LOG_MESSAGE (LOG_LEVEL_ERROR, log_level, "failed to allocate memory");
+        if (ret)
+          *ret = VVAS_RET_ALLOC_ERROR;
+        goto error;
+      }
+      priv->allowed_classes_count = i + 1;
 
       memcpy (&priv->allowed_classes[i]->name,
           &cfg->allowed_classes[i]->name, META_CONVERT_MAX_STR_LENGTH - 1);
@@ -704,16 +1213,25 @@ vvas_metaconvert_create (VvasContext * vvas_ctx, VvasMetaConvertConfig * cfg,
       memcpy (&priv->allowed_classes[i]->color,
           &cfg->allowed_classes[i]->color, sizeof (VvasRGBColor));
       priv->allowed_classes[i]->do_mask = cfg->allowed_classes[i]->do_mask;
-    }
 
-    priv->allowed_classes_count = cfg->allowed_classes_count;
+      style->index = i;
+      style->color = priv->allowed_classes[i]->color;
+      style->do_mask = priv->allowed_classes[i]->do_mask;
+
+      /* first entry wins on duplicate names, same as linear search */
+      if (!vvas_hash_table_lookup (priv->class_table,
+              priv->allowed_classes[i]->name)) {
+        vvas_hash_table_insert (priv->class_table,
+            priv->allowed_classes[i]->name, style);
+      }
+    }
   }
 
   return (VvasMetaConvert *) priv;
 
 error:
   if (priv)
-    free (priv);
+    vvas_metaconvert_destroy ((VvasMetaConvert *) priv);
   return NULL;
 }
 
@@ -733,54 +1251,129 @@ vvas_metaconvert_set_color_for_allowed_classes (VvasMetaConvertPriv * priv,
     VvasInferClassification * classification, uint8_t * do_mask,
     VvasRGBColor * clr)
 {
-  int allowed_class_idx = -1;
-  int i;
+  VvasMetaConvertClassStyle *style;
 
-  for (i = 0; i < priv->allowed_classes_count; i++) {
-    if (!strncmp (classification->class_label, priv->allowed_classes[i]->name,
-            META_CONVERT_MAX_STR_LENGTH)) {
-      LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level, "class %s in allowed list",
-          classification->class_label);
-      allowed_class_idx = i;
-      break;
-    }
-  }
+  if (!priv->class_table || !classification->class_label)
+    return -1;
+
+  style = (VvasMetaConvertClassStyle *)
+      vvas_hash_table_lookup (priv->class_table, classification->class_label);
+  if (!style)
+    return -1;
+
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level, "class %s in allowed list",
+      classification->class_label);
 
-  if (priv->allowed_classes && allowed_class_idx >= 0) {
-    clr->blue = priv->allowed_classes[allowed_class_idx]->color.blue;
-    clr->red = priv->allowed_classes[allowed_class_idx]->color.red;
-    clr->green = priv->allowed_classes[allowed_class_idx]->color.green;
-    *do_mask = priv->allowed_classes[allowed_class_idx]->do_mask;
+  *clr = style->color;
+  *do_mask = style->do_mask;
+
+  return style->index;
+}
+
+static VvasReturnType convert_node (VvasMetaConvertPriv * priv,
+    VvasTreeNode * parent, VvasOverlayShapeBatch * batch,
+    VvasMetaConvertCache * cache);
+
+/**
+ *  @fn static VvasReturnType reuse_node (VvasMetaConvertPriv * priv,
+ *                                        VvasTreeNode * parent,
+ *                                        VvasOverlayShapeBatch * batch,
+ *                                        VvasMetaConvertCache * cache,
+ *                                        const VvasMetaConvertNodeCache * cached,
+ *                                        uint32_t position)
+ *  @param [in] priv - Meta convert private handler
+ *  @param [in] parent - Node of Inference prediction tree
+ *  @param [out] batch - Shape batch to which overlay shapes are appended
+ *  @param [inout] cache - Incremental conversion state
+ *  @param [in] cached - Record of previous call with same inputs as @parent
+ *  @param [in] position - Index of @cached in previous call
+ *  @return VvasReturnType
+ *  @brief Appends shapes converted from @parent in previous call and converts its
+ *         children, keeping the order in which shapes are converted.
+ */
+static VvasReturnType
+reuse_node (VvasMetaConvertPriv * priv, VvasTreeNode * parent,
+    VvasOverlayShapeBatch * batch, VvasMetaConvertCache * cache,
+    const VvasMetaConvertNodeCache * cached, uint32_t position)
+{
+  VvasMetaConvertNodeCache record;
+  VvasMetaConvertNodeCache *dest;
+  VvasTreeNode *child;
+
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level,
+      "reusing shapes of node %p from previous call", parent);
+
+  record.hash = cached->hash;
+  shape_mark (batch, &record.pre_start);
+  if (VVAS_IS_ERROR (shape_copy_range (batch, &cache->shapes,
+              &cached->pre_start, &cached->pre_end)))
+    goto error;
+  shape_mark (batch, &record.pre_end);
+
+  for (child = parent->children; child; child = child->next) {
+    if (vvas_metaconvert_consider_child ((VvasMetaConvert *) priv, child))
+      convert_node (priv, child, batch, cache);
   }
 
-  return allowed_class_idx;
+  shape_mark (batch, &record.post_start);
+  if (VVAS_IS_ERROR (shape_copy_range (batch, &cache->shapes,
+              &cached->post_start, &cached->post_end)))
+    goto error;
+  shape_mark (batch, &record.post_end);
+
+  if (position != cache->cur_count)
+    cache->in_order = FALSE;
+
+  /* cached shapes need an update only if node's shapes moved */
+  record.dirty = memcmp (&record.pre_start, &cached->pre_start,
+      sizeof (VvasMetaConvertShapeMark)) ||
+      memcmp (&record.post_start, &cached->post_start,
+      sizeof (VvasMetaConvertShapeMark));
+  record.reusable = TRUE;
+
+  dest = node_cache_push (cache);
+  if (!dest)
+    goto error;
+  *dest = record;
+
+  return VVAS_RET_SUCCESS;
+
+error:
+  LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level, "failed to allocate memory");
+  return VVAS_RET_ALLOC_ERROR;
 }
 
 /**
- *  @fn void vvas_metaconvert_prepare_overlay_metadata (VvasMetaConvert *meta_convert,
- *                                                                  VvasTreeNode *parent,
- *                                                                  VvasOverlayShapeInfo *shape_info));
- *  @param [in] meta_convert - Handle to VVAS Meta convert
+ *  @fn static VvasReturnType convert_node (VvasMetaConvertPriv * priv,
+ *                                          VvasTreeNode * parent,
+ *                                          VvasOverlayShapeBatch * batch,
+ *                                          VvasMetaConvertCache * cache)
+ *  @param [in] priv - Meta convert private handler
  *  @param [in] parent - Handle to parent node of Inference prediction tree
- *  @param [out] shape_info - Handle to overlay information which will be used overlay module to draw bounding box
+ *  @param [out] batch - Shape batch to which overlay shapes are appended
+ *  @param [inout] cache - Incremental conversion state, NULL to convert all nodes
  *  @return VvasReturnType
- *  @brief Converts Inference prediction tree to structure which can be understood by overlay module
+ *  @brief Converts Inference prediction tree to shapes which can be drawn by overlay module.
+ *         With @cache, shapes of nodes whose inputs are unchanged since previous call
+ *         are reused instead of being converted again.
  */
-VvasReturnType
-vvas_metaconvert_prepare_overlay_metadata (VvasMetaConvert * meta_convert,
-    VvasTreeNode * parent, VvasOverlayShapeInfo * shape_info)
+static VvasReturnType
+convert_node (VvasMetaConvertPriv * priv, VvasTreeNode * parent,
+    VvasOverlayShapeBatch * batch, VvasMetaConvertCache * cache)
 {
-  VvasMetaConvertPriv *priv = (VvasMetaConvertPriv *) meta_convert;
   VvasInferPrediction *parent_pred = (VvasInferPrediction *) parent->data;
   VvasList *parent_classes;
   VvasInferClassification *classification;
-  char *label_string = NULL;
+  VvasMetaConvertLabelBuf *label_buf;
+  bool has_label = FALSE;
   VvasRGBColor clr = { 0, };
   int level = vvas_treenode_get_depth (parent);
   VvasTreeNode *child = parent->children;
   uint8_t do_mask = 0;
   uint8_t rectangle_attached = 0;
   VvasReturnType vret = VVAS_RET_SUCCESS;
+  VvasMetaConvertShapeMark pre_start, pre_end, post_start;
+  uint64_t hash = 0;
 
   LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level, "node %p at depth %d",
       parent, level);
@@ -809,6 +1402,26 @@ vvas_metaconvert_prepare_overlay_metadata (VvasMetaConvert * meta_convert,
     return VVAS_RET_SUCCESS;
   }
 
+  if (cache) {
+    const VvasMetaConvertNodeCache *cached;
+    uint32_t position;
+
+    hash = node_content_hash (priv, parent, level);
+    cached = node_cache_lookup (cache, hash, &position);
+    if (cached)
+      return reuse_node (priv, parent, batch, cache, cached, position);
+
+    cache->converted++;
+    shape_mark (batch, &pre_start);
+  }
+
+  label_buf = get_label_buf (priv, level);
+  if (!label_buf) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
+        "failed to allocate memory for label");
+    return VVAS_RET_ALLOC_ERROR;
+  }
+
   for (parent_classes = parent_pred->classifications; parent_classes;
       parent_classes = parent_classes->next) {
     int allowed_class_idx = -1;
@@ -827,21 +1440,8 @@ vvas_metaconvert_prepare_overlay_metadata (VvasMetaConvert * meta_convert,
             && allowed_class_idx >= 0)) {
       /* Prepare label_string only for infer level which is same as display_level */
       if (priv->level == 0 || (level - 1) == priv->level) {
-        if (!label_string) {
-          label_string =
-              prepare_label_string (priv, parent_pred, classification);
-        } else {
-          char *cur_label_string =
-              prepare_label_string (priv, parent_pred, classification);
-          char *tmp_str;
-
-          tmp_str = append_string (label_string, ", ");
-          free (label_string);
-
-          label_string = append_string (tmp_str, cur_label_string);
-          free (tmp_str);
-          free (cur_label_string);
-        }
+        has_label |= append_label_string (priv, parent_pred, classification,
+            label_buf, has_label, ", ");
       }
     }
   }
@@ -851,67 +1451,61 @@ vvas_metaconvert_prepare_overlay_metadata (VvasMetaConvert * meta_convert,
 
   if (parent_pred->model_class == VVAS_XCLASS_POSEDETECT) {
     /* Add posedetect model coordinates in overlay meta */
-    vret = convert_pose_detection_meta (priv, parent, shape_info);
+    vret = convert_pose_detection_meta (priv, parent, batch);
   } else if (parent_pred->model_class == VVAS_XCLASS_FACELANDMARK) {
     /* Add posedetect model coordinates in overlay meta */
-    vret = convert_face_landmark_meta (priv, parent, shape_info);
+    vret = convert_face_landmark_meta (priv, parent, batch);
   } else if (parent_pred->model_class == VVAS_XCLASS_BCC) {
     /* get count value and convert to text to print as level */
     char bcc_text[MAX_LABEL_LEN];
-    VvasOverlayTextParams *text_params =
-        (VvasOverlayTextParams *) calloc (1, sizeof (VvasOverlayTextParams));
-    if (!text_params) {
-      LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
-          "failed to allocate memory");
-      if (label_string)
-        free (label_string);
+    VvasOverlayTextParams text_params;
 
-      return VVAS_RET_ALLOC_ERROR;
-    }
     LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level, "parsing BCC meta");
 
-    memset (bcc_text, 0, MAX_LABEL_LEN);
-    sprintf (bcc_text, "Crowd = %d", parent_pred->count);
-    /* Update the label string information */
-    shape_info->num_text++;
+    memset (&text_params, 0, sizeof (text_params));
+    snprintf (bcc_text, MAX_LABEL_LEN, "Crowd = %d", parent_pred->count);
     /* default text will be drawn  inside the image since there is no bbox */
-    text_params->bottom_left_origin = 0;
+    text_params.bottom_left_origin = 0;
 
     if (priv->draw_above_bbox_flag)
-      text_params->bottom_left_origin = 1;
+      text_params.bottom_left_origin = 1;
 
     /* TODO: fix x and y location of text */
-    text_params->points.x = 0;
-    text_params->points.y = priv->y_offset;
+    text_params.points.x = 0;
+    text_params.points.y = priv->y_offset;
 
     /* If y is zero bottom_left_origin will be set zero for drawing
        text inside image */
-    if (!text_params->points.y)
-      text_params->bottom_left_origin = 0;
-
-    text_params->text_font.font_size = priv->font_size;
-    text_params->text_font.font_num = priv->font_type;
-    text_params->disp_text = strdup (bcc_text);
-    text_params->apply_bg_color = 1;
-    text_params->bg_color.blue = 0;
-    text_params->bg_color.green = 255;
-    text_params->bg_color.red = 255;
-    shape_info->text_params =
-        vvas_list_append (shape_info->text_params, text_params);
+    if (!text_params.points.y)
+      text_params.bottom_left_origin = 0;
+
+    text_params.text_font.font_size = priv->font_size;
+    text_params.text_font.font_num = priv->font_type;
+    text_params.disp_text = bcc_text;
+    text_params.apply_bg_color = 1;
+    text_params.bg_color.blue = 0;
+    text_params.bg_color.green = 255;
+    text_params.bg_color.red = 255;
+    if (!vvas_overlay_shape_batch_add_text (batch, &text_params)) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
+          "failed to allocate memory");
+      return VVAS_RET_ALLOC_ERROR;
+    }
   } else if (parent_pred->model_class == VVAS_XCLASS_ROADLINE) {
-    vret = convert_road_line_meta (priv, parent, shape_info);
+    vret = convert_road_line_meta (priv, parent, batch);
   } else if (parent_pred->model_class == VVAS_XCLASS_ULTRAFAST) {
-    vret = convert_ultrafast_meta (priv, parent, shape_info);
+    vret = convert_ultrafast_meta (priv, parent, batch);
   }
 
   if (VVAS_IS_ERROR (vret)) {
     LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level,
         "failed to create overlay meta");
-    if (label_string)
-      free (label_string);
     return vret;
   }
 
+  if (cache)
+    shape_mark (batch, &pre_end);
+
   LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level, "child : %p", child);
 
   while (child) {
@@ -926,17 +1520,19 @@ vvas_metaconvert_prepare_overlay_metadata (VvasMetaConvert * meta_convert,
         child, child_level, priv->level, child_pred->bbox.width,
         child_pred->bbox.height);
 
-    if (vvas_metaconvert_consider_child (meta_convert, child) == TRUE) {
+    if (vvas_metaconvert_consider_child ((VvasMetaConvert *) priv,
+            child) == TRUE) {
       /* ignore detection child node as it will be parsed as parent node */
-      vvas_metaconvert_prepare_overlay_metadata (meta_convert, child,
-          shape_info);
+      convert_node (priv, child, batch, cache);
+      /* label buffers might have been reallocated by child */
+      label_buf = &priv->label_bufs[level];
       child = child->next;
       continue;
     }
 
     for (classes = child_pred->classifications; classes;
         classes = classes->next) {
-      char *class_label_str = NULL;
+      const char *separator;
 
       classification = (VvasInferClassification *) classes->data;
 
@@ -945,8 +1541,15 @@ vvas_metaconvert_prepare_overlay_metadata (VvasMetaConvert * meta_convert,
       if (priv->level != 0 && (child_level - 1) != priv->level)
         continue;
 
-      class_label_str = prepare_label_string (priv, NULL, classification);
-      if (!class_label_str)
+      if (append_slash)
+        separator = "\n";
+      else if (label_buf->len && label_buf->str[label_buf->len - 1] == ',')
+        separator = "";         /* has "," as suffix */
+      else
+        separator = ", ";       /* add comma as separator */
+
+      if (!append_label_string (priv, NULL, classification, label_buf,
+              has_label, separator))
         continue;
 
       if (priv->allowed_classes && classification->class_label) {
@@ -954,92 +1557,55 @@ vvas_metaconvert_prepare_overlay_metadata (VvasMetaConvert * meta_convert,
             &do_mask, &clr);
       }
 
-      if (append_slash) {
-        if (label_string) {
-          char *tmp_str;
-
-          tmp_str = append_string (label_string, "\n");
-          free (label_string);
-
-          label_string = append_string (tmp_str, class_label_str);
-          free (tmp_str);
-          free (class_label_str);
-        } else {
-          label_string = class_label_str;
-        }
-        append_slash = FALSE;
-      } else {
-        if (label_string) {
-          if (label_string[strlen (label_string) - 1] == ',') { /* has "," as suffix */
-            char *tmp_str;
-
-            tmp_str = append_string (label_string, class_label_str);
-            free (label_string);
-            label_string = tmp_str;
-          } else {
-            char *tmp_str;
-
-            tmp_str = append_string (label_string, ", ");       /* add comma as separator */
-            free (label_string);
-
-            label_string = append_string (tmp_str, class_label_str);
-            free (tmp_str);
-          }
-          free (class_label_str);
-        } else {
-          label_string = class_label_str;
-        }
-      }
+      has_label = TRUE;
+      append_slash = FALSE;
     }
     child = child->next;
   }
 
+  if (cache)
+    shape_mark (batch, &post_start);
+
   if (level != 1 && (priv->level == 0 || (level - 1) == priv->level)) {
     if (parent_pred->bbox.width && parent_pred->bbox.height) {
-      VvasOverlayRectParams *rect_params =
-          (VvasOverlayRectParams *) calloc (1, sizeof (VvasOverlayRectParams));
-      if (!rect_params) {
-        LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
-            "failed to allocate memory...");
-        
-        if (label_string)
-          free (label_string);
-
-        return VVAS_RET_ALLOC_ERROR;
-      }
-      rect_params->points.x = parent_pred->bbox.x;
-      rect_params->points.y = parent_pred->bbox.y;
-      rect_params->width = parent_pred->bbox.width;
-      rect_params->height = parent_pred->bbox.height;
-      rect_params->thickness = priv->line_thickness;
-      rect_params->rect_color.red = clr.red;
-      rect_params->rect_color.green = clr.green;
-      rect_params->rect_color.blue = clr.blue;
-      rect_params->apply_bg_color = 0;
+      VvasOverlayRectParams rect_params;
+
+      memset (&rect_params, 0, sizeof (rect_params));
+      rect_params.points.x = parent_pred->bbox.x;
+      rect_params.points.y = parent_pred->bbox.y;
+      rect_params.width = parent_pred->bbox.width;
+      rect_params.height = parent_pred->bbox.height;
+      rect_params.thickness = priv->line_thickness;
+      rect_params.rect_color.red = clr.red;
+      rect_params.rect_color.green = clr.green;
+      rect_params.rect_color.blue = clr.blue;
+      rect_params.apply_bg_color = 0;
 
       if (do_mask || ((priv->mask_tree_level)
               && (level == priv->mask_tree_level))) {
         /* Apply masking when class string matches or level matches */
-        rect_params->apply_bg_color = 1;
-        rect_params->bg_color.red = 0;
-        rect_params->bg_color.green = 0;
-        rect_params->bg_color.blue = 0;
+        rect_params.apply_bg_color = 1;
+        rect_params.bg_color.red = 0;
+        rect_params.bg_color.green = 0;
+        rect_params.bg_color.blue = 0;
       }
 
       LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level,
           "appending rectangle [%u] : x = %u, y = %u, width = %u, height = %u"
-          "Color : B = %u, G = %u, R = %u", shape_info->num_rects,
+          "Color : B = %u, G = %u, R = %u", batch->num_rects,
           parent_pred->bbox.x, parent_pred->bbox.y, parent_pred->bbox.width,
-          parent_pred->bbox.height, rect_params->rect_color.blue,
-          rect_params->rect_color.green, rect_params->rect_color.red);
-      shape_info->rect_params =
-          vvas_list_append (shape_info->rect_params, rect_params);
-      shape_info->num_rects++;
+          parent_pred->bbox.height, rect_params.rect_color.blue,
+          rect_params.rect_color.green, rect_params.rect_color.red);
+      if (!vvas_overlay_shape_batch_add_rect (batch, &rect_params)) {
+        LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
+            "failed to allocate memory...");
+        return VVAS_RET_ALLOC_ERROR;
+      }
       rectangle_attached = 1;
     }
   }
 
-  if (label_string) {
+  if (has_label) {
     /* Add bounding box if label_string exists, with this approach we always have label with
        bounding box. Here 3 possible cases cover as per display_level
        case 1 - display only parent label, always have bounding box so add from same node
@@ -1048,100 +1614,214 @@ vvas_metaconvert_prepare_overlay_metadata (VvasMetaConvert * meta_convert,
        case 4 - display only labels, do not have bounding box so do not add bounding box */
     if ((level != 1) && (rectangle_attached == 0) &&
         parent_pred->bbox.width && parent_pred->bbox.height) {
-      VvasOverlayRectParams *rect_params = (VvasOverlayRectParams *) calloc (1,
-          sizeof (VvasOverlayRectParams));
-      if (!rect_params) {
-        free (label_string);
-        LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
-            "failed to allocate memory...");
-        return VVAS_RET_ALLOC_ERROR;
-      }
-      rect_params->points.x = parent_pred->bbox.x;
-      rect_params->points.y = parent_pred->bbox.y;
-      rect_params->width = parent_pred->bbox.width;
-      rect_params->height = parent_pred->bbox.height;
-      rect_params->thickness = priv->line_thickness;
-      rect_params->rect_color.red = clr.red;
-      rect_params->rect_color.green = clr.green;
-      rect_params->rect_color.blue = clr.blue;
-      rect_params->apply_bg_color = 0;
+      VvasOverlayRectParams rect_params;
+
+      memset (&rect_params, 0, sizeof (rect_params));
+      rect_params.points.x = parent_pred->bbox.x;
+      rect_params.points.y = parent_pred->bbox.y;
+      rect_params.width = parent_pred->bbox.width;
+      rect_params.height = parent_pred->bbox.height;
+      rect_params.thickness = priv->line_thickness;
+      rect_params.rect_color.red = clr.red;
+      rect_params.rect_color.green = clr.green;
+      rect_params.rect_color.blue = clr.blue;
+      rect_params.apply_bg_color = 0;
 
       if (do_mask || ((priv->mask_tree_level)
               && (level == priv->mask_tree_level))) {
         /* Apply masking when class string matches or level matches */
-        rect_params->apply_bg_color = 1;
-        rect_params->bg_color.red = 0;
-        rect_params->bg_color.green = 0;
-        rect_params->bg_color.blue = 0;
+        rect_params.apply_bg_color = 1;
+        rect_params.bg_color.red = 0;
+        rect_params.bg_color.green = 0;
+        rect_params.bg_color.blue = 0;
       }
 
       LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level,
           "appending rectangle [%u] : x = %u, y = %u, width = %u, height = %u"
-          "Color : B = %u, G = %u, R = %u", shape_info->num_rects,
+          "Color : B = %u, G = %u, R = %u", batch->num_rects,
           parent_pred->bbox.x, parent_pred->bbox.y, parent_pred->bbox.width,
-          parent_pred->bbox.height, rect_params->rect_color.blue,
-          rect_params->rect_color.green, rect_params->rect_color.red);
-      shape_info->rect_params =
-          vvas_list_append (shape_info->rect_params, rect_params);
-      shape_info->num_rects++;
+          parent_pred->bbox.height, rect_params.rect_color.blue,
+          rect_params.rect_color.green, rect_params.rect_color.red);
+      if (!vvas_overlay_shape_batch_add_rect (batch, &rect_params)) {
+        LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
+            "failed to allocate memory...");
+        return VVAS_RET_ALLOC_ERROR;
+      }
     }
 
     uint32_t y_offset;
-    VvasOverlayTextParams *text_params =
-        (VvasOverlayTextParams *) calloc (1, sizeof (VvasOverlayTextParams));
-    if (!text_params) {
-      free (label_string);
-      LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
-          "failed to allocate memory...");
-      return VVAS_RET_ALLOC_ERROR;
-    }
+    VvasOverlayTextParams text_params;
 
+    memset (&text_params, 0, sizeof (text_params));
     y_offset = priv->y_offset;
 
-    text_params->bottom_left_origin = 1;
+    text_params.bottom_left_origin = 1;
     if (!priv->draw_above_bbox_flag)
-      text_params->bottom_left_origin = 0;
+      text_params.bottom_left_origin = 0;
 
-    text_params->points.x = parent_pred->bbox.x;
-    text_params->points.y = parent_pred->bbox.y + y_offset;
+    text_params.points.x = parent_pred->bbox.x;
+    text_params.points.y = parent_pred->bbox.y + y_offset;
     /* If y is zero bottom_left_origin will be set zero for drawing
        text inside image */
-    if (!text_params->points.y)
-      text_params->bottom_left_origin = 0;
+    if (!text_params.points.y)
+      text_params.bottom_left_origin = 0;
 
-    text_params->text_font.font_size = priv->font_size;
-    text_params->text_font.font_num = priv->font_type;
+    text_params.text_font.font_size = priv->font_size;
+    text_params.text_font.font_num = priv->font_type;
     /* Setting black color for text */
-    text_params->text_font.font_color.blue = 0;
-    text_params->text_font.font_color.green = 0;
-    text_params->text_font.font_color.red = 0;
+    text_params.text_font.font_color.blue = 0;
+    text_params.text_font.font_color.green = 0;
+    text_params.text_font.font_color.red = 0;
 
-    /* copy only what overlay can hold */
-    text_params->disp_text = strdup (label_string);
+    /* label is copied into text pool of the batch */
+    text_params.disp_text = label_buf->str;
 
-    text_params->apply_bg_color = NEED_TEXT_BG_COLOR;
-    text_params->bg_color.blue = clr.blue;
-    text_params->bg_color.green = clr.green;
-    text_params->bg_color.red = clr.red;
+    text_params.apply_bg_color = NEED_TEXT_BG_COLOR;
+    text_params.bg_color.blue = clr.blue;
+    text_params.bg_color.green = clr.green;
+    text_params.bg_color.red = clr.red;
     LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level, "appending text [%u] : "
         "x = %u, y = %u, font size = %f, font number = %u, "
         "need background color = %u Color : B = %u, G = %u, R = %u",
-        shape_info->num_text, parent_pred->bbox.x,
+        batch->num_text, parent_pred->bbox.x,
         parent_pred->bbox.y + y_offset, priv->font_size, priv->font_type,
         NEED_TEXT_BG_COLOR, clr.blue, clr.green, clr.red);
 
     LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level,
-        "appending string %s", text_params->disp_text);
-    shape_info->text_params =
-        vvas_list_append (shape_info->text_params, text_params);
+        "appending string %s", text_params.disp_text);
+    if (!vvas_overlay_shape_batch_add_text (batch, &text_params)) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
+          "failed to allocate memory...");
+      return VVAS_RET_ALLOC_ERROR;
+    }
+  }
+
+  if (cache) {
+    VvasMetaConvertNodeCache *record = node_cache_push (cache);
+
+    if (!record) {
+      LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
+          "failed to allocate memory...");
+      return VVAS_RET_ALLOC_ERROR;
+    }
 
-    shape_info->num_text++;
-    free (label_string);
+    record->hash = hash;
+    record->pre_start = pre_start;
+    record->pre_end = pre_end;
+    record->post_start = post_start;
+    shape_mark (batch, &record->post_end);
+    record->dirty = TRUE;
+    record->reusable = !shape_range_has_masks (&pre_start, &pre_end) &&
+        !shape_range_has_masks (&post_start, &record->post_end);
   }
 
   return VVAS_RET_SUCCESS;
 }
 
+/**
+ *  @fn VvasReturnType vvas_metaconvert_prepare_overlay_batch (VvasMetaConvert *meta_convert,
+ *                                                             VvasTreeNode *parent,
+ *                                                             VvasOverlayShapeBatch *batch)
+ *  @param [in] meta_convert - Handle to VVAS Meta convert
+ *  @param [in] parent - Handle to parent node of Inference prediction tree
+ *  @param [out] batch - Shape batch to which overlay shapes are appended
+ *  @return VvasReturnType
+ *  @brief Converts Inference prediction tree to shapes which can be drawn by overlay module
+ */
+VvasReturnType
+vvas_metaconvert_prepare_overlay_batch (VvasMetaConvert * meta_convert,
+    VvasTreeNode * parent, VvasOverlayShapeBatch * batch)
+{
+  return convert_node ((VvasMetaConvertPriv *) meta_convert, parent, batch,
+      NULL);
+}
+
+/**
+ *  @fn VvasReturnType vvas_metaconvert_prepare_overlay_batch_incremental (VvasMetaConvert *meta_convert,
+ *                                                                         VvasTreeNode *parent,
+ *                                                                         VvasOverlayShapeBatch *batch,
+ *                                                                         bool *changed)
+ *  @param [in] meta_convert - Handle to VVAS Meta convert
+ *  @param [in] parent - Handle to parent node of Inference prediction tree
+ *  @param [out] batch - Shape batch to which overlay shapes are appended
+ *  @param [out] changed - Set to FALSE if shapes are same as in previous call, may be NULL
+ *  @return VvasReturnType
+ *  @brief Converts Inference prediction tree to shapes same as
+ *         vvas_metaconvert_prepare_overlay_batch(), but reuses shapes of nodes whose
+ *         inputs hash same as a node of previous call. Only new or modified nodes
+ *         are converted.
+ */
+VvasReturnType
+vvas_metaconvert_prepare_overlay_batch_incremental (VvasMetaConvert *
+    meta_convert, VvasTreeNode * parent, VvasOverlayShapeBatch * batch,
+    bool *changed)
+{
+  VvasMetaConvertPriv *priv = (VvasMetaConvertPriv *) meta_convert;
+  VvasMetaConvertCache *cache = &priv->cache;
+  uint32_t prev_count = cache->prev_count;
+  VvasReturnType vret;
+
+  cache->cur_count = 0;
+  cache->converted = 0;
+  cache->in_order = TRUE;
+
+  vret = convert_node (priv, parent, batch, cache);
+  if (VVAS_IS_ERROR (vret)) {
+    cache->cur_count = 0;
+    return vret;
+  }
+
+  LOG_MESSAGE (LOG_LEVEL_DEBUG, priv->log_level,
+      "converted %u nodes, reused %u nodes", cache->converted,
+      cache->cur_count - cache->converted);
+
+  if (changed)
+    *changed = cache->converted || !cache->in_order ||
+        cache->cur_count != prev_count;
+
+  vret = node_cache_commit (cache, batch);
+  if (VVAS_IS_ERROR (vret)) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
+        "failed to allocate memory for shape cache");
+  }
+
+  return vret;
+}
+
+/**
+ *  @fn void vvas_metaconvert_prepare_overlay_metadata (VvasMetaConvert *meta_convert,
+ *                                                                  VvasTreeNode *parent,
+ *                                                                  VvasOverlayShapeInfo *shape_info));
+ *  @param [in] meta_convert - Handle to VVAS Meta convert
+ *  @param [in] parent - Handle to parent node of Inference prediction tree
+ *  @param [out] shape_info - Handle to overlay information which will be used overlay module to draw bounding box
+ *  @return VvasReturnType
+ *  @brief Converts Inference prediction tree to structure which can be understood by overlay module.
+ *         Shapes are prepared in the shape batch of \p meta_convert and appended to \p shape_info
+ */
+VvasReturnType
+vvas_metaconvert_prepare_overlay_metadata (VvasMetaConvert * meta_convert,
+    VvasTreeNode * parent, VvasOverlayShapeInfo * shape_info)
+{
+  VvasMetaConvertPriv *priv = (VvasMetaConvertPriv *) meta_convert;
+  VvasReturnType vret;
+
+  vvas_overlay_shape_batch_reset (&priv->shape_batch);
+
+  vret = vvas_metaconvert_prepare_overlay_batch (meta_convert, parent,
+      &priv->shape_batch);
+  if (VVAS_IS_ERROR (vret))
+    return vret;
+
+  vret = vvas_overlay_shape_batch_to_info (&priv->shape_batch, shape_info);
+  if (VVAS_IS_ERROR (vret)) {
+    LOG_MESSAGE (LOG_LEVEL_ERROR, priv->log_level,
+        "failed to allocate memory for overlay shapes");
+  }
+
+  return vret;
+}
+
 /**
  *  @fn void vvas_metaconvert_destroy (VvasMetaConvert *meta_convert)
  *  @param [in] meta_convert - Handle to VVAS Meta convert
@@ -1154,13 +1834,23 @@ vvas_metaconvert_destroy (VvasMetaConvert * meta_convert)
   VvasMetaConvertPriv *priv = (VvasMetaConvertPriv *) meta_convert;
   int idx;
 
-  if (priv->allowed_labels_count) {
-    for (idx = 0; idx < priv->allowed_labels_count; idx++)
-      free (priv->allowed_labels[idx]);
-    free (priv->allowed_labels);
-  }
+  free (priv->label_ops);
+
+  for (idx = 0; idx < priv->label_bufs_count; idx++)
+    free (priv->label_bufs[idx].str);
+  free (priv->label_bufs);
+
+  if (priv->class_table)
+    vvas_hash_table_destroy (priv->class_table);
+  free (priv->class_styles);
+
+  vvas_overlay_shape_batch_free (&priv->shape_batch);
+  vvas_overlay_shape_batch_free (&priv->cache.shapes);
+  free (priv->cache.prev);
+  free (priv->cache.cur);
+  free (priv->cache.index);
 
-  if (priv->allowed_classes_count) {
+  if (priv->allowed_classes) {
     for (idx = 0; idx < priv->allowed_classes_count; idx++)
       free (priv->allowed_classes[idx]);
     free (priv->allowed_classes);
@@ -62,6 +62,9 @@ typedef struct {
  * @clock_font_color: font color
  * @clock_x_offset: clock x offset
  * @clock_y_offset: clock y offset
+ * @apply_bg_color: draw a box of @clock_bg_color behind the clock
+ * @clock_bg_color: background color, 0xRRGGBBAA like @clock_font_color. AA
+ *                  is the opacity of the box from 1 to 255, 0 is opaque
  */
 typedef struct {
   bool display_clock;            
@@ -70,6 +73,8 @@ typedef struct {
   uint32_t clock_font_color;
   uint32_t clock_x_offset;
   uint32_t clock_y_offset;    
+  bool apply_bg_color;
+  uint32_t clock_bg_color;
 } VvasOverlayClockInfo;
 
 /**
@@ -78,11 +83,17 @@ typedef struct {
  * @frame_info: frame information
  * @clk_info: clock overlay information
  * @shape_info: Overlay information
+ * @num_threads: number of threads drawing horizontal bands of the frame in
+ *               parallel, including the calling thread. 0 or 1 draws the
+ *               whole frame on the calling thread, values above 64 are
+ *               clamped to 64. Pixels drawn are the same for any number of
+ *               threads
  */
 typedef struct {
   VvasVideoFrame *frame_info;
   VvasOverlayClockInfo clk_info;
   VvasOverlayShapeInfo shape_info;
+  uint32_t num_threads;
 } VvasOverlayFrameInfo;
 
 
@@ -102,6 +113,22 @@ extern "C" {
  */
 VvasReturnType vvas_overlay_process_frame (VvasOverlayFrameInfo *pFrameInfo);
 
+/**
+ * vvas_overlay_process_frame_batch ()
+ * @pFrameInfo: Address of VvasOverlayFrameInfo, shape_info of it is ignored
+ * @batch: Address of VvasOverlayShapeBatch holding shapes to be drawn
+ *
+ * Context: Drawing of shapes in @batch is performed on the given frame.
+ * Shapes are read from contiguous arrays and are not modified, so a batch
+ * can be reset and refilled for every frame without allocating memory.
+ *
+ * Return:
+ * * On Success, returns VVAS_SUCCESS.
+ * * On Failure, returns VVAS_ERROR_*
+ */
+VvasReturnType vvas_overlay_process_frame_batch (VvasOverlayFrameInfo *pFrameInfo,
+    const VvasOverlayShapeBatch *batch);
+
 #ifdef __cplusplus
 }
 #endif
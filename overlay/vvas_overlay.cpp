@@ -22,6 +22,14 @@
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
 #include <vvas_core/vvas_video_priv.h>
+#include "vvas_overlay_glyph.hpp"
+#include "vvas_overlay_raster.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
 using namespace cv;
 
 #include <vvas_core/vvas_log.h>
@@ -35,6 +43,48 @@ using namespace cv;
 #define MAX_META_TEXT 10
 #define MAX_STRING_SIZE 256
 
+/* Pixels of clock background around the clock text */
+#define CLOCK_BG_MARGIN 2
+
+/* Bands drawn per thread, so that threads stay busy when shapes are
+ * gathered in a part of the frame */
+#define OVERLAY_BANDS_PER_THREAD 4
+#define OVERLAY_MIN_BAND_HEIGHT 32
+#define OVERLAY_MAX_THREADS 64
+
+/**
+ *  @fn static int split_text_lines (const char *text,
+ *                                   char meta_str[][MAX_STRING_SIZE])
+ *  @param [in] text - Text to be split
+ *  @param [out] meta_str - Lines of the text, each truncated to MAX_STRING_SIZE - 1
+ *  @return Number of lines in @meta_str, at most MAX_META_TEXT
+ *  @brief Splits text into lines at '\n' skipping empty lines. Unlike strtok_r,
+ *         @text is not modified, so that shapes can be drawn more than once.
+ */
+static int
+split_text_lines (const char *text, char meta_str[][MAX_STRING_SIZE])
+{
+  int str_cnt = 0;
+
+  while (text && *text && str_cnt < MAX_META_TEXT) {
+    size_t len = strcspn (text, "\n");
+
+    if (len) {
+      if (len > MAX_STRING_SIZE - 1)
+        len = MAX_STRING_SIZE - 1;
+      memcpy (meta_str[str_cnt], text, len);
+      meta_str[str_cnt][len] = '\0';
+      str_cnt++;
+      text += strcspn (text, "\n");
+    }
+
+    if (*text == '\n')
+      text++;
+  }
+
+  return str_cnt;
+}
+
 /**
  *  @fn  static void convert_rgb_to_yuv_clrs (VvasOverlayColorData  clr, uint8_t *y, uint16_t *uv)
  *  @param [in] clr  - reference of VvasOverlayColorData 
@@ -43,29 +93,197 @@ using namespace cv;
  *  @return none  
  *  @brief   
  *  @details This funciton retrieves y and uv color components corresponding to 
- *   givne RGB color
+ *   givne RGB color. Components are taken in BGR order as cvtColor
+ *   (COLOR_BGR2YUV_I420) of Scalar (red, green, blue) does, using precomputed
+ *   tables instead of converting an image per shape.
  */
 static void
 convert_rgb_to_yuv_clrs (VvasOverlayColorData & clr, uint8_t * y, uint16_t * uv)
 {
-  Mat YUVmat;
-  Mat BGRmat (2, 2, CV_8UC3, Scalar (clr.red, clr.green, clr.blue));
-  cvtColor (BGRmat, YUVmat, cv::COLOR_BGR2YUV_I420);
-  *y = YUVmat.at < uchar > (0, 0);
-  *uv = YUVmat.at < uchar > (2, 0) << 8 | YUVmat.at < uchar > (2, 1);
+  uint8_t u, v;
+
+  vvas_raster_rgb_to_yuv (clr.blue, clr.green, clr.red, y, &u, &v);
+  *uv = u << 8 | v;
   return;
 }
 
 /**
- *  @fn static void vvas_overlay_draw_rgb_clock ( Mat &img, VvasOverlayClockInfo *pclkInfo) 
+ *  @fn static uint8_t shape_alpha (const VvasOverlayColorData & clr)
+ *  @param [in] clr - reference of VvasOverlayColorData
+ *  @return Opacity of the shape, 255 for opaque
+ *  @brief Shapes that do not set alpha (0) are drawn opaque as before alpha
+ *         was supported.
+ */
+static inline uint8_t
+shape_alpha (const VvasOverlayColorData & clr)
+{
+  return clr.alpha ? clr.alpha : 255;
+}
+
+/**
+ *  @fn static Point text_bg_end (Point txt_end, int line, int num_lines,
+ *                                uint8_t alpha)
+ *  @param [in] txt_end - Bottom right corner of background of a text line
+ *  @param [in] line - Index of the text line
+ *  @param [in] num_lines - Number of text lines
+ *  @param [in] alpha - Opacity of the background
+ *  @return Bottom right corner to fill
+ *  @brief Last row of background of a line is the first row of background of
+ *         next line. It is left to next line for translucent backgrounds so
+ *         that it is not blended twice.
+ */
+static inline Point
+text_bg_end (Point txt_end, int line, int num_lines, uint8_t alpha)
+{
+  if (alpha < 255 && line + 1 < num_lines)
+    return txt_end - Point (0, 1);
+
+  return txt_end;
+}
+
+/**
+ *  @fn static bool mask_class_alphas (const VvasOverlayMaskParams * mask,
+ *                                     uint8_t * alphas)
+ *  @param [in] mask - Mask to be drawn
+ *  @param [out] alphas - Opacity of each of the 256 mask values
+ *  @return true if the mask has pixels to draw
+ *          false if the mask is invalid or fully transparent
+ *  @brief Classes of class maps beyond the palette and the ignored class, and
+ *         zero pixels of binary masks, get opacity 0 and are left untouched.
+ */
+static bool
+mask_class_alphas (const VvasOverlayMaskParams * mask, uint8_t * alphas)
+{
+  uint32_t alpha = mask->alpha ? mask->alpha : 255;
+  uint32_t num_classes = std::min (mask->num_colors, (uint32_t) 256);
+  bool visible = false;
+
+  memset (alphas, 0, 256);
+  if (!mask->mask_data || !mask->palette || !num_classes || !mask->width
+      || !mask->height || !mask->mask_width || !mask->mask_height
+      || mask->mask_stride < mask->mask_width)
+    return false;
+
+  if (mask->mask_type == MASK_TYPE_BINARY) {
+    memset (alphas + 1, (alpha * shape_alpha (mask->palette[0]) + 127) / 255,
+        255);
+    return true;
+  }
+
+  for (uint32_t c = 0; c < num_classes; c++) {
+    if ((int32_t) c == mask->ignore_class)
+      continue;
+    alphas[c] = (alpha * shape_alpha (mask->palette[c]) + 127) / 255;
+    visible = true;
+  }
+
+  return visible;
+}
+
+/**
+ *  @fn static VvasOverlayColorData mask_class_color
+ *                                  (const VvasOverlayMaskParams * mask,
+ *                                   uint32_t value)
+ *  @param [in] mask - Mask to be drawn
+ *  @param [in] value - Value of a mask pixel with non zero opacity
+ *  @return Color of the mask pixels having @value
+ */
+static inline VvasOverlayColorData
+mask_class_color (const VvasOverlayMaskParams * mask, uint32_t value)
+{
+  return mask->mask_type == MASK_TYPE_BINARY ?
+      mask->palette[0] : mask->palette[value];
+}
+
+/**
+ *  @fn static const char * clock_time_string (time_t clock_time)
+ *  @param [in] clock_time - Time shown by the clock
+ *  @return Time formatted as by ctime
+ *  @brief Formats time of the clock. String is kept per thread and formatted
+ *         again only when the time changes.
+ */
+static const char *
+clock_time_string (time_t clock_time)
+{
+  static thread_local time_t formatted = -1;
+  static thread_local char str[64];
+
+  if (clock_time != formatted) {
+    if (!ctime_r (&clock_time, str))
+      str[0] = '\0';
+    formatted = clock_time;
+  }
+
+  return str;
+}
+
+/**
+ *  @fn static VvasOverlayColorData clock_color (uint32_t val)
+ *  @param [in] val - Color of the clock, 0xRRGGBBAA
+ *  @return Color components of @val
+ *  @brief Splits a color of VvasOverlayClockInfo into its components.
+ */
+static inline VvasOverlayColorData
+clock_color (uint32_t val)
+{
+  VvasOverlayColorData clr;
+
+  clr.red = (val >> 24) & 0xff;
+  clr.green = (val >> 16) & 0xff;
+  clr.blue = (val >> 8) & 0xff;
+  clr.alpha = val & 0xff;
+
+  return clr;
+}
+
+/**
+ *  @fn static std::shared_ptr < const vvas_text_bitmap > clock_bitmap (
+ *                              VvasOverlayClockInfo * pclkInfo,
+ *                              time_t clock_time, double scale)
+ *  @param [in] *pclkInfo - Address of the VvasOverlayClockInfo object.
+ *  @param [in] clock_time - Time shown by the clock
+ *  @param [in] scale - Font scale of the plane
+ *  @return Bitmap of the clock text
+ *  @brief Gets bitmap of the clock text. Text changes once per second, so it
+ *         is drawn with putText only then and blitted into other frames.
+ */
+static inline std::shared_ptr < const vvas_text_bitmap >
+clock_bitmap (VvasOverlayClockInfo * pclkInfo, time_t clock_time, double scale)
+{
+  return vvas_text_bitmap_get (clock_time_string (clock_time),
+      pclkInfo->clock_font_name, scale, 1, 1);
+}
+
+/**
+ *  @fn static void clock_bg_corners (const Rect & box, Point * pt1, Point * pt2)
+ *  @param [in] box - Box of the clock text
+ *  @param [out] pt1 - Top left corner of the background
+ *  @param [out] pt2 - Bottom right corner of the background, included
+ *  @brief Gets background of the clock, @box with a margin. Corners are
+ *         aligned to 2x2 pixel blocks so that chroma of 4:2:0 frames covers
+ *         same pixels as luma.
+ */
+static inline void
+clock_bg_corners (const Rect & box, Point * pt1, Point * pt2)
+{
+  *pt1 = Point ((box.x - CLOCK_BG_MARGIN) & ~1, (box.y - CLOCK_BG_MARGIN) & ~1);
+  *pt2 = Point ((box.x + box.width + CLOCK_BG_MARGIN - 1) | 1,
+      (box.y + box.height + CLOCK_BG_MARGIN - 1) | 1);
+}
+
+/**
+ *  @fn static void vvas_overlay_draw_rgb_clock ( Mat &img, VvasOverlayClockInfo *pclkInfo,
+ *                                                time_t clock_time)
  *  @param [in] img  - Reference of img object to which clock needs to be drawn.
  *  @param [in] *pclkInfo - Address of the VvasOverlayClockInfo object.
+ *  @param [in] clock_time - Time shown by the clock.
  *  @return none  
  *  @brief   
  *  @details This funciton draws clock on the image.
  */
 static void
-vvas_overlay_draw_rgb_clock (Mat & img, VvasOverlayClockInfo * pclkInfo)
+vvas_overlay_draw_rgb_clock (Mat & img, VvasOverlayClockInfo * pclkInfo,
+    time_t clock_time)
 {
   if (NULL == pclkInfo) {
     LOG_E ("pclkInfo null received");
@@ -73,42 +291,38 @@ vvas_overlay_draw_rgb_clock (Mat & img, VvasOverlayClockInfo * pclkInfo)
   }
 
   if (pclkInfo->display_clock) {
+    VvasOverlayColorData clr = clock_color (pclkInfo->clock_font_color);
+    Point org (pclkInfo->clock_x_offset, pclkInfo->clock_y_offset);
+    uint8_t text_clr[3] = { clr.red, clr.green, clr.blue };
+    std::shared_ptr < const vvas_text_bitmap > bitmap =
+        clock_bitmap (pclkInfo, clock_time, pclkInfo->clock_font_scale);
+
+    if (pclkInfo->apply_bg_color) {
+      VvasOverlayColorData bg = clock_color (pclkInfo->clock_bg_color);
+      uint8_t bg_clr[3] = { bg.red, bg.green, bg.blue };
+      Point pt1, pt2;
+
+      clock_bg_corners (bitmap->bounds (org), &pt1, &pt2);
+      vvas_raster_fill (img, pt1, pt2, bg_clr, shape_alpha (bg));
+    }
 
-    time_t curtime;
-    char clock_time_string[256];
-    uint32_t v1, v2, v3, val;
-    memset (clock_time_string, 0, sizeof (clock_time_string));
-
-    time (&curtime);
-    sprintf (clock_time_string, "%s", ctime (&curtime));
-
-    val = pclkInfo->clock_font_color;
-    val = val >> 8;
-
-    v3 = val & 0xff;
-    val = val >> 8;
-    v2 = val & 0xff;
-    val = val >> 8;
-    v1 = val & 0xff;
-
-    putText (img, clock_time_string,
-        Point (pclkInfo->clock_x_offset, pclkInfo->clock_y_offset),
-        pclkInfo->clock_font_name, pclkInfo->clock_font_scale, Scalar (v1,
-            v2, v3), 1, 1);
-
+    bitmap->draw (img, org, text_clr);
   }
 }
 
 /**
- *  @fn static void vvas_overlay_draw_grey_clock ( Mat &img, VvasOverlayClockInfo *pclkInfo) 
+ *  @fn static void vvas_overlay_draw_grey_clock ( Mat &img, VvasOverlayClockInfo *pclkInfo,
+ *                                                 time_t clock_time)
  *  @param [in] img  - Reference of img object to which clock needs to be drawn.
  *  @param [in] *pclkInfo - Address of the VvasOverlayClockInfo object.
+ *  @param [in] clock_time - Time shown by the clock.
  *  @return none  
  *  @brief   
  *  @details This funciton draws clock on the image.
  */
 static void
-vvas_overlay_draw_gray_clock (Mat & img, VvasOverlayClockInfo * pclkInfo)
+vvas_overlay_draw_gray_clock (Mat & img, VvasOverlayClockInfo * pclkInfo,
+    time_t clock_time)
 {
   if (NULL == pclkInfo) {
     LOG_E ("pclkInfo null received");
@@ -116,46 +330,40 @@ vvas_overlay_draw_gray_clock (Mat & img, VvasOverlayClockInfo * pclkInfo)
   }
 
   if (pclkInfo->display_clock) {
+    VvasOverlayColorData clr = clock_color (pclkInfo->clock_font_color);
+    Point org (pclkInfo->clock_x_offset, pclkInfo->clock_y_offset);
+    uint8_t gray_val = (clr.red + clr.green + clr.blue) / 3;
+    std::shared_ptr < const vvas_text_bitmap > bitmap =
+        clock_bitmap (pclkInfo, clock_time, pclkInfo->clock_font_scale);
+
+    if (pclkInfo->apply_bg_color) {
+      VvasOverlayColorData bg = clock_color (pclkInfo->clock_bg_color);
+      uint8_t bg_val = (bg.red + bg.green + bg.blue) / 3;
+      Point pt1, pt2;
+
+      clock_bg_corners (bitmap->bounds (org), &pt1, &pt2);
+      vvas_raster_fill (img, pt1, pt2, &bg_val, shape_alpha (bg));
+    }
 
-    time_t curtime;
-    char clock_time_string[256];
-    uint32_t v1, v2, v3, val, gray_val;
-
-    memset (clock_time_string, 0, sizeof (clock_time_string));
-
-    time (&curtime);
-    sprintf (clock_time_string, "%s", ctime (&curtime));
-
-    val = pclkInfo->clock_font_color;
-    val = val >> 8;
-    v3 = val & 0xff;
-    val = val >> 8;
-    v2 = val & 0xff;
-    val = val >> 8;
-    v1 = val & 0xff;
-
-    gray_val = (v1 + v2 + v3) / 3;
-
-    putText (img, clock_time_string,
-        Point (pclkInfo->clock_x_offset, pclkInfo->clock_y_offset),
-        pclkInfo->clock_font_name, pclkInfo->clock_font_scale,
-        Scalar (gray_val), 1, 1);
+    bitmap->draw (img, org, &gray_val);
   }
 }
 
 /**
  *  @fn static void vvas_overlay_draw_nv12_clock ( Mat &img_y,  Mat &img_uv, 
- *                                                            VvasOverlayClockInfo *pclkInfo) 
+ *                                                            VvasOverlayClockInfo *pclkInfo,
+ *                                                            time_t clock_time)
  *  @param [in] img  - Reference of img object to which clock needs to be drawn (Y plane).
  *  @param [in] img  - Reference of img object to which clock needs to be drawn (UV plane).
  *  @param [in] *pclkInfo - Address of the VvasOverlayClockInfo object.
+ *  @param [in] clock_time - Time shown by the clock.
  *  @return none  
  *  @brief   
  *  @details This funciton draws clock on the image.
  */
 static void
 vvas_overlay_draw_nv12_clock (Mat & img_y, Mat & img_uv,
-    VvasOverlayClockInfo * pclkInfo)
+    VvasOverlayClockInfo * pclkInfo, time_t clock_time)
 {
   if (NULL == pclkInfo) {
     LOG_E ("pclkInfo null received");
@@ -163,47 +371,47 @@ vvas_overlay_draw_nv12_clock (Mat & img_y, Mat & img_uv,
   }
 
   if (pclkInfo->display_clock) {
-    char clock_time_string[256];
     int32_t xmin, ymin;
-    uint32_t v1, v2, v3, val;
     uint8_t yScalar;
     uint16_t uvScalar;
-    VvasOverlayColorData clr;
-    memset (clock_time_string, 0, sizeof (clock_time_string));
-
-    val = pclkInfo->clock_font_color;
-
-    val = val >> 8;
-    v3 = val & 0xff;
-    val = val >> 8;
-    v2 = val & 0xff;
-    val = val >> 8;
-    v1 = val & 0xff;
-
-    clr.red = v1;
-    clr.green = v2;
-    clr.blue = v3;
+    VvasOverlayColorData clr = clock_color (pclkInfo->clock_font_color);
 
     convert_rgb_to_yuv_clrs (clr, &yScalar, &uvScalar);
 
     xmin = floor (pclkInfo->clock_x_offset / 2) * 2;
     ymin = floor (pclkInfo->clock_y_offset / 2) * 2;
 
-    putText (img_y, clock_time_string, Point (xmin, ymin),
-        pclkInfo->clock_font_name, pclkInfo->clock_font_scale,
-        Scalar (yScalar), 1, 1);
+    /* chroma is subsampled, so its text is drawn at half scale */
+    std::shared_ptr < const vvas_text_bitmap > bitmap_y =
+        clock_bitmap (pclkInfo, clock_time, pclkInfo->clock_font_scale);
+    std::shared_ptr < const vvas_text_bitmap > bitmap_uv =
+        clock_bitmap (pclkInfo, clock_time, pclkInfo->clock_font_scale / 2);
+
+    if (pclkInfo->apply_bg_color) {
+      VvasOverlayColorData bg = clock_color (pclkInfo->clock_bg_color);
+      uint8_t bg_yScalar;
+      uint16_t bg_uvScalar;
+      Point pt1, pt2;
+
+      convert_rgb_to_yuv_clrs (bg, &bg_yScalar, &bg_uvScalar);
+      clock_bg_corners (bitmap_y->bounds (Point (xmin, ymin)), &pt1, &pt2);
+      vvas_raster_fill (img_y, pt1, pt2, &bg_yScalar, shape_alpha (bg));
+      vvas_raster_fill (img_uv, Point (pt1.x >> 1, pt1.y >> 1),
+          Point (pt2.x >> 1, pt2.y >> 1), (const uint8_t *) &bg_uvScalar,
+          shape_alpha (bg));
+    }
 
-    putText (img_uv, clock_time_string, Point (xmin / 2, ymin / 2),
-        pclkInfo->clock_font_name, pclkInfo->clock_font_scale / 2,
-        Scalar (uvScalar), 1, 1);
+    bitmap_y->draw (img_y, Point (xmin, ymin), &yScalar);
+    bitmap_uv->draw (img_uv, Point (xmin / 2, ymin / 2),
+        (const uint8_t *) &uvScalar);
   }
 }
 
 /**
- *  @fn  static void vvas_overlay_rgb_draw_rect( Mat &img, VvasOverlayFrameInfo *pFrameInfo
+ *  @fn  static void vvas_overlay_rgb_draw_rect( Mat &img, const VvasOverlayShapeBatch *batch
  *                                               VvasVideoFrameMapInfo *info) 
  *  @param [in] *img  - image container.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @param [in] *Info - VvasVideoFrameMapInfo address.
  *  @return none  
  *  @brief   
@@ -211,31 +419,28 @@ vvas_overlay_draw_nv12_clock (Mat & img_y, Mat & img_uv,
  *
  */
 static void
-vvas_overlay_rgb_draw_rect (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
+vvas_overlay_rgb_draw_rect (Mat & img, const VvasOverlayShapeBatch * batch,
     VvasVideoFrameMapInfo * info)
 {
 
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
-  uint32_t v1 = 0;
-  uint32_t v2 = 0;
-  uint32_t v3 = 0;
-  uint32_t num_rects = pFrameInfo->shape_info.num_rects;
+  uint8_t clr[3];
+  uint32_t num_rects = batch->num_rects;
   uint32_t thickness = 0;
   VvasOverlayColorData ol_color;
-  VvasList *head = NULL;
+  uint32_t idx;
 
   memset (&ol_color, 0, sizeof (ol_color));
 
   //Drawing rectangles
   if (num_rects) {
 
-    head = pFrameInfo->shape_info.rect_params;
-    VvasOverlayRectParams *rect;
-    while (head) {
-      rect = (VvasOverlayRectParams *) head->data;
+        VvasOverlayRectParams *rect;
+    for (idx = 0; idx < num_rects; idx++) {
+      rect = &batch->rects[idx];
       if (rect->apply_bg_color) {
         thickness = FILLED;
         ol_color = rect->bg_color;
@@ -245,28 +450,27 @@ vvas_overlay_rgb_draw_rect (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
       }
 
       if (VVAS_VIDEO_FORMAT_BGR == info->fmt) {
-        v1 = ol_color.blue;
-        v2 = ol_color.green;
-        v3 = ol_color.red;
+        clr[0] = ol_color.blue;
+        clr[1] = ol_color.green;
+        clr[2] = ol_color.red;
       } else {
-        v1 = ol_color.red;
-        v2 = ol_color.green;
-        v3 = ol_color.blue;
+        clr[0] = ol_color.red;
+        clr[1] = ol_color.green;
+        clr[2] = ol_color.blue;
       }
 
-      rectangle (img, Rect (Point (rect->points.x,
+      vvas_raster_rect (img, Rect (Point (rect->points.x,
                   rect->points.y), Size (rect->width, rect->height)),
-          Scalar (v1, v2, v3), thickness, 1, 0);
-      head = head->next;
+          thickness, clr, shape_alpha (ol_color));
     }
   }
 }
 
  /**
- *  @fn  static void vvas_overlay_rgb_draw_text( Mat &img, VvasOverlayFrameInfo *pFrameInfo,
+ *  @fn  static void vvas_overlay_rgb_draw_text( Mat &img, const VvasOverlayShapeBatch *batch,
  *                                               VvasVideoFrameMapInfo *info)
  *  @param [in] *img  - image container.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @param [in] *Info - VvasVideoFrameMapInfo address.
  *  @return none  
  *  @brief   
@@ -274,66 +478,49 @@ vvas_overlay_rgb_draw_rect (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
  *
  */
 static void
-vvas_overlay_rgb_draw_text (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
+vvas_overlay_rgb_draw_text (Mat & img, const VvasOverlayShapeBatch * batch,
     VvasVideoFrameMapInfo * info)
 {
 
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
-  uint32_t v1 = 0;
-  uint32_t v2 = 0;
-  uint32_t v3 = 0;
+  uint8_t bg_clr[3];
   uint32_t v1_t = 0;
   uint32_t v2_t = 0;
   uint32_t v3_t = 0;
-  uint32_t num_text = pFrameInfo->shape_info.num_text;
+  uint32_t num_text = batch->num_text;
   VvasOverlayColorData ol_color;
-  VvasList *head = NULL;
+  uint32_t idx;
   char meta_str[MAX_META_TEXT][MAX_STRING_SIZE];
   Size text_size[MAX_META_TEXT];
   int base_line[MAX_META_TEXT];
   int str_cnt = 0;
-  char *token;
   int tot_height;
   Point txt_start, txt_end;
   int thickness = 1;
-  char *save_ptr = NULL;
+  uint8_t text_clr[3];
 
   memset (&ol_color, 0, sizeof (ol_color));
 
   //Drawing text
   if (num_text) {
     VvasOverlayTextParams *text_info;
-    head = pFrameInfo->shape_info.text_params;
-
-    while (head) {
-      text_info = (VvasOverlayTextParams *) head->data;
-      str_cnt = 0;
 
-      token = NULL;
-      token = strtok_r (text_info->disp_text, "\n", &save_ptr);
-      while (token != NULL) {
-        
-        /* Below code will print car detection and classification results in separate rows */
-        strncpy (meta_str[str_cnt], token, MAX_STRING_SIZE);
+    for (idx = 0; idx < num_text; idx++) {
+      text_info = &batch->texts[idx];
+      str_cnt = split_text_lines (text_info->disp_text, meta_str);
 
-        /* Terminate with '\0' charector */
-        meta_str[str_cnt][MAX_STRING_SIZE -1] = '\0';
-        
-        str_cnt++;
-
-        if (str_cnt >= MAX_META_TEXT)
-          break;
-        token = strtok_r (NULL, "\n", &save_ptr);
-      }
+      /* glyphs are rasterized once per font and reused for all texts */
+      std::shared_ptr < const vvas_glyph_atlas > atlas =
+          vvas_glyph_atlas_get (text_info->text_font.font_num,
+          text_info->text_font.font_size, 1);
 
       tot_height = 0;
       for (int i = 0; i < str_cnt; i++) {
         base_line[i] = 0;
-        text_size[i] = getTextSize (meta_str[i], text_info->text_font.font_num,
-            text_info->text_font.font_size, thickness, &base_line[i]);
+        text_size[i] = atlas->measure (meta_str[i], thickness, &base_line[i]);
         base_line[i] += thickness;
         base_line[i] = base_line[i] + 4;
         tot_height += (text_size[i].height + base_line[i]);
@@ -349,13 +536,13 @@ vvas_overlay_rgb_draw_text (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
         ol_color = text_info->bg_color;
 
         if (VVAS_VIDEO_FORMAT_BGR == info->fmt) {
-          v1 = ol_color.blue;
-          v2 = ol_color.green;
-          v3 = ol_color.red;
+          bg_clr[0] = ol_color.blue;
+          bg_clr[1] = ol_color.green;
+          bg_clr[2] = ol_color.red;
         } else {
-          v1 = ol_color.red;
-          v2 = ol_color.green;
-          v3 = ol_color.blue;
+          bg_clr[0] = ol_color.red;
+          bg_clr[1] = ol_color.green;
+          bg_clr[2] = ol_color.blue;
         }
       }
 
@@ -371,29 +558,31 @@ vvas_overlay_rgb_draw_text (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
         v3_t = ol_color.blue;
       }
 
+      text_clr[0] = v1_t;
+      text_clr[1] = v2_t;
+      text_clr[2] = v3_t;
+
       for (int i = 0; i < str_cnt; i++) {
         txt_end = txt_start +
             Point (text_size[i].width, text_size[i].height + base_line[i]);
         if (text_info->apply_bg_color)
-          rectangle (img, txt_start, txt_end, Scalar (v1, v2, v3), FILLED, 1,
-              0);
+          vvas_raster_fill (img, txt_start, text_bg_end (txt_end, i, str_cnt,
+                  shape_alpha (text_info->bg_color)), bg_clr,
+              shape_alpha (text_info->bg_color));
 
         txt_start = txt_start + Point (0, text_size[i].height + 4);
-        putText (img, meta_str[i], txt_start, text_info->text_font.font_num,
-            text_info->text_font.font_size, Scalar (v1_t, v2_t, v3_t), 1);
+        atlas->draw (img, meta_str[i], txt_start, text_clr);
         txt_start = txt_start + Point (0, (base_line[i] - 4));
       }
-
-      head = head->next;
     }
   }
 }
 
 /**
- *  @fn  static void vvas_overlay_rgb_draw_line( Mat &img, VvasOverlayFrameInfo *pFrameInfo, 
+ *  @fn  static void vvas_overlay_rgb_draw_line( Mat &img, const VvasOverlayShapeBatch *batch, 
  *                                               VvasVideoFrameMapInfo *info)
  *  @param [in] *img  - image container.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @param [in] *Info - VvasVideoFrameMapInfo address.
  *  @return none  
  *  @brief   
@@ -401,52 +590,47 @@ vvas_overlay_rgb_draw_text (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
  *
  */
 static void
-vvas_overlay_rgb_draw_line (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
+vvas_overlay_rgb_draw_line (Mat & img, const VvasOverlayShapeBatch * batch,
     VvasVideoFrameMapInfo * info)
 {
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
-  uint32_t v1 = 0;
-  uint32_t v2 = 0;
-  uint32_t v3 = 0;
-  uint32_t num_lines = pFrameInfo->shape_info.num_lines;
+  uint8_t clr[3];
+  uint32_t num_lines = batch->num_lines;
   VvasOverlayColorData ol_color;
-  VvasList *head = NULL;
+  uint32_t idx;
   memset (&ol_color, 0, sizeof (ol_color));
 
   //Drawing lines
   if (num_lines) {
     VvasOverlayLineParams *line_info;
-    head = pFrameInfo->shape_info.line_params;
-    while (head) {
-      line_info = (VvasOverlayLineParams *) head->data;
+    for (idx = 0; idx < num_lines; idx++) {
+      line_info = &batch->lines[idx];
       ol_color = line_info->line_color;
 
       if (VVAS_VIDEO_FORMAT_BGR == info->fmt) {
-        v1 = ol_color.blue;
-        v2 = ol_color.green;
-        v3 = ol_color.red;
+        clr[0] = ol_color.blue;
+        clr[1] = ol_color.green;
+        clr[2] = ol_color.red;
       } else {
-        v1 = ol_color.red;
-        v2 = ol_color.green;
-        v3 = ol_color.blue;
+        clr[0] = ol_color.red;
+        clr[1] = ol_color.green;
+        clr[2] = ol_color.blue;
       }
-      line (img, Point (line_info->start_pt.x,
+      vvas_raster_line (img, Point (line_info->start_pt.x,
               line_info->start_pt.y), Point (line_info->end_pt.x,
-              line_info->end_pt.y),
-          Scalar (v1, v2, v3), line_info->thickness, 1, 0);
-      head = head->next;
+              line_info->end_pt.y), line_info->thickness, clr);
     }
   }
 }
 
 /**
- *  @fn  static void vvas_overlay_rgb_draw_arrow( Mat &img, VvasOverlayFrameInfo *pFrameInfo, 
+ *  @fn  static void vvas_overlay_rgb_draw_arrow( Mat &img, const VvasOverlayShapeBatch *batch, 
  *                                               VvasVideoFrameMapInfo *info)
  *  @param [in] *img  - image container.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @param [in] *Info - VvasVideoFrameMapInfo address.
  *  @return none  
  *  @brief   
@@ -454,57 +638,54 @@ vvas_overlay_rgb_draw_line (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
  *
  */
 static void
-vvas_overlay_rgb_draw_arrow (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
+vvas_overlay_rgb_draw_arrow (Mat & img, const VvasOverlayShapeBatch * batch,
     VvasVideoFrameMapInfo * info)
 {
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
   int32_t mid_x = 0;
   int32_t mid_y = 0;
-  uint32_t v1 = 0;
-  uint32_t v2 = 0;
-  uint32_t v3 = 0;
+  uint8_t clr[3];
   uint32_t thickness = 0;
-  uint32_t num_arrows = pFrameInfo->shape_info.num_arrows;
+  uint32_t num_arrows = batch->num_arrows;
   VvasOverlayColorData ol_color;
-  VvasList *head = NULL;
+  uint32_t idx;
   memset (&ol_color, 0, sizeof (ol_color));
 
   //Drawing arrows
   if (num_arrows) {
     VvasOverlayArrowParams *arrow_info;
-    head = pFrameInfo->shape_info.arrow_params;
 
-    while (head) {
-      arrow_info = (VvasOverlayArrowParams *) head->data;
+    for (idx = 0; idx < num_arrows; idx++) {
+      arrow_info = &batch->arrows[idx];
 
       ol_color = arrow_info->line_color;
 
       if (VVAS_VIDEO_FORMAT_BGR == info->fmt) {
-        v1 = ol_color.blue;
-        v2 = ol_color.green;
-        v3 = ol_color.red;
+        clr[0] = ol_color.blue;
+        clr[1] = ol_color.green;
+        clr[2] = ol_color.red;
       } else {
-        v1 = ol_color.red;
-        v2 = ol_color.green;
-        v3 = ol_color.blue;
+        clr[0] = ol_color.red;
+        clr[1] = ol_color.green;
+        clr[2] = ol_color.blue;
       }
       thickness = arrow_info->thickness;
       switch (arrow_info->arrow_direction) {
         case ARROW_DIRECTION_START:{
-          arrowedLine (img, Point (arrow_info->end_pt.x,
-                  arrow_info->end_pt.y), Point (arrow_info->start_pt.x,
-                  arrow_info->start_pt.y), Scalar (v1, v2, v3),
-              thickness, 1, 0, arrow_info->tipLength);
+          vvas_raster_arrow (img,
+              Point (arrow_info->end_pt.x, arrow_info->end_pt.y),
+              Point (arrow_info->start_pt.x, arrow_info->start_pt.y), thickness,
+              arrow_info->tipLength, clr);
         }
           break;
         case ARROW_DIRECTION_END:{
-          arrowedLine (img, Point (arrow_info->start_pt.x,
-                  arrow_info->start_pt.y), Point (arrow_info->end_pt.x,
-                  arrow_info->end_pt.y), Scalar (v1, v2, v3),
-              thickness, 1, 0, arrow_info->tipLength);
+          vvas_raster_arrow (img,
+              Point (arrow_info->start_pt.x, arrow_info->start_pt.y),
+              Point (arrow_info->end_pt.x, arrow_info->end_pt.y), thickness,
+              arrow_info->tipLength, clr);
         }
           break;
         case ARROW_DIRECTION_BOTH_ENDS:{
@@ -525,28 +706,27 @@ vvas_overlay_rgb_draw_arrow (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
                 arrow_info->end_pt.y) / 2;
           }
 
-          arrowedLine (img, Point (mid_x, mid_y),
-              Point (arrow_info->end_pt.x, arrow_info->end_pt.y),
-              Scalar (v1, v2, v3), thickness, 1, 0, arrow_info->tipLength / 2);
+          vvas_raster_arrow (img, Point (mid_x, mid_y),
+              Point (arrow_info->end_pt.x, arrow_info->end_pt.y), thickness,
+              arrow_info->tipLength / 2, clr);
 
-          arrowedLine (img, Point (mid_x, mid_y),
-              Point (arrow_info->start_pt.x, arrow_info->start_pt.y),
-              Scalar (v1, v2, v3), thickness, 1, 0, arrow_info->tipLength / 2);
+          vvas_raster_arrow (img, Point (mid_x, mid_y),
+              Point (arrow_info->start_pt.x, arrow_info->start_pt.y), thickness,
+              arrow_info->tipLength / 2, clr);
         }
           break;
         default:
           break;
       }
-      head = head->next;
     }
   }
 }
 
 /**
- *  @fn  static void vvas_overlay_rgb_draw_circle( Mat &img, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_rgb_draw_circle( Mat &img, const VvasOverlayShapeBatch *batch) 
  *                                               VvasVideoFrameMapInfo *info)
  *  @param [in] *img  - image container.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @param [in] *Info - VvasVideoFrameMapInfo address.
  *  @return none  
  *  @brief   
@@ -554,45 +734,41 @@ vvas_overlay_rgb_draw_arrow (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
  *
  */
 static void
-vvas_overlay_rgb_draw_circle (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
+vvas_overlay_rgb_draw_circle (Mat & img, const VvasOverlayShapeBatch * batch,
     VvasVideoFrameMapInfo * info)
 {
 
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
-  uint32_t v1 = 0;
-  uint32_t v2 = 0;
-  uint32_t v3 = 0;
-  uint32_t num_circles = pFrameInfo->shape_info.num_circles;
+  uint8_t clr[3];
+  uint32_t num_circles = batch->num_circles;
   VvasOverlayColorData ol_color;
-  VvasList *head = NULL;
+  uint32_t idx;
   memset (&ol_color, 0, sizeof (ol_color));
 
   /* check how many circles need to be drawn */
   if (num_circles) {
     VvasOverlayCircleParams *circle_info;
-    head = pFrameInfo->shape_info.circle_params;
 
-    while (head) {
-      circle_info = (VvasOverlayCircleParams *) head->data;
+    for (idx = 0; idx < num_circles; idx++) {
+      circle_info = &batch->circles[idx];
       ol_color = circle_info->circle_color;
 
       if (VVAS_VIDEO_FORMAT_BGR == info->fmt) {
-        v1 = ol_color.blue;
-        v2 = ol_color.green;
-        v3 = ol_color.red;
+        clr[0] = ol_color.blue;
+        clr[1] = ol_color.green;
+        clr[2] = ol_color.red;
       } else {
-        v1 = ol_color.red;
-        v2 = ol_color.green;
-        v3 = ol_color.blue;
+        clr[0] = ol_color.red;
+        clr[1] = ol_color.green;
+        clr[2] = ol_color.blue;
       }
 
-      circle (img, Point (circle_info->center_pt.x,
+      vvas_raster_circle (img, Point (circle_info->center_pt.x,
               circle_info->center_pt.y), circle_info->radius,
-          Scalar (v1, v2, v3), circle_info->thickness, 1, 0);
-      head = head->next;
+          circle_info->thickness, clr);
     }
   }
 
@@ -600,10 +776,10 @@ vvas_overlay_rgb_draw_circle (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
 
  /**
  *  @fn  static void vvas_overlay_rgb_draw_polygon( Mat &img, 
- *                                                  VvasOverlayFrameInfo *pFrameInfo,
+ *                                                  const VvasOverlayShapeBatch *batch,
  *                                                  VvasVideoFrameMapInfo *info) 
  *  @param [in] *img  - image container.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @param [in] *Info - VvasVideoFrameMapInfo address.
  *  @return none  
  *  @brief   
@@ -612,64 +788,114 @@ vvas_overlay_rgb_draw_circle (Mat & img, VvasOverlayFrameInfo * pFrameInfo,
  */
 static void
 vvas_overlay_rgb_draw_polygon (Mat & img,
-    VvasOverlayFrameInfo * pFrameInfo, VvasVideoFrameMapInfo * info)
+    const VvasOverlayShapeBatch * batch, VvasVideoFrameMapInfo * info)
 {
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
-  uint32_t v1 = 0;
-  uint32_t v2 = 0;
-  uint32_t v3 = 0;
-  uint32_t num_polys = pFrameInfo->shape_info.num_polys;
+  uint8_t clr[3];
+  uint32_t num_polys = batch->num_polys;
   VvasOverlayColorData ol_color;
-  VvasList *head = NULL, *pt_head = NULL;
+  uint32_t idx, pt;
   memset (&ol_color, 0, sizeof (ol_color));
 
   /* check how many polygons need to be drawn */
   if (num_polys) {
     VvasOverlayPolygonParams *poly_info;
+    VvasOverlayCoordinates *pt_info;
     std::vector < Point > poly_pts;
     const Point *pts;
-    head = pFrameInfo->shape_info.polygn_params;
-    while (head) {
-      poly_info = (VvasOverlayPolygonParams *) head->data;
+    for (idx = 0; idx < num_polys; idx++) {
+      poly_info = &batch->polygons[idx];
       ol_color = poly_info->poly_color;
 
       if (VVAS_VIDEO_FORMAT_BGR == info->fmt) {
-        v1 = ol_color.blue;
-        v2 = ol_color.green;
-        v3 = ol_color.red;
+        clr[0] = ol_color.blue;
+        clr[1] = ol_color.green;
+        clr[2] = ol_color.red;
       } else {
-        v1 = ol_color.red;
-        v2 = ol_color.green;
-        v3 = ol_color.blue;
+        clr[0] = ol_color.red;
+        clr[1] = ol_color.green;
+        clr[2] = ol_color.blue;
       }
 
       poly_pts.clear ();
-      pt_head = poly_info->poly_pts;
-      VvasOverlayCoordinates *pt_info;
-      while (pt_head) {
-        pt_info = (VvasOverlayCoordinates *) pt_head->data;
-        poly_pts.push_back (Point (pt_info->x, pt_info->y));
-        pt_head = pt_head->next;
-      }
+      pt_info = &batch->points[batch->poly_pt_offsets[idx]];
+      for (pt = 0; pt < (uint32_t) poly_info->num_pts; pt++)
+        poly_pts.push_back (Point (pt_info[pt].x, pt_info[pt].y));
 
       pts = (const Point *) Mat (poly_pts).data;
 
       /* draws poloygon on the image buffer */
-      polylines (img, &pts, &poly_info->num_pts, 1, true,
-          Scalar (v1, v2, v3), poly_info->thickness, 1, 0);
-      head = head->next;
+      vvas_raster_polyline (img, pts, poly_info->num_pts, true,
+          poly_info->thickness, clr, shape_alpha (poly_info->poly_color));
+    }
+  }
+}
+
+/**
+ *  @fn  static void vvas_overlay_rgb_draw_mask (Mat &img,
+ *                                              const VvasOverlayShapeBatch *batch,
+ *                                              VvasVideoFrameMapInfo *info)
+ *  @param [in] *img  - image container.
+ *  @param [in] *batch - shapes to be drawn.
+ *  @param [in] *Info - VvasVideoFrameMapInfo address.
+ *  @return none
+ *  @brief
+ *  @details This funciton blends masks on the given frame
+ *
+ */
+static void
+vvas_overlay_rgb_draw_mask (Mat & img, const VvasOverlayShapeBatch * batch,
+    VvasVideoFrameMapInfo * info)
+{
+  if (NULL == batch) {
+    return;
+  }
+
+  uint8_t values[256 * 3] = { 0 };
+  uint8_t alphas[256];
+  VvasOverlayMaskParams *mask;
+  VvasOverlayColorData clr;
+  uint32_t idx, c;
+
+  for (idx = 0; idx < batch->num_masks; idx++) {
+    mask = &batch->masks[idx];
+    if (!mask_class_alphas (mask, alphas))
+      continue;
+
+    for (c = 0; c < 256; c++) {
+      if (!alphas[c])
+        continue;
+
+      clr = mask_class_color (mask, c);
+      if (VVAS_VIDEO_FORMAT_BGR == info->fmt) {
+        values[c * 3] = clr.blue;
+        values[c * 3 + 2] = clr.red;
+      } else {
+        values[c * 3] = clr.red;
+        values[c * 3 + 2] = clr.blue;
+      }
+      values[c * 3 + 1] = clr.green;
     }
+
+    vvas_raster_mask (img, Rect (mask->points.x, mask->points.y, mask->width,
+            mask->height), mask->mask_data, mask->mask_width,
+        mask->mask_height, mask->mask_stride, values, alphas,
+        MASK_SCALING_BILINEAR == mask->scaling);
   }
 }
 
 /**
  *  @fn VvasReturnType vvas_overlay_rgb_draw(VvasOverlayFrameInfo *pFrameInfo,
- *                                          VvasVideoFrameMapInfo *info)
+ *                                          const VvasOverlayShapeBatch *batch,
+ *                                          VvasVideoFrameMapInfo *info,
+ *                                          time_t clock_time)
  *  @param [in] *pFrameInfo  OverlayFrameInformation.
+ *  @param [in] *batch  Shapes to be drawn.
  *  @param [in] *Info  Map info structure.
+ *  @param [in] clock_time  Time shown by the clock.
  *  @return On Success returns VVAS_RET_SUCCESS 
  *          On Failure returns VVAS_ERROR_*  
  *  @brief   
@@ -678,7 +904,8 @@ vvas_overlay_rgb_draw_polygon (Mat & img,
  */
 static VvasReturnType
 vvas_overlay_rgb_draw (VvasOverlayFrameInfo * pFrameInfo,
-    VvasVideoFrameMapInfo * info)
+    const VvasOverlayShapeBatch * batch, VvasVideoFrameMapInfo * info,
+    time_t clock_time)
 {
   VvasReturnType ret = VVAS_RET_SUCCESS;
 
@@ -694,36 +921,39 @@ vvas_overlay_rgb_draw (VvasOverlayFrameInfo * pFrameInfo,
 
   Mat img (img_height, img_width, CV_8UC3, in_plane1, stride);
 
+  /* blends masks below all other shapes */
+  vvas_overlay_rgb_draw_mask (img, batch, info);
+
   /* draw clock info */
-  vvas_overlay_draw_rgb_clock (img, &pFrameInfo->clk_info);
+  vvas_overlay_draw_rgb_clock (img, &pFrameInfo->clk_info, clock_time);
 
   /* draws rectangle pattern on the image */
-  vvas_overlay_rgb_draw_rect (img, pFrameInfo, info);
+  vvas_overlay_rgb_draw_rect (img, batch, info);
 
   /* draws text information on image */
-  vvas_overlay_rgb_draw_text (img, pFrameInfo, info);
+  vvas_overlay_rgb_draw_text (img, batch, info);
 
   /* draws line pattern on image */
-  vvas_overlay_rgb_draw_line (img, pFrameInfo, info);
+  vvas_overlay_rgb_draw_line (img, batch, info);
 
   /* draws arrow pattern on image */
-  vvas_overlay_rgb_draw_arrow (img, pFrameInfo, info);
+  vvas_overlay_rgb_draw_arrow (img, batch, info);
 
   /* draws circle pattern on image */
-  vvas_overlay_rgb_draw_circle (img, pFrameInfo, info);
+  vvas_overlay_rgb_draw_circle (img, batch, info);
 
   /* draws polygon pattern on image */
-  vvas_overlay_rgb_draw_polygon (img, pFrameInfo, info);
+  vvas_overlay_rgb_draw_polygon (img, batch, info);
 
   return ret;
 }
 
 
 /**
- *  @fn  static void vvas_overlay_nv12_draw_rect(Mat &img_y, Mat &img_uv, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_nv12_draw_rect(Mat &img_y, Mat &img_uv, const VvasOverlayShapeBatch *batch) 
  *  @param [in] *img_y  - image container for luma.
  *  @param [in] *img_uv  - image container for chroma.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @return none  
  *  @brief   
  *  @details This funciton performs drawing on the given frame
@@ -731,9 +961,9 @@ vvas_overlay_rgb_draw (VvasOverlayFrameInfo * pFrameInfo,
  */
 static void
 vvas_overlay_nv12_draw_rect (Mat & img_y, Mat & img_uv,
-    VvasOverlayFrameInfo * pFrameInfo)
+    const VvasOverlayShapeBatch * batch)
 {
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
@@ -742,20 +972,20 @@ vvas_overlay_nv12_draw_rect (Mat & img_y, Mat & img_uv,
   int32_t xmax = 0;
   int32_t ymax = 0;
   uint32_t thickness = 0;
-  uint32_t num_rects = pFrameInfo->shape_info.num_rects;
+  uint32_t num_rects = batch->num_rects;
   uint8_t yScalar = 0;
   uint16_t uvScalar = 0;
-  VvasList *head = NULL;
+  uint8_t alpha;
+  uint32_t idx;
 
   VvasOverlayColorData ol_color;
   memset (&ol_color, 0, sizeof (ol_color));
 
   if (num_rects) {
     VvasOverlayRectParams *rect;
-    head = pFrameInfo->shape_info.rect_params;
 
-    while (head) {
-      rect = (VvasOverlayRectParams *) head->data;
+    for (idx = 0; idx < num_rects; idx++) {
+      rect = &batch->rects[idx];
       xmin = floor (rect->points.x / 2) * 2;
       ymin = floor (rect->points.y / 2) * 2;
       xmax = floor ((rect->width + rect->points.x) / 2) * 2;
@@ -763,31 +993,33 @@ vvas_overlay_nv12_draw_rect (Mat & img_y, Mat & img_uv,
 
       if (rect->apply_bg_color) {
         convert_rgb_to_yuv_clrs (rect->bg_color, &yScalar, &uvScalar);
-        rectangle (img_y, Rect (Point (xmin, ymin),
-                Point (xmax, ymax)), Scalar (yScalar), FILLED, 1, 0);
-        rectangle (img_uv, Rect (Point (xmin / 2, ymin / 2),
-                Point (xmax / 2, ymax / 2)), Scalar (uvScalar), FILLED, 1, 0);
+        alpha = shape_alpha (rect->bg_color);
+        vvas_raster_rect (img_y, Rect (Point (xmin, ymin),
+                Point (xmax, ymax)), FILLED, &yScalar, alpha);
+        vvas_raster_rect (img_uv, Rect (Point (xmin / 2, ymin / 2),
+                Point (xmax / 2, ymax / 2)), FILLED,
+            (const uint8_t *) &uvScalar, alpha);
       } else {
         thickness = (rect->thickness * 2) / 2;
         convert_rgb_to_yuv_clrs (rect->rect_color, &yScalar, &uvScalar);
-        rectangle (img_y, Rect (Point (xmin, ymin),
-                Point (xmax, ymax)), Scalar (yScalar), thickness, 1, 0);
+        alpha = shape_alpha (rect->rect_color);
+        vvas_raster_rect (img_y, Rect (Point (xmin, ymin),
+                Point (xmax, ymax)), thickness, &yScalar, alpha);
 
-        rectangle (img_uv, Rect (Point (xmin / 2, ymin / 2),
-                Point (xmax / 2, ymax / 2)), Scalar (uvScalar), thickness / 2,
-            1, 0);
+        vvas_raster_rect (img_uv, Rect (Point (xmin / 2, ymin / 2),
+                Point (xmax / 2, ymax / 2)), thickness / 2,
+            (const uint8_t *) &uvScalar, alpha);
       }
-      head = head->next;
     }
   }
 }
 
 
 /**
- *  @fn  static void vvas_overlay_nv12_draw_text(Mat &img_y, Mat &img_uv, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_nv12_draw_text(Mat &img_y, Mat &img_uv, const VvasOverlayShapeBatch *batch) 
  *  @param [in] *img_y  - image container for luma.
  *  @param [in] *img_uv  - image container for chroma.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @return none  
  *  @brief   
  *  @details This funciton performs drawing on the given frame
@@ -795,66 +1027,54 @@ vvas_overlay_nv12_draw_rect (Mat & img_y, Mat & img_uv,
  */
 static void
 vvas_overlay_nv12_draw_text (Mat & img_y, Mat & img_uv,
-    VvasOverlayFrameInfo * pFrameInfo)
+    const VvasOverlayShapeBatch * batch)
 {
 
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
   int32_t xmin = 0;
   int32_t ymin = 0;
-  uint32_t num_text = pFrameInfo->shape_info.num_text;
+  uint32_t num_text = batch->num_text;
   uint8_t yScalar = 0;
   uint16_t uvScalar = 0;
   uint8_t bg_yScalar = 0;
   uint16_t bg_uvScalar = 0;
   VvasOverlayColorData ol_color;
-  VvasList *head = NULL;
+  uint32_t idx;
   char meta_str[MAX_META_TEXT][MAX_STRING_SIZE];
   Size text_size[MAX_META_TEXT];
   int base_line[MAX_META_TEXT];
   int str_cnt = 0;
-  char *token;
   int tot_height;
   Point txt_start, txt_end;
   int thickness = 2;
-  char *save_ptr = NULL;
 
   memset (&ol_color, 0, sizeof (ol_color));
 
   //Drawing text
   if (num_text) {
     VvasOverlayTextParams *text_info;
-    head = pFrameInfo->shape_info.text_params;
 
-    while (head) {
-      text_info = (VvasOverlayTextParams *) head->data;
+    for (idx = 0; idx < num_text; idx++) {
+      text_info = &batch->texts[idx];
       xmin = floor (text_info->points.x / 2) * 2;
       ymin = floor (text_info->points.y / 2) * 2;
-      str_cnt = 0;
-
-      token = NULL;
-      token = strtok_r (text_info->disp_text, "\n", &save_ptr);
-      while (token != NULL) {
-
-        /* Below code will print car detection and classification results in separate rows */
-        strncpy (meta_str[str_cnt], token, MAX_STRING_SIZE);
+      str_cnt = split_text_lines (text_info->disp_text, meta_str);
 
-        /* Terminate with '\0' charector */
-        meta_str[str_cnt][MAX_STRING_SIZE -1] = '\0';
-
-        str_cnt++;
-        if (str_cnt >= MAX_META_TEXT)
-          break;
-        token = strtok_r (NULL, "\n", &save_ptr);
-      }
+      /* chroma is subsampled, so its glyphs are rasterized at half scale */
+      std::shared_ptr < const vvas_glyph_atlas > atlas_y =
+          vvas_glyph_atlas_get (text_info->text_font.font_num,
+          text_info->text_font.font_size, 1);
+      std::shared_ptr < const vvas_glyph_atlas > atlas_uv =
+          vvas_glyph_atlas_get (text_info->text_font.font_num,
+          text_info->text_font.font_size / 2, 1);
 
       tot_height = 0;
       for (int i = 0; i < str_cnt; i++) {
         base_line[i] = 0;
-        text_size[i] = getTextSize (meta_str[i], text_info->text_font.font_num,
-            text_info->text_font.font_size, thickness, &base_line[i]);
+        text_size[i] = atlas_y->measure (meta_str[i], thickness, &base_line[i]);
         text_size[i].width = floor (text_size[i].width / 2) * 2;
         text_size[i].height = floor (text_size[i].height / 2) * 2;
         base_line[i] += thickness;
@@ -878,30 +1098,30 @@ vvas_overlay_nv12_draw_text (Mat & img_y, Mat & img_uv,
         txt_end = txt_start +
             Point (text_size[i].width, text_size[i].height + base_line[i]);
         if (text_info->apply_bg_color) {
-          rectangle (img_y, txt_start, txt_end, Scalar (bg_yScalar), FILLED, 1,
-              0);
-          rectangle (img_uv, txt_start / 2, txt_end / 2, Scalar (bg_uvScalar),
-              FILLED, 1, 0);
+          uint8_t alpha = shape_alpha (text_info->bg_color);
+
+          vvas_raster_fill (img_y, txt_start,
+              text_bg_end (txt_end, i, str_cnt, alpha), &bg_yScalar, alpha);
+          vvas_raster_fill (img_uv, txt_start / 2,
+              text_bg_end (txt_end / 2, i, str_cnt, alpha),
+              (const uint8_t *) &bg_uvScalar, alpha);
         }
 
         txt_start = txt_start + Point (0, text_size[i].height + 4);
-        putText (img_y, meta_str[i], txt_start, text_info->text_font.font_num,
-            text_info->text_font.font_size, Scalar (yScalar), 1);
-        putText (img_uv, meta_str[i], txt_start / 2,
-            text_info->text_font.font_num, text_info->text_font.font_size / 2,
-            Scalar (uvScalar), 1);
+        atlas_y->draw (img_y, meta_str[i], txt_start, &yScalar);
+        atlas_uv->draw (img_uv, meta_str[i], txt_start / 2,
+            (const uint8_t *) &uvScalar);
         txt_start = txt_start + Point (0, (base_line[i] - 4));
       }
-      head = head->next;
     }
   }
 }
 
 /**
- *  @fn  static void vvas_overlay_nv12_draw_line(Mat &img_y, Mat &img_uv, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_nv12_draw_line(Mat &img_y, Mat &img_uv, const VvasOverlayShapeBatch *batch) 
  *  @param [in] *img_y  - image container for luma.
  *  @param [in] *img_uv  - image container for chroma.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @return none  
  *  @brief   
  *  @details This funciton performs drawing on the given frame
@@ -909,10 +1129,10 @@ vvas_overlay_nv12_draw_text (Mat & img_y, Mat & img_uv,
  */
 static void
 vvas_overlay_nv12_draw_line (Mat & img_y, Mat & img_uv,
-    VvasOverlayFrameInfo * pFrameInfo)
+    const VvasOverlayShapeBatch * batch)
 {
 
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
@@ -922,37 +1142,36 @@ vvas_overlay_nv12_draw_line (Mat & img_y, Mat & img_uv,
   int32_t ymax = 0;
   uint8_t yScalar = 0;
   uint16_t uvScalar = 0;
-  VvasList *head = NULL;
-  uint32_t num_lines = pFrameInfo->shape_info.num_lines;
+  uint32_t idx;
+  uint32_t num_lines = batch->num_lines;
   uint32_t thickness = 0;
 
   if (num_lines) {
     VvasOverlayLineParams *line_info;
-    head = pFrameInfo->shape_info.line_params;
-    while (head) {
-      line_info = (VvasOverlayLineParams *) head->data;
+    for (idx = 0; idx < num_lines; idx++) {
+      line_info = &batch->lines[idx];
       convert_rgb_to_yuv_clrs (line_info->line_color, &yScalar, &uvScalar);
       xmin = floor (line_info->start_pt.x / 2) * 2;
       ymin = floor (line_info->start_pt.y / 2) * 2;
       xmax = floor (line_info->end_pt.x / 2) * 2;
       ymax = floor (line_info->end_pt.y / 2) * 2;
       thickness = (line_info->thickness * 2) / 2;
-      line (img_y, Point (xmin, ymin), Point (xmax, ymax),
-          Scalar (yScalar), thickness, 1, 0);
+      vvas_raster_line (img_y, Point (xmin, ymin), Point (xmax, ymax),
+          thickness, &yScalar);
 
-      line (img_uv, Point (xmin / 2, ymin / 2), Point (xmax / 2, ymax / 2),
-          Scalar (uvScalar), thickness / 2, 1, 0);
-      head = head->next;
+      vvas_raster_line (img_uv, Point (xmin / 2, ymin / 2),
+          Point (xmax / 2, ymax / 2), thickness / 2,
+          (const uint8_t *) &uvScalar);
     }
   }
 }
 
 
  /**
- *  @fn  static void vvas_overlay_nv12_draw_arrow(Mat &img_y, Mat &img_uv, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_nv12_draw_arrow(Mat &img_y, Mat &img_uv, const VvasOverlayShapeBatch *batch) 
  *  @param [in] *img_y  - image container for luma.
  *  @param [in] *img_uv  - image container for chroma.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @return none  
  *  @brief   
  *  @details This funciton performs drawing on the given frame
@@ -960,9 +1179,9 @@ vvas_overlay_nv12_draw_line (Mat & img_y, Mat & img_uv,
  */
 static void
 vvas_overlay_nv12_draw_arrow (Mat & img_y, Mat & img_uv,
-    VvasOverlayFrameInfo * pFrameInfo)
+    const VvasOverlayShapeBatch * batch)
 {
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
@@ -975,17 +1194,16 @@ vvas_overlay_nv12_draw_arrow (Mat & img_y, Mat & img_uv,
   uint8_t yScalar = 0;
   uint16_t uvScalar = 0;
   uint32_t thickness = 0;
-  uint32_t num_arrows = pFrameInfo->shape_info.num_arrows;
+  uint32_t num_arrows = batch->num_arrows;
   float tiplength = 0;
-  VvasList *head = NULL;
+  uint32_t idx;
 
   //Drawing arrows
   if (num_arrows) {
     VvasOverlayArrowParams *arrow_info;
-    head = pFrameInfo->shape_info.arrow_params;
 
-    while (head) {
-      arrow_info = (VvasOverlayArrowParams *) head->data;
+    for (idx = 0; idx < num_arrows; idx++) {
+      arrow_info = &batch->arrows[idx];
       convert_rgb_to_yuv_clrs (arrow_info->line_color, &yScalar, &uvScalar);
       xmin = floor (arrow_info->start_pt.x / 2) * 2;
       ymin = floor (arrow_info->start_pt.y / 2) * 2;
@@ -996,19 +1214,21 @@ vvas_overlay_nv12_draw_arrow (Mat & img_y, Mat & img_uv,
       thickness = (arrow_info->thickness * 2) / 2;
       switch (arrow_info->arrow_direction) {
         case ARROW_DIRECTION_START:{
-          arrowedLine (img_y, Point (xmax, ymax), Point (xmin, ymin),
-              Scalar (yScalar), thickness, 1, 0, tiplength);
+          vvas_raster_arrow (img_y, Point (xmax, ymax), Point (xmin, ymin),
+              thickness, tiplength, &yScalar);
 
-          arrowedLine (img_uv, Point (xmax / 2, ymax / 2), Point (xmin / 2,
-                  ymin / 2), Scalar (uvScalar), thickness / 2, 1, 0, tiplength);
+          vvas_raster_arrow (img_uv, Point (xmax / 2, ymax / 2),
+              Point (xmin / 2, ymin / 2), thickness / 2, tiplength,
+              (const uint8_t *) &uvScalar);
         }
           break;
         case ARROW_DIRECTION_END:{
-          arrowedLine (img_y, Point (xmin, ymin), Point (xmax, ymax),
-              Scalar (yScalar), thickness, 1, 0, tiplength);
+          vvas_raster_arrow (img_y, Point (xmin, ymin), Point (xmax, ymax),
+              thickness, tiplength, &yScalar);
 
-          arrowedLine (img_uv, Point (xmin / 2, ymin / 2), Point (xmax / 2,
-                  ymax / 2), Scalar (uvScalar), thickness / 2, 1, 0, tiplength);
+          vvas_raster_arrow (img_uv, Point (xmin / 2, ymin / 2),
+              Point (xmax / 2, ymax / 2), thickness / 2, tiplength,
+              (const uint8_t *) &uvScalar);
         }
           break;
         case ARROW_DIRECTION_BOTH_ENDS:{
@@ -1024,25 +1244,24 @@ vvas_overlay_nv12_draw_arrow (Mat & img_y, Mat & img_uv,
             mid_y = floor ((ymax + (ymin - ymax) / 2) / 2) * 2;
           }
 
-          arrowedLine (img_y, Point (mid_x, mid_y),
-              Point (xmax, ymax), Scalar (yScalar), thickness, 1, 0, tiplength);
+          vvas_raster_arrow (img_y, Point (mid_x, mid_y), Point (xmax, ymax),
+              thickness, tiplength, &yScalar);
 
-          arrowedLine (img_y, Point (mid_x, mid_y),
-              Point (xmin, ymin), Scalar (yScalar), thickness, 1, 0, tiplength);
+          vvas_raster_arrow (img_y, Point (mid_x, mid_y), Point (xmin, ymin),
+              thickness, tiplength, &yScalar);
 
-          arrowedLine (img_uv, Point (mid_x / 2, mid_y / 2),
-              Point (xmax / 2, ymax / 2), Scalar (uvScalar),
-              thickness / 2, 1, 0, tiplength);
+          vvas_raster_arrow (img_uv, Point (mid_x / 2, mid_y / 2),
+              Point (xmax / 2, ymax / 2), thickness / 2, tiplength,
+              (const uint8_t *) &uvScalar);
 
-          arrowedLine (img_uv, Point (mid_x / 2, mid_y / 2),
-              Point (xmin / 2, ymin / 2), Scalar (uvScalar),
-              thickness / 2, 1, 0, tiplength);
+          vvas_raster_arrow (img_uv, Point (mid_x / 2, mid_y / 2),
+              Point (xmin / 2, ymin / 2), thickness / 2, tiplength,
+              (const uint8_t *) &uvScalar);
         }
           break;
         default:
           break;
       }                         // end of switch case
-      head = head->next;
     }                           // end of while loop
   }                             // end of if block
 
@@ -1050,10 +1269,10 @@ vvas_overlay_nv12_draw_arrow (Mat & img_y, Mat & img_uv,
 
 
  /**
- *  @fn  static void vvas_overlay_nv12_draw_circle(Mat &img_y, Mat &img_uv, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_nv12_draw_circle(Mat &img_y, Mat &img_uv, const VvasOverlayShapeBatch *batch) 
  *  @param [in] *img_y  - image container for luma.
  *  @param [in] *img_uv  - image container for chroma.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @return none  
  *  @brief   
  *  @details This funciton performs drawing on the given frame
@@ -1061,9 +1280,9 @@ vvas_overlay_nv12_draw_arrow (Mat & img_y, Mat & img_uv,
  */
 static void
 vvas_overlay_nv12_draw_circle (Mat & img_y, Mat & img_uv,
-    VvasOverlayFrameInfo * pFrameInfo)
+    const VvasOverlayShapeBatch * batch)
 {
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
@@ -1072,38 +1291,36 @@ vvas_overlay_nv12_draw_circle (Mat & img_y, Mat & img_uv,
   int32_t radius = 0;
   uint8_t yScalar = 0;
   uint16_t uvScalar = 0;
-  VvasList *head = NULL;
-  uint32_t num_circles = pFrameInfo->shape_info.num_circles;
+  uint32_t idx;
+  uint32_t num_circles = batch->num_circles;
   uint32_t thickness = 0;
 
   //Drawing cicles
   if (num_circles) {
     VvasOverlayCircleParams *circle_info;
-    head = pFrameInfo->shape_info.circle_params;
 
-    while (head) {
-      circle_info = (VvasOverlayCircleParams *) head->data;
+    for (idx = 0; idx < num_circles; idx++) {
+      circle_info = &batch->circles[idx];
       convert_rgb_to_yuv_clrs (circle_info->circle_color, &yScalar, &uvScalar);
       xmin = floor (circle_info->center_pt.x / 2) * 2;
       ymin = floor (circle_info->center_pt.y / 2) * 2;
       radius = floor (circle_info->radius / 2) * 2;
       thickness = (circle_info->thickness * 2) / 2;
 
-      circle (img_y, Point (xmin, ymin), radius,
-          Scalar (yScalar), thickness, 1, 0);
+      vvas_raster_circle (img_y, Point (xmin, ymin), radius,
+          thickness, &yScalar);
 
-      circle (img_uv, Point (xmin / 2, ymin / 2), radius / 2,
-          Scalar (uvScalar), thickness / 2, 1, 0);
-      head = head->next;
+      vvas_raster_circle (img_uv, Point (xmin / 2, ymin / 2), radius / 2,
+          thickness / 2, (const uint8_t *) &uvScalar);
     }
   }
 }
 
  /**
- *  @fn  static void vvas_overlay_nv12_draw_polygon(Mat &img_y, Mat &img_uv, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_nv12_draw_polygon(Mat &img_y, Mat &img_uv, const VvasOverlayShapeBatch *batch) 
  *  @param [in] *img_y  - image container for luma.
  *  @param [in] *img_uv  - image container for chroma.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @return none  
  *  @brief   
  *  @details This funciton performs drawing on the given frame
@@ -1111,9 +1328,9 @@ vvas_overlay_nv12_draw_circle (Mat & img_y, Mat & img_uv,
  */
 static void
 vvas_overlay_nv12_draw_polygon (Mat & img_y, Mat & img_uv,
-    VvasOverlayFrameInfo * pFrameInfo)
+    const VvasOverlayShapeBatch * batch)
 {
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
@@ -1121,56 +1338,113 @@ vvas_overlay_nv12_draw_polygon (Mat & img_y, Mat & img_uv,
   int32_t ymin = 0;
   uint8_t yScalar = 0;
   uint16_t uvScalar = 0;
-  VvasList *head = NULL, *pt_head = NULL;
+  uint32_t idx, pt;
 
-  uint32_t num_polys = pFrameInfo->shape_info.num_polys;
+  uint32_t num_polys = batch->num_polys;
   uint32_t thickness = 0;
 
   //Drawing polygons
   if (num_polys) {
     VvasOverlayPolygonParams *poly_info;
-    head = pFrameInfo->shape_info.polygn_params;
-
+    VvasOverlayCoordinates *pt_info;
     std::vector < Point > poly_pts_y;
     std::vector < Point > poly_pts_uv;
     const Point *pts;
-    while (head) {
-      poly_info = (VvasOverlayPolygonParams *) head->data;
+    for (idx = 0; idx < num_polys; idx++) {
+      poly_info = &batch->polygons[idx];
 
       convert_rgb_to_yuv_clrs (poly_info->poly_color, &yScalar, &uvScalar);
 
       poly_pts_y.clear ();
       poly_pts_uv.clear ();
-      pt_head = poly_info->poly_pts;
-      VvasOverlayCoordinates *pt_info;
-      while (pt_head) {
-        pt_info = (VvasOverlayCoordinates *) pt_head->data;
-        xmin = floor (pt_info->x / 2) * 2;
-        ymin = floor (pt_info->y / 2) * 2;
+      pt_info = &batch->points[batch->poly_pt_offsets[idx]];
+      for (pt = 0; pt < (uint32_t) poly_info->num_pts; pt++) {
+        xmin = floor (pt_info[pt].x / 2) * 2;
+        ymin = floor (pt_info[pt].y / 2) * 2;
         poly_pts_y.push_back (Point (xmin, ymin));
         poly_pts_uv.push_back (Point (xmin / 2, ymin / 2));
-        pt_head = pt_head->next;
       }
 
       thickness = (poly_info->thickness * 2) / 2;
       pts = (const Point *) Mat (poly_pts_y).data;
-      polylines (img_y, &pts, &poly_info->num_pts, 1, true,
-          Scalar (yScalar), thickness, 1, 0);
+      vvas_raster_polyline (img_y, pts, poly_info->num_pts, true, thickness,
+          &yScalar, shape_alpha (poly_info->poly_color));
 
       pts = (const Point *) Mat (poly_pts_uv).data;
-      polylines (img_uv, &pts, &poly_info->num_pts, 1, true,
-          Scalar (uvScalar), thickness / 2, 1, 0);
-      head = head->next;
+      vvas_raster_polyline (img_uv, pts, poly_info->num_pts, true,
+          thickness / 2, (const uint8_t *) &uvScalar,
+          shape_alpha (poly_info->poly_color));
     }                           //end of for loop
   }                             // end of if block
 
 }
 
+/**
+ *  @fn  static void vvas_overlay_nv12_draw_mask (Mat &img_y, Mat &img_uv,
+ *                                               const VvasOverlayShapeBatch *batch)
+ *  @param [in] *img_y  - image container for luma.
+ *  @param [in] *img_uv  - image container for chroma.
+ *  @param [in] *batch - shapes to be drawn.
+ *  @return none
+ *  @brief
+ *  @details This funciton blends masks on the given frame, chroma is blended
+ *           with the mask scaled to the half resolution region.
+ *
+ */
+static void
+vvas_overlay_nv12_draw_mask (Mat & img_y, Mat & img_uv,
+    const VvasOverlayShapeBatch * batch)
+{
+  if (NULL == batch) {
+    return;
+  }
+
+  uint8_t y_values[256] = { 0 };
+  uint16_t uv_values[256] = { 0 };
+  uint8_t alphas[256];
+  VvasOverlayMaskParams *mask;
+  VvasOverlayColorData clr;
+  int32_t xmin, ymin, xmax, ymax;
+  uint32_t idx, c;
+
+  for (idx = 0; idx < batch->num_masks; idx++) {
+    mask = &batch->masks[idx];
+    if (!mask_class_alphas (mask, alphas))
+      continue;
+
+    for (c = 0; c < 256; c++) {
+      if (!alphas[c])
+        continue;
+
+      clr = mask_class_color (mask, c);
+      convert_rgb_to_yuv_clrs (clr, &y_values[c], &uv_values[c]);
+    }
+
+    xmin = floor (mask->points.x / 2) * 2;
+    ymin = floor (mask->points.y / 2) * 2;
+    xmax = floor ((mask->width + mask->points.x) / 2) * 2;
+    ymax = floor ((mask->height + mask->points.y) / 2) * 2;
+
+    vvas_raster_mask (img_y, Rect (Point (xmin, ymin), Point (xmax, ymax)),
+        mask->mask_data, mask->mask_width, mask->mask_height,
+        mask->mask_stride, y_values, alphas,
+        MASK_SCALING_BILINEAR == mask->scaling);
+    vvas_raster_mask (img_uv, Rect (Point (xmin / 2, ymin / 2),
+            Point (xmax / 2, ymax / 2)), mask->mask_data, mask->mask_width,
+        mask->mask_height, mask->mask_stride, (const uint8_t *) uv_values,
+        alphas, MASK_SCALING_BILINEAR == mask->scaling);
+  }
+}
+
 /**
  *  @fn VvasReturnType vvas_overlay_nv12_draw(VvasOverlayFrameInfo *pFrameInfo
- *                                           VvasVideoFrameMapInfo *info)
+ *                                           const VvasOverlayShapeBatch *batch,
+ *                                           VvasVideoFrameMapInfo *info,
+ *                                           time_t clock_time)
  *  @param [in] *pFrameInfo  - OverlayFrameInformation.
+ *  @param [in] *batch  - Shapes to be drawn.
  *  @param [in] *Info  VvasVideoFrameMapInfo address.
+ *  @param [in] clock_time - Time shown by the clock.
  *  @return On Success returns VVAS_RET_SUCCESS 
  *          On Failure returns VVAS_ERROR_*  
  *  @brief   
@@ -1179,7 +1453,8 @@ vvas_overlay_nv12_draw_polygon (Mat & img_y, Mat & img_uv,
  */
 static VvasReturnType
 vvas_overlay_nv12_draw (VvasOverlayFrameInfo * pFrameInfo,
-    VvasVideoFrameMapInfo * info)
+    const VvasOverlayShapeBatch * batch, VvasVideoFrameMapInfo * info,
+    time_t clock_time)
 {
   VvasReturnType ret = VVAS_RET_SUCCESS;
 
@@ -1202,136 +1477,127 @@ vvas_overlay_nv12_draw (VvasOverlayFrameInfo * pFrameInfo,
 
   Mat img_uv (img_height / 2, img_width / 2, CV_16UC1, in_plane2, stride);
 
+  /* blends masks below all other shapes */
+  vvas_overlay_nv12_draw_mask (img_y, img_uv, batch);
+
   /* draw clock info */
-  vvas_overlay_draw_nv12_clock (img_y, img_uv, &pFrameInfo->clk_info);
+  vvas_overlay_draw_nv12_clock (img_y, img_uv, &pFrameInfo->clk_info,
+      clock_time);
 
   /* draws rectangle pattern on the image */
-  vvas_overlay_nv12_draw_rect (img_y, img_uv, pFrameInfo);
+  vvas_overlay_nv12_draw_rect (img_y, img_uv, batch);
 
   /* draws text information on image */
-  vvas_overlay_nv12_draw_text (img_y, img_uv, pFrameInfo);
+  vvas_overlay_nv12_draw_text (img_y, img_uv, batch);
 
   /* draws line pattern on image */
-  vvas_overlay_nv12_draw_line (img_y, img_uv, pFrameInfo);
+  vvas_overlay_nv12_draw_line (img_y, img_uv, batch);
 
   /* draws arrow pattern on image */
-  vvas_overlay_nv12_draw_arrow (img_y, img_uv, pFrameInfo);
+  vvas_overlay_nv12_draw_arrow (img_y, img_uv, batch);
 
   /* draws circle pattern on image */
-  vvas_overlay_nv12_draw_circle (img_y, img_uv, pFrameInfo);
+  vvas_overlay_nv12_draw_circle (img_y, img_uv, batch);
 
   /* draws polygon pattern on image */
-  vvas_overlay_nv12_draw_polygon (img_y, img_uv, pFrameInfo);
+  vvas_overlay_nv12_draw_polygon (img_y, img_uv, batch);
   return ret;
 }
 
 /**
- *  @fn  static void vvas_overlay_gray_draw_rect(Mat &img, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_gray_draw_rect(Mat &img, const VvasOverlayShapeBatch *batch) 
  *  @param [in] *img  - image container.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @return none  
  *  @brief   
  *  @details This funciton performs drawing on the given frame
  *
  */
 static void
-vvas_overlay_gray_draw_rect (Mat & img, VvasOverlayFrameInfo * pFrameInfo)
+vvas_overlay_gray_draw_rect (Mat & img, const VvasOverlayShapeBatch * batch)
 {
 
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
-  uint32_t num_rects = pFrameInfo->shape_info.num_rects;
+  uint32_t num_rects = batch->num_rects;
   uint32_t thickness = 0;
   uint32_t gray_val = 0;
-  VvasList *head = NULL;
+  uint8_t gray_clr;
+  uint8_t alpha;
+  uint32_t idx;
 
   //Drawing rectangles
   if (num_rects) {
     VvasOverlayRectParams *rect;
-    head = pFrameInfo->shape_info.rect_params;
-    while (head) {
-      rect = (VvasOverlayRectParams *) head->data;
+    for (idx = 0; idx < num_rects; idx++) {
+      rect = &batch->rects[idx];
       if (rect->apply_bg_color) {
         thickness = FILLED;
         gray_val = (rect->bg_color.red +
             rect->bg_color.green + rect->bg_color.blue) / 3;
+        alpha = shape_alpha (rect->bg_color);
       } else {
         thickness = rect->thickness;
         gray_val = (rect->rect_color.red +
             rect->rect_color.green + rect->rect_color.blue) / 3;
+        alpha = shape_alpha (rect->rect_color);
       }
-      rectangle (img, Rect (Point (rect->points.x,
+      gray_clr = gray_val;
+      vvas_raster_rect (img, Rect (Point (rect->points.x,
                   rect->points.y), Size (rect->width, rect->height)),
-          Scalar (gray_val), thickness, 1, 0);
-      head = head->next;
+          thickness, &gray_clr, alpha);
     }
   }
 }
 
 /**
- *  @fn  static void vvas_overlay_gray_draw_text(Mat &img, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_gray_draw_text(Mat &img, const VvasOverlayShapeBatch *batch) 
  *  @param [in] *img  - image container.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @return none  
  *  @brief   
  *  @details This funciton performs drawing on the given frame
  *
  */
 static void
-vvas_overlay_gray_draw_text (Mat & img, VvasOverlayFrameInfo * pFrameInfo)
+vvas_overlay_gray_draw_text (Mat & img, const VvasOverlayShapeBatch * batch)
 {
 
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
-  uint32_t num_text = pFrameInfo->shape_info.num_text;
+  uint32_t num_text = batch->num_text;
   uint32_t gray_val = 0;
   uint32_t gray_val_t = 0;
-  VvasList *head = NULL;
+  uint8_t gray_clr, bg_clr;
+  uint32_t idx;
   char meta_str[MAX_META_TEXT][MAX_STRING_SIZE];
   Size text_size[MAX_META_TEXT];
   int base_line[MAX_META_TEXT];
   int str_cnt = 0;
-  char *token;
   int tot_height;
   Point txt_start, txt_end;
   int thickness = 1;
-  char *save_ptr = NULL;
 
   //Drawing text
   if (num_text) {
     VvasOverlayTextParams *text_info;
-    head = pFrameInfo->shape_info.text_params;
 
-    while (head) {
-      text_info = (VvasOverlayTextParams *) head->data;
-      str_cnt = 0;
+    for (idx = 0; idx < num_text; idx++) {
+      text_info = &batch->texts[idx];
+      str_cnt = split_text_lines (text_info->disp_text, meta_str);
 
-      token = NULL;
-      token = strtok_r (text_info->disp_text, "\n", &save_ptr);
-      while (token != NULL) {
-        
-        /* Below code will print car detection and classification results in separate rows */
-        strncpy (meta_str[str_cnt], token, MAX_STRING_SIZE);
-
-        /* Terminate with '\0' charector */
-        meta_str[str_cnt][MAX_STRING_SIZE -1] = '\0';
-        
-        str_cnt++;
-
-        if (str_cnt >= MAX_META_TEXT)
-          break;
-        token = strtok_r (NULL, "\n", &save_ptr);
-      }
+      std::shared_ptr < const vvas_glyph_atlas > atlas =
+          vvas_glyph_atlas_get (text_info->text_font.font_num,
+          text_info->text_font.font_size, 1);
 
       tot_height = 0;
       for (int i = 0; i < str_cnt; i++) {
         base_line[i] = 0;
-        text_size[i] = getTextSize (meta_str[i], text_info->text_font.font_num,
-            text_info->text_font.font_size, thickness, &base_line[i]);
+        text_size[i] = atlas->measure (meta_str[i], thickness, &base_line[i]);
         base_line[i] += thickness;
         base_line[i] = base_line[i] + 4;
         tot_height += (text_size[i].height + base_line[i]);
@@ -1350,111 +1616,108 @@ vvas_overlay_gray_draw_text (Mat & img, VvasOverlayFrameInfo * pFrameInfo)
       gray_val_t = (text_info->text_font.font_color.red +
           text_info->text_font.font_color.green +
           text_info->text_font.font_color.blue) / 3;
+      gray_clr = gray_val_t;
+      bg_clr = gray_val;
 
       for (int i = 0; i < str_cnt; i++) {
         txt_end = txt_start +
             Point (text_size[i].width, text_size[i].height + base_line[i]);
         if (text_info->apply_bg_color)
-          rectangle (img, txt_start, txt_end, Scalar (gray_val), FILLED, 1, 0);
+          vvas_raster_fill (img, txt_start, text_bg_end (txt_end, i, str_cnt,
+                  shape_alpha (text_info->bg_color)), &bg_clr,
+              shape_alpha (text_info->bg_color));
 
         txt_start = txt_start + Point (0, text_size[i].height + 4);
-        putText (img, meta_str[i], txt_start, text_info->text_font.font_num,
-            text_info->text_font.font_size, Scalar (gray_val_t), 1);
+        atlas->draw (img, meta_str[i], txt_start, &gray_clr);
         txt_start = txt_start + Point (0, (base_line[i] - 4));
       }
-
-      head = head->next;
     }
   }
 }
 
 
 /**
- *  @fn  static void vvas_overlay_gray_draw_lines(Mat &img, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_gray_draw_lines(Mat &img, const VvasOverlayShapeBatch *batch) 
  *  @param [in] *img  - image container.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @return none  
  *  @brief   
  *  @details This funciton performs drawing on the given frame
  *
  */
 static void
-vvas_overlay_gray_draw_line (Mat & img, VvasOverlayFrameInfo * pFrameInfo)
+vvas_overlay_gray_draw_line (Mat & img, const VvasOverlayShapeBatch * batch)
 {
 
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
-  uint32_t num_lines = pFrameInfo->shape_info.num_lines;
-  uint32_t gray_val = 0;
-  VvasList *head = NULL;
+  uint32_t num_lines = batch->num_lines;
+  uint8_t gray_clr;
+  uint32_t idx;
 
   //Drawing lines
   if (num_lines) {
     VvasOverlayLineParams *line_info;
-    head = pFrameInfo->shape_info.line_params;
 
-    while (head) {
-      line_info = (VvasOverlayLineParams *) head->data;
-      gray_val = (line_info->line_color.red +
+    for (idx = 0; idx < num_lines; idx++) {
+      line_info = &batch->lines[idx];
+      gray_clr = (line_info->line_color.red +
           line_info->line_color.green + line_info->line_color.blue) / 3;
-      line (img, Point (line_info->start_pt.x,
+      vvas_raster_line (img, Point (line_info->start_pt.x,
               line_info->start_pt.y), Point (line_info->end_pt.x,
-              line_info->end_pt.y),
-          Scalar (gray_val), line_info->thickness, 1, 0);
-      head = head->next;
+              line_info->end_pt.y), line_info->thickness, &gray_clr);
     }
   }
 }
 
  /**
- *  @fn  static void vvas_overlay_gray_draw_arrows(Mat &img, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_gray_draw_arrows(Mat &img, const VvasOverlayShapeBatch *batch) 
  *  @param [in] *img  - image container.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @return none  
  *  @brief   
  *  @details This funciton performs drawing on the given frame
  *
  */
 static void
-vvas_overlay_gray_draw_arrow (Mat & img, VvasOverlayFrameInfo * pFrameInfo)
+vvas_overlay_gray_draw_arrow (Mat & img, const VvasOverlayShapeBatch * batch)
 {
 
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
   uint32_t mid_x = 0;
   uint32_t mid_y = 0;
-  uint32_t num_arrows = pFrameInfo->shape_info.num_arrows;
-  uint32_t gray_val = 0;
+  uint32_t num_arrows = batch->num_arrows;
+  uint8_t gray_clr;
   uint32_t thickness = 0;
-  VvasList *head = NULL;
+  uint32_t idx;
 
   if (num_arrows) {
     VvasOverlayArrowParams *arrow_info;
-    head = pFrameInfo->shape_info.arrow_params;
 
-    while (head) {
-      arrow_info = (VvasOverlayArrowParams *) head->data;
-      gray_val = (arrow_info->line_color.red +
+    for (idx = 0; idx < num_arrows; idx++) {
+      arrow_info = &batch->arrows[idx];
+      gray_clr = (arrow_info->line_color.red +
           arrow_info->line_color.green + arrow_info->line_color.blue) / 3;
 
       thickness = arrow_info->thickness;
       switch (arrow_info->arrow_direction) {
         case ARROW_DIRECTION_START:{
-          arrowedLine (img, Point (arrow_info->end_pt.x,
-                  arrow_info->end_pt.y), Point (arrow_info->start_pt.x,
-                  arrow_info->start_pt.y), Scalar (gray_val),
-              thickness, 1, 0, arrow_info->tipLength);
+          vvas_raster_arrow (img,
+              Point (arrow_info->end_pt.x, arrow_info->end_pt.y),
+              Point (arrow_info->start_pt.x, arrow_info->start_pt.y), thickness,
+              arrow_info->tipLength, &gray_clr);
         }
           break;
         case ARROW_DIRECTION_END:{
-          arrowedLine (img, Point (arrow_info->start_pt.x,
-                  arrow_info->start_pt.y), Point (arrow_info->end_pt.x,
-                  arrow_info->end_pt.y), Scalar (gray_val),
-              thickness, 1, 0, arrow_info->tipLength);
+          vvas_raster_arrow (img,
+              Point (arrow_info->start_pt.x, arrow_info->start_pt.y),
+              Point (arrow_info->end_pt.x, arrow_info->end_pt.y), thickness,
+              arrow_info->tipLength, &gray_clr);
         }
           break;
         case ARROW_DIRECTION_BOTH_ENDS:{
@@ -1474,116 +1737,153 @@ vvas_overlay_gray_draw_arrow (Mat & img, VvasOverlayFrameInfo * pFrameInfo)
                 arrow_info->end_pt.y) / 2;
           }
 
-          arrowedLine (img, Point (mid_x, mid_y),
-              Point (arrow_info->end_pt.x, arrow_info->end_pt.y),
-              Scalar (gray_val), thickness, 1, 0, arrow_info->tipLength / 2);
+          vvas_raster_arrow (img, Point (mid_x, mid_y),
+              Point (arrow_info->end_pt.x, arrow_info->end_pt.y), thickness,
+              arrow_info->tipLength / 2, &gray_clr);
 
-          arrowedLine (img, Point (mid_x, mid_y),
-              Point (arrow_info->start_pt.x, arrow_info->start_pt.y),
-              Scalar (gray_val), thickness, 1, 0, arrow_info->tipLength / 2);
+          vvas_raster_arrow (img, Point (mid_x, mid_y),
+              Point (arrow_info->start_pt.x, arrow_info->start_pt.y), thickness,
+              arrow_info->tipLength / 2, &gray_clr);
         }
           break;
         default:
           break;
       }
-      head = head->next;
     }
   }
 }
 
  /**
- *  @fn  static void vvas_overlay_gray_draw_circle(Mat &img, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_gray_draw_circle(Mat &img, const VvasOverlayShapeBatch *batch) 
  *  @param [in] *img  - image container.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @return none  
  *  @brief   
  *  @details This funciton performs drawing on the given frame
  *
  */
 static void
-vvas_overlay_gray_draw_circle (Mat & img, VvasOverlayFrameInfo * pFrameInfo)
+vvas_overlay_gray_draw_circle (Mat & img, const VvasOverlayShapeBatch * batch)
 {
 
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
-  uint32_t num_circles = pFrameInfo->shape_info.num_circles;
-  uint32_t gray_val = 0;
-  VvasList *head = NULL;
+  uint32_t num_circles = batch->num_circles;
+  uint8_t gray_clr;
+  uint32_t idx;
 
   //Drawing cicles
   if (num_circles) {
     VvasOverlayCircleParams *circle_info;
-    head = pFrameInfo->shape_info.circle_params;
 
-    while (head) {
-      circle_info = (VvasOverlayCircleParams *) head->data;
-      gray_val = (circle_info->circle_color.red +
+    for (idx = 0; idx < num_circles; idx++) {
+      circle_info = &batch->circles[idx];
+      gray_clr = (circle_info->circle_color.red +
           circle_info->circle_color.green + circle_info->circle_color.blue) / 3;
-      circle (img, Point (circle_info->center_pt.x,
+      vvas_raster_circle (img, Point (circle_info->center_pt.x,
               circle_info->center_pt.y), circle_info->radius,
-          Scalar (gray_val), circle_info->thickness, 1, 0);
-      head = head->next;
+          circle_info->thickness, &gray_clr);
     }
   }
 }
 
 /**
- *  @fn  static void vvas_overlay_gray_draw_polygon(Mat &img, VvasOverlayFrameInfo *pFrameInfo) 
+ *  @fn  static void vvas_overlay_gray_draw_polygon(Mat &img, const VvasOverlayShapeBatch *batch) 
  *  @param [in] *img  - image container.
- *  @param [in] *pFrameInfo - contains complete overlay information.
+ *  @param [in] *batch - shapes to be drawn.
  *  @return none  
  *  @brief   
  *  @details This funciton performs drawing on the given frame
  *
  */
 static void
-vvas_overlay_gray_draw_polygon (Mat & img, VvasOverlayFrameInfo * pFrameInfo)
+vvas_overlay_gray_draw_polygon (Mat & img, const VvasOverlayShapeBatch * batch)
 {
 
-  if (NULL == pFrameInfo) {
+  if (NULL == batch) {
     return;
   }
 
-  uint32_t num_polys = pFrameInfo->shape_info.num_polys;
-  uint32_t gray_val = 0;
-  VvasList *head = NULL, *pt_head = NULL;
+  uint32_t num_polys = batch->num_polys;
+  uint8_t gray_clr;
+  uint32_t idx, pt;
 
   //Drawing polygons
   if (num_polys) {
     VvasOverlayPolygonParams *poly_info;
-    head = pFrameInfo->shape_info.polygn_params;
-
+    VvasOverlayCoordinates *pt_info;
     std::vector < Point > poly_pts;
     const Point *pts;
-    while (head) {
-      poly_info = (VvasOverlayPolygonParams *) head->data;
-      gray_val = (poly_info->poly_color.red +
+    for (idx = 0; idx < num_polys; idx++) {
+      poly_info = &batch->polygons[idx];
+      gray_clr = (poly_info->poly_color.red +
           poly_info->poly_color.green + poly_info->poly_color.blue) / 3;
 
       poly_pts.clear ();
-      pt_head = poly_info->poly_pts;
-      VvasOverlayCoordinates *pt_info;
-      while (pt_head) {
-        pt_info = (VvasOverlayCoordinates *) pt_head->data;
-        poly_pts.push_back (Point (pt_info->x, pt_info->y));
-        pt_head = pt_head->next;
-      }
+      pt_info = &batch->points[batch->poly_pt_offsets[idx]];
+      for (pt = 0; pt < (uint32_t) poly_info->num_pts; pt++)
+        poly_pts.push_back (Point (pt_info[pt].x, pt_info[pt].y));
 
       pts = (const Point *) Mat (poly_pts).data;
-      polylines (img, &pts, &poly_info->num_pts, 1, true,
-          Scalar (gray_val), poly_info->thickness, 1, 0);
-      head = head->next;
+      vvas_raster_polyline (img, pts, poly_info->num_pts, true,
+          poly_info->thickness, &gray_clr, shape_alpha (poly_info->poly_color));
+    }
+  }
+}
+
+/**
+ *  @fn  static void vvas_overlay_gray_draw_mask(Mat &img, const VvasOverlayShapeBatch *batch)
+ *  @param [in] *img  - image container.
+ *  @param [in] *batch - shapes to be drawn.
+ *  @return none
+ *  @brief
+ *  @details This funciton blends masks on the given frame
+ *
+ */
+static void
+vvas_overlay_gray_draw_mask (Mat & img, const VvasOverlayShapeBatch * batch)
+{
+  if (NULL == batch) {
+    return;
+  }
+
+  uint8_t values[256] = { 0 };
+  uint8_t alphas[256];
+  VvasOverlayMaskParams *mask;
+  VvasOverlayColorData clr;
+  uint32_t idx, c;
+
+  for (idx = 0; idx < batch->num_masks; idx++) {
+    mask = &batch->masks[idx];
+    if (!mask_class_alphas (mask, alphas))
+      continue;
+
+    for (c = 0; c < 256; c++) {
+      if (!alphas[c])
+        continue;
+
+      clr = mask_class_color (mask, c);
+      values[c] = (clr.red + clr.green + clr.blue) / 3;
     }
+
+    vvas_raster_mask (img, Rect (mask->points.x, mask->points.y, mask->width,
+            mask->height), mask->mask_data, mask->mask_width,
+        mask->mask_height, mask->mask_stride, values, alphas,
+        MASK_SCALING_BILINEAR == mask->scaling);
   }
 }
 
 /**
  *  @fn VvasReturnType vvas_overlay_gray_draw(VvasOverlayFrameInfo *pFrameInfo)
- *                                           VvasVideoFrameMapInfo *info)
+ *                                           const VvasOverlayShapeBatch *batch,
+ *                                           VvasVideoFrameMapInfo *info,
+ *                                           time_t clock_time)
  *  @param [in] *pFrameInfo  - OverlayFrameInformation.
+ *  @param [in] *batch  - Shapes to be drawn.
  *  @param [in] *info  - VvasVideoFrameMapInfo addresss.
+ *  @param [in] clock_time - Time shown by the clock.
  *  @return On Success returns VVAS_RET_SUCCESS 
  *          On Failure returns VVAS_ERROR_*  
  *  @brief   
@@ -1592,7 +1892,8 @@ vvas_overlay_gray_draw_polygon (Mat & img, VvasOverlayFrameInfo * pFrameInfo)
  */
 static VvasReturnType
 vvas_overlay_gray_draw (VvasOverlayFrameInfo * pFrameInfo,
-    VvasVideoFrameMapInfo * info)
+    const VvasOverlayShapeBatch * batch, VvasVideoFrameMapInfo * info,
+    time_t clock_time)
 {
   VvasReturnType ret = VVAS_RET_SUCCESS;
 
@@ -1607,51 +1908,518 @@ vvas_overlay_gray_draw (VvasOverlayFrameInfo * pFrameInfo,
 
   Mat img (img_height, img_width, CV_8UC1, in_plane1, stride);
 
+  /* blends masks below all other shapes */
+  vvas_overlay_gray_draw_mask (img, batch);
+
   /* draw clock on the image */
-  vvas_overlay_draw_gray_clock (img, &pFrameInfo->clk_info);
+  vvas_overlay_draw_gray_clock (img, &pFrameInfo->clk_info, clock_time);
 
   /* draws rectangle pattern on the image */
-  vvas_overlay_gray_draw_rect (img, pFrameInfo);
+  vvas_overlay_gray_draw_rect (img, batch);
 
   /* draws text information on image */
-  vvas_overlay_gray_draw_text (img, pFrameInfo);
+  vvas_overlay_gray_draw_text (img, batch);
 
   /* draws line pattern on image */
-  vvas_overlay_gray_draw_line (img, pFrameInfo);
+  vvas_overlay_gray_draw_line (img, batch);
 
   /* draws arrow pattern on image */
-  vvas_overlay_gray_draw_arrow (img, pFrameInfo);
+  vvas_overlay_gray_draw_arrow (img, batch);
 
   /* draws circle pattern on image */
-  vvas_overlay_gray_draw_circle (img, pFrameInfo);
+  vvas_overlay_gray_draw_circle (img, batch);
 
   /* draws polygon pattern on image */
-  vvas_overlay_gray_draw_polygon (img, pFrameInfo);
+  vvas_overlay_gray_draw_polygon (img, batch);
 
   return ret;
 }
 
 /**
- *  @fn VvasReturnType vvas_overlay_process_frame(VvasOverlayFrameInfo *pFrameInfo)
+ *  @fn VvasReturnType vvas_overlay_draw_frame(VvasOverlayFrameInfo *pFrameInfo,
+ *                                            const VvasOverlayShapeBatch *batch,
+ *                                            VvasVideoFrameMapInfo *info,
+ *                                            time_t clock_time)
+ *  @param [in] *pFrameInfo  - OverlayFrameInformation.
+ *  @param [in] *batch  - Shapes to be drawn.
+ *  @param [in] *info  - Map info of the frame.
+ *  @param [in] clock_time - Time shown by the clock.
+ *  @return On Success returns VVAS_RET_SUCCESS
+ *          On Failure returns VVAS_ERROR_*
+ *  @brief Draws on the mapped frame according to its color format.
+ */
+static VvasReturnType
+vvas_overlay_draw_frame (VvasOverlayFrameInfo * pFrameInfo,
+    const VvasOverlayShapeBatch * batch, VvasVideoFrameMapInfo * info,
+    time_t clock_time)
+{
+  switch (info->fmt) {
+    case VVAS_VIDEO_FORMAT_RGB:
+    case VVAS_VIDEO_FORMAT_BGR:
+      return vvas_overlay_rgb_draw (pFrameInfo, batch, info, clock_time);
+
+    case VVAS_VIDEO_FORMAT_Y_UV8_420:
+      return vvas_overlay_nv12_draw (pFrameInfo, batch, info, clock_time);
+
+    case VVAS_VIDEO_FORMAT_GRAY8:
+      return vvas_overlay_gray_draw (pFrameInfo, batch, info, clock_time);
+
+    default:
+      return VVAS_RET_INVALID_ARGS;
+  }
+}
+
+/**
+ * class overlay_band_pool - Worker threads shared by all frames, drawing
+ *                           bands of a frame together with the caller
+ */
+class overlay_band_pool
+{
+  std::mutex lock;
+  std::mutex busy;
+  std::condition_variable wake;
+  std::condition_variable done;
+  std::vector < std::thread > workers;
+  std::function < void (int) > job;
+  std::atomic < int > next;
+  int count = 0;
+  int active = 0;
+  uint64_t generation = 0;
+  bool quit = false;
+
+  /**
+   *  @fn void overlay_band_pool::work ()
+   *  @return none
+   *  @brief Runs jobs of the current run until none is left.
+   */
+  void work ()
+  {
+    for (int i = next++; i < count; i = next++)
+      job (i);
+  }
+
+  /**
+   *  @fn void overlay_band_pool::worker_main (uint64_t seen)
+   *  @param [in] seen - Run which was current when the worker was created
+   *  @return none
+   *  @brief Loop of a worker thread, joins every run started after @seen.
+   */
+  void worker_main (uint64_t seen)
+  {
+    std::unique_lock < std::mutex > guard (lock);
+
+    for (;;) {
+      wake.wait (guard, [&] { return quit || generation != seen; });
+      if (quit)
+        return;
+
+      seen = generation;
+      guard.unlock ();
+      work ();
+      guard.lock ();
+      if (--active == 0)
+        done.notify_all ();
+    }
+  }
+
+public:
+
+  ~overlay_band_pool ()
+  {
+    {
+      std::lock_guard < std::mutex > guard (lock);
+      quit = true;
+    }
+    wake.notify_all ();
+    for (auto & worker:workers)
+      worker.join ();
+  }
+
+  /**
+   *  @fn bool overlay_band_pool::run (uint32_t num_threads, int num_jobs,
+   *                                   const std::function < void (int) > &fn)
+   *  @param [in] num_threads - Number of threads including the caller
+   *  @param [in] num_jobs - Number of jobs
+   *  @param [in] fn - Job, called with job index from 0 to @num_jobs - 1
+   *  @return true when all jobs are done
+   *          false when the pool is used by another caller, no job is run
+   *  @brief Runs jobs on workers and on the calling thread and waits for
+   *         them. Workers are created on demand and are kept for next runs.
+   */
+  bool run (uint32_t num_threads, int num_jobs,
+      const std::function < void (int) > &fn)
+  {
+    std::unique_lock < std::mutex > owner (busy, std::try_to_lock);
+
+    if (!owner.owns_lock ())
+      return false;
+
+    {
+      std::lock_guard < std::mutex > guard (lock);
+
+      num_threads = std::min (num_threads, (uint32_t) OVERLAY_MAX_THREADS);
+      try {
+        while (workers.size () + 1 < num_threads)
+          workers.emplace_back (&overlay_band_pool::worker_main, this,
+              generation);
+      } catch (const std::system_error &) {
+        LOG_W ("failed to create overlay thread, using %zu threads",
+            workers.size () + 1);
+      }
+
+      job = fn;
+      count = num_jobs;
+      next = 0;
+      active = workers.size ();
+      generation++;
+    }
+
+    wake.notify_all ();
+    work ();
+
+    std::unique_lock < std::mutex > guard (lock);
+    done.wait (guard, [&] { return active == 0; });
+    return true;
+  }
+};
+
+/**
+ * struct overlay_band - Band of rows of a frame and the shapes crossing it
+ * @begin: First row of the band
+ * @end: Row after the last row of the band
+ * @batch: Shapes crossing the band, arrays point to the vectors below or to
+ *         the batch being drawn
+ * @rects: Rectangles crossing the band
+ * @texts: Texts crossing the band
+ * @lines: Lines crossing the band
+ * @arrows: Arrows crossing the band
+ * @circles: Circles crossing the band
+ * @polygons: Polygons crossing the band
+ * @poly_pt_offsets: Offset of the points of each polygon in the drawn batch
+ * @masks: Masks crossing the band
+ * @ret: Result of drawing the band
+ */
+struct overlay_band
+{
+  int begin;
+  int end;
+  VvasOverlayShapeBatch batch;
+  std::vector < VvasOverlayRectParams > rects;
+  std::vector < VvasOverlayTextParams > texts;
+  std::vector < VvasOverlayLineParams > lines;
+  std::vector < VvasOverlayArrowParams > arrows;
+  std::vector < VvasOverlayCircleParams > circles;
+  std::vector < VvasOverlayPolygonParams > polygons;
+  std::vector < uint32_t > poly_pt_offsets;
+  std::vector < VvasOverlayMaskParams > masks;
+  VvasReturnType ret;
+};
+
+/**
+ *  @fn static void band_range (int64_t top, int64_t bottom, int band_height,
+ *                              int num_bands, int *first, int *last)
+ *  @param [in] top - First row of a shape
+ *  @param [in] bottom - Last row of the shape
+ *  @param [in] band_height - Height of the bands, last one can be shorter
+ *  @param [in] num_bands - Number of bands
+ *  @param [out] first - First band crossed by the shape
+ *  @param [out] last - Last band crossed by the shape, less than @first when
+ *                      shape is above or below the frame
+ *  @return none
+ */
+static void
+band_range (int64_t top, int64_t bottom, int band_height, int num_bands,
+    int *first, int *last)
+{
+  *first = std::max (top, (int64_t) 0) / band_height;
+  *last = std::min (bottom / band_height, (int64_t) num_bands - 1);
+  if (bottom < 0 || top > bottom)
+    *last = -1;
+}
+
+/**
+ *  @fn static void text_rows (const VvasOverlayTextParams *text,
+ *                             int64_t *top, int64_t *bottom)
+ *  @param [in] text - Text shape
+ *  @param [out] top - Row above which nothing of the text is drawn
+ *  @param [out] bottom - Row below which nothing of the text is drawn
+ *  @return none
+ *  @brief Measures text like text drawing functions of all formats do, rows
+ *         are widened by the size of a line as glyphs and backgrounds of
+ *         formats differ slightly.
+ */
+static void
+text_rows (const VvasOverlayTextParams * text, int64_t * top, int64_t * bottom)
+{
+  char meta_str[MAX_META_TEXT][MAX_STRING_SIZE];
+  int str_cnt = split_text_lines (text->disp_text, meta_str);
+  std::shared_ptr < const vvas_glyph_atlas > atlas =
+      vvas_glyph_atlas_get (text->text_font.font_num,
+      text->text_font.font_size, 1);
+  int64_t tot_height = 0, line_height = 0;
+
+  for (int i = 0; i < str_cnt; i++) {
+    int base_line = 0;
+    Size size = atlas->measure (meta_str[i], 2, &base_line);
+
+    line_height = std::max (line_height, (int64_t) size.height + base_line + 6);
+    tot_height += size.height + base_line + 6;
+  }
+
+  *top = text->points.y;
+  if (text->bottom_left_origin)
+    *top -= tot_height;
+  *bottom = *top + tot_height + 2 * line_height + 2;
+  *top -= 2 * line_height + 2;
+}
+
+/**
+ *  @fn static void overlay_bin_shapes (const VvasOverlayShapeBatch *batch,
+ *                                      std::vector < overlay_band > &bands,
+ *                                      int band_height)
+ *  @param [in] batch - Shapes to be drawn
+ *  @param [inout] bands - Bands of the frame, their shapes are replaced
+ *  @param [in] band_height - Height of the bands
+ *  @return none
+ *  @brief Copies each shape to the bands its rows cross, keeping the order of
+ *         the shapes. Rows of shapes are widened by their thickness and by
+ *         rounding of coordinates for subsampled planes.
+ */
+static void
+overlay_bin_shapes (const VvasOverlayShapeBatch * batch,
+    std::vector < overlay_band > &bands, int band_height)
+{
+  int num_bands = bands.size ();
+  int first, last, b;
+  uint32_t idx, pt;
+
+  for (auto & band:bands) {
+    band.rects.clear ();
+    band.texts.clear ();
+    band.lines.clear ();
+    band.arrows.clear ();
+    band.circles.clear ();
+    band.polygons.clear ();
+    band.poly_pt_offsets.clear ();
+    band.masks.clear ();
+  }
+
+  for (idx = 0; idx < batch->num_rects; idx++) {
+    const VvasOverlayRectParams & rect = batch->rects[idx];
+    int64_t margin = (int64_t) rect.thickness + 2;
+
+    band_range ((int64_t) rect.points.y - margin,
+        (int64_t) rect.points.y + rect.height + margin, band_height,
+        num_bands, &first, &last);
+    for (b = first; b <= last; b++)
+      bands[b].rects.push_back (rect);
+  }
+
+  for (idx = 0; idx < batch->num_text; idx++) {
+    int64_t top, bottom;
+
+    text_rows (&batch->texts[idx], &top, &bottom);
+    band_range (top, bottom, band_height, num_bands, &first, &last);
+    for (b = first; b <= last; b++)
+      bands[b].texts.push_back (batch->texts[idx]);
+  }
+
+  for (idx = 0; idx < batch->num_lines; idx++) {
+    const VvasOverlayLineParams & line = batch->lines[idx];
+    int64_t margin = (int64_t) line.thickness + 2;
+
+    band_range ((int64_t) std::min (line.start_pt.y, line.end_pt.y) - margin,
+        (int64_t) std::max (line.start_pt.y, line.end_pt.y) + margin,
+        band_height, num_bands, &first, &last);
+    for (b = first; b <= last; b++)
+      bands[b].lines.push_back (line);
+  }
+
+  for (idx = 0; idx < batch->num_arrows; idx++) {
+    const VvasOverlayArrowParams & arrow = batch->arrows[idx];
+    double dx = (double) arrow.end_pt.x - arrow.start_pt.x;
+    double dy = (double) arrow.end_pt.y - arrow.start_pt.y;
+    /* tips can point away from the segment at both ends */
+    int64_t margin = (int64_t) (fabs (arrow.tipLength) * sqrt (dx * dx +
+            dy * dy)) + arrow.thickness + 2;
+
+    band_range ((int64_t) std::min (arrow.start_pt.y, arrow.end_pt.y) - margin,
+        (int64_t) std::max (arrow.start_pt.y, arrow.end_pt.y) + margin,
+        band_height, num_bands, &first, &last);
+    for (b = first; b <= last; b++)
+      bands[b].arrows.push_back (arrow);
+  }
+
+  for (idx = 0; idx < batch->num_circles; idx++) {
+    const VvasOverlayCircleParams & circle = batch->circles[idx];
+    int64_t extent = (int64_t) circle.radius + circle.thickness + 2;
+
+    band_range ((int64_t) circle.center_pt.y - extent,
+        (int64_t) circle.center_pt.y + extent, band_height, num_bands,
+        &first, &last);
+    for (b = first; b <= last; b++)
+      bands[b].circles.push_back (circle);
+  }
+
+  for (idx = 0; idx < batch->num_polys; idx++) {
+    const VvasOverlayPolygonParams & polygon = batch->polygons[idx];
+    const VvasOverlayCoordinates *pts =
+        &batch->points[batch->poly_pt_offsets[idx]];
+    int64_t margin = (int64_t) polygon.thickness + 2;
+    int64_t top = INT64_MAX, bottom = INT64_MIN;
+
+    for (pt = 0; pt < (uint32_t) polygon.num_pts; pt++) {
+      top = std::min (top, (int64_t) pts[pt].y);
+      bottom = std::max (bottom, (int64_t) pts[pt].y);
+    }
+    if (top > bottom)
+      continue;
+
+    band_range (top - margin, bottom + margin, band_height, num_bands,
+        &first, &last);
+    for (b = first; b <= last; b++) {
+      bands[b].polygons.push_back (polygon);
+      bands[b].poly_pt_offsets.push_back (batch->poly_pt_offsets[idx]);
+    }
+  }
+
+  for (idx = 0; idx < batch->num_masks; idx++) {
+    const VvasOverlayMaskParams & mask = batch->masks[idx];
+
+    band_range ((int64_t) mask.points.y - 2,
+        (int64_t) mask.points.y + mask.height + 2, band_height, num_bands,
+        &first, &last);
+    for (b = first; b <= last; b++)
+      bands[b].masks.push_back (mask);
+  }
+
+  for (auto & band:bands) {
+    VvasOverlayShapeBatch *sub = &band.batch;
+
+    memset (sub, 0, sizeof (VvasOverlayShapeBatch));
+    sub->num_rects = band.rects.size ();
+    sub->rects = band.rects.data ();
+    sub->num_text = band.texts.size ();
+    sub->texts = band.texts.data ();
+    sub->num_lines = band.lines.size ();
+    sub->lines = band.lines.data ();
+    sub->num_arrows = band.arrows.size ();
+    sub->arrows = band.arrows.data ();
+    sub->num_circles = band.circles.size ();
+    sub->circles = band.circles.data ();
+    sub->num_polys = band.polygons.size ();
+    sub->polygons = band.polygons.data ();
+    sub->poly_pt_offsets = band.poly_pt_offsets.data ();
+    sub->num_points = batch->num_points;
+    sub->points = batch->points;
+    sub->num_masks = band.masks.size ();
+    sub->masks = band.masks.data ();
+  }
+}
+
+/**
+ *  @fn VvasReturnType vvas_overlay_draw_bands(VvasOverlayFrameInfo *pFrameInfo,
+ *                                            const VvasOverlayShapeBatch *batch,
+ *                                            VvasVideoFrameMapInfo *info,
+ *                                            time_t clock_time,
+ *                                            uint32_t num_threads)
  *  @param [in] *pFrameInfo  - OverlayFrameInformation.
+ *  @param [in] *batch  - Shapes to be drawn.
+ *  @param [in] *info  - Map info of the frame.
+ *  @param [in] clock_time - Time shown by the clock, same for all bands.
+ *  @param [in] num_threads - Number of threads, 2 to OVERLAY_MAX_THREADS.
+ *  @return On Success returns VVAS_RET_SUCCESS
+ *          On Failure returns VVAS_ERROR_*
+ *  @brief Draws horizontal bands of the frame in parallel.
+ *  @details Each band draws the shapes crossing it in their usual order and
+ *           skips rows outside of the band, so pixels are same as when the
+ *           frame is drawn by one thread. Clock is drawn by every band, each
+ *           one blitting its rows of the cached clock.
+ */
+static VvasReturnType
+vvas_overlay_draw_bands (VvasOverlayFrameInfo * pFrameInfo,
+    const VvasOverlayShapeBatch * batch, VvasVideoFrameMapInfo * info,
+    time_t clock_time, uint32_t num_threads)
+{
+  static overlay_band_pool pool;
+  /* kept per calling thread to reuse allocations across frames, workers
+   * reach it through the reference captured by the jobs */
+  static thread_local std::vector < overlay_band > band_cache;
+  std::vector < overlay_band > &bands = band_cache;
+  int height = info->height;
+  int num_bands = std::min ((int) num_threads * OVERLAY_BANDS_PER_THREAD,
+      height / OVERLAY_MIN_BAND_HEIGHT);
+  int band_height;
+
+  if (num_bands <= 1)
+    return vvas_overlay_draw_frame (pFrameInfo, batch, info, clock_time);
+
+  /* even rows, so that bands split chroma rows of 4:2:0 frames exactly */
+  band_height = ((height + num_bands - 1) / num_bands + 1) & ~1;
+  num_bands = (height + band_height - 1) / band_height;
+
+  bands.resize (num_bands);
+  for (int b = 0; b < num_bands; b++) {
+    bands[b].begin = b * band_height;
+    bands[b].end = std::min (height, (b + 1) * band_height);
+  }
+  overlay_bin_shapes (batch, bands, band_height);
+
+  auto job = [&](int b) {
+    vvas_raster_band scope (bands[b].begin, bands[b].end, height);
+
+    bands[b].ret = vvas_overlay_draw_frame (pFrameInfo, &bands[b].batch, info,
+        clock_time);
+  };
+
+  /* pool is busy with a frame of another stream, draw bands here */
+  if (!pool.run (num_threads, num_bands, job)) {
+    for (int b = 0; b < num_bands; b++)
+      job (b);
+  }
+
+  for (int b = 0; b < num_bands; b++) {
+    if (bands[b].ret != VVAS_RET_SUCCESS)
+      return bands[b].ret;
+  }
+
+  return VVAS_RET_SUCCESS;
+}
+
+/**
+ *  @fn VvasReturnType vvas_overlay_process_frame_batch(VvasOverlayFrameInfo *pFrameInfo,
+ *                                                     const VvasOverlayShapeBatch *batch)
+ *  @param [in] *pFrameInfo  - OverlayFrameInformation, shape_info is ignored.
+ *  @param [in] *batch  - Shapes to be drawn.
  *  @return On Success returns VVAS_RET_SUCCESS 
  *          On Failure returns VVAS_ERROR_*  
  *  @brief   
- *  @details This funciton performs drawing on the given frame
+ *  @details This funciton performs drawing of shapes in batch on the given frame
  *
  */
 VvasReturnType
-vvas_overlay_process_frame (VvasOverlayFrameInfo * pFrameInfo)
+vvas_overlay_process_frame_batch (VvasOverlayFrameInfo * pFrameInfo,
+    const VvasOverlayShapeBatch * batch)
 {
   VvasReturnType ret = VVAS_RET_ERROR;
+  uint32_t num_threads;
   /* Validate input params */
-  if ((NULL == pFrameInfo) ||
+  if ((NULL == pFrameInfo) || (NULL == batch) ||
       ((NULL != pFrameInfo) && (NULL == pFrameInfo->frame_info))) {
     LOG_E ("NULL Frame info received.");
     ret = VVAS_RET_INVALID_ARGS;
     return ret;
   }
 
+  /* num_threads was appended to the structure, a value left unset by the
+   * application must not start an unbounded number of threads */
+  num_threads = pFrameInfo->num_threads;
+  if (num_threads > OVERLAY_MAX_THREADS) {
+    LOG_W ("num_threads %u is more than %u, using %u threads", num_threads,
+        OVERLAY_MAX_THREADS, OVERLAY_MAX_THREADS);
+    num_threads = OVERLAY_MAX_THREADS;
+  }
+
   VvasVideoFrameMapInfo info;
   memset (&info, 0, sizeof (VvasVideoFrameMapInfo));
   ret = vvas_video_frame_map (pFrameInfo->frame_info,
@@ -1662,46 +2430,21 @@ vvas_overlay_process_frame (VvasOverlayFrameInfo * pFrameInfo)
     return VVAS_RET_ERROR;
   }
 
-  VvasVideoFormat ColorFormat = info.fmt;
+  /* one time for the whole frame, bands must not show different times */
+  time_t clock_time = time (NULL);
 
-  switch (ColorFormat) {
+  if (num_threads > 1)
+    ret = vvas_overlay_draw_bands (pFrameInfo, batch, &info, clock_time,
+        num_threads);
+  else
+    ret = vvas_overlay_draw_frame (pFrameInfo, batch, &info, clock_time);
 
-    case VVAS_VIDEO_FORMAT_RGB:
-    case VVAS_VIDEO_FORMAT_BGR:{
-      ret = vvas_overlay_rgb_draw (pFrameInfo, &info);
-      if (ret != VVAS_RET_SUCCESS) {
-        LOG_E ("failed to draw");
-        return ret;
-      }
-    }
-      break;
-
-    case VVAS_VIDEO_FORMAT_Y_UV8_420:{
-      ret = vvas_overlay_nv12_draw (pFrameInfo, &info);
-      if (ret != VVAS_RET_SUCCESS) {
-        LOG_E ("failed to draw");
-        return ret;
-      }
-    }
-      break;
-
-    case VVAS_VIDEO_FORMAT_GRAY8:{
-      ret = vvas_overlay_gray_draw (pFrameInfo, &info);
-      if (ret != VVAS_RET_SUCCESS) {
-        LOG_E ("failed to draw");
-        return ret;
-      }
-    }
-      break;
-
-    default:{
-      ret = VVAS_RET_INVALID_ARGS;
-      return ret;
-    }
-      break;
+  if (ret != VVAS_RET_SUCCESS) {
+    if (ret != VVAS_RET_INVALID_ARGS)
+      LOG_E ("failed to draw");
+    return ret;
   }
 
-
   /* frame with overlay drawings is not required to sync to device memory
    * Therefore unsetting flag to avoid sync to device.
    */
@@ -1717,3 +2460,39 @@ vvas_overlay_process_frame (VvasOverlayFrameInfo * pFrameInfo)
 
   return ret;
 }
+
+/**
+ *  @fn VvasReturnType vvas_overlay_process_frame(VvasOverlayFrameInfo *pFrameInfo)
+ *  @param [in] *pFrameInfo  - OverlayFrameInformation.
+ *  @return On Success returns VVAS_RET_SUCCESS 
+ *          On Failure returns VVAS_ERROR_*  
+ *  @brief   
+ *  @details This funciton performs drawing on the given frame. Shapes in list
+ *           form are gathered into a per thread batch which keeps its storage
+ *           across frames.
+ *
+ */
+VvasReturnType
+vvas_overlay_process_frame (VvasOverlayFrameInfo * pFrameInfo)
+{
+  static thread_local struct ShapeBatchHolder {
+    VvasOverlayShapeBatch batch;
+    ShapeBatchHolder () { vvas_overlay_shape_batch_init (&batch); }
+    ~ShapeBatchHolder () { vvas_overlay_shape_batch_free (&batch); }
+  } holder;
+  VvasReturnType ret;
+
+  if (NULL == pFrameInfo) {
+    LOG_E ("NULL Frame info received.");
+    return VVAS_RET_INVALID_ARGS;
+  }
+
+  ret = vvas_overlay_shape_batch_from_info (&holder.batch,
+      &pFrameInfo->shape_info);
+  if (VVAS_IS_ERROR (ret)) {
+    LOG_E ("failed to prepare shapes");
+    return ret;
+  }
+
+  return vvas_overlay_process_frame_batch (pFrameInfo, &holder.batch);
+}
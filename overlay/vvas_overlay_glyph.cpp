@@ -0,0 +1,484 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "config.h"
+#include "vvas_overlay_glyph.hpp"
+#include "vvas_overlay_raster.hpp"
+#include <memory>
+#include <opencv2/imgproc.hpp>
+
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace cv;
+
+/* Pen position is kept in same fixed point format as putText */
+#define GLYPH_SHIFT 16
+#define GLYPH_ONE (1 << GLYPH_SHIFT)
+
+/* Number of atlases kept per thread, oldest one is dropped when exceeded */
+#define MAX_GLYPH_ATLASES 16
+
+/* Number of text bitmaps kept per thread, oldest one is dropped when exceeded.
+ * A clock needs one per plane and is redrawn once per second. */
+#define MAX_TEXT_BITMAPS 8
+
+/**
+ *  @fn static void blit_row_8 (uint8_t * dst, const uint8_t * mask, uint32_t n,
+ *                              uint8_t value)
+ *  @param [inout] dst - Pixels of 8 bit plane
+ *  @param [in] mask - Coverage of the pixels, 0 or 0xff
+ *  @param [in] n - Number of pixels
+ *  @param [in] value - Value of covered pixels
+ *  @return none
+ *  @brief Sets covered pixels of a row to @value.
+ */
+static void
+blit_row_8 (uint8_t * dst, const uint8_t * mask, uint32_t n, uint8_t value)
+{
+  uint32_t i = 0;
+
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+  uint8x16_t v = vdupq_n_u8 (value);
+
+  for (; i + 16 <= n; i += 16)
+    vst1q_u8 (dst + i, vbslq_u8 (vld1q_u8 (mask + i), v, vld1q_u8 (dst + i)));
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+  __m128i v = _mm_set1_epi8 ((char) value);
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i m = _mm_loadu_si128 ((const __m128i *) (mask + i));
+    __m128i d = _mm_loadu_si128 ((const __m128i *) (dst + i));
+
+    _mm_storeu_si128 ((__m128i *) (dst + i),
+        _mm_or_si128 (_mm_and_si128 (m, v), _mm_andnot_si128 (m, d)));
+  }
+#endif
+
+  for (; i < n; i++) {
+    if (mask[i])
+      dst[i] = value;
+  }
+}
+
+/**
+ *  @fn static void blit_row_16 (uint16_t * dst, const uint8_t * mask, uint32_t n,
+ *                               uint16_t value)
+ *  @param [inout] dst - Pixels of 16 bit plane
+ *  @param [in] mask - Coverage of the pixels, 0 or 0xff
+ *  @param [in] n - Number of pixels
+ *  @param [in] value - Value of covered pixels
+ *  @return none
+ *  @brief Sets covered pixels of a row to @value, used for interleaved UV plane.
+ */
+static void
+blit_row_16 (uint16_t * dst, const uint8_t * mask, uint32_t n, uint16_t value)
+{
+  uint32_t i = 0;
+
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+  uint16x8_t v = vdupq_n_u16 (value);
+
+  for (; i + 8 <= n; i += 8) {
+    /* sign extension turns 0xff coverage into 0xffff */
+    uint16x8_t m =
+        vreinterpretq_u16_s16 (vmovl_s8 (vreinterpret_s8_u8 (vld1_u8 (mask +
+                    i))));
+
+    vst1q_u16 (dst + i, vbslq_u16 (m, v, vld1q_u16 (dst + i)));
+  }
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+  __m128i v = _mm_set1_epi16 ((short) value);
+
+  for (; i + 8 <= n; i += 8) {
+    __m128i m = _mm_loadl_epi64 ((const __m128i *) (mask + i));
+    __m128i d = _mm_loadu_si128 ((const __m128i *) (dst + i));
+
+    m = _mm_unpacklo_epi8 (m, m);
+    _mm_storeu_si128 ((__m128i *) (dst + i),
+        _mm_or_si128 (_mm_and_si128 (m, v), _mm_andnot_si128 (m, d)));
+  }
+#endif
+
+  for (; i < n; i++) {
+    if (mask[i])
+      dst[i] = value;
+  }
+}
+
+/**
+ *  @fn static void blit_row_24 (uint8_t * dst, const uint8_t * mask, uint32_t n,
+ *                               const uint8_t * value)
+ *  @param [inout] dst - Pixels of packed 3 channel plane
+ *  @param [in] mask - Coverage of the pixels, 0 or 0xff
+ *  @param [in] n - Number of pixels
+ *  @param [in] value - Channel values of covered pixels
+ *  @return none
+ *  @brief Sets covered pixels of a row to @value.
+ */
+static void
+blit_row_24 (uint8_t * dst, const uint8_t * mask, uint32_t n,
+    const uint8_t * value)
+{
+  for (uint32_t i = 0; i < n; i++, dst += 3) {
+    if (mask[i]) {
+      dst[0] = value[0];
+      dst[1] = value[1];
+      dst[2] = value[2];
+    }
+  }
+}
+
+/**
+ *  @fn static void blit (Mat & img, const uint8_t * mask, int x, int y,
+ *                        int width, int height, const uint8_t * value)
+ *  @param [inout] img - Plane to draw on, 8 bit, 16 bit or 3 channel 8 bit
+ *  @param [in] mask - Coverage bitmap, @width bytes per row
+ *  @param [in] x - Column of the left of the bitmap in @img
+ *  @param [in] y - Row of the top of the bitmap in @img
+ *  @param [in] width - Width of the bitmap
+ *  @param [in] height - Height of the bitmap
+ *  @param [in] value - Pixel value, img.elemSize() bytes
+ *  @return none
+ *  @brief Sets covered pixels of @img to @value. Bitmap is clipped to @img and
+ *         to the band of rows drawn by the calling thread.
+ */
+static void
+blit (Mat & img, const uint8_t * mask, int x, int y, int width, int height,
+    const uint8_t * value)
+{
+  size_t elem_size = img.elemSize ();
+  int row_begin, row_end;
+  int x0, x1, y0, y1;
+
+  vvas_raster_rows (img, &row_begin, &row_end);
+
+  x0 = std::max (x, 0);
+  y0 = std::max (y, row_begin);
+  x1 = std::min (x + width, img.cols);
+  y1 = std::min (y + height, row_end);
+  if (x0 >= x1 || y0 >= y1)
+    return;
+
+  for (int row = y0; row < y1; row++) {
+    const uint8_t *src = mask + (row - y) * width + (x0 - x);
+    uint8_t *dst = img.ptr < uint8_t > (row) + x0 * elem_size;
+
+    if (elem_size == 1)
+      blit_row_8 (dst, src, x1 - x0, value[0]);
+    else if (elem_size == 2)
+      blit_row_16 ((uint16_t *) dst, src, x1 - x0, *(const uint16_t *) value);
+    else
+      blit_row_24 (dst, src, x1 - x0, value);
+  }
+}
+
+/**
+ *  @fn vvas_glyph_atlas::vvas_glyph_atlas (int font, double scale, int thickness)
+ *  @param [in] font - OpenCV Hershey font face
+ *  @param [in] scale - Font scale
+ *  @param [in] thickness - Thickness of the strokes
+ *  @return none
+ *  @brief Rasterizes all printable characters with putText and keeps the
+ *         tight coverage bitmap of each one.
+ *  @details Font metrics are read in font units through getTextSize at unit
+ *           scale, so that measuring text gives same result as getTextSize.
+ */
+vvas_glyph_atlas::vvas_glyph_atlas (int font, double scale, int thickness)
+:font (font), scale (scale), thickness (thickness)
+{
+  int base_line = 0;
+  Size size = getTextSize (" ", font, 1.0, 0, &base_line);
+  int pad;
+
+  hscale = cvRound (scale * GLYPH_ONE);
+  height_units = size.height;
+  base_units = base_line;
+
+  /* strokes can go out of the advance and the cap height */
+  pad = cvRound (height_units * scale) + thickness + 2;
+
+  for (int c = VVAS_GLYPH_FIRST_CHAR; c <= VVAS_GLYPH_LAST_CHAR; c++) {
+    vvas_glyph & g = glyphs[c - VVAS_GLYPH_FIRST_CHAR];
+    char str[2] = { (char) c, '\0' };
+    Point org;
+    Rect box;
+    Mat canvas, points;
+
+    g.units = getTextSize (str, font, 1.0, 0, NULL).width;
+    g.left = g.top = 0;
+    g.width = g.height = 0;
+    g.offset = coverage.size ();
+
+    canvas = Mat::zeros (cvRound ((height_units + base_units) * scale) +
+        2 * pad, cvRound (g.units * scale) + 2 * pad, CV_8UC1);
+    org = Point (pad, pad + cvRound (height_units * scale));
+    putText (canvas, str, org, font, scale, Scalar (255), thickness);
+
+    findNonZero (canvas, points);
+    if (points.empty ())
+      continue;
+
+    box = boundingRect (points);
+    g.left = box.x - org.x;
+    g.top = box.y - org.y;
+    g.width = box.width;
+    g.height = box.height;
+
+    for (int row = box.y; row < box.y + box.height; row++) {
+      const uint8_t *src = canvas.ptr < uint8_t > (row) + box.x;
+
+      for (int col = 0; col < box.width; col++)
+        coverage.push_back (src[col] ? 0xff : 0);
+    }
+  }
+}
+
+/**
+ *  @fn const vvas_glyph & vvas_glyph_atlas::glyph (char c) const
+ *  @param [in] c - Character
+ *  @return Glyph of @c
+ *  @brief Gets glyph of a character, '?' is used for characters without glyph.
+ */
+const vvas_glyph &
+vvas_glyph_atlas::glyph (char c) const
+{
+  if (c < VVAS_GLYPH_FIRST_CHAR || c > VVAS_GLYPH_LAST_CHAR)
+    c = '?';
+  return glyphs[c - VVAS_GLYPH_FIRST_CHAR];
+}
+
+/**
+ *  @fn bool vvas_glyph_atlas::matches (int font, double scale, int thickness) const
+ *  @param [in] font - OpenCV Hershey font face
+ *  @param [in] scale - Font scale
+ *  @param [in] thickness - Thickness of the strokes
+ *  @return true if atlas is rasterized with given parameters
+ *  @brief Checks whether atlas can be used for given font parameters.
+ */
+bool
+vvas_glyph_atlas::matches (int font, double scale, int thickness) const
+{
+  return this->font == font && this->scale == scale &&
+      this->thickness == thickness;
+}
+
+/**
+ *  @fn Size vvas_glyph_atlas::measure (const char *text, int thickness,
+ *                                      int *base_line) const
+ *  @param [in] text - Text to be measured
+ *  @param [in] thickness - Thickness used for measurement
+ *  @param [out] base_line - y-coordinate of the baseline relative to the bottom-most text point
+ *  @return Size of the box containing the text
+ *  @brief Measures text from cached metrics, same as getTextSize.
+ */
+Size
+vvas_glyph_atlas::measure (const char *text, int thickness,
+    int *base_line) const
+{
+  double view_x = 0;
+  Size size;
+
+  for (; *text; text++)
+    view_x += glyph (*text).units * scale;
+
+  size.width = cvRound (view_x + thickness);
+  size.height = cvRound (height_units * scale + (thickness + 1) / 2);
+  if (base_line)
+    *base_line = cvRound (base_units * scale + thickness * 0.5);
+
+  return size;
+}
+
+/**
+ *  @fn void vvas_glyph_atlas::draw (Mat & img, const char *text, Point org,
+ *                                   const uint8_t * value) const
+ *  @param [inout] img - Plane to draw on, 8 bit, 16 bit or 3 channel 8 bit
+ *  @param [in] text - Text to be drawn
+ *  @param [in] org - Bottom-left corner of the text, same as in putText
+ *  @param [in] value - Pixel value, img.elemSize() bytes
+ *  @return none
+ *  @brief Blits cached glyphs of @text into @img.
+ *  @details Pen advances in fixed point same as putText, each glyph is placed at
+ *           the nearest pixel of the pen position. Glyphs are clipped to @img
+ *           and to the band of rows drawn by the calling thread.
+ */
+void
+vvas_glyph_atlas::draw (Mat & img, const char *text, Point org,
+    const uint8_t * value) const
+{
+  int64_t pen = (int64_t) org.x << GLYPH_SHIFT;
+
+  for (; *text; text++) {
+    const vvas_glyph & g = glyph (*text);
+    int x = (int) ((pen + GLYPH_ONE / 2) >> GLYPH_SHIFT) + g.left;
+
+    pen += g.units * hscale;
+    if (g.width)
+      blit (img, &coverage[g.offset], x, org.y + g.top, g.width, g.height,
+          value);
+  }
+}
+
+std::shared_ptr < const vvas_glyph_atlas >
+vvas_glyph_atlas_get (int font, double scale, int thickness)
+{
+  static thread_local std::vector < std::shared_ptr < const vvas_glyph_atlas >>
+      atlases;
+
+  for (auto & atlas:atlases) {
+    if (atlas->matches (font, scale, thickness))
+      return atlas;
+  }
+
+  /* callers still drawing with the dropped atlas keep it alive */
+  if (atlases.size () == MAX_GLYPH_ATLASES)
+    atlases.erase (atlases.begin ());
+
+  atlases.push_back (std::make_shared < const vvas_glyph_atlas > (font, scale,
+          thickness));
+  return atlases.back ();
+}
+
+/**
+ *  @fn vvas_text_bitmap::vvas_text_bitmap (const char *text, int font,
+ *                                          double scale, int thickness,
+ *                                          int line_type)
+ *  @param [in] text - Text to be drawn
+ *  @param [in] font - OpenCV Hershey font face
+ *  @param [in] scale - Font scale
+ *  @param [in] thickness - Thickness of the strokes
+ *  @param [in] line_type - Line type passed to putText
+ *  @return none
+ *  @brief Draws the text with putText and keeps its tight coverage bitmap.
+ *  @details putText places strokes relative to the integer origin, so the
+ *           bitmap gives the same pixels as putText at any origin where the
+ *           text is not clipped by the frame.
+ */
+vvas_text_bitmap::vvas_text_bitmap (const char *text, int font, double scale,
+    int thickness, int line_type)
+:text (text), font (font), scale (scale), thickness (thickness),
+line_type (line_type), left (0), top (0), width (0), height (0), base_line (0)
+{
+  Mat canvas, points;
+  Point org;
+  Rect box;
+  int pad;
+
+  size = getTextSize (text, font, scale, thickness, &base_line);
+
+  /* strokes can go out of the box given by getTextSize */
+  pad = size.height + thickness + 2;
+  canvas = Mat::zeros (size.height + base_line + 2 * pad,
+      size.width + 2 * pad, CV_8UC1);
+  org = Point (pad, pad + size.height);
+  putText (canvas, text, org, font, scale, Scalar (255), thickness, line_type);
+
+  findNonZero (canvas, points);
+  if (points.empty ())
+    return;
+
+  box = boundingRect (points);
+  left = box.x - org.x;
+  top = box.y - org.y;
+  width = box.width;
+  height = box.height;
+
+  coverage.reserve (width * height);
+  for (int row = box.y; row < box.y + box.height; row++) {
+    const uint8_t *src = canvas.ptr < uint8_t > (row) + box.x;
+
+    for (int col = 0; col < box.width; col++)
+      coverage.push_back (src[col] ? 0xff : 0);
+  }
+}
+
+/**
+ *  @fn bool vvas_text_bitmap::matches (const char *text, int font,
+ *                                      double scale, int thickness,
+ *                                      int line_type) const
+ *  @param [in] text - Text to be drawn
+ *  @param [in] font - OpenCV Hershey font face
+ *  @param [in] scale - Font scale
+ *  @param [in] thickness - Thickness of the strokes
+ *  @param [in] line_type - Line type passed to putText
+ *  @return true if bitmap is drawn with given text and parameters
+ *  @brief Checks whether bitmap can be used for given text.
+ */
+bool
+vvas_text_bitmap::matches (const char *text, int font, double scale,
+    int thickness, int line_type) const
+{
+  return this->font == font && this->scale == scale &&
+      this->thickness == thickness && this->line_type == line_type &&
+      this->text == text;
+}
+
+/**
+ *  @fn Rect vvas_text_bitmap::bounds (Point org) const
+ *  @param [in] org - Bottom-left corner of the text, same as in putText
+ *  @return Box of the text including the part below the baseline
+ *  @brief Gets box of the text as given by getTextSize, used for background
+ *         of the text.
+ */
+Rect
+vvas_text_bitmap::bounds (Point org) const
+{
+  return Rect (org.x, org.y - size.height, size.width,
+      size.height + base_line);
+}
+
+/**
+ *  @fn void vvas_text_bitmap::draw (Mat & img, Point org,
+ *                                   const uint8_t * value) const
+ *  @param [inout] img - Plane to draw on, 8 bit, 16 bit or 3 channel 8 bit
+ *  @param [in] org - Bottom-left corner of the text, same as in putText
+ *  @param [in] value - Pixel value, img.elemSize() bytes
+ *  @return none
+ *  @brief Blits the bitmap into @img.
+ */
+void
+vvas_text_bitmap::draw (Mat & img, Point org, const uint8_t * value) const
+{
+  if (width)
+    blit (img, coverage.data (), org.x + left, org.y + top, width, height,
+        value);
+}
+
+std::shared_ptr < const vvas_text_bitmap >
+vvas_text_bitmap_get (const char *text, int font, double scale, int thickness,
+    int line_type)
+{
+  static thread_local std::vector < std::shared_ptr < const vvas_text_bitmap >>
+      bitmaps;
+
+  for (auto & bitmap:bitmaps) {
+    if (bitmap->matches (text, font, scale, thickness, line_type))
+      return bitmap;
+  }
+
+  /* callers still drawing with the dropped bitmap keep it alive */
+  if (bitmaps.size () == MAX_TEXT_BITMAPS)
+    bitmaps.erase (bitmaps.begin ());
+
+  bitmaps.push_back (std::make_shared < const vvas_text_bitmap > (text, font,
+          scale, thickness, line_type));
+  return bitmaps.back ();
+}
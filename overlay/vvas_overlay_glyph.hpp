@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+/* Printable ASCII characters are cached, others are drawn as '?' like putText */
+#define VVAS_GLYPH_FIRST_CHAR ' '
+#define VVAS_GLYPH_LAST_CHAR '~'
+#define VVAS_GLYPH_COUNT (VVAS_GLYPH_LAST_CHAR - VVAS_GLYPH_FIRST_CHAR + 1)
+
+/**
+ * struct vvas_glyph - Coverage bitmap of one character
+ * @left: Horizontal offset of the bitmap from pen position
+ * @top: Vertical offset of the bitmap from text origin
+ * @width: Width of the bitmap
+ * @height: Height of the bitmap
+ * @offset: Offset of the bitmap in coverage buffer of the atlas
+ * @units: Advance of the pen in font units
+ */
+struct vvas_glyph
+{
+  int32_t left;
+  int32_t top;
+  uint32_t width;
+  uint32_t height;
+  uint32_t offset;
+  int32_t units;
+};
+
+/**
+ * class vvas_glyph_atlas - Glyphs of a Hershey font rasterized once for a
+ *                          scale and thickness, so that text can be measured
+ *                          and drawn without rasterizing vector fonts per call
+ */
+class vvas_glyph_atlas
+{
+  int font;
+  double scale;
+  int thickness;
+  int64_t hscale;
+  int height_units;
+  int base_units;
+  vvas_glyph glyphs[VVAS_GLYPH_COUNT];
+  std::vector < uint8_t > coverage;
+
+  const vvas_glyph & glyph (char c) const;
+
+public:
+
+  vvas_glyph_atlas (int font, double scale, int thickness);
+
+  bool matches (int font, double scale, int thickness) const;
+
+  cv::Size measure (const char *text, int thickness, int *base_line) const;
+
+  void draw (cv::Mat & img, const char *text, cv::Point org,
+      const uint8_t * value) const;
+};
+
+/**
+ * vvas_glyph_atlas_get() - Gets glyph atlas of a font, atlases are created on first use
+ *                          and kept per thread
+ * @font: OpenCV Hershey font face, optionally with FONT_ITALIC
+ * @scale: Font scale
+ * @thickness: Thickness of the strokes
+ *
+ * Return: Glyph atlas, it stays valid while the caller holds the pointer even
+ * if later calls drop it from the per thread cache
+ */
+std::shared_ptr < const vvas_glyph_atlas > vvas_glyph_atlas_get (int font,
+    double scale, int thickness);
+
+/**
+ * class vvas_text_bitmap - Coverage bitmap of a whole text drawn with putText,
+ *                          for texts drawn unchanged on many frames like the
+ *                          clock, so that drawing is a blit of the bitmap
+ * @text: Text of the bitmap
+ * @font: OpenCV Hershey font face
+ * @scale: Font scale
+ * @thickness: Thickness of the strokes
+ * @line_type: Line type passed to putText
+ * @left: Horizontal offset of the bitmap from text origin
+ * @top: Vertical offset of the bitmap from text origin
+ * @width: Width of the bitmap
+ * @height: Height of the bitmap
+ * @size: Size of the text as given by getTextSize
+ * @base_line: Baseline of the text as given by getTextSize
+ * @coverage: Coverage of each pixel of the bitmap, 0 or 0xff
+ */
+class vvas_text_bitmap
+{
+  std::string text;
+  int font;
+  double scale;
+  int thickness;
+  int line_type;
+  int32_t left;
+  int32_t top;
+  uint32_t width;
+  uint32_t height;
+  cv::Size size;
+  int base_line;
+  std::vector < uint8_t > coverage;
+
+public:
+
+  vvas_text_bitmap (const char *text, int font, double scale, int thickness,
+      int line_type);
+
+  bool matches (const char *text, int font, double scale, int thickness,
+      int line_type) const;
+
+  cv::Rect bounds (cv::Point org) const;
+
+  void draw (cv::Mat & img, cv::Point org, const uint8_t * value) const;
+};
+
+/**
+ * vvas_text_bitmap_get() - Gets bitmap of a text, bitmaps are drawn on first use
+ *                          and kept per thread
+ * @text: Text to be drawn
+ * @font: OpenCV Hershey font face, optionally with FONT_ITALIC
+ * @scale: Font scale
+ * @thickness: Thickness of the strokes
+ * @line_type: Line type passed to putText
+ *
+ * Return: Text bitmap, it stays valid while the caller holds the pointer even
+ * if later calls drop it from the per thread cache
+ */
+std::shared_ptr < const vvas_text_bitmap > vvas_text_bitmap_get (const char
+    *text, int font, double scale, int thickness, int line_type);
@@ -0,0 +1,1121 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "config.h"
+#include "vvas_overlay_raster.hpp"
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace cv;
+
+/* Fixed point BT.601 coefficients used by OpenCV for RGB to YUV 4:2:0 */
+#define YUV_SHIFT 20
+#define YUV_HALF (1 << (YUV_SHIFT - 1))
+#define YUV_R2Y 269484
+#define YUV_G2Y 528482
+#define YUV_B2Y 102760
+#define YUV_R2U -155188
+#define YUV_G2U -305135
+#define YUV_B2U 460324
+#define YUV_G2V -385875
+#define YUV_B2V -74448
+
+/* Bytes of pixel value pattern blended per SIMD iteration */
+#define BLEND_PATTERN_SIZE 48
+
+/* Largest thickness accepted by OpenCV drawing functions */
+#define MAX_RASTER_THICKNESS 32767
+
+/**
+ * struct yuv_table - Contribution of each value of a color component to Y, U
+ *                    and V, rounding and offsets are added to red entries
+ */
+struct yuv_table
+{
+  int32_t y[3][256];
+  int32_t u[3][256];
+  int32_t v[3][256];
+
+  yuv_table ()
+  {
+    for (int32_t i = 0; i < 256; i++) {
+      y[0][i] = i * YUV_R2Y + (16 << YUV_SHIFT) + YUV_HALF;
+      y[1][i] = i * YUV_G2Y;
+      y[2][i] = i * YUV_B2Y;
+      u[0][i] = i * YUV_R2U + (128 << YUV_SHIFT) + YUV_HALF;
+      u[1][i] = i * YUV_G2U;
+      u[2][i] = i * YUV_B2U;
+      /* Red coefficient of V is same as blue coefficient of U */
+      v[0][i] = i * YUV_B2U + (128 << YUV_SHIFT) + YUV_HALF;
+      v[1][i] = i * YUV_G2V;
+      v[2][i] = i * YUV_B2V;
+    }
+  }
+};
+
+void
+vvas_raster_rgb_to_yuv (uint8_t red, uint8_t green, uint8_t blue,
+    uint8_t * y, uint8_t * u, uint8_t * v)
+{
+  static const yuv_table table;
+
+  *y = (table.y[0][red] + table.y[1][green] + table.y[2][blue]) >> YUV_SHIFT;
+  *u = (table.u[0][red] + table.u[1][green] + table.u[2][blue]) >> YUV_SHIFT;
+  *v = (table.v[0][red] + table.v[1][green] + table.v[2][blue]) >> YUV_SHIFT;
+}
+
+/**
+ *  @fn static void fill_row_16 (uint16_t * dst, int n, uint16_t value)
+ *  @param [out] dst - Pixels of 16 bit plane
+ *  @param [in] n - Number of pixels
+ *  @param [in] value - Pixel value
+ *  @return none
+ *  @brief Sets @n pixels of a row to @value.
+ */
+static void
+fill_row_16 (uint16_t * dst, int n, uint16_t value)
+{
+  int i = 0;
+
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+  uint16x8_t v = vdupq_n_u16 (value);
+
+  for (; i + 8 <= n; i += 8)
+    vst1q_u16 (dst + i, v);
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+  __m128i v = _mm_set1_epi16 ((short) value);
+
+  for (; i + 8 <= n; i += 8)
+    _mm_storeu_si128 ((__m128i *) (dst + i), v);
+#endif
+
+  for (; i < n; i++)
+    dst[i] = value;
+}
+
+/**
+ *  @fn static void fill_row_24 (uint8_t * dst, int n, const uint8_t * value)
+ *  @param [out] dst - Pixels of 24 bit plane
+ *  @param [in] n - Number of pixels
+ *  @param [in] value - 3 bytes of pixel value
+ *  @return none
+ *  @brief Sets @n pixels of a row to @value.
+ */
+static void
+fill_row_24 (uint8_t * dst, int n, const uint8_t * value)
+{
+  int i = 0;
+
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+  uint8x16x3_t v;
+
+  v.val[0] = vdupq_n_u8 (value[0]);
+  v.val[1] = vdupq_n_u8 (value[1]);
+  v.val[2] = vdupq_n_u8 (value[2]);
+  for (; i + 16 <= n; i += 16)
+    vst3q_u8 (dst + i * 3, v);
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+  uint8_t pattern[48];
+
+  for (int j = 0; j < 48; j++)
+    pattern[j] = value[j % 3];
+
+  __m128i v0 = _mm_loadu_si128 ((const __m128i *) pattern);
+  __m128i v1 = _mm_loadu_si128 ((const __m128i *) (pattern + 16));
+  __m128i v2 = _mm_loadu_si128 ((const __m128i *) (pattern + 32));
+
+  for (; i + 16 <= n; i += 16) {
+    _mm_storeu_si128 ((__m128i *) (dst + i * 3), v0);
+    _mm_storeu_si128 ((__m128i *) (dst + i * 3 + 16), v1);
+    _mm_storeu_si128 ((__m128i *) (dst + i * 3 + 32), v2);
+  }
+#endif
+
+  for (; i < n; i++) {
+    dst[i * 3] = value[0];
+    dst[i * 3 + 1] = value[1];
+    dst[i * 3 + 2] = value[2];
+  }
+}
+
+/**
+ *  @fn static void blend_row (uint8_t * dst, int n, int bpp,
+ *                             const uint8_t * value, uint32_t alpha)
+ *  @param [inout] dst - Pixels of the plane
+ *  @param [in] n - Number of pixels
+ *  @param [in] bpp - Bytes per pixel, 1, 2 or 3
+ *  @param [in] value - @bpp bytes of pixel value
+ *  @param [in] alpha - Opacity of @value, 0 to 255
+ *  @return none
+ *  @brief Blends @n pixels of a row with @value. Each byte is computed as
+ *         (dst * (256 - a) + value * a + 128) >> 8 where a is @alpha scaled
+ *         to 0..256, so that opacity 255 gives @value exactly.
+ */
+static void
+blend_row (uint8_t * dst, int n, int bpp, const uint8_t * value,
+    uint32_t alpha)
+{
+  uint32_t a = alpha + (alpha >> 7);
+  uint32_t ia = 256 - a;
+  uint8_t pattern[BLEND_PATTERN_SIZE];
+  int bytes = n * bpp;
+  int i = 0;
+
+  /* pattern size is a multiple of 16 and of all pixel sizes */
+  for (int j = 0; j < BLEND_PATTERN_SIZE; j++)
+    pattern[j] = value[j % bpp];
+
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+  uint16x8_t vi = vdupq_n_u16 (ia);
+  uint16x8_t pv[6];
+
+  for (int k = 0; k < 3; k++) {
+    uint8x16_t p = vld1q_u8 (pattern + k * 16);
+
+    pv[k * 2] = vmlaq_n_u16 (vdupq_n_u16 (128), vmovl_u8 (vget_low_u8 (p)), a);
+    pv[k * 2 + 1] = vmlaq_n_u16 (vdupq_n_u16 (128),
+        vmovl_u8 (vget_high_u8 (p)), a);
+  }
+
+  for (; i + BLEND_PATTERN_SIZE <= bytes; i += BLEND_PATTERN_SIZE) {
+    for (int k = 0; k < 3; k++) {
+      uint8x16_t d = vld1q_u8 (dst + i + k * 16);
+      uint16x8_t lo = vmlaq_u16 (pv[k * 2], vmovl_u8 (vget_low_u8 (d)), vi);
+      uint16x8_t hi = vmlaq_u16 (pv[k * 2 + 1], vmovl_u8 (vget_high_u8 (d)),
+          vi);
+
+      vst1q_u8 (dst + i + k * 16, vcombine_u8 (vshrn_n_u16 (lo, 8),
+              vshrn_n_u16 (hi, 8)));
+    }
+  }
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+  __m128i zero = _mm_setzero_si128 ();
+  __m128i vi = _mm_set1_epi16 ((short) ia);
+  __m128i pv[6];
+
+  for (int k = 0; k < 3; k++) {
+    __m128i p = _mm_loadu_si128 ((const __m128i *) (pattern + k * 16));
+
+    pv[k * 2] = _mm_add_epi16 (_mm_mullo_epi16 (_mm_unpacklo_epi8 (p, zero),
+            _mm_set1_epi16 ((short) a)), _mm_set1_epi16 (128));
+    pv[k * 2 + 1] = _mm_add_epi16 (_mm_mullo_epi16 (_mm_unpackhi_epi8 (p,
+                zero), _mm_set1_epi16 ((short) a)), _mm_set1_epi16 (128));
+  }
+
+  for (; i + BLEND_PATTERN_SIZE <= bytes; i += BLEND_PATTERN_SIZE) {
+    for (int k = 0; k < 3; k++) {
+      __m128i d = _mm_loadu_si128 ((const __m128i *) (dst + i + k * 16));
+      __m128i lo = _mm_add_epi16 (_mm_mullo_epi16 (_mm_unpacklo_epi8 (d,
+                  zero), vi), pv[k * 2]);
+      __m128i hi = _mm_add_epi16 (_mm_mullo_epi16 (_mm_unpackhi_epi8 (d,
+                  zero), vi), pv[k * 2 + 1]);
+
+      _mm_storeu_si128 ((__m128i *) (dst + i + k * 16),
+          _mm_packus_epi16 (_mm_srli_epi16 (lo, 8), _mm_srli_epi16 (hi, 8)));
+    }
+  }
+#endif
+
+  for (; i < bytes; i++)
+    dst[i] = (dst[i] * ia + pattern[i % BLEND_PATTERN_SIZE] * a + 128) >> 8;
+}
+
+/**
+ *  @fn static void blend_premultiplied_row (uint8_t * dst, int bytes,
+ *                                           const uint8_t * color,
+ *                                           const uint8_t * alpha)
+ *  @param [inout] dst - Bytes of the plane
+ *  @param [in] bytes - Number of bytes
+ *  @param [in] color - Value of each byte premultiplied by its opacity
+ *  @param [in] alpha - Opacity of each byte, 0 to 255
+ *  @return none
+ *  @brief Blends a row with values varying per pixel. Each byte is computed
+ *         as ((dst * (256 - a) + 128) >> 8) + color where a is @alpha scaled
+ *         to 0..256. Blocks of fully transparent bytes are skipped.
+ */
+static void
+blend_premultiplied_row (uint8_t * dst, int bytes, const uint8_t * color,
+    const uint8_t * alpha)
+{
+  int i = 0;
+
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+  uint16x8_t full = vdupq_n_u16 (256);
+  uint16x8_t half = vdupq_n_u16 (128);
+
+  for (; i + 16 <= bytes; i += 16) {
+    uint8x16_t va = vld1q_u8 (alpha + i);
+
+    if (!vmaxvq_u8 (va))
+      continue;
+
+    uint8x16_t d = vld1q_u8 (dst + i);
+    uint16x8_t alo = vmovl_u8 (vget_low_u8 (va));
+    uint16x8_t ahi = vmovl_u8 (vget_high_u8 (va));
+
+    alo = vsraq_n_u16 (alo, alo, 7);
+    ahi = vsraq_n_u16 (ahi, ahi, 7);
+
+    uint16x8_t lo = vmlaq_u16 (half, vmovl_u8 (vget_low_u8 (d)),
+        vsubq_u16 (full, alo));
+    uint16x8_t hi = vmlaq_u16 (half, vmovl_u8 (vget_high_u8 (d)),
+        vsubq_u16 (full, ahi));
+
+    vst1q_u8 (dst + i, vqaddq_u8 (vcombine_u8 (vshrn_n_u16 (lo, 8),
+                vshrn_n_u16 (hi, 8)), vld1q_u8 (color + i)));
+  }
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+  __m128i zero = _mm_setzero_si128 ();
+  __m128i full = _mm_set1_epi16 (256);
+  __m128i half = _mm_set1_epi16 (128);
+
+  for (; i + 16 <= bytes; i += 16) {
+    __m128i va = _mm_loadu_si128 ((const __m128i *) (alpha + i));
+
+    if (_mm_movemask_epi8 (_mm_cmpeq_epi8 (va, zero)) == 0xFFFF)
+      continue;
+
+    __m128i d = _mm_loadu_si128 ((const __m128i *) (dst + i));
+    __m128i alo = _mm_unpacklo_epi8 (va, zero);
+    __m128i ahi = _mm_unpackhi_epi8 (va, zero);
+
+    alo = _mm_add_epi16 (alo, _mm_srli_epi16 (alo, 7));
+    ahi = _mm_add_epi16 (ahi, _mm_srli_epi16 (ahi, 7));
+
+    __m128i lo = _mm_add_epi16 (_mm_mullo_epi16 (_mm_unpacklo_epi8 (d, zero),
+            _mm_sub_epi16 (full, alo)), half);
+    __m128i hi = _mm_add_epi16 (_mm_mullo_epi16 (_mm_unpackhi_epi8 (d, zero),
+            _mm_sub_epi16 (full, ahi)), half);
+
+    _mm_storeu_si128 ((__m128i *) (dst + i),
+        _mm_adds_epu8 (_mm_packus_epi16 (_mm_srli_epi16 (lo, 8),
+                _mm_srli_epi16 (hi, 8)),
+            _mm_loadu_si128 ((const __m128i *) (color + i))));
+  }
+#endif
+
+  for (; i < bytes; i++) {
+    uint32_t a = alpha[i] + (alpha[i] >> 7);
+
+    if (a)
+      dst[i] = std::min ((uint32_t) 255,
+          ((dst[i] * (256 - a) + 128) >> 8) + color[i]);
+  }
+}
+
+/**
+ * struct raster_band_rows - Band of the frame drawn by a thread
+ * @begin: First row of the band
+ * @end: Row after the last row of the band
+ * @height: Height of the frame, 0 when whole planes are drawn
+ */
+struct raster_band_rows
+{
+  int begin;
+  int end;
+  int height;
+};
+
+static thread_local raster_band_rows raster_band = { 0, 0, 0 };
+
+vvas_raster_band::vvas_raster_band (int begin, int end, int height)
+{
+  prev_begin = raster_band.begin;
+  prev_end = raster_band.end;
+  prev_height = raster_band.height;
+  raster_band = { begin, end, height };
+}
+
+vvas_raster_band::~vvas_raster_band ()
+{
+  raster_band = { prev_begin, prev_end, prev_height };
+}
+
+void
+vvas_raster_rows (const Mat & img, int *begin, int *end)
+{
+  if (raster_band.height <= 0) {
+    *begin = 0;
+    *end = img.rows;
+    return;
+  }
+
+  /* bands of subsampled planes are scaled, adjacent bands stay adjacent */
+  *begin = (int64_t) raster_band.begin * img.rows / raster_band.height;
+  *end = (int64_t) raster_band.end * img.rows / raster_band.height;
+  *begin = std::min (std::max (*begin, 0), img.rows);
+  *end = std::min (std::max (*end, *begin), img.rows);
+}
+
+/**
+ * struct raster_span - Pixels of a row covered by a shape
+ * @y: Row
+ * @x0: First column
+ * @x1: Last column
+ */
+struct raster_span
+{
+  int32_t y;
+  int32_t x0;
+  int32_t x1;
+};
+
+/**
+ * struct raster_pen - Destination of the spans of a shape
+ * @img: Plane to draw on
+ * @value: Pixel value
+ * @alpha: Opacity of @value, 0 to 255
+ * @spans: When not NULL, spans are collected here and drawn by flush_spans ()
+ *         so that pixels covered more than once are blended only once
+ * @row_begin: First row of @img drawn by this thread
+ * @row_end: Row after the last row of @img drawn by this thread
+ */
+struct raster_pen
+{
+  Mat & img;
+  const uint8_t *value;
+  uint32_t alpha;
+  std::vector < raster_span > *spans;
+  int row_begin;
+  int row_end;
+
+  raster_pen (Mat & img, const uint8_t * value, uint32_t alpha,
+      std::vector < raster_span > *spans)
+  :img (img), value (value), alpha (alpha), spans (spans)
+  {
+    vvas_raster_rows (img, &row_begin, &row_end);
+  }
+};
+
+/**
+ *  @fn static void fill_span (raster_pen & pen, int y, int x0, int x1)
+ *  @param [in] pen - Plane and value to draw with
+ *  @param [in] y - Row of the span, inside the plane
+ *  @param [in] x0 - First column of the span, inside the plane
+ *  @param [in] x1 - Last column of the span, inside the plane
+ *  @return none
+ *  @brief Fills or blends pixels of a row from @x0 to @x1.
+ */
+static void
+fill_span (raster_pen & pen, int y, int x0, int x1)
+{
+  uint8_t *row = pen.img.ptr (y);
+  int bpp = pen.img.elemSize ();
+  int n = x1 - x0 + 1;
+
+  if (pen.alpha < 255) {
+    blend_row (row + x0 * bpp, n, bpp, pen.value, pen.alpha);
+    return;
+  }
+
+  switch (bpp) {
+    case 1:
+      memset (row + x0, pen.value[0], n);
+      break;
+    case 2:{
+      uint16_t v;
+
+      memcpy (&v, pen.value, sizeof (v));
+      fill_row_16 ((uint16_t *) row + x0, n, v);
+      break;
+    }
+    case 3:
+      fill_row_24 (row + x0 * 3, n, pen.value);
+      break;
+    default:
+      break;
+  }
+}
+
+/**
+ *  @fn static void draw_span (raster_pen & pen, int64_t y, int64_t x0,
+ *                             int64_t x1)
+ *  @param [in] pen - Plane and value to draw with
+ *  @param [in] y - Row of the span
+ *  @param [in] x0 - First column of the span
+ *  @param [in] x1 - Last column of the span
+ *  @return none
+ *  @brief Draws pixels of a row from @x0 to @x1, parts outside the plane are
+ *         skipped.
+ */
+static void
+draw_span (raster_pen & pen, int64_t y, int64_t x0, int64_t x1)
+{
+  if (y < pen.row_begin || y >= pen.row_end)
+    return;
+
+  x0 = std::max (x0, (int64_t) 0);
+  x1 = std::min (x1, (int64_t) pen.img.cols - 1);
+  if (x0 > x1)
+    return;
+
+  if (pen.spans)
+    pen.spans->push_back ({(int32_t) y, (int32_t) x0, (int32_t) x1});
+  else
+    fill_span (pen, y, x0, x1);
+}
+
+/**
+ *  @fn static void flush_spans (raster_pen & pen)
+ *  @param [in] pen - Plane and value to draw with, and the collected spans
+ *  @return none
+ *  @brief Draws collected spans, overlapping spans of a row are merged first.
+ */
+static void
+flush_spans (raster_pen & pen)
+{
+  std::vector < raster_span > &spans = *pen.spans;
+  size_t i = 0;
+
+  std::sort (spans.begin (), spans.end (),
+      [](const raster_span & l, const raster_span & r) {
+        return l.y < r.y || (l.y == r.y && l.x0 < r.x0);
+      });
+
+  while (i < spans.size ()) {
+    raster_span cur = spans[i++];
+
+    while (i < spans.size () && spans[i].y == cur.y && spans[i].x0 <= cur.x1 + 1)
+      cur.x1 = std::max (cur.x1, spans[i++].x1);
+
+    fill_span (pen, cur.y, cur.x0, cur.x1);
+  }
+
+  spans.clear ();
+}
+
+/**
+ *  @fn static const int * disc_half_widths (int radius)
+ *  @param [in] radius - Radius of the disc
+ *  @return Half width of each row of the disc, indexed by distance from center row
+ *  @brief Computes rows of a filled disc with the midpoint algorithm used by
+ *         OpenCV for round joints of thick lines. Table is kept per thread.
+ */
+static const int *
+disc_half_widths (int radius)
+{
+  static thread_local std::vector < int >half;
+  int err = 0, dx = radius, dy = 0, plus = 1, minus = (radius << 1) - 1;
+
+  half.assign (radius + 1, 0);
+  while (dx >= dy) {
+    int mask;
+
+    half[dy] = std::max (half[dy], dx);
+    half[dx] = std::max (half[dx], dy);
+
+    dy++;
+    err += plus;
+    plus += 2;
+    mask = (err <= 0) - 1;
+    err -= minus & mask;
+    dx += mask;
+    minus -= mask & 2;
+  }
+
+  return half.data ();
+}
+
+/**
+ *  @fn static void outline_rect (raster_pen & pen, int x0, int y0, int x1,
+ *                                int y1, int thickness)
+ *  @param [in] pen - Plane and value to draw with
+ *  @param [in] x0 - Left column
+ *  @param [in] y0 - Top row
+ *  @param [in] x1 - Right column, not less than @x0
+ *  @param [in] y1 - Bottom row, not less than @y0
+ *  @param [in] thickness - Thickness of the outline, filled when negative
+ *  @return none
+ *  @brief Draws a rectangle as rows of its edges. Edges of thickness t are
+ *         bands of (t + 1) / 2 pixels on both sides joined with round corners,
+ *         as thick lines of OpenCV.
+ */
+static void
+outline_rect (raster_pen & pen, int x0, int y0, int x1, int y1,
+    int thickness)
+{
+  if (thickness < 0) {
+    for (int y = std::max (y0, pen.row_begin);
+        y <= std::min (y1, pen.row_end - 1); y++)
+      draw_span (pen, y, x0, x1);
+    return;
+  }
+
+  int h = thickness > 1 ?
+      (std::min (thickness, MAX_RASTER_THICKNESS) + 1) / 2 : 0;
+  const int *half = disc_half_widths (h);
+  int y_start = std::max (y0 - h, pen.row_begin);
+  int y_end = std::min (y1 + h, pen.row_end - 1);
+
+  for (int y = y_start; y <= y_end; y++) {
+    int top = abs (y - y0);
+    int bottom = abs (y - y1);
+    bool inside = y >= y0 && y <= y1;
+
+    if (top <= h || bottom <= h) {
+      /* horizontal edge, widened by vertical edges or corners */
+      int ext = 0;
+
+      if (inside)
+        ext = h;
+      else if (top <= h)
+        ext = half[top];
+      if (!inside && bottom <= h)
+        ext = std::max (ext, half[bottom]);
+
+      draw_span (pen, y, x0 - ext, x1 + ext);
+    } else if (x0 + h + 1 >= x1 - h) {
+      draw_span (pen, y, x0 - h, x1 + h);
+    } else {
+      draw_span (pen, y, x0 - h, x0 + h);
+      draw_span (pen, y, x1 - h, x1 + h);
+    }
+  }
+}
+
+void
+vvas_raster_fill (Mat & img, Point pt1, Point pt2, const uint8_t * value,
+    uint8_t alpha)
+{
+  raster_pen pen = { img, value, alpha, NULL };
+
+  if (!alpha)
+    return;
+
+  outline_rect (pen, std::min (pt1.x, pt2.x), std::min (pt1.y, pt2.y),
+      std::max (pt1.x, pt2.x), std::max (pt1.y, pt2.y), -1);
+}
+
+void
+vvas_raster_rect (Mat & img, Rect rect, int thickness, const uint8_t * value,
+    uint8_t alpha)
+{
+  /* spans of a rectangle do not overlap, so they are blended directly */
+  raster_pen pen = { img, value, alpha, NULL };
+
+  /* rectangle is cropped to one pixel around the image, like OpenCV */
+  int64_t x0 = std::max (rect.x, -1);
+  int64_t y0 = std::max (rect.y, -1);
+  int64_t x1 = std::min ((int64_t) rect.x + rect.width, (int64_t) img.cols + 1);
+  int64_t y1 = std::min ((int64_t) rect.y + rect.height,
+      (int64_t) img.rows + 1);
+
+  if (x1 <= x0 || y1 <= y0 || !alpha)
+    return;
+
+  outline_rect (pen, x0, y0, x1 - 1, y1 - 1, thickness);
+}
+
+/**
+ *  @fn static bool clip_line (int64_t width, int64_t height, int64_t * x1,
+ *                             int64_t * y1, int64_t * x2, int64_t * y2)
+ *  @param [in] width - Width of the plane
+ *  @param [in] height - Height of the plane
+ *  @param [inout] x1, y1 - First end of the segment
+ *  @param [inout] x2, y2 - Second end of the segment
+ *  @return true when part of the segment is inside the plane
+ *  @brief Clips a segment to the plane with same rounding as clipLine of OpenCV,
+ *         so that clipped lines are same as the ones drawn by OpenCV.
+ */
+static bool
+clip_line (int64_t width, int64_t height, int64_t * x1, int64_t * y1,
+    int64_t * x2, int64_t * y2)
+{
+  int64_t right = width - 1, bottom = height - 1, a;
+  int c1, c2;
+
+  if (width <= 0 || height <= 0)
+    return false;
+
+  c1 = (*x1 < 0) + (*x1 > right) * 2 + (*y1 < 0) * 4 + (*y1 > bottom) * 8;
+  c2 = (*x2 < 0) + (*x2 > right) * 2 + (*y2 < 0) * 4 + (*y2 > bottom) * 8;
+
+  if ((c1 & c2) == 0 && (c1 | c2) != 0) {
+    if (c1 & 12) {
+      a = c1 < 8 ? 0 : bottom;
+      *x1 += (int64_t) ((double) (a - *y1) * (*x2 - *x1) / (*y2 - *y1));
+      *y1 = a;
+      c1 = (*x1 < 0) + (*x1 > right) * 2;
+    }
+    if (c2 & 12) {
+      a = c2 < 8 ? 0 : bottom;
+      *x2 += (int64_t) ((double) (a - *y2) * (*x2 - *x1) / (*y2 - *y1));
+      *y2 = a;
+      c2 = (*x2 < 0) + (*x2 > right) * 2;
+    }
+    if ((c1 & c2) == 0 && (c1 | c2) != 0) {
+      if (c1) {
+        a = c1 == 1 ? 0 : right;
+        *y1 += (int64_t) ((double) (a - *x1) * (*y2 - *y1) / (*x2 - *x1));
+        *x1 = a;
+        c1 = 0;
+      }
+      if (c2) {
+        a = c2 == 1 ? 0 : right;
+        *y2 += (int64_t) ((double) (a - *x2) * (*y2 - *y1) / (*x2 - *x1));
+        *x2 = a;
+        c2 = 0;
+      }
+    }
+  }
+
+  return (c1 | c2) == 0;
+}
+
+/**
+ *  @fn static void thin_line (raster_pen & pen, Point pt1, Point pt2)
+ *  @param [in] pen - Plane and value to draw with
+ *  @param [in] pt1 - First end of the segment
+ *  @param [in] pt2 - Second end of the segment
+ *  @return none
+ *  @brief Draws a 4-connected line one row at a time. Line is walked from
+ *         left to right and steps to next row once the error term of OpenCV
+ *         4-connected line iterator gets negative, so span of each row is
+ *         computed directly instead of stepping every pixel.
+ */
+static void
+thin_line (raster_pen & pen, Point pt1, Point pt2)
+{
+  int64_t x1 = pt1.x, y1 = pt1.y, x2 = pt2.x, y2 = pt2.y;
+
+  if (!clip_line (pen.img.cols, pen.img.rows, &x1, &y1, &x2, &y2))
+    return;
+
+  if (x1 > x2) {
+    std::swap (x1, x2);
+    std::swap (y1, y2);
+  }
+
+  int64_t dx = x2 - x1;
+  int64_t dy = std::abs (y2 - y1);
+
+  /* ties of the error term step along the major axis */
+  int64_t bias = dx >= dy ? dy : dy - 1;
+
+  for (int64_t y = std::min (y1, y2); y <= std::max (y1, y2); y++) {
+    int64_t j = std::abs (y - y1);
+    int64_t first = j == 0 ? 0 : std::min (dx, (dx * (j - 1) + bias) / dy);
+    int64_t last = j == dy ? dx : std::min (dx, (dx * j + bias) / dy);
+
+    draw_span (pen, y, x1 + first, x1 + last);
+  }
+}
+
+/**
+ *  @fn static void draw_line (raster_pen & pen, Point pt1, Point pt2,
+ *                             int thickness)
+ *  @param [in] pen - Plane and value to draw with
+ *  @param [in] pt1 - First end of the segment
+ *  @param [in] pt2 - Second end of the segment
+ *  @param [in] thickness - Thickness of the line
+ *  @return none
+ *  @brief Draws a line segment as rows of pixels around it.
+ */
+static void
+draw_line (raster_pen & pen, Point pt1, Point pt2, int thickness)
+{
+  if (thickness <= 1) {
+    thin_line (pen, pt1, pt2);
+    return;
+  }
+
+  /* pixels within half a pixel of a band of (thickness + 1) / 2 pixels on
+   * both sides of the segment, with round caps */
+  int h = (std::min (thickness, MAX_RASTER_THICKNESS) + 1) / 2;
+  const int *half = disc_half_widths (h);
+  double dx = (double) pt2.x - pt1.x;
+  double dy = (double) pt2.y - pt1.y;
+  double len2 = dx * dx + dy * dy;
+  double hlen = (h + 0.5) * sqrt (len2);
+  int y_start = std::max (std::min (pt1.y, pt2.y) - h, pen.row_begin);
+  int y_end = std::min (std::max (pt1.y, pt2.y) + h, pen.row_end - 1);
+
+  for (int y = y_start; y <= y_end; y++) {
+    double lo = HUGE_VAL, hi = -HUGE_VAL;
+    double ry = (double) y - pt1.y;
+    int d1 = abs (y - pt1.y), d2 = abs (y - pt2.y);
+
+    /* round caps */
+    if (d1 <= h) {
+      lo = std::min (lo, (double) pt1.x - half[d1]);
+      hi = std::max (hi, (double) pt1.x + half[d1]);
+    }
+    if (d2 <= h) {
+      lo = std::min (lo, (double) pt2.x - half[d2]);
+      hi = std::max (hi, (double) pt2.x + half[d2]);
+    }
+
+    /* body, (x - pt1.x) * dx within [-ry * dy, len2 - ry * dy] and
+     * (x - pt1.x) * dy within [ry * dx - hlen, ry * dx + hlen] */
+    if (len2 > 0) {
+      double b_lo = -HUGE_VAL, b_hi = HUGE_VAL;
+      double a0 = -ry * dy, a1 = len2 - ry * dy;
+      double c0 = ry * dx - hlen, c1 = ry * dx + hlen;
+
+      if (dx != 0) {
+        b_lo = std::max (b_lo, std::min (a0 / dx, a1 / dx));
+        b_hi = std::min (b_hi, std::max (a0 / dx, a1 / dx));
+      } else if (a0 > 0 || a1 < 0) {
+        b_hi = -HUGE_VAL;
+      }
+
+      if (dy != 0) {
+        b_lo = std::max (b_lo, std::min (c0 / dy, c1 / dy));
+        b_hi = std::min (b_hi, std::max (c0 / dy, c1 / dy));
+      } else if (c0 > 0 || c1 < 0) {
+        b_hi = -HUGE_VAL;
+      }
+
+      if (b_lo <= b_hi) {
+        lo = std::min (lo, pt1.x + b_lo);
+        hi = std::max (hi, pt1.x + b_hi);
+      }
+    }
+
+    if (lo <= hi) {
+      lo = std::max (ceil (lo - 1e-9), -1.0);
+      hi = std::min (floor (hi + 1e-9), (double) pen.img.cols);
+      draw_span (pen, y, (int) lo, (int) hi);
+    }
+  }
+}
+
+/**
+ *  @fn static int64_t isqrt (int64_t v)
+ *  @param [in] v - Non negative value
+ *  @return Largest integer whose square is not greater than @v
+ */
+static int64_t
+isqrt (int64_t v)
+{
+  int64_t r = (int64_t) sqrt ((double) v);
+
+  while (r > 0 && r * r > v)
+    r--;
+  while ((r + 1) * (r + 1) <= v)
+    r++;
+
+  return r;
+}
+
+void
+vvas_raster_line (Mat & img, Point pt1, Point pt2, int thickness,
+    const uint8_t * value)
+{
+  raster_pen pen = { img, value, 255, NULL };
+
+  draw_line (pen, pt1, pt2, thickness);
+}
+
+void
+vvas_raster_circle (Mat & img, Point center, int radius, int thickness,
+    const uint8_t * value)
+{
+  raster_pen pen = { img, value, 255, NULL };
+
+  if (radius < 0)
+    return;
+
+  /* ring of pixels whose center is within (thickness + 1) / 2 + 0.5 from
+   * the circle, distances are doubled to stay in integers */
+  int64_t h = thickness > 1 ?
+      (std::min (thickness, MAX_RASTER_THICKNESS) + 1) / 2 : 0;
+  int64_t outer = 2 * ((int64_t) radius + h) + 1;
+  int64_t inner = thickness < 0 ? 0 : 2 * ((int64_t) radius - h) - 1;
+  int64_t extent = (int64_t) radius + h;
+  int y_start = std::max ((int64_t) center.y - extent,
+      (int64_t) pen.row_begin);
+  int y_end = std::min ((int64_t) center.y + extent,
+      (int64_t) pen.row_end - 1);
+
+  for (int y = y_start; y <= y_end; y++) {
+    int64_t dy2 = 4 * ((int64_t) y - center.y) * ((int64_t) y - center.y);
+    int64_t q_out = outer * outer - dy2;
+    int64_t q_in = inner > 0 ? inner * inner - dy2 - 1 : -1;
+
+    if (q_out < 0)
+      continue;
+
+    int64_t b = isqrt (q_out / 4);
+
+    if (q_in < 0) {
+      draw_span (pen, y, center.x - b, center.x + b);
+    } else {
+      int64_t a = isqrt (q_in / 4);
+
+      draw_span (pen, y, center.x - b, center.x - a - 1);
+      draw_span (pen, y, center.x + a + 1, center.x + b);
+    }
+  }
+}
+
+void
+vvas_raster_arrow (Mat & img, Point pt1, Point pt2, int thickness,
+    double tip_length, const uint8_t * value)
+{
+  /* tip is placed as in arrowedLine of OpenCV */
+  double tip_size = sqrt ((double) (pt1.x - pt2.x) * (pt1.x - pt2.x) +
+      (double) (pt1.y - pt2.y) * (pt1.y - pt2.y)) * tip_length;
+  double angle = atan2 ((double) pt1.y - pt2.y, (double) pt1.x - pt2.x);
+  raster_pen pen = { img, value, 255, NULL };
+
+  draw_line (pen, pt1, pt2, thickness);
+  draw_line (pen, Point (cvRound (pt2.x + tip_size * cos (angle + CV_PI / 4)),
+          cvRound (pt2.y + tip_size * sin (angle + CV_PI / 4))), pt2,
+      thickness);
+  draw_line (pen, Point (cvRound (pt2.x + tip_size * cos (angle - CV_PI / 4)),
+          cvRound (pt2.y + tip_size * sin (angle - CV_PI / 4))), pt2,
+      thickness);
+}
+
+void
+vvas_raster_polyline (Mat & img, const Point * pts, int npts, bool closed,
+    int thickness, const uint8_t * value, uint8_t alpha)
+{
+  /* edges overlap at the vertices, so translucent polylines are blended
+   * once from the union of spans of all edges */
+  static thread_local std::vector < raster_span > spans;
+  raster_pen pen = { img, value, alpha, alpha < 255 ? &spans : NULL };
+
+  if (npts <= 0 || !alpha)
+    return;
+
+  if (npts == 1)
+    draw_line (pen, pts[0], pts[0], thickness);
+
+  for (int i = 1; i < npts; i++)
+    draw_line (pen, pts[i - 1], pts[i], thickness);
+
+  if (closed && npts > 1)
+    draw_line (pen, pts[npts - 1], pts[0], thickness);
+
+  if (pen.spans)
+    flush_spans (pen);
+}
+
+/**
+ * struct mask_sample - Position of a column or row of the plane in the mask
+ * @i0: First mask pixel
+ * @i1: Second mask pixel, next to @i0 for bilinear scaling
+ * @f: Weight of @i1, 0 to 255, weight of @i0 is 256 - @f
+ */
+struct mask_sample
+{
+  int32_t i0;
+  int32_t i1;
+  int32_t f;
+};
+
+/**
+ *  @fn static void mask_samples (std::vector < mask_sample > &samples,
+ *                                int start, int count, int dst_size,
+ *                                int src_size, bool bilinear)
+ *  @param [out] samples - Position of each of the @count pixels
+ *  @param [in] start - First pixel, relative to the start of the mask
+ *  @param [in] count - Number of pixels
+ *  @param [in] dst_size - Size of the mask once scaled
+ *  @param [in] src_size - Size of the mask
+ *  @param [in] bilinear - Compute two neighbours and their weights when set,
+ *                         nearest mask pixel otherwise
+ *  @return none
+ *  @brief Maps centers of scaled pixels to the mask, as resize () of OpenCV.
+ */
+static void
+mask_samples (std::vector < mask_sample > &samples, int start, int count,
+    int dst_size, int src_size, bool bilinear)
+{
+  samples.resize (count);
+
+  for (int i = 0; i < count; i++) {
+    int64_t center = (int64_t) (2 * (start + i) + 1) * src_size;
+    mask_sample & s = samples[i];
+
+    if (!bilinear) {
+      s.i0 = s.i1 = std::min (center / (2 * (int64_t) dst_size),
+          (int64_t) src_size - 1);
+      s.f = 0;
+      continue;
+    }
+
+    /* position with 8 fractional bits, clamped at the borders */
+    int64_t pos = center * 128 / dst_size - 128;
+
+    pos = std::min (std::max (pos, (int64_t) 0), (int64_t) (src_size - 1) << 8);
+    s.i0 = pos >> 8;
+    s.i1 = std::min (s.i0 + 1, src_size - 1);
+    s.f = pos & 255;
+  }
+}
+
+/**
+ *  @fn static void mask_row_horizontal (const uint8_t * src,
+ *                                       const std::vector < mask_sample > &cols,
+ *                                       int bpp, const uint8_t * premul,
+ *                                       const uint8_t * alphas,
+ *                                       uint16_t * color, uint16_t * alpha)
+ *  @param [in] src - Row of the mask
+ *  @param [in] cols - Position of each column in the mask
+ *  @param [in] bpp - Bytes per pixel
+ *  @param [in] premul - Pixel values of classes premultiplied by their opacity
+ *  @param [in] alphas - Opacity of classes
+ *  @param [out] color - Interpolated premultiplied values, 8 fractional bits
+ *  @param [out] alpha - Interpolated opacities, 8 fractional bits
+ *  @return none
+ *  @brief Scales a row of the mask horizontally with linear interpolation.
+ */
+static void
+mask_row_horizontal (const uint8_t * src,
+    const std::vector < mask_sample > &cols, int bpp, const uint8_t * premul,
+    const uint8_t * alphas, uint16_t * color, uint16_t * alpha)
+{
+  for (size_t x = 0; x < cols.size (); x++) {
+    uint32_t c0 = src[cols[x].i0];
+    uint32_t c1 = src[cols[x].i1];
+    uint32_t f = cols[x].f;
+    uint32_t g = 256 - f;
+
+    alpha[x] = alphas[c0] * g + alphas[c1] * f;
+    for (int k = 0; k < bpp; k++)
+      color[x * bpp + k] = premul[c0 * bpp + k] * g + premul[c1 * bpp + k] * f;
+  }
+}
+
+void
+vvas_raster_mask (Mat & img, Rect rect, const uint8_t * mask, int mask_width,
+    int mask_height, int mask_stride, const uint8_t * values,
+    const uint8_t * alphas, bool bilinear)
+{
+  static thread_local std::vector < mask_sample > cols, rows;
+  static thread_local std::vector < uint8_t > color, alpha;
+  static thread_local std::vector < uint16_t > hcolor[2], halpha[2];
+  uint8_t premul[256 * 3];
+  int bpp = img.elemSize ();
+  int row_begin, row_end;
+
+  vvas_raster_rows (img, &row_begin, &row_end);
+
+  int x0 = std::max (rect.x, 0);
+  int y0 = std::max (rect.y, row_begin);
+  int x1 = std::min ((int64_t) rect.x + rect.width, (int64_t) img.cols);
+  int y1 = std::min ((int64_t) rect.y + rect.height, (int64_t) row_end);
+  int n = x1 - x0;
+
+  if (!mask || mask_width <= 0 || mask_height <= 0 || rect.width <= 0
+      || rect.height <= 0 || x0 >= x1 || y0 >= y1 || bpp > 3)
+    return;
+
+  for (int c = 0; c < 256; c++)
+    for (int k = 0; k < bpp; k++)
+      premul[c * bpp + k] = (values[c * bpp + k] * alphas[c] + 127) / 255;
+
+  mask_samples (cols, x0 - rect.x, n, rect.width, mask_width, bilinear);
+  mask_samples (rows, y0 - rect.y, y1 - y0, rect.height, mask_height,
+      bilinear);
+  color.resize (n * bpp);
+  alpha.resize (n * bpp);
+
+  if (!bilinear) {
+    int cached = -1;
+
+    for (int y = y0; y < y1; y++) {
+      int sy = rows[y - y0].i0;
+
+      /* consecutive rows scaled from the same mask row are identical */
+      if (sy != cached) {
+        const uint8_t *src = mask + (size_t) sy * mask_stride;
+
+        for (int x = 0; x < n; x++) {
+          uint32_t c = src[cols[x].i0];
+
+          for (int k = 0; k < bpp; k++) {
+            color[x * bpp + k] = premul[c * bpp + k];
+            alpha[x * bpp + k] = alphas[c];
+          }
+        }
+        cached = sy;
+      }
+
+      blend_premultiplied_row (img.ptr (y) + x0 * bpp, n * bpp, color.data (),
+          alpha.data ());
+    }
+    return;
+  }
+
+  /* mask rows scaled horizontally, kept for the next rows of the plane */
+  int keys[2] = { -1, -1 };
+
+  for (int i = 0; i < 2; i++) {
+    hcolor[i].resize (n * bpp);
+    halpha[i].resize (n);
+  }
+
+  for (int y = y0; y < y1; y++) {
+    const mask_sample & r = rows[y - y0];
+    int s0 = keys[0] == r.i0 ? 0 : keys[1] == r.i0 ? 1 : -1;
+    int s1;
+
+    if (s0 < 0) {
+      s0 = keys[0] == r.i1 ? 1 : 0;
+      mask_row_horizontal (mask + (size_t) r.i0 * mask_stride, cols, bpp,
+          premul, alphas, hcolor[s0].data (), halpha[s0].data ());
+      keys[s0] = r.i0;
+    }
+
+    s1 = keys[0] == r.i1 ? 0 : keys[1] == r.i1 ? 1 : -1;
+    if (s1 < 0) {
+      s1 = 1 - s0;
+      mask_row_horizontal (mask + (size_t) r.i1 * mask_stride, cols, bpp,
+          premul, alphas, hcolor[s1].data (), halpha[s1].data ());
+      keys[s1] = r.i1;
+    }
+
+    const uint16_t *c0 = hcolor[s0].data (), *c1 = hcolor[s1].data ();
+    const uint16_t *a0 = halpha[s0].data (), *a1 = halpha[s1].data ();
+    uint32_t f = r.f;
+    uint32_t g = 256 - f;
+
+    uint8_t *dc = color.data ();
+    uint8_t *da = alpha.data ();
+
+    /* plain loops over all bytes are vectorized by the compiler */
+    for (int i = 0; i < n * bpp; i++)
+      dc[i] = (c0[i] * g + c1[i] * f + 32768) >> 16;
+
+    if (bpp == 1) {
+      for (int x = 0; x < n; x++)
+        da[x] = (a0[x] * g + a1[x] * f + 32768) >> 16;
+    } else {
+      for (int x = 0; x < n; x++) {
+        uint8_t a = (a0[x] * g + a1[x] * f + 32768) >> 16;
+
+        for (int k = 0; k < bpp; k++)
+          da[x * bpp + k] = a;
+      }
+    }
+
+    blend_premultiplied_row (img.ptr (y) + x0 * bpp, n * bpp, color.data (),
+        alpha.data ());
+  }
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <opencv2/core.hpp>
+
+/*
+ * Shapes are rasterized into horizontal spans which are filled directly in the
+ * mapped plane. Planes of 1 (Y, GRAY), 2 (interleaved UV) and 3 (RGB, BGR) bytes
+ * per pixel are supported, @value points to elemSize() bytes of the pixel value.
+ * Translucent shapes blend each byte of the covered pixels with @value.
+ */
+
+/**
+ * class vvas_raster_band - Limits drawing of the calling thread to a band of
+ *                          rows of the frame while the object exists. Shapes
+ *                          keep coordinates of the whole plane and rows
+ *                          outside of the band are skipped, so that bands
+ *                          drawn by different threads give the same pixels
+ *                          as drawing the whole plane.
+ * @prev_begin: First row of the band replaced by this one
+ * @prev_end: End row of the band replaced by this one
+ * @prev_height: Frame height of the band replaced by this one
+ */
+class vvas_raster_band
+{
+  int prev_begin;
+  int prev_end;
+  int prev_height;
+
+public:
+
+  /**
+   * vvas_raster_band() - Sets band of the calling thread
+   * @begin: First row of the band in rows of the frame
+   * @end: Row after the last row of the band in rows of the frame
+   * @height: Height of the frame, rows of planes with less rows (chroma) are
+   *          scaled from it
+   */
+  vvas_raster_band (int begin, int end, int height);
+
+  ~vvas_raster_band ();
+};
+
+/**
+ * vvas_raster_rows() - Gets rows of a plane drawn by the calling thread
+ * @img: Plane to draw on
+ * @begin: Address to store first row
+ * @end: Address to store row after the last row
+ *
+ * Return: None
+ */
+void vvas_raster_rows (const cv::Mat & img, int *begin, int *end);
+
+/**
+ * vvas_raster_rgb_to_yuv() - Converts a color to BT.601 YUV using precomputed tables,
+ *                            results are same as cvtColor (COLOR_RGB2YUV_I420)
+ * @red: Red component
+ * @green: Green component
+ * @blue: Blue component
+ * @y: Address to store luma
+ * @u: Address to store blue difference chroma
+ * @v: Address to store red difference chroma
+ *
+ * Return: None
+ */
+void vvas_raster_rgb_to_yuv (uint8_t red, uint8_t green, uint8_t blue,
+    uint8_t * y, uint8_t * u, uint8_t * v);
+
+/**
+ * vvas_raster_fill() - Fills a rectangle given by two opposite corners, like
+ *                      rectangle (img, pt1, pt2, color, FILLED)
+ * @img: Plane to draw on
+ * @pt1: Corner of the rectangle
+ * @pt2: Opposite corner of the rectangle, included in the rectangle
+ * @value: Pixel value
+ * @alpha: Opacity of @value, 255 to overwrite pixels
+ *
+ * Return: None
+ */
+void vvas_raster_fill (cv::Mat & img, cv::Point pt1, cv::Point pt2,
+    const uint8_t * value, uint8_t alpha);
+
+/**
+ * vvas_raster_rect() - Draws a rectangle, same pixels as
+ *                      rectangle (img, rect, color, thickness, 1, 0)
+ * @img: Plane to draw on
+ * @rect: Rectangle to be drawn
+ * @thickness: Thickness of the outline, filled when negative
+ * @value: Pixel value
+ * @alpha: Opacity of @value, 255 to overwrite pixels
+ *
+ * Return: None
+ */
+void vvas_raster_rect (cv::Mat & img, cv::Rect rect, int thickness,
+    const uint8_t * value, uint8_t alpha);
+
+/**
+ * vvas_raster_line() - Draws a line segment with round caps
+ * @img: Plane to draw on
+ * @pt1: First end of the segment
+ * @pt2: Second end of the segment
+ * @thickness: Thickness of the line, lines of thickness 1 or less are 4-connected
+ * @value: Pixel value
+ *
+ * Return: None
+ */
+void vvas_raster_line (cv::Mat & img, cv::Point pt1, cv::Point pt2,
+    int thickness, const uint8_t * value);
+
+/**
+ * vvas_raster_circle() - Draws a circle
+ * @img: Plane to draw on
+ * @center: Center of the circle
+ * @radius: Radius of the circle
+ * @thickness: Thickness of the outline, filled when negative
+ * @value: Pixel value
+ *
+ * Return: None
+ */
+void vvas_raster_circle (cv::Mat & img, cv::Point center, int radius,
+    int thickness, const uint8_t * value);
+
+/**
+ * vvas_raster_arrow() - Draws a line segment with an arrow tip at @pt2, tip is
+ *                       placed as in arrowedLine (img, pt1, pt2, color, thickness,
+ *                       1, 0, tip_length)
+ * @img: Plane to draw on
+ * @pt1: Start of the arrow
+ * @pt2: End of the arrow, where tip is drawn
+ * @thickness: Thickness of the lines
+ * @tip_length: Length of the tip relative to length of the arrow
+ * @value: Pixel value
+ *
+ * Return: None
+ */
+void vvas_raster_arrow (cv::Mat & img, cv::Point pt1, cv::Point pt2,
+    int thickness, double tip_length, const uint8_t * value);
+
+/**
+ * vvas_raster_polyline() - Draws line segments joining consecutive points
+ * @img: Plane to draw on
+ * @pts: Points of the polyline
+ * @npts: Number of points in @pts
+ * @closed: If set, last point is joined to first point
+ * @thickness: Thickness of the lines
+ * @value: Pixel value
+ * @alpha: Opacity of @value, 255 to overwrite pixels. Pixels shared by
+ *         several lines are blended once.
+ *
+ * Return: None
+ */
+void vvas_raster_polyline (cv::Mat & img, const cv::Point * pts, int npts,
+    bool closed, int thickness, const uint8_t * value, uint8_t alpha);
+
+/**
+ * vvas_raster_mask() - Blends a mask of class indices scaled to a rectangle
+ * @img: Plane to draw on
+ * @rect: Rectangle covered by the mask, parts outside of @img are skipped
+ * @mask: Class index of each pixel of the mask
+ * @mask_width: Width of the mask
+ * @mask_height: Height of the mask
+ * @mask_stride: Bytes between rows of the mask
+ * @values: Pixel value of each of the 256 class indices
+ * @alphas: Opacity of each of the 256 class indices, pixels of classes with
+ *          opacity 0 are left untouched
+ * @bilinear: If set, values and opacities of neighbouring mask pixels are
+ *            interpolated, otherwise nearest mask pixel is used
+ *
+ * Return: None
+ */
+void vvas_raster_mask (cv::Mat & img, cv::Rect rect, const uint8_t * mask,
+    int mask_width, int mask_height, int mask_stride, const uint8_t * values,
+    const uint8_t * alphas, bool bilinear);
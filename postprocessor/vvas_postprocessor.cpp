@@ -15,7 +15,9 @@
  * limitations under the License.
  */
 
+#include "config.h"
 #include <sys/stat.h>
+#include <math.h>
 #include <iomanip>
 #include <numeric>
 #include <google/protobuf/text_format.h>
@@ -27,6 +29,7 @@
 #include <vitis/ai/nnpp/yolov3.hpp>
 
 #include <vvas_core/vvas_postprocessor.hpp>
+#include "vvas_tensor_convert.hpp"
 
 using namespace vitis::ai;
 using namespace cv;
@@ -167,27 +170,31 @@ tensor_buffer_datatype_transform (vart::TensorBuffer * tb_from,
   size_t size_from = tensor_from->get_element_num () / from_batch_size;
   size_t size_to = tensor_to->get_element_num () / to_batch_size;
   CHECK_EQ (size_from, size_to) << "element numbers is not same";
+
+  /* conversion is chosen once, each batch is converted as a whole view */
+  bool quantize = from_data_type == xir::DataType::FLOAT &&
+      to_data_type == xir::DataType::XINT;
+  bool dequantize = from_data_type == xir::DataType::XINT &&
+      to_data_type == xir::DataType::FLOAT;
+  if (!quantize && !dequantize) {
+    LOG (FATAL) << "unsupported data type conversion: from "
+        << (int) from_data_type << " to " << (int) to_data_type;
+  }
+
   for (auto batch = 0u; batch < batch_size; ++batch) {
     dim[0] = (int) batch;
     view_from = tb_from->data (dim);
     view_to = tb_to->data (dim);
-    for (auto i = 0u; i < size_from; ++i) {
-      if (from_data_type == xir::DataType::FLOAT &&
-          to_data_type == xir::DataType::XINT) {
-        auto from_value = ((float *) view_from.first)[i];
-        auto to_value = (int8_t) (from_value * scale);
-        if (i < 3)
-          printf ("frm %f to %d scale = %f\n", from_value, to_value, scale);
-        ((int8_t *) view_to.first)[i] = to_value;
-      } else if (from_data_type == xir::DataType::XINT &&
-          to_data_type == xir::DataType::FLOAT) {
-        auto from_value = ((int8_t *) view_from.first)[i];
-        auto to_value = ((float) from_value) * scale;
-        ((float *) view_to.first)[i] = to_value;
-      } else {
-        LOG (FATAL) << "unsupported data type conversion: from "
-            << (int) from_data_type << " to " << (int) to_data_type;
-      }
+    if (quantize) {
+      CHECK_GE (view_from.second, size_from * sizeof (float));
+      CHECK_GE (view_to.second, size_from * sizeof (int8_t));
+      float_to_int8 ((const float *) view_from.first,
+          (int8_t *) view_to.first, size_from, scale);
+    } else {
+      CHECK_GE (view_from.second, size_from * sizeof (int8_t));
+      CHECK_GE (view_to.second, size_from * sizeof (float));
+      int8_to_float ((const int8_t *) view_from.first,
+          (float *) view_to.first, size_from, scale);
     }
   }
 }
@@ -450,6 +457,23 @@ postprocess_resnet_v1_50_tf (const std::vector <
   }
 }
 
+/* Models whose raw tensors can be post-processed */
+typedef enum {
+  VVAS_POSTPROCESS_MODEL_UNKNOWN,
+  VVAS_POSTPROCESS_MODEL_PLATENUM,
+  VVAS_POSTPROCESS_MODEL_RESNET_V1_50_TF,
+  VVAS_POSTPROCESS_MODEL_YOLOV3,
+  VVAS_POSTPROCESS_MODEL_DENSEBOX,
+} VvasPostProcessModel;
+
+/* XINT copy of an output tensor, reused for all frames with same tensor */
+typedef struct {
+  std::string name;
+  std::vector < std::int32_t > shape;
+  std::unique_ptr < xir::Tensor > tensor;
+  std::unique_ptr < vart::TensorBuffer > buffer;
+} VvasPostProcessOutput;
+
 typedef struct {
   std::string modelpath;
   std::string modelname;
@@ -458,9 +482,143 @@ typedef struct {
   std::vector <std::string> labels;
   std::unique_ptr <xir::Attrs> default_attrs_;
   VvasLogLevel log_level;
-  int32_t fixpoint_node_flip;
+  /* prototxt is parsed on first use and kept */
+  std::unique_ptr <vitis::ai::proto::DpuModelParam> config;
+  bool config_missing;
+  /* model of the last prediction, model name is resolved only when it changes */
+  std::string dispatch_name;
+  VvasPostProcessModel dispatch_model;
+  /* tensors given to the post-processing of Vitis AI library, built for
+   * the model, format and size of the image they were last used with */
+  VvasPostProcessModel tensor_model;
+  unsigned long int tensor_fmt;
+  unsigned long int tensor_width;
+  unsigned long int tensor_height;
+  std::vector <VvasPostProcessOutput> outputs;
+  std::vector <std::vector <vitis::ai::library::InputTensor>> input_tensors;
+  std::vector <std::vector <vitis::ai::library::OutputTensor>> output_tensors;
 } VvasPostProcessPriv;
 
+static VvasPostProcessModel
+get_model (const char *model_name)
+{
+  if (!strcmp (model_name, "plate_num"))
+    return VVAS_POSTPROCESS_MODEL_PLATENUM;
+  if (!strcmp (model_name, "resnet_v1_50_tf"))
+    return VVAS_POSTPROCESS_MODEL_RESNET_V1_50_TF;
+  if (!strcmp (model_name, "yolov3_voc_tf") || !strcmp (model_name, "yolov3_voc"))
+    return VVAS_POSTPROCESS_MODEL_YOLOV3;
+  if (!strcmp (model_name, "densebox_320_320"))
+    return VVAS_POSTPROCESS_MODEL_DENSEBOX;
+
+  return VVAS_POSTPROCESS_MODEL_UNKNOWN;
+}
+
+static const vitis::ai::proto::DpuModelParam *
+load_config (VvasPostProcessPriv * kpriv)
+{
+  if (!kpriv->config && !kpriv->config_missing) {
+    if (!fileexists (kpriv->prototxt)) {
+      kpriv->config_missing = true;
+    } else {
+      kpriv->config.reset (new vitis::ai::proto::DpuModelParam (get_config
+              (kpriv->prototxt, kpriv->default_attrs_.get ())));
+    }
+  }
+
+  if (kpriv->config_missing)
+    LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level, "Prototxt file %s not found", kpriv->prototxt.c_str ());
+
+  return kpriv->config.get ();
+}
+
+/* Creates XINT copies of the output tensors and their descriptions for the
+ * post-processing, only when tensors differ from the previous frame */
+static void
+prepare_tensors (VvasPostProcessPriv * kpriv,
+    const std::vector < vart::TensorBuffer * >&outputsPtr, TensorBuf * tb,
+    VvasPostProcessModel model)
+{
+  bool same = kpriv->tensor_model == model && kpriv->tensor_fmt == tb->fmt &&
+      kpriv->tensor_width == tb->width && kpriv->tensor_height == tb->height &&
+      kpriv->outputs.size () == outputsPtr.size ();
+
+  for (auto i = 0u; same && i < outputsPtr.size (); i++) {
+    auto tensor_from = outputsPtr[i]->get_tensor ();
+
+    same = kpriv->outputs[i].name == tensor_from->get_name () &&
+        kpriv->outputs[i].shape == tensor_from->get_shape ();
+  }
+
+  if (same)
+    return;
+
+  kpriv->tensor_model = model;
+  kpriv->tensor_fmt = tb->fmt;
+  kpriv->tensor_width = tb->width;
+  kpriv->tensor_height = tb->height;
+  kpriv->outputs.clear ();
+  kpriv->input_tensors.clear ();
+  kpriv->output_tensors.clear ();
+
+  /* create new input TensorBuffer */
+  auto input_tb = std::vector < vitis::ai::library::InputTensor > { };
+  auto ret1 = vitis::ai::library::InputTensor { };
+  ret1.width = tb->width;
+  ret1.height = tb->height;
+  ret1.batch = 1;
+  input_tb.emplace_back (ret1);
+  kpriv->input_tensors.emplace_back (input_tb);
+
+  /* create new output TensorBuffer */
+  auto output_tb = std::vector < vitis::ai::library::OutputTensor > { };
+  output_tb.reserve (outputsPtr.size ());
+  kpriv->outputs.resize (outputsPtr.size ());
+  for (auto i = 0u; i < outputsPtr.size (); i++) {
+    VvasPostProcessOutput & out = kpriv->outputs[i];
+    auto tensor_from = outputsPtr[i]->get_tensor ();
+
+    out.name = tensor_from->get_name ();
+    out.shape = tensor_from->get_shape ();
+    out.tensor = xir::Tensor::create (tensor_from->get_name (),
+        tensor_from->get_shape (), { xir::DataType::XINT, 8 });
+    out.tensor->set_attrs (tensor_from->get_attrs ());
+    if (model == VVAS_POSTPROCESS_MODEL_YOLOV3) {
+      out.tensor->set_attr < int >("fix_point", (int) 2);
+    } else {
+      /* densebox outputs alternate between fix point 0 and 4 */
+      out.tensor->set_attr < int >("fix_point", (int) (i % 2 ? 4 : 0));
+    }
+
+    out.buffer = vart::alloc_cpu_flat_tensor_buffer (out.tensor.get ());
+    auto tensor = out.buffer->get_tensor ();
+    int height;
+    int width;
+    int channel;
+    auto dim_num = tensor->get_shape ().size ();
+    auto batch = dim_num <= 0 ? 1 : tensor->get_shape ().at (0);
+    const char *datatype =
+        tensor->get_data_type ().type ==
+        xir::DataType::XINT ? "XINT" : "FLOAT";
+    height = dim_num <= 1 ? 1 : tensor->get_shape ().at (1);
+    width = dim_num <= 2 ? 1 : tensor->get_shape ().at (2);
+    channel = dim_num <= 3 ? 1 : tensor->get_shape ().at (3);
+
+    if (LOG_LEVEL_INFO < kpriv->log_level) {
+      printf ("%d\t\t %s\t\t %d\t\t \t%d \t%d \t%d \t%d \t%d \t%s\n", 0,
+          (tensor->get_name ()).c_str (),
+          tensor->get_element_num (),
+          tensor->get_data_size (), batch, width, height, channel, datatype);
+    }
+
+    /* data of the buffer stays at same address, so descriptions are kept */
+    output_tb.emplace_back (convert_tensor_buffer_to_output_tensor
+        (out.buffer.get (), (vart::Runner::TensorFormat) tb->fmt,
+        get_fix_point (out.tensor.get ())));
+  }
+  kpriv->output_tensors.emplace_back (output_tb);
+}
+
 static bool readlabels (VvasPostProcessPriv *kpriv, char *json_file)
 {
   json_t *root = NULL, *karray, *label, *value;
@@ -576,7 +734,12 @@ VvasPostProcessor * vvas_postprocess_create (VvasPostProcessConf * postproc_conf
   kpriv->modelname = postproc_conf->model_name;
   kpriv->modelpath = postproc_conf->model_path;
   kpriv->log_level = log_level;
-  kpriv->fixpoint_node_flip = 0;
+  kpriv->config_missing = false;
+  kpriv->dispatch_model = VVAS_POSTPROCESS_MODEL_UNKNOWN;
+  kpriv->tensor_model = VVAS_POSTPROCESS_MODEL_UNKNOWN;
+  kpriv->tensor_fmt = 0;
+  kpriv->tensor_width = 0;
+  kpriv->tensor_height = 0;
 
   if (!fileexists (kpriv->modelpath)) {
     LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
@@ -587,7 +750,7 @@ VvasPostProcessor * vvas_postprocess_create (VvasPostProcessConf * postproc_conf
   kpriv->xmodel_name = kpriv->modelpath + "/" + kpriv->modelname + "/" + kpriv->modelname + ".xmodel";
   kpriv->prototxt = kpriv->modelpath + "/" + kpriv->modelname + "/" + kpriv->modelname + ".prototxt";
 
-  if (!(strcmp (postproc_conf->model_name, "yolov3_voc_tf")) || !(strcmp (postproc_conf->model_name, "yolov3_voc"))) {
+  if (get_model (postproc_conf->model_name) == VVAS_POSTPROCESS_MODEL_YOLOV3) {
     std::string label_file = kpriv->modelpath + "/" + kpriv->modelname + "/" + "label.json";
     if (!fileexists (label_file)) {
       LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
@@ -664,100 +827,33 @@ VvasInferPrediction* vvas_postprocess_tensor (VvasPostProcessor *postproc_handle
     outputsPtr.push_back ((vart::TensorBuffer *) tb->ptr[i]);
   }
 
-  if (!strcmp (src->model_name, "plate_num")) {
+  if (kpriv->dispatch_name != src->model_name) {
+    kpriv->dispatch_name = src->model_name;
+    kpriv->dispatch_model = get_model (src->model_name);
+  }
+
+  if (kpriv->dispatch_model == VVAS_POSTPROCESS_MODEL_PLATENUM) {
     postprocess_platenum (outputsPtr, &parent_predict, kpriv->log_level, src->model_name);
-  } else if (!strcmp (src->model_name, "resnet_v1_50_tf")) {
+  } else if (kpriv->dispatch_model == VVAS_POSTPROCESS_MODEL_RESNET_V1_50_TF) {
     postprocess_resnet_v1_50_tf (outputsPtr, &parent_predict, kpriv->log_level, src->model_name);
-  } else if (!strcmp (src->model_name, "yolov3_voc_tf") ||
-             !strcmp (src->model_name, "yolov3_voc") ||
-	     !strcmp (src->model_name, "densebox_320_320")) {
+  } else if (kpriv->dispatch_model == VVAS_POSTPROCESS_MODEL_YOLOV3 ||
+             kpriv->dispatch_model == VVAS_POSTPROCESS_MODEL_DENSEBOX) {
 
-    if (!fileexists (kpriv->prototxt)) {
-      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level, "Prototxt file %s not found", kpriv->prototxt.c_str ());
+    const vitis::ai::proto::DpuModelParam *config_ptr = load_config (kpriv);
+    if (!config_ptr)
       return parent_predict;
-    }
-    const vitis::ai::proto::DpuModelParam & config =
-        get_config (kpriv->prototxt, kpriv->default_attrs_.get ());
+    const vitis::ai::proto::DpuModelParam & config = *config_ptr;
     auto det_threshold_ = config.dense_box_param ().det_threshold ();
 
-    /* create new input TensorBuffer */
-    auto input_tensors =
-        std::vector < std::vector < vitis::ai::library::InputTensor >> ();
-    input_tensors.reserve (1);
-    /* Get the current format */
-    auto input_tb = std::vector < vitis::ai::library::InputTensor > { };
-    input_tb.reserve (1);
-    for (int i = 0; i < 1; i++) {
-      auto ret1 = vitis::ai::library::InputTensor { };
-      ret1.width = tb->width;
-      ret1.height = tb->height;
-      ret1.batch = 1;
-      input_tb.emplace_back (ret1);
-    }
-    input_tensors.emplace_back (input_tb);
-
-    /* create new output TensorBuffer */
-    std::vector < std::unique_ptr < vart::TensorBuffer >> xint_tensor_buffers;
-    auto output_tensors =
-        std::vector < std::vector < vitis::ai::library::OutputTensor >> ();
-    output_tensors.reserve (1);
-    /* Get the current format */
-    auto output_tb = std::vector < vitis::ai::library::OutputTensor > { };
-    output_tb.reserve (outputsPtr.size ());
-    int i = 0;
-    for (auto & t:outputsPtr) {
-      auto tensor_from = t->get_tensor ();
-      auto new_tensor_ = xir::Tensor::create (tensor_from->get_name (),
-          tensor_from->get_shape (), { xir::DataType::XINT, 8 });
-
-      new_tensor_->set_attrs (tensor_from->get_attrs ());
-      if (!strcmp (src->model_name, "yolov3_voc_tf") || !strcmp (src->model_name, "yolov3_voc")) {
-        new_tensor_->set_attr < int >("fix_point", (int) 2);
-      } else if (!strcmp (src->model_name, "densebox_320_320")) {
-        if (kpriv->fixpoint_node_flip == 0) {
-          new_tensor_->set_attr < int >("fix_point", (int) 0);
-          kpriv->fixpoint_node_flip = 1;
-        } else {
-          new_tensor_->set_attr < int >("fix_point", (int) 4);
-          kpriv->fixpoint_node_flip = 0;
-        }
-      } else {
-	LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level, "Unsupported model");
-        return parent_predict;
-      }
-
-      xint_tensor_buffers.emplace_back (vart::
-          alloc_cpu_flat_tensor_buffer (new_tensor_.get ()));
-      vart::TensorBuffer::copy_tensor_buffer (t, xint_tensor_buffers[i].get ());
-      auto tensor = xint_tensor_buffers[i]->get_tensor ();
-      int height;
-      int width;
-      int channel;
-      auto dim_num = tensor->get_shape ().size ();
-      auto batch = dim_num <= 0 ? 1 : tensor->get_shape ().at (0);
-      const char *datatype =
-          tensor->get_data_type ().type ==
-          xir::DataType::XINT ? "XINT" : "FLOAT";
-      height = dim_num <= 1 ? 1 : tensor->get_shape ().at (1);
-      width = dim_num <= 2 ? 1 : tensor->get_shape ().at (2);
-      channel = dim_num <= 3 ? 1 : tensor->get_shape ().at (3);
-
-      if (LOG_LEVEL_INFO < kpriv->log_level) {
-        printf ("%d\t\t %s\t\t %d\t\t \t%d \t%d \t%d \t%d \t%d \t%s\n", 0,
-            (tensor->get_name ()).c_str (),
-            tensor->get_element_num (),
-            tensor->get_data_size (), batch, width, height, channel, datatype);
-      }
-
-        output_tb.emplace_back (convert_tensor_buffer_to_output_tensor
-            (xint_tensor_buffers[i].get (), (vart::Runner::TensorFormat) tb->fmt,
-            get_fix_point (new_tensor_.get ())));
-        i++;
-    }
+    prepare_tensors (kpriv, outputsPtr, tb, kpriv->dispatch_model);
+    for (auto i = 0u; i < outputsPtr.size (); i++)
+      vart::TensorBuffer::copy_tensor_buffer (outputsPtr[i],
+          kpriv->outputs[i].buffer.get ());
 
-    output_tensors.emplace_back (output_tb);
+    auto & input_tensors = kpriv->input_tensors;
+    auto & output_tensors = kpriv->output_tensors;
 
-    if (!(strcmp (src->model_name, "yolov3_voc_tf")) || !(strcmp (src->model_name, "yolov3_voc"))) {
+    if (kpriv->dispatch_model == VVAS_POSTPROCESS_MODEL_YOLOV3) {
       auto results =
           vitis::ai::yolov3_post_process (input_tensors[0], output_tensors[0],
           config, tb->width, tb->height);
@@ -804,7 +900,7 @@ VvasInferPrediction* vvas_postprocess_tensor (VvasPostProcessor *postproc_handle
             label, xmin, ymin, xmax, ymax, confidence);
       }
       LOG_MESSAGE (LOG_LEVEL_INFO, kpriv->log_level, "\n");
-    } else if (!strcmp (src->model_name, "densebox_320_320")) {
+    } else {
       auto results =
           vitis::ai::face_detect_post_process (input_tensors, output_tensors,
           config, det_threshold_);
@@ -848,9 +944,6 @@ VvasInferPrediction* vvas_postprocess_tensor (VvasPostProcessor *postproc_handle
               "RESULT: %f %f %f %f (%f)", xmin, ymin, xmax, ymax, confidence);
         }
       }
-    } else {
-      LOG_MESSAGE (LOG_LEVEL_ERROR, kpriv->log_level,
-          "unsupported postprocessing for mode %s", src->model_name);
     }
   }
 
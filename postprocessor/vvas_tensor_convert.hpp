@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Conversion of tensor data between float and int8. Platform macros of
+ * config.h select the SIMD path, so config.h must be included first. */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+#include <algorithm>
+
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * float_to_int8() - Requantizes floats to int8, values are rounded to nearest
+ *                   even and saturated. NaN gives 0 on all platforms
+ * @src: Floats to be converted
+ * @dst: Converted values
+ * @n: Number of values
+ * @scale: Factor applied to @src before rounding
+ *
+ * Blocks of 16 values are converted with SIMD instructions when available,
+ * remaining values with the scalar loop. Both give the same values.
+ */
+static inline void
+float_to_int8 (const float *src, int8_t * dst, size_t n, float scale)
+{
+  size_t i = 0;
+
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+  float32x4_t s = vdupq_n_f32 (scale);
+
+  /* vcvtnq rounds to nearest even, saturates and converts NaN to 0 */
+  for (; i + 16 <= n; i += 16) {
+    int32x4_t a = vcvtnq_s32_f32 (vmulq_f32 (vld1q_f32 (src + i), s));
+    int32x4_t b = vcvtnq_s32_f32 (vmulq_f32 (vld1q_f32 (src + i + 4), s));
+    int32x4_t c = vcvtnq_s32_f32 (vmulq_f32 (vld1q_f32 (src + i + 8), s));
+    int32x4_t d = vcvtnq_s32_f32 (vmulq_f32 (vld1q_f32 (src + i + 12), s));
+    int16x8_t lo = vcombine_s16 (vqmovn_s32 (a), vqmovn_s32 (b));
+    int16x8_t hi = vcombine_s16 (vqmovn_s32 (c), vqmovn_s32 (d));
+
+    vst1q_s8 (dst + i, vcombine_s8 (vqmovn_s16 (lo), vqmovn_s16 (hi)));
+  }
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+  __m128 s = _mm_set1_ps (scale);
+  __m128 lo = _mm_set1_ps (-128.f);
+  __m128 hi = _mm_set1_ps (127.f);
+
+  /* cvtps rounds to nearest even in default rounding mode, values are
+   * clamped first as out of range values convert to INT_MIN */
+  for (; i + 16 <= n; i += 16) {
+    __m128i v[4];
+
+    for (int k = 0; k < 4; k++) {
+      __m128 x = _mm_mul_ps (_mm_loadu_ps (src + i + 4 * k), s);
+
+      x = _mm_and_ps (x, _mm_cmpord_ps (x, x));
+      v[k] = _mm_cvtps_epi32 (_mm_min_ps (_mm_max_ps (x, lo), hi));
+    }
+    _mm_storeu_si128 ((__m128i *) (dst + i),
+        _mm_packs_epi16 (_mm_packs_epi32 (v[0], v[1]),
+            _mm_packs_epi32 (v[2], v[3])));
+  }
+#endif
+
+  for (; i < n; i++) {
+    float x = src[i] * scale;
+
+    if (x != x)
+      x = 0.f;
+    x = std::min (std::max (x, -128.f), 127.f);
+    dst[i] = (int8_t) lrintf (x);
+  }
+}
+
+/**
+ * int8_to_float() - Dequantizes int8 to floats
+ * @src: Values to be converted
+ * @dst: Converted floats
+ * @n: Number of values
+ * @scale: Factor applied to converted values
+ *
+ * Blocks of 16 values are converted with SIMD instructions when available,
+ * remaining values with the scalar loop. Both give the same floats.
+ */
+static inline void
+int8_to_float (const int8_t * src, float *dst, size_t n, float scale)
+{
+  size_t i = 0;
+
+#if defined(XLNX_EMBEDDED_PLATFORM) && defined(__aarch64__)
+  float32x4_t s = vdupq_n_f32 (scale);
+
+  for (; i + 16 <= n; i += 16) {
+    int8x16_t v = vld1q_s8 (src + i);
+    int16x8_t lo = vmovl_s8 (vget_low_s8 (v));
+    int16x8_t hi = vmovl_s8 (vget_high_s8 (v));
+
+    vst1q_f32 (dst + i,
+        vmulq_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_low_s16 (lo))), s));
+    vst1q_f32 (dst + i + 4,
+        vmulq_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_high_s16 (lo))), s));
+    vst1q_f32 (dst + i + 8,
+        vmulq_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_low_s16 (hi))), s));
+    vst1q_f32 (dst + i + 12,
+        vmulq_f32 (vcvtq_f32_s32 (vmovl_s16 (vget_high_s16 (hi))), s));
+  }
+#elif defined(XLNX_PCIe_PLATFORM) && defined(__SSE2__)
+  __m128 s = _mm_set1_ps (scale);
+
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128 ((const __m128i *) (src + i));
+    /* sign extension by unpacking into the high bytes and shifting back */
+    __m128i lo = _mm_srai_epi16 (_mm_unpacklo_epi8 (v, v), 8);
+    __m128i hi = _mm_srai_epi16 (_mm_unpackhi_epi8 (v, v), 8);
+
+    _mm_storeu_ps (dst + i, _mm_mul_ps (_mm_cvtepi32_ps (_mm_srai_epi32
+                (_mm_unpacklo_epi16 (lo, lo), 16)), s));
+    _mm_storeu_ps (dst + i + 4, _mm_mul_ps (_mm_cvtepi32_ps (_mm_srai_epi32
+                (_mm_unpackhi_epi16 (lo, lo), 16)), s));
+    _mm_storeu_ps (dst + i + 8, _mm_mul_ps (_mm_cvtepi32_ps (_mm_srai_epi32
+                (_mm_unpacklo_epi16 (hi, hi), 16)), s));
+    _mm_storeu_ps (dst + i + 12, _mm_mul_ps (_mm_cvtepi32_ps (_mm_srai_epi32
+                (_mm_unpackhi_epi16 (hi, hi), 16)), s));
+  }
+#endif
+
+  for (; i < n; i++)
+    dst[i] = ((float) src[i]) * scale;
+}
@@ -127,6 +127,8 @@ typedef struct
   VvasDpuInfer *resnet18_car_color_handle;
   /** Metaconvert handle */
   VvasMetaConvert *mc_handle;
+  /** Overlay shapes, reused for every frame */
+  VvasOverlayShapeBatch shape_batch;
   /** Scaler output frame produced by sc_ctx handle */
     vector < VvasVideoFrame * >scaler_outframes;
   VvasAppCropFrameHandle crop_handle;
@@ -225,66 +227,25 @@ get_num_planes (VvasVideoFormat fmt)
 }
 
 static void
-free_overlay_text_params (void *data)
-{
-  VvasOverlayTextParams *text_params = (VvasOverlayTextParams *) data;
-  free (text_params->disp_text);
-  free (text_params);
-}
-
-static void
-compute_factors (VvasVideoInfo * from, VvasVideoInfo * to, double *hfactor,
-    double *vfactor)
+prediction_scale_ip (VvasInferPrediction * self, PredictionScaleData * sdata)
 {
+  VvasBBoxTransform xform;
 
-  if (!to || !from || !hfactor || !vfactor) {
+  if (!self || !sdata)
     return;
-  }
 
-  if (!from->width || !from->height) {
+  if (!sdata->from->width || !sdata->from->height) {
     LOG_MESSAGE (LOG_LEVEL_ERROR, gloglevel,
         "Wrong width and height paramters");
     return;
   }
 
-  *hfactor = to->width * 1.0 / from->width;
-  *vfactor = to->height * 1.0 / from->height;
-}
-
-static void
-prediction_scale_ip (VvasInferPrediction * self, VvasVideoInfo * to,
-    VvasVideoInfo * from)
-{
-  double hfactor = 0.0, vfactor = 0.0;
-
-  if (!self || !to || !from)
-    return;
-
-  compute_factors (from, to, &hfactor, &vfactor);
-
-  LOG_MESSAGE (LOG_LEVEL_DEBUG, gloglevel,
-      "source bbox : x = %d, y = %d, width = %d, height = %d",
-      self->bbox.x, self->bbox.y, self->bbox.width, self->bbox.height);
+  vvas_bbox_transform_set_scale (&xform, sdata->from->width,
+      sdata->from->height, sdata->to->width, sdata->to->height);
+  xform.round_position = true;
 
-  self->bbox.x = nearbyintf (self->bbox.x * hfactor);
-  self->bbox.y = nearbyintf (self->bbox.y * vfactor);
-  self->bbox.width = nearbyintf (self->bbox.width * hfactor);
-  self->bbox.height = nearbyintf (self->bbox.height * vfactor);
-
-  LOG_MESSAGE (LOG_LEVEL_DEBUG, gloglevel,
-      "destination bbox : x = %d, y = %d, width = %d, height = %d",
-      self->bbox.x, self->bbox.y, self->bbox.width, self->bbox.height);
-}
-
-static int
-node_scale_ip (VvasTreeNode * node, void *data)
-{
-  VvasInferPrediction *self = (VvasInferPrediction *) node->data;
-  PredictionScaleData *sdata = (PredictionScaleData *) data;
-
-  prediction_scale_ip (self, sdata->to, sdata->from);
-
-  return 0;
+  /* scale bounding boxes of all nodes in one batch */
+  vvas_inferprediction_transform (self, &xform);
 }
 
 static int
@@ -388,6 +349,12 @@ reset_dpuinfer_conf (VvasDpuInferConf * dpu_conf)
   dpu_conf->float_feature = true;
   dpu_conf->segoutfmt = VVAS_VIDEO_FORMAT_UNKNOWN;
   dpu_conf->segoutfactor = 1;
+  dpu_conf->segoutrle = false;
+  dpu_conf->batch_timeout_us = 0;
+  dpu_conf->num_inflight_batches = 1;
+  dpu_conf->mosaic_max_tiles = 0;
+  dpu_conf->mosaic_guard = 0;
+  dpu_conf->share_model = false;
 }
 
 static void
@@ -547,6 +514,13 @@ parse_dpu_json (char *json_file, VvasDpuInferConf * dpu_conf, int gloglevel)
         dpu_conf->segoutfactor);
   }
 
+  value = json_object_get (kconfig, "segoutrle");
+  if (json_is_boolean (value)) {
+    dpu_conf->segoutrle = json_boolean_value (value);
+    LOG_MESSAGE (LOG_LEVEL_DEBUG, gloglevel, "Setting segoutrle as %d",
+        dpu_conf->segoutrle);
+  }
+
   value = json_object_get (kconfig, "float-feature");
   if (json_is_boolean (value)) {
     dpu_conf->float_feature = json_boolean_value (value);
@@ -1147,6 +1121,7 @@ vvas_app_destroy_module_contexts (VvasAppHandle * app_handle)
 
   if (app_handle->mc_handle)
     vvas_metaconvert_destroy (app_handle->mc_handle);
+  vvas_overlay_shape_batch_free (&app_handle->shape_batch);
   if (app_handle->vvas_gctx)
     vvas_context_destroy (app_handle->vvas_gctx);
 }
@@ -1543,8 +1518,7 @@ main (int argc, char *argv[])
       /* need more data to decode */
       LOG_MESSAGE (LOG_LEVEL_DEBUG, gloglevel, "decoder need more input data");
     } else if (vret == VVAS_RET_SUCCESS) {
-      VvasOverlayFrameInfo overlay;
-      VvasOverlayShapeInfo shape_info;
+      VvasOverlayFrameInfo overlay = { 0, };
       VvasVideoFrame *yolov3_dpu_inputs[MAX_NUM_OBJECT] = { 0, };
       VvasInferPrediction *yolov3_pred[MAX_NUM_OBJECT] = { 0, };
 
@@ -1599,8 +1573,7 @@ main (int argc, char *argv[])
           vvas_video_frame_get_videoinfo (cur_dec_outframe, to_vinfo);
 
           /* scale metadata to original buffer (i.e. decoder output buffer) */
-          vvas_treenode_traverse (cur_yolov3_pred->node, IN_ORDER, TRAVERSE_ALL,
-              -1, (vvas_treenode_traverse_func) node_scale_ip, &data);
+          prediction_scale_ip (cur_yolov3_pred, &data);
 
           app_handle.crop_handle.src_vframe = cur_dec_outframe;
 
@@ -1723,11 +1696,13 @@ main (int argc, char *argv[])
             app_handle.crop_handle.proc_oframes = NULL;
           }
 
-          memset (&shape_info, 0x0, sizeof (VvasOverlayShapeInfo));
+          vvas_overlay_shape_batch_reset (&app_handle.shape_batch);
 
-          /* convert VvasInferPrediction tree to overlay metadata */
-          vret = vvas_metaconvert_prepare_overlay_metadata (app_handle.mc_handle,
-              cur_yolov3_pred->node, &shape_info);
+          /* convert VvasInferPrediction tree to overlay metadata, objects
+           * unchanged since previous frame reuse their shapes */
+          vret = vvas_metaconvert_prepare_overlay_batch_incremental (
+              app_handle.mc_handle, cur_yolov3_pred->node,
+              &app_handle.shape_batch, NULL);
           if (VVAS_IS_ERROR(vret)) {
             LOG_MESSAGE (LOG_LEVEL_ERROR, gloglevel,
                 "failed to convert inference metadata to overlay metadata");
@@ -1736,14 +1711,9 @@ main (int argc, char *argv[])
 
           vvas_inferprediction_free (cur_yolov3_pred);
 
-          overlay.shape_info = shape_info;
           overlay.frame_info = cur_dec_outframe;
 
-          vvas_overlay_process_frame (&overlay);
-
-          vvas_list_free_full (shape_info.rect_params, free);
-          vvas_list_free_full (shape_info.text_params,
-              free_overlay_text_params);
+          vvas_overlay_process_frame_batch (&overlay, &app_handle.shape_batch);
         }
 
         if (outfp) {
@@ -893,6 +893,12 @@ reset_dpuinfer_conf (VvasDpuInferConf * dpu_conf)
   dpu_conf->float_feature = true;
   dpu_conf->segoutfmt = VVAS_VIDEO_FORMAT_UNKNOWN;
   dpu_conf->segoutfactor = 1;
+  dpu_conf->segoutrle = false;
+  dpu_conf->batch_timeout_us = 0;
+  dpu_conf->num_inflight_batches = 1;
+  dpu_conf->mosaic_max_tiles = 0;
+  dpu_conf->mosaic_guard = 0;
+  dpu_conf->share_model = false;
 }
 
 /**
@@ -1057,6 +1063,12 @@ parse_dpu_json (char *json_file, VvasDpuInferConf * dpu_conf, int gloglevel)
     VVAS_APP_DEBUG_LOG ("Setting segoutfactor as %d", dpu_conf->segoutfactor);
   }
 
+  value = json_object_get (kconfig, "segoutrle");
+  if (json_is_boolean (value)) {
+    dpu_conf->segoutrle = json_boolean_value (value);
+    VVAS_APP_DEBUG_LOG ("Setting segoutrle as %d", dpu_conf->segoutrle);
+  }
+
   value = json_object_get (kconfig, "float-feature");
   if (json_is_boolean (value)) {
     dpu_conf->float_feature = json_boolean_value (value);
@@ -1534,77 +1546,34 @@ vvas_app_configure_decoder (VvasContext * vvas_ctx,
   return VVAS_RET_SUCCESS;
 }
 
-static void
-compute_factors (VvasVideoInfo * from, VvasVideoInfo * to, double *hfactor,
-    double *vfactor)
-{
-  if (!to || !from || !hfactor || !vfactor) {
-    return;
-  }
-
-  if (!from->width || !from->height) {
-    VVAS_APP_ERROR_LOG ("Wrong width and height paramters");
-    return;
-  }
-
-  *hfactor = to->width * 1.0 / from->width;
-  *vfactor = to->height * 1.0 / from->height;
-}
-
 /**
- *  prediction_scale_ip() - Scale VvasInferPrediction
+ *  prediction_scale_ip() - Scale VvasInferPrediction tree
  *
  *  @self: Inference prediction data
- *  @to: VideoInfo from which inference data need to be scaled
- *  @from: VideoInfo to which inference data need to be scaled
+ *  @sdata: VideoInfo from and to which inference data need to be scaled
  *
  *  Return: None
  *
  */
 static void
-prediction_scale_ip (VvasInferPrediction * self, VvasVideoInfo * to,
-    VvasVideoInfo * from)
+prediction_scale_ip (VvasInferPrediction * self, PredictionScaleData * sdata)
 {
-  double hfactor = 0.0, vfactor = 0.0;
+  VvasBBoxTransform xform;
 
-  if (!self || !to || !from)
+  if (!self || !sdata)
     return;
 
-  compute_factors (from, to, &hfactor, &vfactor);
-
-  self->bbox.x = nearbyintf (self->bbox.x * hfactor);
-  self->bbox.y = nearbyintf (self->bbox.y * vfactor);
-  self->bbox.width = nearbyintf (self->bbox.width * hfactor);
-  self->bbox.height = nearbyintf (self->bbox.height * vfactor);
-}
-
-static int
-node_scale_ip (VvasTreeNode * node, void *data)
-{
-  VvasInferPrediction *self = (VvasInferPrediction *) node->data;
-  PredictionScaleData *sdata = (PredictionScaleData *) data;
-
-  prediction_scale_ip (self, &sdata->to, &sdata->from);
-
-  return 0;
-}
-
-static void
-free_overlay_text_params (void *data)
-{
-  VvasOverlayTextParams *text_params = (VvasOverlayTextParams *) data;
-
-  if (!text_params) {
+  if (!sdata->from.width || !sdata->from.height) {
+    VVAS_APP_ERROR_LOG ("Wrong width and height paramters");
     return;
   }
 
-  if (text_params->disp_text) {
-    free (text_params->disp_text);
-  }
+  vvas_bbox_transform_set_scale (&xform, sdata->from.width,
+      sdata->from.height, sdata->to.width, sdata->to.height);
+  xform.round_position = true;
 
-  if (text_params) {
-    free (text_params);
-  }
+  /* scale bounding boxes of all nodes in one batch */
+  vvas_inferprediction_transform (self, &xform);
 }
 
 /**
@@ -2008,9 +1977,13 @@ vvas_overlay_thread (void *args)
   VvasContext *vvas_ctx = NULL;
   VvasPipelineBuffer *pipeline_buf = NULL;
   VvasMetaConvert *metaconvert_ctx = NULL;
+  VvasOverlayShapeBatch shape_batch;
   uint8_t instance_num = overlay_thread_data->instance_id;
   bool is_error = false;
 
+  /* shapes of every frame are prepared in the same batch */
+  vvas_overlay_shape_batch_init (&shape_batch);
+
   vvas_ctx = vvas_app_create_vvas_context (pipeline_ctx, NULL);
   if (!vvas_ctx) {
     VVAS_APP_ERROR_LOG ("Failed to create VVAS Context");
@@ -2045,15 +2018,15 @@ vvas_overlay_thread (void *args)
         pipeline_buf->main_buffer->user_data;
 
     if (cur_yolov3_pred) {
-      VvasOverlayFrameInfo overlay;
-      VvasOverlayShapeInfo shape_info;
+      VvasOverlayFrameInfo overlay = { 0, };
       VvasReturnType vret = VVAS_RET_SUCCESS;
 
-      memset (&shape_info, 0x0, sizeof (VvasOverlayShapeInfo));
+      vvas_overlay_shape_batch_reset (&shape_batch);
 
-      /* convert VvasInferPrediction tree to overlay metadata */
-      vret = vvas_metaconvert_prepare_overlay_metadata (metaconvert_ctx,
-          cur_yolov3_pred->node, &shape_info);
+      /* convert VvasInferPrediction tree to overlay metadata, objects
+       * unchanged since previous frame reuse their shapes */
+      vret = vvas_metaconvert_prepare_overlay_batch_incremental
+          (metaconvert_ctx, cur_yolov3_pred->node, &shape_batch, NULL);
       if (VVAS_IS_ERROR (vret)) {
         VVAS_APP_ERROR_LOG
             ("failed to convert inference metadata to overlay metadata");
@@ -2064,18 +2037,14 @@ vvas_overlay_thread (void *args)
       vvas_inferprediction_free (cur_yolov3_pred);
       pipeline_buf->main_buffer->user_data = NULL;
 
-      overlay.shape_info = shape_info;
       overlay.frame_info = pipeline_buf->main_buffer->video_frame;
 
-      vret = vvas_overlay_process_frame (&overlay);
+      vret = vvas_overlay_process_frame_batch (&overlay, &shape_batch);
       if (VVAS_IS_ERROR (vret)) {
         VVAS_APP_ERROR_LOG ("Failed to draw, %d", vret);
         is_error = true;
       }
 
-      vvas_list_free_full (shape_info.rect_params, free);
-      vvas_list_free_full (shape_info.text_params, free_overlay_text_params);
-
       if (is_error) {
         break;
       }
@@ -2122,6 +2091,8 @@ error:
     vvas_metaconvert_destroy (metaconvert_ctx);
   }
 
+  vvas_overlay_shape_batch_free (&shape_batch);
+
   if (vvas_ctx) {
     vvas_context_destroy (vvas_ctx);
   }
@@ -3085,9 +3056,7 @@ vvas_yolov3_thread (void *args)
           vvas_video_frame_get_videoinfo (main_buffer, &data.to);
 
           /* scale metadata to original buffer (i.e. decoder output buffer) */
-          vvas_treenode_traverse (yolov3_pred[idx]->node, IN_ORDER,
-              TRAVERSE_ALL, -1, (vvas_treenode_traverse_func) node_scale_ip,
-              &data);
+          prediction_scale_ip (yolov3_pred[idx], &data);
 
           /* Store scaled metadata into main buffer's user_data */
           buf->main_buffer->user_data = yolov3_pred[idx];
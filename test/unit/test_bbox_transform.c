@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks vvas_bbox_transform_apply () gives the same boxes whether they go
+ * through the SIMD loop, which handles boxes in pairs, or the scalar loop,
+ * which handles a lone box.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vvas_core/vvas_infer_prediction.h>
+
+#define NUM_BOXES 67
+
+static const double factors[] = { 1.0, 0.5, 1.5, 3.0 / 7.0, -2.5, 1e9, -1e9,
+  NAN, INFINITY
+};
+
+static const double offsets[] = { 0.0, 0.5, -10.5, 2.5, 1e12, -1e12 };
+
+static const int32_t positions[] = { 0, 1, -1, 3, -3, 1919, 1920,
+  INT32_MAX, INT32_MIN
+};
+
+static const uint32_t sizes[] = { 0, 1, 2, 5, 1080, INT32_MAX, UINT32_MAX };
+
+static void
+fill_boxes (VvasBoundingBox * bbox, uint32_t num, uint32_t seed)
+{
+  uint32_t i;
+
+  memset (bbox, 0x0, num * sizeof (VvasBoundingBox));
+  for (i = 0; i < num; i++, seed = seed * 1103515245u + 12345u) {
+    bbox[i].x = positions[(seed >> 4) % (sizeof (positions) / sizeof (int32_t))];
+    bbox[i].y = positions[(seed >> 8) % (sizeof (positions) / sizeof (int32_t))];
+    bbox[i].width = sizes[(seed >> 12) % (sizeof (sizes) / sizeof (uint32_t))];
+    bbox[i].height = sizes[(seed >> 16) % (sizeof (sizes) / sizeof (uint32_t))];
+  }
+}
+
+static int
+check (const VvasBBoxTransform * xform, uint32_t num, uint32_t seed)
+{
+  VvasBoundingBox batch[NUM_BOXES], single[NUM_BOXES];
+  uint32_t i;
+  int failures = 0;
+
+  fill_boxes (batch, num, seed);
+  memcpy (single, batch, sizeof (batch));
+
+  vvas_bbox_transform_apply (batch, num, xform);
+  for (i = 0; i < num; i++) {
+    vvas_bbox_transform_apply (&single[i], 1, xform);
+  }
+
+  for (i = 0; i < num; i++) {
+    if (memcmp (&batch[i], &single[i], sizeof (VvasBoundingBox))) {
+      printf ("mismatch factor %g offset %g clip %u round %d box %u: "
+          "(%d, %d, %u, %u) != (%d, %d, %u, %u)\n", xform->hfactor,
+          xform->xoffset, xform->clip_width, xform->round_position, i,
+          batch[i].x, batch[i].y, batch[i].width, batch[i].height,
+          single[i].x, single[i].y, single[i].width, single[i].height);
+      failures++;
+    }
+  }
+  return failures;
+}
+
+int
+main (void)
+{
+  VvasBBoxTransform xform;
+  uint32_t f, o, clip, round, num, seed = 1;
+  int failures = 0;
+
+  for (f = 0; f < sizeof (factors) / sizeof (double); f++) {
+    for (o = 0; o < sizeof (offsets) / sizeof (double); o++) {
+      for (clip = 0; clip < 2; clip++) {
+        for (round = 0; round < 2; round++) {
+          memset (&xform, 0x0, sizeof (xform));
+          xform.hfactor = factors[f];
+          xform.vfactor = factors[(f + 1) % (sizeof (factors) / sizeof (double))];
+          xform.xoffset = offsets[o];
+          xform.yoffset = -offsets[o];
+          xform.clip_width = clip ? 1920 : 0;
+          xform.clip_height = clip ? 1080 : 0;
+          xform.round_position = round;
+
+          /* odd counts leave a scalar tail, more than 64 spans two batches */
+          for (num = 1; num <= NUM_BOXES; num += 6) {
+            failures += check (&xform, num, seed++);
+          }
+        }
+      }
+    }
+  }
+
+  printf ("%s: %d mismatches\n", failures ? "FAIL" : "PASS", failures);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Runs frames of several threads through vvas_dpubatch with a model that
+ * only checks what it is given. Callers use process (), submit () with poll ()
+ * and wait (), or submit () with a release callback. Checks that batches are
+ * not larger than the batch size, that requests are never split, that model
+ * runs do not overlap and keep the order frames were queued in, that requests
+ * of a caller complete in order and that every prediction goes back to the
+ * frame it was made for.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <atomic>
+#include "vvas_dpubatch.hpp"
+
+#define BATCH_SIZE 4
+#define NUM_CALLERS 4
+#define NUM_REQUESTS 100
+#define MAX_PENDING 3
+
+/* Frame given to the batcher, its prediction is the frame itself */
+typedef struct
+{
+  int caller;
+  int request;
+  int index;
+  int count;
+} Frame;
+
+typedef struct
+{
+  Frame frames[NUM_REQUESTS][BATCH_SIZE];
+  VvasVideoFrame *inputs[NUM_REQUESTS][BATCH_SIZE];
+  VvasInferPrediction *predictions[NUM_REQUESTS][BATCH_SIZE];
+  std::atomic < int > completed;
+  /* last request run, only touched by the model, runs do not overlap */
+  int last_run;
+} Caller;
+
+static std::atomic < int > failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+      printf (__VA_ARGS__); \
+      printf ("\n"); \
+      failures++; \
+    } \
+  } while (0)
+
+static Caller callers[NUM_CALLERS];
+static std::atomic < int > running;
+static std::atomic < int > partial_batches;
+
+static VvasReturnType
+run_model (VvasVideoFrame ** inputs, VvasInferPrediction ** predictions,
+    int num)
+{
+  CHECK (running++ == 0, "model runs overlap");
+  CHECK (num > 0 && num <= BATCH_SIZE, "batch of %d frames", num);
+  if (num < BATCH_SIZE)
+    partial_batches++;
+
+  for (int i = 0; i < num;) {
+    Frame *frame = (Frame *) inputs[i];
+    Caller *caller = &callers[frame->caller];
+
+    CHECK (frame->index == 0, "request %d of caller %d split",
+        frame->request, frame->caller);
+    CHECK (i + frame->count <= num, "request %d of caller %d split",
+        frame->request, frame->caller);
+    CHECK (frame->request == caller->last_run + 1,
+        "caller %d request %d run after %d", frame->caller, frame->request,
+        caller->last_run);
+    caller->last_run = frame->request;
+
+    for (int j = 0; j < frame->count && i < num; j++, i++) {
+      CHECK ((Frame *) inputs[i] == frame + j,
+          "request %d of caller %d split", frame->request, frame->caller);
+      predictions[i] = (VvasInferPrediction *) inputs[i];
+    }
+  }
+
+  std::this_thread::sleep_for (std::chrono::microseconds (100));
+  running--;
+  return VVAS_RET_SUCCESS;
+}
+
+static void
+check_done (Caller * caller, int caller_num, int request)
+{
+  for (int i = 0; i < caller->frames[request][0].count; i++) {
+    CHECK (caller->predictions[request][i] ==
+        (VvasInferPrediction *) caller->inputs[request][i],
+        "caller %d request %d frame %d got wrong prediction", caller_num,
+        request, i);
+  }
+}
+
+static void
+run_caller (vvas_dpubatch * batcher, int caller_num)
+{
+  Caller *caller = &callers[caller_num];
+  std::deque < std::pair < int, vvas_dpubatch_request * > > pending;
+
+  for (int r = 0; r < NUM_REQUESTS; r++) {
+    /* 1 to BATCH_SIZE frames, so requests often do not fill a batch */
+    int count = 1 + (r + caller_num) % BATCH_SIZE;
+    vvas_dpubatch_done done = nullptr;
+
+    for (int i = 0; i < count; i++) {
+      caller->frames[r][i] = { caller_num, r, i, count };
+      caller->inputs[r][i] = (VvasVideoFrame *) & caller->frames[r][i];
+      caller->predictions[r][i] = NULL;
+    }
+
+    if (caller_num % 3 == 0) {
+      CHECK (!VVAS_IS_ERROR (batcher->process (caller->inputs[r],
+                  caller->predictions[r], count)),
+          "caller %d request %d failed", caller_num, r);
+      CHECK (caller->completed++ == r, "caller %d request %d out of order",
+          caller_num, r);
+      check_done (caller, caller_num, r);
+      continue;
+    }
+
+    done = [caller, caller_num, r] (VvasReturnType ret) {
+      CHECK (!VVAS_IS_ERROR (ret), "caller %d request %d failed",
+          caller_num, r);
+      CHECK (caller->completed.load () == r,
+          "caller %d request %d out of order", caller_num, r);
+      check_done (caller, caller_num, r);
+      caller->completed++;
+    };
+
+    if (caller_num % 3 == 1) {
+      batcher->submit (caller->inputs[r], caller->predictions[r], count,
+          done, true);
+      continue;
+    }
+
+    pending.push_back (std::make_pair (r, batcher->submit (caller->inputs[r],
+                caller->predictions[r], count, done, false)));
+    while (pending.size () > MAX_PENDING || (!pending.empty () &&
+            batcher->poll (pending.front ().second))) {
+      CHECK (!VVAS_IS_ERROR (batcher->wait (pending.front ().second)),
+          "caller %d request %d failed", caller_num, pending.front ().first);
+      pending.pop_front ();
+    }
+  }
+
+  for (auto & req:pending)
+    CHECK (!VVAS_IS_ERROR (batcher->wait (req.second)),
+        "caller %d request %d failed", caller_num, req.first);
+}
+
+static void
+check (unsigned int num_workers, unsigned int timeout_us)
+{
+  std::vector < std::thread > threads;
+
+  for (int c = 0; c < NUM_CALLERS; c++) {
+    callers[c].completed = 0;
+    callers[c].last_run = -1;
+  }
+  partial_batches = 0;
+
+  {
+    vvas_dpubatch batcher (BATCH_SIZE, timeout_us, num_workers, run_model);
+
+    for (int c = 0; c < NUM_CALLERS; c++)
+      threads.emplace_back (run_caller, &batcher, c);
+    for (auto & thread:threads)
+      thread.join ();
+
+    /* lone request is run once its deadline passes */
+    Caller *caller = &callers[0];
+    caller->frames[0][0] = { 0, NUM_REQUESTS, 0, 1 };
+    caller->inputs[0][0] = (VvasVideoFrame *) & caller->frames[0][0];
+    caller->predictions[0][0] = NULL;
+    CHECK (!VVAS_IS_ERROR (batcher.process (caller->inputs[0],
+                caller->predictions[0], 1)), "lone request failed");
+    CHECK (caller->predictions[0][0] ==
+        (VvasInferPrediction *) caller->inputs[0][0],
+        "lone request got wrong prediction");
+    /* release requests still queued are run by the destructor */
+  }
+
+  for (int c = 0; c < NUM_CALLERS; c++) {
+    CHECK (callers[c].completed.load () == NUM_REQUESTS,
+        "workers %u timeout %u: caller %d completed %d requests",
+        num_workers, timeout_us, c, callers[c].completed.load ());
+  }
+  CHECK (partial_batches.load () > 0,
+      "workers %u timeout %u: no batch dispatched before being full",
+      num_workers, timeout_us);
+}
+
+int
+main (void)
+{
+  for (unsigned int workers = 1; workers <= 3; workers++) {
+    check (workers, 0);
+    check (workers, 2000);
+  }
+
+  printf ("%s: %d failures\n", failures ? "FAIL" : "PASS", failures.load ());
+  return failures ? 1 : 0;
+}
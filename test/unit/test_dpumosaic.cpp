@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks vvas_mosaic_pack () places ROIs inside the model input without
+ * overlap, with guard pixels between them and no more than max_tiles per
+ * mosaic, scaling down ROIs larger than the input. Checks vvas_mosaic_unpack ()
+ * hands detections back to their ROI in ROI coordinates and drops those
+ * straddling tiles.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "vvas_dpumosaic.hpp"
+
+#define INPUT_WIDTH 416
+#define INPUT_HEIGHT 416
+#define NUM_SMALL_ROIS 60
+
+/* pixels a detection mapped back may be off by, for each pixel of the tile */
+#define TOLERANCE 1.5
+
+static int failures;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+      printf (__VA_ARGS__); \
+      printf ("\n"); \
+      failures++; \
+    } \
+  } while (0)
+
+static std::vector < cv::Size > make_rois (uint32_t seed)
+{
+  std::vector < cv::Size > rois;
+
+  for (int i = 0; i < NUM_SMALL_ROIS; i++) {
+    seed = seed * 1103515245u + 12345u;
+    rois.push_back (cv::Size (20 + (seed >> 8) % 100, 20 + (seed >> 20) % 120));
+  }
+  /* larger than the input, wider than high */
+  rois.push_back (cv::Size (800, 300));
+  /* larger than the input, higher than wide */
+  rois.push_back (cv::Size (200, 1000));
+  return rois;
+}
+
+static void
+check_layout (const std::vector < cv::Size > &rois,
+    const std::vector < vvas_mosaic_tile > &tiles, int num, int guard,
+    unsigned int max_tiles)
+{
+  std::vector < unsigned int >count (num, 0);
+  cv::Rect input (0, 0, INPUT_WIDTH, INPUT_HEIGHT);
+
+  CHECK (tiles.size () == rois.size (), "%zu tiles for %zu ROIs",
+      tiles.size (), rois.size ());
+
+  for (size_t i = 0; i < tiles.size (); i++) {
+    const vvas_mosaic_tile & a = tiles[i];
+
+    CHECK (a.mosaic >= 0 && a.mosaic < num, "tile %zu in mosaic %d of %d",
+        i, a.mosaic, num);
+    if (a.mosaic < 0 || a.mosaic >= num)
+      continue;
+    count[a.mosaic]++;
+
+    CHECK ((a.rect & input).area () == a.rect.area () && a.rect.area () > 0,
+        "tile %zu (%d, %d, %d, %d) outside of input", i, a.rect.x, a.rect.y,
+        a.rect.width, a.rect.height);
+
+    if (rois[i].width <= INPUT_WIDTH && rois[i].height <= INPUT_HEIGHT) {
+      CHECK (a.scale == 1.0 && a.rect.width == rois[i].width &&
+          a.rect.height == rois[i].height, "tile %zu resized", i);
+    } else {
+      /* scaled down to fit, keeping aspect ratio */
+      CHECK (a.scale < 1.0 && (a.rect.width >= INPUT_WIDTH - 1 ||
+              a.rect.height >= INPUT_HEIGHT - 1),
+          "tile %zu scale %g size %dx%d",
+          i, a.scale, a.rect.width, a.rect.height);
+      CHECK (abs (a.rect.width - (int) (rois[i].width * a.scale)) <= 1 &&
+          abs (a.rect.height - (int) (rois[i].height * a.scale)) <= 1,
+          "tile %zu does not keep aspect ratio", i);
+    }
+
+    /* other tiles of the mosaic are at least guard pixels away */
+    cv::Rect guarded (a.rect.x - guard, a.rect.y - guard,
+        a.rect.width + 2 * guard, a.rect.height + 2 * guard);
+    for (size_t j = i + 1; j < tiles.size (); j++) {
+      const vvas_mosaic_tile & b = tiles[j];
+
+      CHECK (b.mosaic != a.mosaic || (guarded & b.rect).area () == 0,
+          "tiles %zu and %zu of mosaic %d are closer than %d pixels", i, j,
+          a.mosaic, guard);
+    }
+  }
+
+  for (int m = 0; m < num; m++) {
+    CHECK (count[m] > 0 && count[m] <= max_tiles,
+        "mosaic %d holds %u tiles, max %u", m, count[m], max_tiles);
+  }
+}
+
+static VvasInferPrediction *
+new_detection (VvasInferPrediction * parent, int x, int y, int width,
+    int height)
+{
+  VvasInferPrediction *det = vvas_inferprediction_new ();
+
+  det->bbox.x = x;
+  det->bbox.y = y;
+  det->bbox.width = width;
+  det->bbox.height = height;
+  vvas_inferprediction_append (parent, det);
+  return det;
+}
+
+/* true when no tile of the mosaic holds the point */
+static bool
+is_guard_pixel (const std::vector < vvas_mosaic_tile > &tiles, int mosaic,
+    cv::Point point)
+{
+  for (auto & tile:tiles) {
+    if (tile.mosaic == mosaic && tile.rect.contains (point))
+      return false;
+  }
+  return true;
+}
+
+static void
+check_unpack (const std::vector < cv::Size > &rois,
+    const std::vector < vvas_mosaic_tile > &tiles, int num)
+{
+  std::vector < VvasInferPrediction * >predictions (rois.size (), NULL);
+  unsigned int expected = 0, count = 0;
+
+  for (int m = 0; m < num; m++) {
+    VvasInferPrediction *mosaic = vvas_inferprediction_new ();
+
+    for (size_t i = 0; i < tiles.size (); i++) {
+      const cv::Rect & rect = tiles[i].rect;
+
+      if (tiles[i].mosaic != m)
+        continue;
+
+      /* box in the middle of the ROI */
+      new_detection (mosaic, rect.x + rect.width / 4, rect.y + rect.height / 4,
+          rect.width / 2, rect.height / 2);
+      expected++;
+
+      /* centered in the tile, less than half of it in the tile */
+      new_detection (mosaic, rect.x + rect.width - 12,
+          rect.y + rect.height - 12, 20, 20);
+
+      /* centered on a guard pixel right of the tile */
+      cv::Point guard (rect.x + rect.width, rect.y + rect.height / 2);
+      if (is_guard_pixel (tiles, m, guard))
+        new_detection (mosaic, guard.x - 6, guard.y - 6, 12, 12);
+    }
+    count += vvas_mosaic_unpack (mosaic, m, rois, tiles, predictions.data ());
+  }
+
+  CHECK (count == expected, "%u detections handed back, expected %u", count,
+      expected);
+
+  for (size_t i = 0; i < rois.size (); i++) {
+    VvasInferPrediction *parent = predictions[i];
+
+    CHECK (parent != NULL, "ROI %zu got no detection", i);
+    if (!parent)
+      continue;
+
+    CHECK (parent->bbox.x == 0 && parent->bbox.y == 0 &&
+        (int) parent->bbox.width == rois[i].width &&
+        (int) parent->bbox.height == rois[i].height,
+        "ROI %zu parent box is %ux%u", i, parent->bbox.width,
+        parent->bbox.height);
+    CHECK (vvas_treenode_get_n_childnodes (parent->node) == 1,
+        "ROI %zu got %u detections", i,
+        vvas_treenode_get_n_childnodes (parent->node));
+    if (!parent->node->children)
+      continue;
+
+    VvasBoundingBox *bbox =
+        &((VvasInferPrediction *) parent->node->children->data)->bbox;
+    int tolerance = (int) (TOLERANCE / tiles[i].scale);
+    CHECK (abs (bbox->x - rois[i].width / 4) <= tolerance &&
+        abs (bbox->y - rois[i].height / 4) <= tolerance &&
+        abs ((int) bbox->width - rois[i].width / 2) <= tolerance &&
+        abs ((int) bbox->height - rois[i].height / 2) <= tolerance,
+        "ROI %zu %dx%d detection is (%d, %d, %u, %u)", i, rois[i].width,
+        rois[i].height, bbox->x, bbox->y, bbox->width, bbox->height);
+
+    vvas_inferprediction_free (parent);
+  }
+}
+
+static void
+check (uint32_t seed, int guard, unsigned int max_tiles)
+{
+  std::vector < cv::Size > rois = make_rois (seed);
+  std::vector < vvas_mosaic_tile > tiles;
+  int num;
+
+  num = vvas_mosaic_pack (rois, cv::Size (INPUT_WIDTH, INPUT_HEIGHT), guard,
+      max_tiles, tiles);
+
+  CHECK (num > 0 && (size_t) num <= rois.size (),
+      "%d mosaics for %zu ROIs", num, rois.size ());
+  CHECK ((size_t) num * max_tiles >= rois.size (),
+      "%d mosaics of %u tiles for %zu ROIs", num, max_tiles, rois.size ());
+  check_layout (rois, tiles, num, guard, max_tiles);
+  check_unpack (rois, tiles, num);
+}
+
+int
+main (void)
+{
+  static const int guards[] = { 0, 1, 4, 16 };
+  static const unsigned int max_tiles[] = { 1, 3, 16, 64 };
+
+  for (uint32_t seed = 1; seed <= 8; seed++) {
+    for (auto guard:guards) {
+      for (auto tiles:max_tiles)
+        check (seed, guard, tiles);
+    }
+  }
+
+  printf ("%s: %d failures\n", failures ? "FAIL" : "PASS", failures);
+  return failures ? 1 : 0;
+}
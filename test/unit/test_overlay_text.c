@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Draws text on NV12 frames with more font/size pairs than the per thread
+ * glyph atlas cache holds. Texts are ordered so that the atlas of a text for
+ * the Y plane is the oldest cached one when its atlas for the UV plane is
+ * created, and the last text must look the same as when it is drawn alone.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <vvas_core/vvas_context.h>
+#include <vvas_core/vvas_video.h>
+#include <vvas_core/vvas_overlay.h>
+
+#define FRAME_WIDTH 1920
+#define FRAME_HEIGHT 1080
+
+/* rows below this one are drawn only by the last text */
+#define CHECK_ROW 900
+
+typedef struct
+{
+  uint32_t font_num;
+  float font_size;
+  int32_t x;
+  int32_t y;
+} TextSpec;
+
+/* UV atlas of a text is scaled by half, so a text hits the atlas created
+ * for the UV plane of a text of twice its size */
+static const TextSpec texts[] = {
+  {0, 0.5f, 40, 100},           /* Y 0.5, UV 0.25 */
+  {0, 1.0f, 40, 160},           /* Y 1.0, UV 0.5 hit */
+  {1, 0.7f, 40, 220},
+  {2, 0.7f, 40, 280},
+  {3, 0.7f, 40, 340},
+  {4, 0.7f, 40, 400},
+  {5, 0.7f, 40, 460},
+  {6, 0.7f, 40, 520},           /* 15 atlases */
+  {0, 2.0f, 600, 300},          /* Y 2.0 is 16th, cache is full, UV 1.0 hit */
+  {0, 4.0f, 600, 600},          /* Y 4.0 drops Y 0.5, UV 2.0 hit */
+  {0, 0.25f, 40, 1040},         /* Y 0.25 hit is oldest, UV 0.125 drops it */
+};
+
+#define NUM_TEXTS (sizeof (texts) / sizeof (texts[0]))
+
+typedef struct
+{
+  VvasVideoFrame *frame;
+  uint32_t first;
+  VvasReturnType vret;
+} DrawJob;
+
+static void *
+draw_texts (void *data)
+{
+  DrawJob *job = (DrawJob *) data;
+  VvasOverlayShapeBatch batch;
+  VvasOverlayFrameInfo frame_info;
+  uint32_t i;
+
+  vvas_overlay_shape_batch_init (&batch);
+  for (i = job->first; i < NUM_TEXTS; i++) {
+    VvasOverlayTextParams text;
+
+    memset (&text, 0x0, sizeof (text));
+    text.points.x = texts[i].x;
+    text.points.y = texts[i].y;
+    text.disp_text = (char *) "VVAS 0123";
+    text.bottom_left_origin = 1;
+    text.text_font.font_num = texts[i].font_num;
+    text.text_font.font_size = texts[i].font_size;
+    text.text_font.font_color.red = 255;
+    if (!vvas_overlay_shape_batch_add_text (&batch, &text)) {
+      job->vret = VVAS_RET_ALLOC_ERROR;
+      goto exit;
+    }
+  }
+
+  memset (&frame_info, 0x0, sizeof (frame_info));
+  frame_info.frame_info = job->frame;
+  job->vret = vvas_overlay_process_frame_batch (&frame_info, &batch);
+
+exit:
+  vvas_overlay_shape_batch_free (&batch);
+  return NULL;
+}
+
+/* atlases are cached per thread, a new thread starts with an empty cache */
+static VvasReturnType
+draw_on_new_thread (VvasVideoFrame * frame, uint32_t first)
+{
+  DrawJob job = { frame, first, VVAS_RET_ERROR };
+  pthread_t thread;
+
+  if (pthread_create (&thread, NULL, draw_texts, &job))
+    return VVAS_RET_ERROR;
+  pthread_join (thread, NULL);
+  return job.vret;
+}
+
+static VvasVideoFrame *
+alloc_frame (VvasContext * ctx)
+{
+  VvasVideoFrameMapInfo info;
+  VvasVideoFrame *frame;
+  VvasVideoInfo vinfo;
+  VvasReturnType vret;
+
+  memset (&vinfo, 0x0, sizeof (vinfo));
+  vinfo.width = FRAME_WIDTH;
+  vinfo.height = FRAME_HEIGHT;
+  vinfo.fmt = VVAS_VIDEO_FORMAT_Y_UV8_420;
+  vinfo.n_planes = 2;
+
+  frame = vvas_video_frame_alloc (ctx, VVAS_ALLOC_TYPE_NON_CMA,
+      VVAS_ALLOC_FLAG_NONE, 0, &vinfo, &vret);
+  if (!frame)
+    return NULL;
+
+  if (VVAS_IS_ERROR (vvas_video_frame_map (frame, VVAS_DATA_MAP_WRITE,
+              &info))) {
+    vvas_video_frame_free (frame);
+    return NULL;
+  }
+  memset (info.planes[0].data, 0x10, info.planes[0].size);
+  memset (info.planes[1].data, 0x80, info.planes[1].size);
+  vvas_video_frame_unmap (frame, &info);
+
+  return frame;
+}
+
+static int
+compare_rows (VvasVideoFrame * frame, VvasVideoFrame * ref)
+{
+  VvasVideoFrameMapInfo info, ref_info;
+  int failures = 0;
+  uint32_t plane;
+
+  if (VVAS_IS_ERROR (vvas_video_frame_map (frame, VVAS_DATA_MAP_READ, &info)))
+    return 1;
+  if (VVAS_IS_ERROR (vvas_video_frame_map (ref, VVAS_DATA_MAP_READ,
+              &ref_info))) {
+    vvas_video_frame_unmap (frame, &info);
+    return 1;
+  }
+
+  for (plane = 0; plane < 2; plane++) {
+    /* UV plane has half the rows */
+    uint32_t row = plane ? CHECK_ROW / 2 : CHECK_ROW;
+    uint32_t rows = plane ? FRAME_HEIGHT / 2 : FRAME_HEIGHT;
+
+    for (; row < rows; row++) {
+      const uint8_t *a = info.planes[plane].data +
+          row * info.planes[plane].stride;
+      const uint8_t *b = ref_info.planes[plane].data +
+          row * ref_info.planes[plane].stride;
+
+      if (memcmp (a, b, FRAME_WIDTH)) {
+        printf ("mismatch in plane %u row %u\n", plane, row);
+        failures++;
+      }
+    }
+  }
+
+  vvas_video_frame_unmap (ref, &ref_info);
+  vvas_video_frame_unmap (frame, &info);
+  return failures;
+}
+
+int
+main (void)
+{
+  VvasVideoFrame *frame = NULL, *ref = NULL;
+  VvasContext *ctx;
+  VvasReturnType vret;
+  int failures = 1;
+
+  ctx = vvas_context_create (-1, NULL, LOG_LEVEL_WARNING, &vret);
+  if (!ctx) {
+    printf ("FAIL: failed to create context\n");
+    return 1;
+  }
+
+  frame = alloc_frame (ctx);
+  ref = alloc_frame (ctx);
+  if (!frame || !ref) {
+    printf ("FAIL: failed to allocate frames\n");
+    goto exit;
+  }
+
+  if (VVAS_IS_ERROR (draw_on_new_thread (frame, 0)) ||
+      VVAS_IS_ERROR (draw_on_new_thread (ref, NUM_TEXTS - 1))) {
+    printf ("FAIL: failed to draw text\n");
+    goto exit;
+  }
+
+  failures = compare_rows (frame, ref);
+  printf ("%s: %d mismatches\n", failures ? "FAIL" : "PASS", failures);
+
+exit:
+  if (frame)
+    vvas_video_frame_free (frame);
+  if (ref)
+    vvas_video_frame_free (ref);
+  vvas_context_destroy (ctx);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2022 Xilinx, Inc.
+ * Copyright (C) 2022-2023 Advanced Micro Devices, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Checks float_to_int8 () and int8_to_float () give the same bits whether
+ * values go through the SIMD loop, which handles blocks of 16 values, or the
+ * scalar loop, which handles the remaining ones.
+ */
+
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include <limits>
+#include "vvas_tensor_convert.hpp"
+
+#define MAX_VALUES 67
+
+static const float values[] = { 0.f, -0.f, 0.5f, -0.5f, 1.5f, -1.5f, 2.5f,
+  -2.5f, 126.5f, 127.f, 127.49f, 127.5f, 128.f, 128.5f, -127.5f, -128.f,
+  -128.5f, -129.f, 1e9f, -1e9f, std::numeric_limits < float >::max (),
+  std::numeric_limits < float >::lowest (),
+  std::numeric_limits < float >::denorm_min (),
+  std::numeric_limits < float >::infinity (),
+  -std::numeric_limits < float >::infinity (),
+  std::numeric_limits < float >::quiet_NaN (),
+  -std::numeric_limits < float >::quiet_NaN ()
+};
+
+#define NUM_VALUES (sizeof (values) / sizeof (values[0]))
+
+static const float scales[] = { 1.f, 0.5f, 2.f, 64.f, -1.f, 1e-3f, 0.f };
+
+#define NUM_SCALES (sizeof (scales) / sizeof (scales[0]))
+
+/* shorter than, equal to and longer than one or more SIMD blocks */
+static const size_t lengths[] = { 1, 15, 16, 17, 31, 33, 64, MAX_VALUES };
+
+static int
+check_float_to_int8 (size_t n, float scale, uint32_t seed)
+{
+  float src[MAX_VALUES];
+  int8_t simd[MAX_VALUES], scalar[MAX_VALUES];
+  int failures = 0;
+  size_t i;
+
+  for (i = 0; i < n; i++, seed = seed * 1103515245u + 12345u)
+    src[i] = values[(seed >> 8) % NUM_VALUES];
+
+  float_to_int8 (src, simd, n, scale);
+  for (i = 0; i < n; i++)
+    float_to_int8 (&src[i], &scalar[i], 1, scale);
+
+  for (i = 0; i < n; i++) {
+    if (simd[i] != scalar[i]) {
+      printf ("float_to_int8 mismatch length %zu scale %g value %g: "
+          "%d != %d\n", n, scale, src[i], simd[i], scalar[i]);
+      failures++;
+    }
+  }
+  return failures;
+}
+
+static int
+check_int8_to_float (size_t n, float scale, uint32_t seed)
+{
+  int8_t src[MAX_VALUES];
+  float simd[MAX_VALUES], scalar[MAX_VALUES];
+  int failures = 0;
+  size_t i;
+
+  /* both ends of int8 range are always converted */
+  for (i = 0; i < n; i++, seed = seed * 1103515245u + 12345u)
+    src[i] = (i == 0) ? INT8_MIN : (i + 1 == n) ? INT8_MAX :
+        (int8_t) (seed >> 16);
+
+  int8_to_float (src, simd, n, scale);
+  for (i = 0; i < n; i++)
+    int8_to_float (&src[i], &scalar[i], 1, scale);
+
+  for (i = 0; i < n; i++) {
+    if (memcmp (&simd[i], &scalar[i], sizeof (float))) {
+      printf ("int8_to_float mismatch length %zu scale %g value %d: "
+          "%g != %g\n", n, scale, src[i], simd[i], scalar[i]);
+      failures++;
+    }
+  }
+  return failures;
+}
+
+/* values which must be same on all platforms */
+static int
+check_expected (void)
+{
+  static const struct
+  {
+    float value;
+    int8_t expected;
+  } cases[] = {
+    {0.5f, 0}, {1.5f, 2}, {2.5f, 2}, {-2.5f, -2}, {127.5f, 127},
+    {128.f, 127}, {1e9f, 127}, {-128.5f, -128}, {-1e9f, -128},
+    {std::numeric_limits < float >::infinity (), 127},
+    {-std::numeric_limits < float >::infinity (), -128},
+    {std::numeric_limits < float >::quiet_NaN (), 0},
+  };
+  float src[16];
+  int8_t dst[16];
+  int failures = 0;
+  size_t i, k;
+
+  /* a whole block, so that SIMD platforms check their SIMD loop */
+  for (i = 0; i < sizeof (cases) / sizeof (cases[0]); i++) {
+    for (k = 0; k < 16; k++)
+      src[k] = cases[i].value;
+    float_to_int8 (src, dst, 16, 1.f);
+    for (k = 0; k < 16; k++) {
+      if (dst[k] != cases[i].expected) {
+        printf ("float_to_int8 of %g gives %d instead of %d\n",
+            cases[i].value, dst[k], cases[i].expected);
+        failures++;
+        break;
+      }
+    }
+  }
+  return failures;
+}
+
+int
+main (void)
+{
+  uint32_t seed = 1;
+  int failures = check_expected ();
+  size_t l, s;
+
+  for (s = 0; s < NUM_SCALES; s++) {
+    for (l = 0; l < sizeof (lengths) / sizeof (lengths[0]); l++) {
+      for (int rep = 0; rep < 16; rep++) {
+        failures += check_float_to_int8 (lengths[l], scales[s], seed++);
+        failures += check_int8_to_float (lengths[l], scales[s], seed++);
+      }
+    }
+  }
+
+  printf ("%s: %d mismatches\n", failures ? "FAIL" : "PASS", failures);
+  return failures ? 1 : 0;
+}